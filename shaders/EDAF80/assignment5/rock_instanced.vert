@@ -0,0 +1,68 @@
+#version 410
+#define PI 3.141592653589793
+
+layout (location = 0) in vec3 vertex;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 texcoord;
+layout (location = 3) in vec3 tangent;
+layout (location = 4) in vec3 binormal;
+
+uniform float planet_radius;
+
+// Rocks baked by planet::rock_placements: their transforms from model space
+// to the flat world, relative to their foot, and their warp matrices, with
+// the rotation at the foot in xyz, the arc scales in the w of the first
+// three columns, and the cubic in the exponent of the height profile in the
+// fourth one.
+uniform mat4[100] vertex_model_to_world;
+uniform mat4[100] rock_warps;
+uniform mat4 vertex_world_to_clip;
+
+out VS_OUT {
+	vec3 vertex;
+	mat3 tbn;
+	vec2 texcoord;
+	float height;
+} vs_out;
+
+// rotate_by_dir() of rock_on_sphr.vert.
+mat3 rotate_by_dir(float angle, vec2 direction){
+	vec3 ax = vec3(-direction.y,0.0,direction.x);
+	float c = cos(-angle),
+		  s = sin(-angle);
+
+	return mat3(vec3(ax.x*ax.x+(1-ax.x*ax.x)*c, ax.z*s,ax.x*ax.z*(1-c)),
+				vec3(                  -ax.z*s,      c,         ax.x*s),
+				vec3(          ax.x*ax.z*(1-c),-ax.x*s,ax.z*ax.z+(1-ax.z*ax.z)*c)
+			   );
+}
+
+void main()
+{
+	mat4 model_to_foot = vertex_model_to_world[gl_InstanceID];
+	mat4 warp = rock_warps[gl_InstanceID];
+
+	vec3 local = vec3(model_to_foot * vec4(vertex, 1.0));
+
+	// Bend the offset from the foot around the sphere, as arcs.
+	vec2 offset = mat2(warp[0].w, warp[1].w, warp[1].w, warp[2].w) * local.xz;
+	float arc = length(offset);
+	vec2 dir = arc > 0.0 ? offset / arc : vec2(0.0);
+	mat3 rotation = mat3(warp) * rotate_by_dir(min(PI, arc / planet_radius), dir);
+
+	// Exact height profile of rock_on_sphr.vert, with the heights taken
+	// from the foot.
+	float exponent = ((warp[3].w * local.y + warp[3].z) * local.y + warp[3].y) * local.y + warp[3].x;
+	float h = planet_radius * exp(exponent);
+
+	// Transpose of the inverse, from the cofactors: no inverse() per vertex.
+	mat3 m = mat3(model_to_foot);
+	mat3 cofactors = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]));
+	vs_out.tbn = rotation * (cofactors / dot(m[0], cofactors[0])) * mat3(tangent, binormal, normal);
+
+	vs_out.texcoord = texcoord.xy;
+	vs_out.vertex = h * rotation[1];
+	vs_out.height = h - planet_radius;
+
+	gl_Position = vertex_world_to_clip * vec4(vs_out.vertex, 1.0);
+}
@@ -0,0 +1,49 @@
+#version 410
+
+layout (location = 0) in vec3 vertex;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 texcoord;
+layout (location = 3) in vec3 tangent;
+layout (location = 4) in vec3 binormal;
+
+uniform mat4 vertex_model_to_world;
+uniform mat4 normal_model_to_world;
+uniform mat4 vertex_world_to_clip;
+
+uniform float nowTime;
+
+uniform vec2 texScale;
+uniform vec2 bumpSpeed;
+
+// Written by my_ocean3.comp, in the frame of the undisplaced surface.
+uniform sampler2D wave_displacement_map;
+uniform sampler2D wave_normal_map;
+
+out VS_OUT {
+	vec3 vertex;
+	mat3 tang_to_world;
+	vec2 bumpCoord[3];
+} vs_out;
+
+void main()
+{
+	vec3 displacement = textureLod(wave_displacement_map, texcoord.xy, 0.0).xyz;
+	vec3 norm = normalize(textureLod(wave_normal_map, texcoord.xy, 0.0).xyz);
+
+	// Only the normal is stored: the tangent is the one of a heightfield.
+	vec3 tang = normalize(vec3(norm.z, 0.0, -norm.x));
+	vec3 bino = cross(norm, tang);
+
+	vs_out.bumpCoord[0] = texcoord.xy*texScale.xy + nowTime*bumpSpeed;
+	vs_out.bumpCoord[1] = texcoord.xy*texScale.xy*2 + nowTime*bumpSpeed*4;
+	vs_out.bumpCoord[2] = texcoord.xy*texScale.xy*4 + nowTime*bumpSpeed*8;
+
+	mat3 modelsurface_to_model = mat3(tangent,binormal,normal);
+
+	//						world	<-	model		  ,	model<-modelsurface	, modelsurface <- wavesurface
+	vs_out.tang_to_world = mat3(normal_model_to_world)*modelsurface_to_model*mat3(tang,bino,norm);
+
+	vs_out.vertex = vec3(vertex_model_to_world * vec4(vertex+modelsurface_to_model*displacement,1.0));
+
+	gl_Position = vertex_world_to_clip * vec4(vs_out.vertex,1.0);
+}
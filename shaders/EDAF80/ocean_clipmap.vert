@@ -0,0 +1,64 @@
+#version 410
+
+layout (location = 0) in vec3 vertex;
+
+//One transform per tile, scaling its unit grid by the spacing of its level.
+uniform mat4 vertex_model_to_world[100];
+uniform mat4 vertex_world_to_clip;
+uniform vec3 camera_position;
+
+uniform float clipmap_block_size;
+uniform float clipmap_coarsest_spacing;
+
+uniform float nowTime;
+
+//Displacements (x, height, z) of the FFT ocean, tiling every patch_size.
+uniform sampler2D displacement_map;
+uniform float patch_size;
+uniform float texels_per_metre;
+
+uniform vec2 texScale;
+uniform vec2 bumpSpeed;
+
+out VS_OUT {
+	vec3 vertex;
+	vec2 ocean_coord;
+	vec2 bumpCoord[3];
+} vs_out;
+
+void main()
+{
+	mat4 tile_to_world = vertex_model_to_world[gl_InstanceID];
+	float spacing = tile_to_world[0][0];
+	vec3 position = vec3(tile_to_world * vec4(vertex,1.0));
+
+	//Every level is at least 2M - 1 of its quads from the camera to its
+	//outer edge, and the previous level, snapped to twice its own spacing,
+	//reaches up to M + 1.5 of them: move the odd vertices onto their even
+	//neighbours from M + 2 on, so that the inner edge stays on the grid of
+	//the previous level and the outer edge matches the next level, which
+	//is twice as coarse.
+	vec2 from_camera = abs(position.xz - camera_position.xz);
+	float distance = max(from_camera.x,from_camera.y)/spacing;
+	float morph_start = clipmap_block_size + 2.0;
+	float morph_end = 2.0*clipmap_block_size - 1.0;
+	float morph = clamp((distance - morph_start)/max(morph_end - morph_start,1.0),0.0,1.0);
+	if (spacing >= clipmap_coarsest_spacing)
+		morph = 0.0;
+	vec2 grid_position = floor(position.xz/spacing + 0.5);
+	position.xz -= mod(grid_position,2.0)*spacing*morph;
+
+	//Sample with the mip level matching the spacing of the vertices, so
+	//that waves shorter than it do not alias.
+	vs_out.ocean_coord = position.xz/patch_size;
+	float lod = max(log2(spacing*texels_per_metre),0.0);
+	vec3 displacement = textureLod(displacement_map,vs_out.ocean_coord,lod).xyz;
+
+	vs_out.bumpCoord[0] = vs_out.ocean_coord*texScale.xy + nowTime*bumpSpeed;
+	vs_out.bumpCoord[1] = vs_out.ocean_coord*texScale.xy*2 + nowTime*bumpSpeed*4;
+	vs_out.bumpCoord[2] = vs_out.ocean_coord*texScale.xy*4 + nowTime*bumpSpeed*8;
+
+	vs_out.vertex = position + displacement;
+
+	gl_Position = vertex_world_to_clip * vec4(vs_out.vertex,1.0);
+}
@@ -0,0 +1,66 @@
+#version 410
+
+uniform vec3 camera_position;
+uniform samplerCube cubemap_texture;
+uniform sampler2D bump_texture;
+//Normals (xyz) and foam coverage (w) of the FFT ocean.
+uniform sampler2D normal_foam_map;
+
+uniform mat4 normal_model_to_world;
+
+uniform vec3 water_deep_color;
+uniform vec3 water_shallow_color;
+
+uniform float waveBumpScale;
+uniform float reflectionScale;
+uniform float refractionScale;
+
+in VS_OUT {
+	vec3 vertex;
+	vec2 ocean_coord;
+	vec2 bumpCoord[3];
+} fs_in;
+
+out vec4 frag_color;
+
+void main(){
+	vec4 normal_foam = texture(normal_foam_map,fs_in.ocean_coord);
+	vec3 wave_normal = normalize(normal_foam.xyz);
+
+	//Tangent frame of the wave surface, to add the small ripples of the
+	//bump texture on top of the simulated waves.
+	vec3 tang = normalize(vec3(1.0,0.0,0.0) - wave_normal.x*wave_normal);
+	vec3 bino = cross(tang,wave_normal);
+
+	vec3 normalTexs[3];
+	normalTexs[0] = texture(bump_texture,fs_in.bumpCoord[0]).xyz-0.5;
+	normalTexs[1] = texture(bump_texture,fs_in.bumpCoord[1]).xyz-0.5;
+	normalTexs[2] = texture(bump_texture,fs_in.bumpCoord[2]).xyz-0.5;
+	vec3 blendedNormal = normalize(
+		2.0*(normalTexs[0]+normalTexs[1]+normalTexs[2])
+	);
+	blendedNormal = mix(vec3(0.0,0.0,1.0),blendedNormal,waveBumpScale);
+
+	vec3 normal = normalize(mat3(normal_model_to_world)*(mat3(tang,bino,wave_normal)*blendedNormal));
+
+	vec3 toCamera = normalize(camera_position - fs_in.vertex);
+
+	float facing = 1.0-max(dot(toCamera,normal),0.0);
+	vec3 water_color = mix(water_deep_color,water_shallow_color,facing);
+
+	float fastFresnel = clamp(0.02037 + (1.0-0.02037)*pow(1.0-dot(toCamera,normal),5.0),0.0,1.0);
+	vec3 reflection = reflectionScale*texture(cubemap_texture,reflect(-toCamera,normal)).rgb;
+
+	vec3 refractVec = refract(-toCamera,normal,1.0/1.33);
+	vec3 refraction = refractionScale*texture(cubemap_texture,refractVec).rgb*(1-fastFresnel);
+
+	vec3 retCol =
+				water_color
+				+ reflection * fastFresnel
+				+ water_deep_color * refraction * (1.0-fastFresnel);
+
+	//Foam where the surface folds onto itself, at the crests.
+	retCol = mix(retCol,vec3(0.9),normal_foam.w);
+
+	frag_color = vec4(pow(retCol,vec3(1.0/2.2)),1.0);
+}
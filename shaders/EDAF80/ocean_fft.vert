@@ -0,0 +1,44 @@
+#version 410
+
+layout (location = 0) in vec3 vertex;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 texcoord;
+layout (location = 3) in vec3 tangent;
+layout (location = 4) in vec3 binormal;
+
+uniform mat4 vertex_model_to_world;
+uniform mat4 normal_model_to_world;
+uniform mat4 vertex_world_to_clip;
+
+uniform float nowTime;
+
+//Displacements (x, height, z) of the FFT ocean, tiling every patch_size.
+uniform sampler2D displacement_map;
+uniform float patch_size;
+uniform float displacement_lod;
+
+uniform vec2 texScale;
+uniform vec2 bumpSpeed;
+
+out VS_OUT {
+	vec3 vertex;
+	vec2 ocean_coord;
+	vec2 bumpCoord[3];
+} vs_out;
+
+void main()
+{
+	//The grid lies in the xz plane of the model; sample with the mip level
+	//matching the spacing of its vertices, so that waves shorter than it
+	//do not alias.
+	vs_out.ocean_coord = vertex.xz/patch_size;
+	vec3 displacement = textureLod(displacement_map,vs_out.ocean_coord,displacement_lod).xyz;
+
+	vs_out.bumpCoord[0] = texcoord.xy*texScale.xy + nowTime*bumpSpeed;
+	vs_out.bumpCoord[1] = texcoord.xy*texScale.xy*2 + nowTime*bumpSpeed*4;
+	vs_out.bumpCoord[2] = texcoord.xy*texScale.xy*4 + nowTime*bumpSpeed*8;
+
+	vs_out.vertex = vec3(vertex_model_to_world * vec4(vertex+displacement,1.0));
+
+	gl_Position = vertex_world_to_clip * vec4(vs_out.vertex,1.0);
+}
@@ -0,0 +1,49 @@
+#version 410
+#define PI 3.141592653589793
+
+layout (location = 0) in vec3 vertex;
+
+//One transform per patch, from its grid to the surface of the cube.
+uniform mat4[100] vertex_model_to_world;
+uniform mat4 vertex_world_to_clip;
+uniform vec3 camera_position;
+
+uniform float planet_radius;
+uniform float cdlod_range_per_step;
+uniform float cdlod_morph_fraction;
+
+out VS_OUT {
+	vec3 vertex;
+	mat3 tbn;
+	vec2 texcoord;
+} vs_out;
+
+//Equal-angle mapping of the cube onto the unit sphere.
+vec3 on_sphere(vec3 cube){
+	return normalize(tan(cube*PI/4.0));
+}
+
+void main()
+{
+	mat4 patch_to_cube = vertex_model_to_world[gl_InstanceID];
+	vec3 u = patch_to_cube[0].xyz;
+	vec3 v = patch_to_cube[2].xyz;
+	float step = length(u);
+
+	//Odd vertices slide onto their even neighbours as they get close to the
+	//range of their level, where the next level is twice as coarse.
+	vec3 position = planet_radius*on_sphere(vec3(patch_to_cube*vec4(vertex,1.0)));
+	float range = cdlod_range_per_step*step;
+	float morph = clamp((distance(position,camera_position) - (1.0-cdlod_morph_fraction)*range)/(cdlod_morph_fraction*range),0.0,1.0);
+	vec2 grid_position = vertex.xz - mod(vertex.xz,2.0)*morph;
+
+	vec3 cube = vec3(patch_to_cube*vec4(grid_position.x,0.0,grid_position.y,1.0));
+	vec3 n = on_sphere(cube);
+	vec3 t = normalize(u - dot(u,n)*n);
+	vs_out.tbn = mat3(t,cross(t,n),n);
+	vs_out.texcoord = 0.5*vec2(dot(cube,u),dot(cube,v))/step + 0.5;
+
+	vs_out.vertex = planet_radius*n;
+
+	gl_Position = vertex_world_to_clip * vec4(vs_out.vertex,1.0);
+}
@@ -0,0 +1,70 @@
+#version 410
+
+uniform samplerBuffer draw_transforms;
+uniform uint draw_id_offset;
+uniform uint normal_transforms_base;
+uniform mat4 vertex_world_to_clip;
+
+// Attributes follow bonobo::compact_vertex_format.
+layout (location = 0) in vec3 vertex;
+layout (location = 1) in vec2 normal;   // octahedral, snorm16
+layout (location = 2) in vec2 texcoord; // half floats
+layout (location = 3) in ivec2 tangent; // octahedral, snorm16; handedness in the LSB of y
+layout (location = 5) in uint draw_id;
+
+out VS_OUT {
+	vec3 normal;
+	vec2 texcoord;
+	vec3 tangent;
+	vec3 binormal;
+} vs_out;
+
+
+vec2 sign_not_zero(vec2 v)
+{
+	return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec3 octahedral_decode(vec2 e)
+{
+	vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (v.z < 0.0)
+		v.xy = (1.0 - abs(v.yx)) * sign_not_zero(v.xy);
+	return normalize(v);
+}
+
+mat4 fetch_model_to_world()
+{
+	int base = 4 * int(draw_id + draw_id_offset);
+	return mat4(texelFetch(draw_transforms, base + 0),
+	            texelFetch(draw_transforms, base + 1),
+	            texelFetch(draw_transforms, base + 2),
+	            texelFetch(draw_transforms, base + 3));
+}
+
+mat3 fetch_normal_model_to_world()
+{
+	int base = int(normal_transforms_base) + 3 * int(draw_id + draw_id_offset);
+	return mat3(texelFetch(draw_transforms, base + 0).xyz,
+	            texelFetch(draw_transforms, base + 1).xyz,
+	            texelFetch(draw_transforms, base + 2).xyz);
+}
+
+void main() {
+	float handedness = (tangent.y & 1) != 0 ? -1.0 : 1.0;
+
+	// Unlike fill_gbuffer.vert, the frame is output in world-space, using
+	// the normal transform of the draw: `normal_model_to_world` is left to
+	// the identity for this program.
+	mat4 model_to_world = fetch_model_to_world();
+	mat3 normal_model_to_world = fetch_normal_model_to_world();
+	vec3 model_normal = octahedral_decode(normal);
+	vec3 model_tangent = octahedral_decode(max(vec2(tangent) / 32767.0, -1.0));
+
+	vs_out.normal   = normalize(normal_model_to_world * model_normal);
+	vs_out.texcoord = texcoord;
+	vs_out.tangent  = normalize(mat3(model_to_world) * model_tangent);
+	vs_out.binormal = handedness * cross(vs_out.normal, vs_out.tangent);
+
+	gl_Position = vertex_world_to_clip * model_to_world * vec4(vertex, 1.0);
+}
@@ -0,0 +1,22 @@
+#version 410
+
+uniform samplerBuffer draw_transforms;
+uniform uint draw_id_offset;
+uniform mat4 vertex_world_to_clip;
+
+layout (location = 0) in vec3 vertex;
+layout (location = 5) in uint draw_id;
+
+mat4 fetch_model_to_world()
+{
+	int base = 4 * int(draw_id + draw_id_offset);
+	return mat4(texelFetch(draw_transforms, base + 0),
+	            texelFetch(draw_transforms, base + 1),
+	            texelFetch(draw_transforms, base + 2),
+	            texelFetch(draw_transforms, base + 3));
+}
+
+void main()
+{
+	gl_Position = vertex_world_to_clip * fetch_model_to_world() * vec4(vertex, 1.0);
+}
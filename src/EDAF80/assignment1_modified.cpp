@@ -1,4 +1,5 @@
 #include "config.hpp"
+#include "core/animation.hpp"
 #include "core/FPSCamera.h"
 #include "core/helpers.hpp"
 #include "core/Log.h"
@@ -14,6 +15,7 @@
 #include <stack>
 #include <vector>
 
+#include <cmath>
 #include <cstdlib>
 
 #include <glm/gtc/type_ptr.hpp>
@@ -392,6 +394,40 @@ int main()
         root_node.add_child(child);
     }
 
+    //Spins of the planets, moons and rings, as a looping clip with a key
+    //every quarter turn of each node
+    std::vector<Node *> spinning_nodes;
+    bonobo::animation_clip spins;
+    spins.set_looping(true);
+    auto const addSpin = [&spinning_nodes, &spins](Node &node, float speed, glm::vec3 const &axis)
+    {
+        float const quarter_turn_duration = glm::half_pi<float>() / std::abs(speed);
+        std::vector<float> times;
+        std::vector<glm::quat> rotations;
+        for (int k = 0; k <= 4; ++k)
+        {
+            times.push_back(quarter_turn_duration * static_cast<float>(k));
+            rotations.push_back(glm::angleAxis(std::copysign(glm::half_pi<float>(), speed) * static_cast<float>(k), axis));
+        }
+        spins.add_rotation_track(spinning_nodes.size(), times, rotations);
+        spinning_nodes.push_back(&node);
+    };
+    glm::vec3 const y_axis(0.0f, 1.0f, 0.0f);
+    addSpin(skaia_node, skaia_spin_speed, y_axis);
+    addSpin(lowas_node, lowas_spin_speed, y_axis);
+    addSpin(lolar_node, lolar_spin_speed, y_axis);
+    addSpin(lohac_node, lohac_spin_speed, y_axis);
+    addSpin(planets, planets_spin_speed, y_axis);
+    addSpin(prospit_orbit, prospit_orbit_speed, glm::vec3(0.0f, 0.0f, 1.0f));
+    addSpin(prospit_node, prospit_spin_speed, y_axis);
+    addSpin(prospit_barycenter, -1.1f * prospit_spin_speed, y_axis);
+    addSpin(prospit_moon, -0.5f * prospit_spin_speed, y_axis);
+    addSpin(far_ring, far_ring_speed, y_axis);
+    addSpin(far_ring_rocks, 0.1f * far_ring_speed, y_axis);
+    addSpin(derse_node, derse_spin_speed, y_axis);
+    addSpin(gate_root, planets_spin_speed, y_axis);
+    bonobo::animation_sampler spin_sampler(spins);
+
     // Retrieve the actual framebuffer size: for HiDPI monitors, you might
     // end up with a framebuffer larger than what you actually asked for.
     // For example, if you ask for a 1920x1080 framebuffer, you might get a
@@ -408,7 +444,8 @@ int main()
     bool show_gui = true;
 
     size_t fpsSamples = 0;
-    double lastTime = GetTimeSeconds();
+    double const startTime = GetTimeSeconds();
+    double lastTime = startTime;
     double fpsNextTick = lastTime + 1.0;
 
     while (!glfwWindowShouldClose(window))
@@ -500,19 +537,8 @@ int main()
         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
         //Update transforms
-        skaia_node.rotate_y(skaia_spin_speed * delta_time);
-        lowas_node.rotate_y(lowas_spin_speed * delta_time);
-        lolar_node.rotate_y(lolar_spin_speed * delta_time);
-        lohac_node.rotate_y(lohac_spin_speed * delta_time);
-        planets.rotate_y(planets_spin_speed * delta_time);
-        prospit_orbit.rotate_z(prospit_orbit_speed * delta_time);
-        prospit_node.rotate_y(prospit_spin_speed * delta_time);
-        prospit_barycenter.rotate_y(-1.1f * prospit_spin_speed * delta_time);
-        prospit_moon.rotate_y(-0.5f * prospit_spin_speed * delta_time);
-        far_ring.rotate_y(far_ring_speed * delta_time);
-        far_ring_rocks.rotate_y(0.1f * far_ring_speed * delta_time);
-        derse_node.rotate_y(derse_spin_speed * delta_time);
-        gate_root.rotate_y(planets_spin_speed * delta_time);
+        spin_sampler.sample(static_cast<float>(nowTime - startTime));
+        spin_sampler.apply(spinning_nodes.data());
 
         //Traverse the scene graph and render all nodes
         renderNodeTree(&root_node, camera.GetWorldToClipMatrix());
@@ -545,6 +571,8 @@ int main()
         {
             ImGui::DragInt("FOLLOW_PLANET", &FOLLOW_PLANET, 0.1f, 0, 7);
             ImGui::Text("%s", (std::to_string(delta_time)).c_str());
+            if (ImGui::Button("Benchmark keyframe animation"))
+                bonobo::benchmark_animation();
             ImGui::Render();
         }
 
@@ -8,6 +8,7 @@
 #include "core/Log.h"
 #include "core/LogView.h"
 #include "core/Misc.h"
+#include "core/mesh_simplifier.hpp"
 #include "core/node.hpp"
 #include "core/ShaderProgramManager.hpp"
 #include <imgui.h>
@@ -82,7 +83,7 @@ void renderTreeWithProgram(const glm::mat4 mvp,
 
 float pickSphereRad()
 {
-	return 0.5 + static_cast<float>(std::rand()) / static_cast<float>(2u * RAND_MAX);
+	return static_cast<float>(RandomUniform(0.5, 1.0));
 }
 
 //Rotation matrix to align positive y-axis to d.
@@ -108,7 +109,7 @@ const glm::mat4 rotationAlignPosZ(const glm::vec3 d)
 void edaf80::Assignment2::run()
 {
 	// Load the sphere geometry
-	constexpr size_t num_shapes = 18;
+	constexpr size_t num_shapes = 20;
 	bonobo::mesh_data shapes[num_shapes];
 	shapes[0] = parametric_shapes::createCircleRing(4u, 60u, 1.0f, 2.0f);
 	shapes[1] = parametric_shapes::createQuad(1u, 1u);
@@ -128,6 +129,26 @@ void edaf80::Assignment2::run()
 	shapes[15] = parametric_shapes::createTorus(64u, 4u, 2.0f * pickSphereRad(), pickSphereRad());
 	shapes[16] = parametric_shapes::createTorus(4u, 64u, 2.0f * pickSphereRad(), pickSphereRad());
 	shapes[17] = parametric_shapes::createZoneplate(128u, 128u, 4.0f * pickSphereRad(), 0.5f * pickSphereRad());
+	shapes[18] = parametric_shapes::createIcosphere(4u, 1.0f);
+	shapes[19] = parametric_shapes::createCubeSphere(6u, 1.0f);
+
+	// Full-resolution shapes with generated levels of detail, selected per
+	// node from how large their error is once projected on screen.
+	bonobo::mesh_options lod_options;
+	lod_options.optimize = true;
+	lod_options.lod_levels = 6u;
+	constexpr float lod_bounding_radius = 1.5f;
+	bonobo::mesh_data const lod_shapes[] = {
+		parametric_shapes::createSphere(64u, 64u, 1.0f, lod_options),
+		parametric_shapes::createTorus(64u, 64u, 1.0f, 0.5f, lod_options)};
+	for (auto const &shape : lod_shapes)
+	{
+		if (shape.vao == 0u)
+		{
+			LogError("Failed to generate the shapes with levels of detail.");
+			return;
+		}
+	}
 
 	for (size_t i = 0; i < num_shapes; ++i)
 	{
@@ -202,10 +223,11 @@ void edaf80::Assignment2::run()
 	// Set whether the default interpolation algorithm should be the linear one;
 	// it can always be changed at runtime through the "Scene Controls" window.
 	bool use_linear = true;
+	bool use_constant_speed = false;
 
 	Node root;
 
-	constexpr size_t num_nodes = 18;
+	constexpr size_t num_nodes = 20;
 	std::array<Node, num_nodes> nodes;
 	for (size_t i = 0; i < num_nodes; ++i)
 	{
@@ -228,6 +250,12 @@ void edaf80::Assignment2::run()
 		nodes[i].set_translation(glm::vec3(0.0f, 14.0f - 2.0f * static_cast<float>(i), 0.0f));
 		sphere_parent.add_child(&nodes[i]);
 	}
+	//evenly tessellated spheres, below the UV ones
+	for (size_t i = 18; i < 20; ++i)
+	{
+		nodes[i].set_translation(glm::vec3(0.0f, 14.0f - 2.0f * static_cast<float>(i - 8), 0.0f));
+		sphere_parent.add_child(&nodes[i]);
+	}
 	sphere_parent.set_translation(glm::vec3(-4.0f, 0.0f, 0.0f));
 	root.add_child(&sphere_parent);
 
@@ -242,6 +270,22 @@ void edaf80::Assignment2::run()
 	torus_parent.set_translation(glm::vec3(-8.0f, 0.0f, 0.0f));
 	root.add_child(&torus_parent);
 
+	//shapes with levels of detail, receding from the camera
+	constexpr size_t num_lod_nodes = 24;
+	Node lod_parent;
+	std::array<Node, num_lod_nodes> lod_nodes;
+	std::array<bonobo::lod_selector, num_lod_nodes> lod_selectors;
+	for (size_t i = 0; i < num_lod_nodes; ++i)
+	{
+		lod_nodes[i].set_geometry(lod_shapes[i % 2]);
+		lod_nodes[i].set_translation(glm::vec3(4.0f * static_cast<float>(i % 2) - 2.0f, 0.0f, -6.0f * static_cast<float>(i / 2)));
+		lod_parent.add_child(&lod_nodes[i]);
+	}
+	lod_parent.set_translation(glm::vec3(12.0f, 0.0f, 0.0f));
+	root.add_child(&lod_parent);
+	bool use_lods = true;
+	float lod_pixel_threshold = 1.0f;
+
 	//Interpolation node markers
 	constexpr unsigned int max_interpolation_markers = 20;
 	int num_control_points = 10;	  // In interface
@@ -256,6 +300,14 @@ void edaf80::Assignment2::run()
 		interpolation_markers[i].set_program(&normal_shader, set_uniforms);
 		interpolation_parent.add_child(&interpolation_markers[i]);
 	}
+	// Its segments are only recomputed when the control points or the
+	// tension change.
+	interpolation::catmull_rom_spline interpolation_path;
+	interpolation::arc_length_table interpolation_lengths(interpolation_path);
+	std::array<float, max_interpolation_markers> marker_parameters;
+	for (unsigned int i = 0; i < max_interpolation_markers; ++i)
+		marker_parameters[i] = static_cast<float>(i);
+	std::array<glm::vec3, max_interpolation_markers> marker_derivatives;
 	Node interpolation_runner;
 	interpolation_runner.set_geometry(shapes[16]);
 	interpolation_runner.set_scaling(glm::vec3(0.1f));
@@ -365,6 +417,23 @@ void edaf80::Assignment2::run()
 		glClearColor(0.1f, 0.2f, 0.1f, 1.0f);
 		glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
+		size_t lod_triangles_nb = 0u;
+		for (size_t i = 0; i < num_lod_nodes; ++i)
+		{
+			size_t level = 0u;
+			if (use_lods)
+			{
+				auto const world = lod_parent.get_transform() * lod_nodes[i].get_transform();
+				auto const pixels_per_unit = bonobo::get_pixels_per_unit(world, lod_bounding_radius,
+																		 mCamera.mWorld.GetTranslation(), mCamera.mFov,
+																		 static_cast<float>(framebuffer_height));
+				lod_selectors[i].set_pixel_threshold(lod_pixel_threshold);
+				level = lod_selectors[i].select(lod_shapes[i % 2].lods, pixels_per_unit);
+			}
+			lod_nodes[i].set_lod(level);
+			lod_triangles_nb += lod_nodes[i].get_indices_nb() / 3u;
+		}
+
 		auto shader = fallback_shader;
 		switch (shader_program_selected)
 		{
@@ -396,6 +465,14 @@ void edaf80::Assignment2::run()
 			control_points[i] = glm::vec3(2.0f * cos(t), 2.0f * sin(t), t * t * t * t * glm::two_over_pi<float>() / 1024.0f);
 			interpolation_markers[i].set_translation(control_points[i]);
 		}
+		if (interpolation_path.get_segments_nb() != static_cast<size_t>(num_control_points)
+		    || interpolation_path.get_tension() != catmull_rom_tension)
+		{
+			interpolation_path = interpolation::catmull_rom_spline(control_points.data(), num_control_points, catmull_rom_tension);
+			interpolation_lengths = interpolation::arc_length_table(interpolation_path);
+		}
+		if (!use_linear)
+			interpolation_path.evaluate(marker_parameters.data(), num_control_points, nullptr, marker_derivatives.data());
 		const glm::mat4 wtc = mCamera.GetWorldToClipMatrix();
 		const glm::mat4 pt = interpolation_parent.get_transform();
 		for (unsigned int i = 0; i < num_control_points; ++i)
@@ -411,11 +488,7 @@ void edaf80::Assignment2::run()
 			else
 			{
 				interpolation_markers[i].set_scaling(glm::vec3(0.2f));
-				const glm::vec3 &p0 = control_points[(i + num_control_points - 1) % num_control_points],
-								&p1 = control_points[i],
-								&p2 = control_points[(i + 1) % num_control_points],
-								&p3 = control_points[(i + 2) % num_control_points];
-				derivativeDir = glm::normalize(interpolation::evalCatmullRomDerivative(p0, p1, p2, p3, catmull_rom_tension, 0.0f));
+				derivativeDir = glm::normalize(marker_derivatives[i]);
 			}
 			interpolation_markers[i].render(wtc, pt * (interpolation_markers[i].get_transform()) * rotationAlignPosZ(derivativeDir), shader, set_uniforms);
 		}
@@ -435,13 +508,14 @@ void edaf80::Assignment2::run()
 		}
 		else
 		{
-			const glm::vec3 &p0 = control_points[i],
-							&p1 = control_points[(i + 1) % num_control_points],
-							&p2 = control_points[(i + 2) % num_control_points],
-							&p3 = control_points[(i + 3) % num_control_points];
-			interpolation_runner.set_translation(interpolation::evalCatmullRom(p0, p1, p2, p3, catmull_rom_tension, x));
-			derivativeDir =
-				glm::normalize(interpolation::evalCatmullRomDerivative(p0, p1, p2, p3, catmull_rom_tension, x));
+			glm::vec3 position, derivative;
+			// Covering as much of the path on average, at constant speed.
+			const float s = use_constant_speed
+			              ? interpolation_lengths.parameter_at(interpolation_lengths.get_length() * f / static_cast<float>(num_control_points))
+			              : f;
+			interpolation_path.evaluate(&s, 1u, &position, &derivative);
+			interpolation_runner.set_translation(position);
+			derivativeDir = glm::normalize(derivative);
 			interpolation_derivative.set_translation(2.0f * derivativeDir);
 		}
 		interpolation_runner.render(wtc, pt * interpolation_runner.get_transform() * rotationAlignPosY(derivativeDir), shader, set_uniforms);
@@ -480,6 +554,21 @@ void edaf80::Assignment2::run()
 			ImGui::SliderInt("Number of interpolation control points", &num_control_points, 1, max_interpolation_markers);
 			ImGui::SliderFloat("Interpolation speed", &interpolation_speed, 0.001f, 10.0f);
 			ImGui::Checkbox("Use linear interpolation", &use_linear);
+			ImGui::Checkbox("Constant speed along the spline", &use_constant_speed);
+			ImGui::Text("");
+			ImGui::Text("Level of detail controls:");
+			ImGui::Checkbox("Select levels of detail", &use_lods);
+			ImGui::SliderFloat("Tolerated error (pixels)", &lod_pixel_threshold, 0.25f, 16.0f);
+			ImGui::Text("Triangles drawn: %u", static_cast<unsigned int>(lod_triangles_nb));
+			ImGui::Text("");
+			if (ImGui::Button("Benchmark shape generation"))
+				parametric_shapes::benchmarkGeneration(2048u);
+			if (ImGui::Button("Benchmark spline evaluation"))
+				interpolation::benchmarkSpline();
+			if (ImGui::Button("Benchmark spline queries"))
+				interpolation::benchmarkSplineQueries();
+			if (ImGui::Button("Compare sphere tessellations"))
+				parametric_shapes::compareSphereTessellations(1.0e-3f);
 		}
 		ImGui::End();
 
@@ -4,6 +4,7 @@
 
 #include "config.hpp"
 #include "core/Bonobo.h"
+#include "core/cpu_dispatch.hpp"
 #include "core/FPSCamera.h"
 #include "core/Log.h"
 #include "core/LogView.h"
@@ -109,6 +110,7 @@ getTextureData(std::string const &filename, u32 &width, u32 &height, bool flip)
 {
 	auto const path = config::resources_path(filename);
 	std::vector<unsigned char> image;
+	bonobo::install_png_unfilter();
 	if (lodepng::decode(image, width, height, path, LCT_RGBA) != 0)
 	{
 		LogWarning("Couldn't load or decode image file %s", path.c_str());
@@ -206,7 +208,7 @@ GLuint myLoadCubemap(std::string const &folderName, bool generate_mipmap)
 
 float randf()
 {
-	return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+	return static_cast<float>(RandomUniform());
 }
 
 void edaf80::Assignment3::run()
@@ -2,6 +2,7 @@
 
 #include "config.hpp"
 #include "core/Bonobo.h"
+#include "core/cpu_dispatch.hpp"
 #include "core/FPSCamera.h"
 #include "core/helpers.hpp"
 #include "core/Log.h"
@@ -15,7 +16,13 @@
 #include <imgui.h>
 #include <external/imgui_impl_glfw_gl3.h>
 
+#include "gerstner_textures.hpp"
+#include "gerstner_waves.hpp"
+#include "ocean_clipmap.hpp"
+#include "ocean_simulation.hpp"
 #include "parametric_shapes_modified.hpp"
+#include "planet_cdlod_sphere.hpp"
+#include "planet_rocks.hpp"
 #include "core/node.hpp"
 
 #include <stdexcept>
@@ -40,6 +47,7 @@ getTextureData(std::string const &filename, u32 &width, u32 &height, bool flip)
 {
 	auto const path = config::resources_path(filename);
 	std::vector<unsigned char> image;
+	bonobo::install_png_unfilter();
 	if (lodepng::decode(image, width, height, path, LCT_RGBA) != 0)
 	{
 		LogWarning("Couldn't load or decode image file %s", path.c_str());
@@ -253,6 +261,50 @@ void edaf80::Assignment4::run()
 		LogError("Failed to load ocean2 shader");
 	}
 
+	// OceanV3 evaluated once per frame by a compute shader, when the
+	// context has compute shaders and image stores.
+	const bool gerstner_compute_supported = ocean::gerstner_textures::is_supported();
+	GLuint ocean3_compute_program = 0u;
+	GLuint ocean3_fetch_shader = 0u;
+	if (gerstner_compute_supported)
+	{
+		program_manager.CreateAndRegisterComputeProgram("EDAF80/my_ocean3.comp", ocean3_compute_program);
+		if (ocean3_compute_program == 0u)
+		{
+			LogError("Failed to load ocean3 compute shader");
+		}
+
+		program_manager.CreateAndRegisterProgram({{ShaderType::vertex, "EDAF80/my_ocean3_fetch.vert"},
+												  {ShaderType::fragment, "EDAF80/my_ocean.frag"}},
+												 ocean3_fetch_shader);
+		if (ocean3_fetch_shader == 0u)
+		{
+			LogError("Failed to load ocean3_fetch shader");
+		}
+	}
+	else
+	{
+		LogInfo("Compute shaders or image stores are unavailable: OceanV3 can only be computed per vertex.");
+	}
+
+	GLuint ocean_fft_shader = 0u;
+	program_manager.CreateAndRegisterProgram({{ShaderType::vertex, "EDAF80/ocean_fft.vert"},
+											  {ShaderType::fragment, "EDAF80/ocean_fft.frag"}},
+											 ocean_fft_shader);
+	if (ocean_fft_shader == 0u)
+	{
+		LogError("Failed to load ocean_fft shader");
+	}
+
+	GLuint ocean_clipmap_shader = 0u;
+	program_manager.CreateAndRegisterProgram({{ShaderType::vertex, "EDAF80/ocean_clipmap.vert"},
+											  {ShaderType::fragment, "EDAF80/ocean_fft.frag"}},
+											 ocean_clipmap_shader);
+	if (ocean_clipmap_shader == 0u)
+	{
+		LogError("Failed to load ocean_clipmap shader");
+	}
+
 	GLuint skybox_shader = 0u;
 	program_manager.CreateAndRegisterProgram({{ShaderType::vertex, "EDAF80/my_skybox.vert"},
 											  {ShaderType::fragment, "EDAF80/my_skybox.frag"}},
@@ -287,6 +339,9 @@ void edaf80::Assignment4::run()
 	std::vector<float> waveSpikies{2.0f, 2.0f};
 	float waveSpaceScale = 50.0f;
 	uint editSelectedWave = 0;
+	// Value of the `nowTime` uniform, shared with the CPU evaluation of
+	// the waves.
+	float waveTime = 0.0f;
 
 	const auto insertWave = [&waveAmplitudes, &waveDirections, &waveFrequencies, &wavePhases, &waveSpikies](const float amp, const glm::vec2 dir, const float freq, const float phase, const float spike) {
 		if (waveAmplitudes.size() < MAX_WAVES)
@@ -309,15 +364,28 @@ void edaf80::Assignment4::run()
 		waveSpikies.erase(waveSpikies.begin() + waveID);
 	};
 
+	// The FFT ocean is simulated on the CPU, and its displacements and
+	// normals sampled from textures by the ocean_fft shaders.
+	const unsigned int ocean_vertices_nb = 50u;
+	const float ocean_side = 40.0f;
+	ocean::fft_parameters fft_parameters;
+	fft_parameters.patch_size = 64.0f;
+	ocean::fft_simulation fft_ocean(fft_parameters);
+	fft_ocean.update(0.0f);
+	fft_ocean.upload();
+	// Mip level of the displacements whose texels are as far apart as the
+	// vertices of the ocean.
+	const float fft_displacement_lod = std::max(std::log2(ocean_side / static_cast<float>(ocean_vertices_nb - 1u) * static_cast<float>(fft_parameters.resolution) / fft_parameters.patch_size), 0.0f);
+
 	auto const ocean_set_uniforms =
-		[&camera_position, &water_deep_color, &water_shallow_color, &waveAmplitudes, &waveDirections, &waveFrequencies, &wavePhases, &waveSpikies, &waveSpaceScale, &bumpValueScale, &texScale, &bumpSpeed, &reflectionScale, &refractionScale](GLuint program) {
+		[&camera_position, &water_deep_color, &water_shallow_color, &waveAmplitudes, &waveDirections, &waveFrequencies, &wavePhases, &waveSpikies, &waveSpaceScale, &bumpValueScale, &texScale, &bumpSpeed, &reflectionScale, &refractionScale, &fft_ocean, fft_displacement_lod, &waveTime](GLuint program) {
 			glUniform3fv(glGetUniformLocation(program, "camera_position"), 1, glm::value_ptr(camera_position));
 			glUniform3fv(glGetUniformLocation(program, "water_deep_color"), 1, glm::value_ptr(water_deep_color));
 			glUniform3fv(glGetUniformLocation(program, "water_shallow_color"), 1, glm::value_ptr(water_shallow_color));
 
 			glUniform1fv(glGetUniformLocation(program, "waveSpaceScale"), 1, reinterpret_cast<GLfloat *>(&waveSpaceScale));
 
-			glUniform1f(glGetUniformLocation(program, "nowTime"), static_cast<float>(fmod(GetTimeSeconds(), 100.0)));
+			glUniform1f(glGetUniformLocation(program, "nowTime"), waveTime);
 			glUniform1fv(glGetUniformLocation(program, "waveBumpScale"), 1, reinterpret_cast<GLfloat *>(&bumpValueScale));
 			glUniform2fv(glGetUniformLocation(program, "texScale"), 1, glm::value_ptr(texScale));
 			glUniform2fv(glGetUniformLocation(program, "bumpSpeed"), 1, glm::value_ptr(bumpSpeed));
@@ -325,6 +393,10 @@ void edaf80::Assignment4::run()
 			glUniform1fv(glGetUniformLocation(program, "reflectionScale"), 1, reinterpret_cast<GLfloat *>(&reflectionScale));
 			glUniform1fv(glGetUniformLocation(program, "refractionScale"), 1, reinterpret_cast<GLfloat *>(&refractionScale));
 
+			glUniform1f(glGetUniformLocation(program, "patch_size"), fft_ocean.get_parameters().patch_size);
+			glUniform1f(glGetUniformLocation(program, "displacement_lod"), fft_displacement_lod);
+			glUniform1f(glGetUniformLocation(program, "texels_per_metre"), static_cast<float>(fft_ocean.get_parameters().resolution) / fft_ocean.get_parameters().patch_size);
+
 			//Waves!
 			glUniform1ui(glGetUniformLocation(program, "num_waves"), waveAmplitudes.size());
 			glUniform1fv(glGetUniformLocation(program, "waveAmplitudes"), waveAmplitudes.size(), reinterpret_cast<GLfloat *>(waveAmplitudes.data()));
@@ -338,7 +410,7 @@ void edaf80::Assignment4::run()
 
 	//
 	// Load geometry
-	bonobo::mesh_data ocean_mesh = parametric_shapes::createOceanplate(50, 50, 40.0f);
+	bonobo::mesh_data ocean_mesh = parametric_shapes::createOceanplate(ocean_vertices_nb, ocean_vertices_nb, ocean_side);
 	if (ocean_mesh.vao == 0u)
 		LogError("Couldn't generate ocean_mesh!");
 	const GLuint bump_tex = bonobo::loadTexture2D("waves.png", true);
@@ -347,15 +419,34 @@ void edaf80::Assignment4::run()
 	else
 		ocean_mesh.bindings.insert({"bump_texture", bump_tex});
 
+	// Twice as many texels as vertices along the ocean plate, so that
+	// filtering between texels barely smooths the waves.
+	ocean::gerstner_textures wave_textures(2u * ocean_vertices_nb);
+
 	Node root;
 
 	GLuint current_water_shader = ocean_shader;
+	GLuint current_ocean_shader = ocean_shader;
 
 	Node ocean;
 	ocean.set_geometry(ocean_mesh);
-	ocean.set_program(&current_water_shader, ocean_set_uniforms);
+	ocean.set_program(&current_ocean_shader, ocean_set_uniforms);
+	ocean.add_texture("displacement_map", fft_ocean.get_displacement_texture(), GL_TEXTURE_2D);
+	ocean.add_texture("normal_foam_map", fft_ocean.get_normal_foam_texture(), GL_TEXTURE_2D);
+	ocean.add_texture("wave_displacement_map", wave_textures.get_displacement_texture(), GL_TEXTURE_2D);
+	ocean.add_texture("wave_normal_map", wave_textures.get_normal_texture(), GL_TEXTURE_2D);
 	root.add_child(&ocean);
 
+	// The FFT ocean can also be drawn as a clipmap around the camera,
+	// reaching the far plane for about as many vertices as a uniform grid
+	// of 150 x 150 vertices.
+	ocean::clipmap ocean_clipmap{ocean::clipmap_parameters()};
+	ocean_clipmap.add_texture("displacement_map", fft_ocean.get_displacement_texture(), GL_TEXTURE_2D);
+	ocean_clipmap.add_texture("normal_foam_map", fft_ocean.get_normal_foam_texture(), GL_TEXTURE_2D);
+	if (bump_tex != 0u)
+		ocean_clipmap.add_texture("bump_texture", bump_tex, GL_TEXTURE_2D);
+	bool clipmap_enable = false;
+
 	Node magic;
 	magic.set_translation(glm::vec3(0.0f, 40.0f, 0.0f));
 	magic.set_rotation_x(glm::half_pi<float>());
@@ -371,6 +462,8 @@ void edaf80::Assignment4::run()
 	drop.set_geometry(drop_mesh);
 	drop.set_program(&current_water_shader, ocean_set_uniforms);
 	drop.set_scaling(glm::vec3(0.5));
+	drop.add_texture("wave_displacement_map", wave_textures.get_displacement_texture(), GL_TEXTURE_2D);
+	drop.add_texture("wave_normal_map", wave_textures.get_normal_texture(), GL_TEXTURE_2D);
 	magic.add_child(&drop);
 
 	bonobo::mesh_data ring_mesh = parametric_shapes::createTorus(50, 50, 12.5f, 4.0f);
@@ -382,8 +475,27 @@ void edaf80::Assignment4::run()
 	Node ring;
 	ring.set_geometry(ring_mesh);
 	ring.set_program(&current_water_shader, ocean_set_uniforms);
+	ring.add_texture("wave_displacement_map", wave_textures.get_displacement_texture(), GL_TEXTURE_2D);
+	ring.add_texture("wave_normal_map", wave_textures.get_normal_texture(), GL_TEXTURE_2D);
 	magic.add_child(&ring);
 
+	// A buoy floating on the OceanV3 waves, whose height is found on the
+	// CPU.
+	const glm::vec2 buoy_position = glm::vec2(6.0f, -4.0f);
+	const glm::vec2 buoy_texcoord = glm::vec2(0.5f + buoy_position.x / ocean_side, 0.5f - buoy_position.y / ocean_side);
+	const glm::vec2 ocean_surface_size = glm::vec2(ocean_side, -ocean_side);
+	ocean::gerstner_evaluator buoy_waves({}, waveSpaceScale);
+
+	bonobo::mesh_data buoy_mesh = parametric_shapes::createSphere(20, 20, 0.5f);
+	if (buoy_mesh.vao == 0u)
+		LogError("Couldn't generate buoy_mesh!");
+
+	Node buoy;
+	buoy.set_geometry(buoy_mesh);
+	buoy.set_program(&fallback_shader, no_uniforms);
+	buoy.set_translation(glm::vec3(buoy_position.x, 0.0f, buoy_position.y));
+	root.add_child(&buoy);
+
 	Node skybox;
 	bonobo::mesh_data skybox_mesh = parametric_shapes::createQuad(1, 1);
 	if (skybox_mesh.vao == 0u)
@@ -414,6 +526,7 @@ void edaf80::Assignment4::run()
 			}
 		}
 		skybox.add_texture("cubemap_texture", cubemap_texture, GL_TEXTURE_CUBE_MAP);
+		ocean_clipmap.add_texture("cubemap_texture", cubemap_texture, GL_TEXTURE_CUBE_MAP);
 	}
 	//
 	//
@@ -443,6 +556,8 @@ void edaf80::Assignment4::run()
 	// 3 - OceanV2
 	// 4 - OceanV3 Normals
 	// 5 - OceanV3
+	// 6 - Ocean FFT
+	// 7 - OceanV3, computed once per frame
 	uint shader_mode = 5u;
 
 	while (!glfwWindowShouldClose(window))
@@ -523,8 +638,39 @@ void edaf80::Assignment4::run()
 			current_water_shader = ocean3_normal_shader;
 			break;
 		case 5:
+		case 6:
 			current_water_shader = ocean3_shader;
 			break;
+		case 7:
+			current_water_shader = ocean3_fetch_shader;
+			break;
+		}
+		current_ocean_shader = shader_mode == 6u ? ocean_fft_shader : current_water_shader;
+		// The clipmap replaces the ocean plate, which is skipped without a
+		// program.
+		const bool render_clipmap = shader_mode == 6u && clipmap_enable;
+		if (render_clipmap)
+			current_ocean_shader = 0u;
+
+		waveTime = static_cast<float>(fmod(GetTimeSeconds(), 100.0));
+		if (shader_mode == 4u || shader_mode == 5u || shader_mode == 7u)
+		{
+			std::vector<ocean::gerstner_wave> waves;
+			for (size_t i = 0; i < waveAmplitudes.size(); ++i)
+				waves.push_back({waveAmplitudes[i], waveDirections[i], waveFrequencies[i], wavePhases[i], waveSpikies[i]});
+			buoy_waves.set_waves(waves);
+			buoy_waves.set_space_scale(waveSpaceScale);
+			const float buoy_height = buoy_waves.height_at(buoy_texcoord, waveTime, ocean_surface_size);
+			buoy.set_translation(glm::vec3(buoy_position.x, buoy_height, buoy_position.y));
+		}
+
+		if (shader_mode == 7u)
+			wave_textures.update(ocean3_compute_program, ocean_set_uniforms);
+
+		if (shader_mode == 6u)
+		{
+			fft_ocean.update(static_cast<float>(GetTimeSeconds()));
+			fft_ocean.upload();
 		}
 
 		if (!shader_reload_failed)
@@ -534,6 +680,12 @@ void edaf80::Assignment4::run()
 
 			renderTree(mvp, &root);
 
+			if (render_clipmap)
+			{
+				ocean_clipmap.update(camera_position);
+				ocean_clipmap.render(mvp, ocean_clipmap_shader, ocean_set_uniforms);
+			}
+
 			if (skybox_enable)
 			{
 				skybox.render(mvp, glm::mat4(1.0f));
@@ -562,6 +714,15 @@ void edaf80::Assignment4::run()
 				shader_mode = 4u;
 			if (ImGui::RadioButton("OceanV3", shader_mode == 5u))
 				shader_mode = 5u;
+			if (ImGui::RadioButton("Ocean FFT", shader_mode == 6u))
+				shader_mode = 6u;
+			if (gerstner_compute_supported && ImGui::RadioButton("OceanV3 (compute)", shader_mode == 7u))
+				shader_mode = 7u;
+			ImGui::Spacing();
+			if (ImGui::Button("Benchmark CDLOD selection"))
+				planet::benchmarkCDLOD();
+			if (ImGui::Button("Benchmark rock placements"))
+				planet::benchmarkRockPlacements();
 		}
 		ImGui::End();
 
@@ -589,6 +750,8 @@ void edaf80::Assignment4::run()
 				insertWave(1.0f, glm::vec2(1.0f, 1.0f), 1.0f, 1.0f, 1.0f);
 			}
 			ImGui::Text("Wave count: %u", static_cast<uint>(waveAmplitudes.size()));
+			if (shader_mode == 7u && ImGui::Button("Check compute waves"))
+				ocean::checkGerstnerTextures(wave_textures, buoy_waves, waveTime);
 			for (uint i = 0; i < waveAmplitudes.size(); ++i)
 			{
 				if (ImGui::RadioButton(("Wave " + std::to_string(i + 1u)).c_str(), editSelectedWave == i))
@@ -614,6 +777,40 @@ void edaf80::Assignment4::run()
 		}
 		ImGui::End();
 
+		bool fft_control_opened = ImGui::Begin("FFT Ocean Control", &fft_control_opened, ImVec2(300, 100), -1.0f, 0);
+		if (fft_control_opened)
+		{
+			bool changed = false;
+			if (ImGui::RadioButton("Phillips", fft_parameters.spectrum_kind == ocean::spectrum::phillips))
+			{
+				fft_parameters.spectrum_kind = ocean::spectrum::phillips;
+				changed = true;
+			}
+			if (ImGui::RadioButton("JONSWAP", fft_parameters.spectrum_kind == ocean::spectrum::jonswap))
+			{
+				fft_parameters.spectrum_kind = ocean::spectrum::jonswap;
+				changed = true;
+			}
+			changed |= ImGui::SliderFloat2("Wind (m/s)", &fft_parameters.wind_velocity.x, -20.0f, 20.0f);
+			changed |= ImGui::SliderFloat("Fetch", &fft_parameters.fetch, 1000.0f, 500000.0f, "%.0f m");
+			changed |= ImGui::SliderFloat("Choppiness", &fft_parameters.choppiness, 0.0f, 2.0f);
+			changed |= ImGui::SliderFloat("Foam threshold", &fft_parameters.foam_threshold, 0.0f, 1.0f);
+			if (changed)
+				fft_ocean.set_parameters(fft_parameters);
+			if (ImGui::Checkbox("Clipmap", &clipmap_enable) && clipmap_enable)
+			{
+				const float extent = ocean_clipmap.get_extent();
+				const float spacing = ocean_clipmap.get_parameters().finest_spacing;
+				const float uniform_vertices_nb = (extent / spacing + 1.0f) * (extent / spacing + 1.0f);
+				ocean_clipmap.update(camera_position);
+				LogInfo("Ocean clipmap: %zu vertices over %.0f m, instead of %.0f for a uniform grid as fine as its finest level, and %u for the %.0f m ocean plate.",
+				        ocean_clipmap.get_vertices_nb(), extent, uniform_vertices_nb, ocean_vertices_nb * ocean_vertices_nb, ocean_side);
+			}
+			if (ImGui::Button("Benchmark FFT ocean"))
+				ocean::benchmarkFFT();
+		}
+		ImGui::End();
+
 		bool opened2 = ImGui::Begin("Render Time", &opened2, ImVec2(120, 50), -1.0f, 0);
 		if (opened2)
 		{
@@ -0,0 +1,136 @@
+#include "gerstner_textures.hpp"
+
+#include "core/Log.h"
+#include "core/opengl.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace
+{
+	typedef void (APIENTRYP bind_image_texture_proc)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+	typedef void (APIENTRYP memory_barrier_proc)(GLbitfield barriers);
+
+	// Missing from the 4.1 headers.
+	constexpr GLbitfield texture_fetch_barrier_bit = 0x00000008u;
+
+	// Must match the local size of my_ocean3.comp.
+	constexpr unsigned int work_group_size = 8u;
+
+	//! Functions of GL_ARB_shader_image_load_store, loaded the first time
+	//! they are needed, as that requires a current context.
+	struct image_functions
+	{
+		bind_image_texture_proc bind_image_texture;
+		memory_barrier_proc memory_barrier;
+	};
+
+	image_functions const &get_image_functions()
+	{
+		static image_functions const functions = []() {
+			image_functions f{nullptr, nullptr};
+			if (utils::opengl::has_extension("GL_ARB_shader_image_load_store"))
+			{
+				f.bind_image_texture = reinterpret_cast<bind_image_texture_proc>(glfwGetProcAddress("glBindImageTexture"));
+				f.memory_barrier = reinterpret_cast<memory_barrier_proc>(glfwGetProcAddress("glMemoryBarrier"));
+			}
+			return f;
+		}();
+		return functions;
+	}
+}
+
+ocean::gerstner_textures::gerstner_textures(unsigned int resolution)
+	: _resolution(resolution), _displacement_texture(0u), _normal_texture(0u)
+{
+	assert(resolution > 0u);
+
+	auto const n = static_cast<GLsizei>(resolution);
+	for (auto texture : {&_displacement_texture, &_normal_texture})
+	{
+		glGenTextures(1, texture);
+		glBindTexture(GL_TEXTURE_2D, *texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, texture == &_displacement_texture ? GL_RGBA32F : GL_RGBA16F, n, n, 0,
+		             GL_RGBA, GL_FLOAT, nullptr);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0u);
+}
+
+ocean::gerstner_textures::~gerstner_textures()
+{
+	glDeleteTextures(1, &_displacement_texture);
+	glDeleteTextures(1, &_normal_texture);
+}
+
+bool ocean::gerstner_textures::is_supported()
+{
+	auto const &functions = get_image_functions();
+	return GLAD_GL_ARB_compute_shader && functions.bind_image_texture != nullptr && functions.memory_barrier != nullptr;
+}
+
+void ocean::gerstner_textures::update(GLuint program, std::function<void(GLuint)> const &set_uniforms) const
+{
+	if (program == 0u || !is_supported())
+		return;
+
+	auto const &functions = get_image_functions();
+	glUseProgram(program);
+	set_uniforms(program);
+	functions.bind_image_texture(0u, _displacement_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	functions.bind_image_texture(1u, _normal_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+	glUniform1i(glGetUniformLocation(program, "displacement_image"), 0);
+	glUniform1i(glGetUniformLocation(program, "normal_image"), 1);
+	glUniform1i(glGetUniformLocation(program, "resolution"), static_cast<GLint>(_resolution));
+
+	auto const groups_nb = (_resolution + work_group_size - 1u) / work_group_size;
+	glDispatchCompute(groups_nb, groups_nb, 1u);
+
+	// The vertex shaders sample what was just written.
+	functions.memory_barrier(texture_fetch_barrier_bit);
+	functions.bind_image_texture(0u, 0u, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	functions.bind_image_texture(1u, 0u, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+	glUseProgram(0u);
+}
+
+bool ocean::checkGerstnerTextures(gerstner_textures const &textures, gerstner_evaluator const &evaluator, float time)
+{
+	auto const n = textures.get_resolution();
+	auto const texels_nb = static_cast<size_t>(n) * n;
+
+	std::vector<glm::vec4> displacements(texels_nb), normals(texels_nb);
+	glBindTexture(GL_TEXTURE_2D, textures.get_displacement_texture());
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, displacements.data());
+	glBindTexture(GL_TEXTURE_2D, textures.get_normal_texture());
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, normals.data());
+	glBindTexture(GL_TEXTURE_2D, 0u);
+
+	std::vector<glm::vec2> texcoords(texels_nb);
+	for (auto j = 0u; j < n; ++j)
+		for (auto i = 0u; i < n; ++i)
+			texcoords[j * n + i] = (glm::vec2(i, j) + 0.5f) / static_cast<float>(n);
+	std::vector<gerstner_sample> samples(texels_nb);
+	evaluator.evaluate(texcoords.data(), texels_nb, time, samples.data());
+
+	float displacement_error = 0.0f, normal_error = 0.0f, largest_displacement = 0.0f;
+	for (size_t i = 0u; i < texels_nb; ++i)
+	{
+		largest_displacement = std::max(largest_displacement, glm::length(samples[i].displacement));
+		displacement_error = std::max(displacement_error, glm::length(glm::vec3(displacements[i]) - samples[i].displacement));
+		normal_error = std::max(normal_error, glm::length(glm::vec3(normals[i]) - glm::normalize(samples[i].normal)));
+	}
+
+	// GPUs may evaluate sines with less precision than the CPU, and the
+	// normals are stored as halves.
+	LogInfo("Gerstner textures against the evaluator, over %u x %u texels: displacement error %g (largest displacement %g), normal error %g",
+	        n, n, displacement_error, largest_displacement, normal_error);
+	auto const passed = displacement_error < 1.0e-3f * std::max(largest_displacement, 1.0f) && normal_error < 4.0e-3f;
+	if (!passed)
+		LogError("The Gerstner textures do not match the evaluator.");
+	return passed;
+}
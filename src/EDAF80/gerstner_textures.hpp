@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gerstner_waves.hpp"
+
+#include "external/glad/glad.h"
+
+#include <functional>
+
+namespace ocean
+{
+	//! \brief Gerstner waves of my_ocean3.vert, evaluated once per frame by
+	//!        a compute shader into textures.
+	//!
+	//! my_ocean3.vert sums every wave for every vertex, and again for every
+	//! object or pass drawn with it. `update()` instead runs my_ocean3.comp
+	//! once over a grid of `resolution` x `resolution` texels covering the
+	//! texture coordinates of the ocean plate, texel (i, j) being at
+	//! ((i + 0.5) / resolution, (j + 0.5) / resolution); my_ocean3_fetch.vert
+	//! then only samples:
+	//! * `wave_displacement_map`, RGBA32F: displacement along (tangent,
+	//!   binormal, normal) of the undisplaced surface, and 0;
+	//! * `wave_normal_map`, RGBA16F: normal in that frame, and 0.
+	//!
+	//! Compute shaders and image stores are core in OpenGL 4.3 and 4.2;
+	//! the labs request a 4.1 context, so they are used through
+	//! GL_ARB_compute_shader and GL_ARB_shader_image_load_store, which
+	//! software implementations such as Mesa's llvmpipe expose as well.
+	class gerstner_textures
+	{
+	public:
+		//! \brief Create the textures; needs a current context.
+		//!
+		//! @param [in] resolution texels along each side of the textures
+		explicit gerstner_textures(unsigned int resolution);
+		~gerstner_textures();
+		gerstner_textures(gerstner_textures const &) = delete;
+		gerstner_textures &operator=(gerstner_textures const &) = delete;
+
+		//! \brief Whether the current context can run `update()`.
+		static bool is_supported();
+
+		//! \brief Evaluate the waves into the textures.
+		//!
+		//! @param [in] program my_ocean3.comp, created with
+		//!             `ShaderProgramManager::CreateAndRegisterComputeProgram()`
+		//! @param [in] set_uniforms sets the wave uniforms of `program`,
+		//!             like for my_ocean3.vert
+		void update(GLuint program, std::function<void(GLuint)> const &set_uniforms) const;
+
+		unsigned int get_resolution() const { return _resolution; }
+		GLuint get_displacement_texture() const { return _displacement_texture; }
+		GLuint get_normal_texture() const { return _normal_texture; }
+
+	private:
+		unsigned int _resolution;
+		GLuint _displacement_texture;
+		GLuint _normal_texture;
+	};
+
+	//! \brief Read back the textures of the last `update()` and compare
+	//!        them with `gerstner_evaluator`; log the largest errors.
+	//!
+	//! @param [in] textures textures updated with the same waves as
+	//!             `evaluator`, at `time`
+	//! @param [in] evaluator CPU version of the waves
+	//! @param [in] time value of the `nowTime` uniform
+	//! @return whether all errors are within half-precision tolerances
+	bool checkGerstnerTextures(gerstner_textures const &textures, gerstner_evaluator const &evaluator, float time);
+}
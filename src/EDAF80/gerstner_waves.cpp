@@ -0,0 +1,271 @@
+#include "gerstner_waves.hpp"
+
+#include "core/parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GERSTNER_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+struct ocean::gerstner_evaluator::wave_sums
+{
+	glm::vec3 displacement; // Σ (Q D.x c, Q D.y c, s)
+	float sx, sxy, syy;     // Σ Q D.x D.x f s, Σ Q D.x D.y f s, Σ Q D.y D.y f s
+	float cx, cy;           // Σ D.x f c, Σ D.y f c
+};
+
+namespace
+{
+	constexpr size_t lanes_nb = 4u;
+
+	// Below this many points, splitting a batch across threads costs more
+	// than it saves.
+	constexpr size_t min_points_per_thread = 1024u;
+
+	// Factor by which main() fades the waves near the edges of the
+	// texture coordinates.
+	float edge_fade(glm::vec2 const &texcoord)
+	{
+		auto const distances = glm::min(texcoord, 1.0f - texcoord);
+		return glm::smoothstep(0.0f, 0.05f, glm::min(distances.x, distances.y));
+	}
+
+#if defined(GERSTNER_USE_SSE)
+	// Sine and cosine of four angles, with the range reduction and
+	// polynomials of the Cephes library, accurate to a few ulps.
+	void sincos_ps(__m128 x, __m128 &sine, __m128 &cosine)
+	{
+		auto const sign_mask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+		auto sign_sin = _mm_and_ps(x, sign_mask);
+		x = _mm_andnot_ps(sign_mask, x);
+
+		// Octant of the angle, rounded up to an even one, so that the rest
+		// lies in [-pi/4, pi/4].
+		auto octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+		octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+		auto const y = _mm_cvtepi32_ps(octant);
+
+		auto const swap_sign_sin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+		auto const sign_cos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+		auto const use_sine_polynomial = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+		sign_sin = _mm_xor_ps(sign_sin, swap_sign_sin);
+
+		// Extended precision subtraction of octant * pi/4.
+		x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+		x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+		x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+		auto const z = _mm_mul_ps(x, x);
+
+		auto cos_polynomial = _mm_set1_ps(2.443315711809948e-5f);
+		cos_polynomial = _mm_add_ps(_mm_mul_ps(cos_polynomial, z), _mm_set1_ps(-1.388731625493765e-3f));
+		cos_polynomial = _mm_add_ps(_mm_mul_ps(cos_polynomial, z), _mm_set1_ps(4.166664568298827e-2f));
+		cos_polynomial = _mm_mul_ps(_mm_mul_ps(cos_polynomial, z), z);
+		cos_polynomial = _mm_sub_ps(cos_polynomial, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+		cos_polynomial = _mm_add_ps(cos_polynomial, _mm_set1_ps(1.0f));
+
+		auto sin_polynomial = _mm_set1_ps(-1.9515295891e-4f);
+		sin_polynomial = _mm_add_ps(_mm_mul_ps(sin_polynomial, z), _mm_set1_ps(8.3321608736e-3f));
+		sin_polynomial = _mm_add_ps(_mm_mul_ps(sin_polynomial, z), _mm_set1_ps(-1.6666654611e-1f));
+		sin_polynomial = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_polynomial, z), x), x);
+
+		sine = _mm_or_ps(_mm_and_ps(use_sine_polynomial, sin_polynomial), _mm_andnot_ps(use_sine_polynomial, cos_polynomial));
+		cosine = _mm_or_ps(_mm_and_ps(use_sine_polynomial, cos_polynomial), _mm_andnot_ps(use_sine_polynomial, sin_polynomial));
+		sine = _mm_xor_ps(sine, sign_sin);
+		cosine = _mm_xor_ps(cosine, sign_cos);
+	}
+#endif
+}
+
+ocean::gerstner_evaluator::gerstner_evaluator(std::vector<gerstner_wave> const &waves, float space_scale)
+	: _space_scale(space_scale)
+{
+	set_waves(waves);
+}
+
+void ocean::gerstner_evaluator::set_waves(std::vector<gerstner_wave> const &waves)
+{
+	_amplitudes.clear();
+	_directions_x.clear();
+	_directions_y.clear();
+	_frequencies.clear();
+	_phases.clear();
+	_steepnesses.clear();
+	for (auto const &wave : waves)
+	{
+		_amplitudes.push_back(wave.amplitude);
+		_directions_x.push_back(wave.direction.x);
+		_directions_y.push_back(wave.direction.y);
+		_frequencies.push_back(wave.frequency);
+		_phases.push_back(wave.phase);
+		_steepnesses.push_back(wave.spikiness / 10.0f);
+	}
+}
+
+void ocean::gerstner_evaluator::sum_waves(glm::vec2 const *texcoords, size_t count, float time, wave_sums *sums) const
+{
+	auto const waves_nb = _amplitudes.size();
+	for (size_t first = 0u; first < count; first += lanes_nb)
+	{
+		auto const lanes = std::min(lanes_nb, count - first);
+		alignas(16) float uv_x[lanes_nb] = {}, uv_y[lanes_nb] = {};
+		for (size_t lane = 0u; lane < lanes; ++lane)
+		{
+			auto const uv = (-1.0f + 2.0f * texcoords[first + lane]) * _space_scale;
+			uv_x[lane] = uv.x;
+			uv_y[lane] = uv.y;
+		}
+
+		alignas(16) float totals[8][lanes_nb] = {};
+#if defined(GERSTNER_USE_SSE)
+		auto const x = _mm_load_ps(uv_x), y = _mm_load_ps(uv_y);
+		__m128 accumulators[8];
+		for (auto &accumulator : accumulators)
+			accumulator = _mm_setzero_ps();
+		for (size_t w = 0u; w < waves_nb; ++w)
+		{
+			auto const dx = _mm_set1_ps(_directions_x[w]), dy = _mm_set1_ps(_directions_y[w]);
+			auto const f = _mm_set1_ps(_frequencies[w]);
+			auto const angle = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(x, dx), _mm_mul_ps(y, dy)), f),
+			                              _mm_set1_ps(time * _phases[w]));
+			__m128 sine, cosine;
+			sincos_ps(angle, sine, cosine);
+			auto const s = _mm_mul_ps(_mm_set1_ps(_amplitudes[w]), sine);
+			auto const c = _mm_mul_ps(_mm_set1_ps(_amplitudes[w]), cosine);
+
+			auto const q = _mm_set1_ps(_steepnesses[w]);
+			auto const qdx = _mm_mul_ps(q, dx), qdy = _mm_mul_ps(q, dy);
+			auto const fs = _mm_mul_ps(f, s), fc = _mm_mul_ps(f, c);
+			accumulators[0] = _mm_add_ps(accumulators[0], _mm_mul_ps(qdx, c));
+			accumulators[1] = _mm_add_ps(accumulators[1], _mm_mul_ps(qdy, c));
+			accumulators[2] = _mm_add_ps(accumulators[2], s);
+			accumulators[3] = _mm_add_ps(accumulators[3], _mm_mul_ps(_mm_mul_ps(qdx, dx), fs));
+			accumulators[4] = _mm_add_ps(accumulators[4], _mm_mul_ps(_mm_mul_ps(qdx, dy), fs));
+			accumulators[5] = _mm_add_ps(accumulators[5], _mm_mul_ps(_mm_mul_ps(qdy, dy), fs));
+			accumulators[6] = _mm_add_ps(accumulators[6], _mm_mul_ps(dx, fc));
+			accumulators[7] = _mm_add_ps(accumulators[7], _mm_mul_ps(dy, fc));
+		}
+		for (size_t i = 0u; i < 8u; ++i)
+			_mm_store_ps(totals[i], accumulators[i]);
+#else
+		for (size_t w = 0u; w < waves_nb; ++w)
+		{
+			auto const dx = _directions_x[w], dy = _directions_y[w], f = _frequencies[w], q = _steepnesses[w];
+			for (size_t lane = 0u; lane < lanes; ++lane)
+			{
+				auto const angle = (uv_x[lane] * dx + uv_y[lane] * dy) * f + time * _phases[w];
+				auto const s = _amplitudes[w] * std::sin(angle), c = _amplitudes[w] * std::cos(angle);
+				totals[0][lane] += q * dx * c;
+				totals[1][lane] += q * dy * c;
+				totals[2][lane] += s;
+				totals[3][lane] += q * dx * dx * f * s;
+				totals[4][lane] += q * dx * dy * f * s;
+				totals[5][lane] += q * dy * dy * f * s;
+				totals[6][lane] += dx * f * c;
+				totals[7][lane] += dy * f * c;
+			}
+		}
+#endif
+
+		for (size_t lane = 0u; lane < lanes; ++lane)
+		{
+			auto &sum = sums[first + lane];
+			sum.displacement = glm::vec3(totals[0][lane], totals[1][lane], totals[2][lane]);
+			sum.sx = totals[3][lane];
+			sum.sxy = totals[4][lane];
+			sum.syy = totals[5][lane];
+			sum.cx = totals[6][lane];
+			sum.cy = totals[7][lane];
+		}
+	}
+}
+
+ocean::gerstner_sample ocean::gerstner_evaluator::finish(glm::vec2 const &texcoord, wave_sums const &sums) const
+{
+	if (_amplitudes.empty())
+		return {glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+
+	// Like the shader, which sums the tangents of every wave, each of them
+	// starting from 1 along its own axis.
+	auto const waves_nb = static_cast<float>(_amplitudes.size());
+	auto const tangent = glm::vec3(waves_nb - sums.sx, -sums.sxy, sums.cx);
+	auto const binormal = glm::vec3(-sums.sxy, waves_nb - sums.syy, sums.cy);
+
+	auto const fade = edge_fade(texcoord);
+	gerstner_sample sample;
+	sample.displacement = sums.displacement * fade;
+	sample.tangent = glm::normalize(glm::mix(glm::vec3(1.0f, 0.0f, 0.0f), tangent, fade));
+	sample.binormal = glm::normalize(glm::mix(glm::vec3(0.0f, 1.0f, 0.0f), binormal, fade));
+	sample.normal = glm::cross(sample.tangent, sample.binormal);
+	return sample;
+}
+
+void ocean::gerstner_evaluator::evaluate(glm::vec2 const *texcoords, size_t count, float time, gerstner_sample *samples) const
+{
+	bonobo::parallel_for(count, [&](size_t first, size_t last) {
+		std::vector<wave_sums> sums(last - first);
+		sum_waves(texcoords + first, last - first, time, sums.data());
+		for (size_t i = first; i < last; ++i)
+			samples[i] = finish(texcoords[i], sums[i - first]);
+	}, min_points_per_thread);
+}
+
+ocean::gerstner_sample ocean::gerstner_evaluator::evaluate(glm::vec2 const &texcoord, float time) const
+{
+	gerstner_sample sample;
+	evaluate(&texcoord, 1u, time, &sample);
+	return sample;
+}
+
+void ocean::gerstner_evaluator::heights_at(glm::vec2 const *texcoords, size_t count, float time, glm::vec2 const &surface_size,
+                                           float *heights, glm::vec2 *rest_texcoords, unsigned int iterations) const
+{
+	// Looking for the rest position r whose displaced position is the
+	// query point p, i.e. the root of g(r) = r + fade * D(r) / size - p,
+	// with D the horizontal displacement. Its Jacobian follows from the
+	// sums, as dD.x/du.x = -Σ Q D.x D.x f s, and so on, and
+	// du/dtexcoord = 2 * waveSpaceScale; the variations of the fade are
+	// neglected.
+	bonobo::parallel_for(count, [&](size_t first, size_t last) {
+		auto const points_nb = last - first;
+		std::vector<glm::vec2> rest(texcoords + first, texcoords + last);
+		std::vector<wave_sums> sums(points_nb);
+		for (auto iteration = 0u; iteration < iterations; ++iteration)
+		{
+			sum_waves(rest.data(), points_nb, time, sums.data());
+			for (size_t i = 0u; i < points_nb; ++i)
+			{
+				auto const &sum = sums[i];
+				auto const fade = edge_fade(rest[i]);
+				auto const g = rest[i] + fade * glm::vec2(sum.displacement) / surface_size - texcoords[first + i];
+
+				auto const k = 2.0f * _space_scale * fade;
+				auto const j00 = 1.0f - k * sum.sx / surface_size.x, j01 = -k * sum.sxy / surface_size.x;
+				auto const j10 = -k * sum.sxy / surface_size.y, j11 = 1.0f - k * sum.syy / surface_size.y;
+				auto const determinant = j00 * j11 - j01 * j10;
+
+				// Where the surface folds onto itself, fall back to a fixed
+				// point iteration.
+				if (std::abs(determinant) < 1.0e-4f)
+					rest[i] -= g;
+				else
+					rest[i] -= glm::vec2(j11 * g.x - j01 * g.y, j00 * g.y - j10 * g.x) / determinant;
+			}
+		}
+
+		sum_waves(rest.data(), points_nb, time, sums.data());
+		for (size_t i = 0u; i < points_nb; ++i)
+			heights[first + i] = edge_fade(rest[i]) * sums[i].displacement.z;
+		if (rest_texcoords != nullptr)
+			std::copy(rest.begin(), rest.end(), rest_texcoords + first);
+	}, min_points_per_thread);
+}
+
+float ocean::gerstner_evaluator::height_at(glm::vec2 const &texcoord, float time, glm::vec2 const &surface_size) const
+{
+	float height = 0.0f;
+	heights_at(&texcoord, 1u, time, surface_size, &height);
+	return height;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace ocean
+{
+	//! \brief One of the waves summed by my_ocean3.vert, with the meaning
+	//!        of its uniforms.
+	struct gerstner_wave
+	{
+		float amplitude;      //!< waveAmplitudes[i]
+		glm::vec2 direction;  //!< waveDirections[i]
+		float frequency;      //!< waveFrequencies[i]
+		float phase;          //!< wavePhases[i], multiplied by the time
+		float spikiness;      //!< waveSpikies[i]
+	};
+
+	//! \brief Surface of the ocean at one point, as my_ocean3.vert computes
+	//!        it, in the frame (tangent, binormal, normal) of the
+	//!        undisplaced surface.
+	struct gerstner_sample
+	{
+		glm::vec3 displacement; //!< added to the vertex, in model units
+		glm::vec3 tangent;
+		glm::vec3 binormal;
+		glm::vec3 normal;
+	};
+
+	//! \brief CPU version of the Gerstner waves of my_ocean3.vert, so that
+	//!        the rest of the program can know where the water is.
+	//!
+	//! Points are given by their texture coordinates on the ocean plate,
+	//! which the shader maps to wave space as
+	//! `uv = (-1 + 2 * texcoord) * waveSpaceScale`; the waves fade out
+	//! near the edges of the texture coordinates like in the shader.
+	//! Batches are evaluated four points at a time with SSE, and large
+	//! ones split across `bonobo::parallel_for()` threads; the
+	//! gerstner_waves_tests check compares them with the shader.
+	class gerstner_evaluator
+	{
+	public:
+		gerstner_evaluator(std::vector<gerstner_wave> const &waves, float space_scale);
+
+		void set_waves(std::vector<gerstner_wave> const &waves);
+		void set_space_scale(float space_scale) { _space_scale = space_scale; }
+
+		//! \brief Evaluate the surface at `count` points.
+		//!
+		//! @param [in] texcoords texture coordinates of the points
+		//! @param [in] count number of points
+		//! @param [in] time value of the `nowTime` uniform
+		//! @param [out] samples surface at each point
+		void evaluate(glm::vec2 const *texcoords, size_t count, float time, gerstner_sample *samples) const;
+
+		gerstner_sample evaluate(glm::vec2 const &texcoord, float time) const;
+
+		//! \brief Find the height of the water above `count` points.
+		//!
+		//! Gerstner waves also move the surface horizontally, so the
+		//! surface above a point comes from elsewhere; that rest position
+		//! is found with a few Newton iterations before the height is
+		//! evaluated there.
+		//!
+		//! @param [in] texcoords texture coordinates of the points
+		//! @param [in] count number of points
+		//! @param [in] time value of the `nowTime` uniform
+		//! @param [in] surface_size model units covered by one unit of
+		//!             texture coordinates, along the tangent and the
+		//!             binormal; (40, -40) for `createOceanplate(.., .., 40)`
+		//!             whose v goes towards -z
+		//! @param [out] heights displacement along the normal above each
+		//!              point
+		//! @param [out] rest_texcoords if not null, texture coordinates of
+		//!              the vertices which end up above each point
+		//! @param [in] iterations number of Newton iterations
+		void heights_at(glm::vec2 const *texcoords, size_t count, float time, glm::vec2 const &surface_size,
+		                float *heights, glm::vec2 *rest_texcoords = nullptr, unsigned int iterations = 4u) const;
+
+		float height_at(glm::vec2 const &texcoord, float time, glm::vec2 const &surface_size) const;
+
+	private:
+		// Sums over the waves of the terms of `waveHeight()`, before the
+		// fading and normalisation done by `main()`.
+		struct wave_sums;
+
+		void sum_waves(glm::vec2 const *texcoords, size_t count, float time, wave_sums *sums) const;
+		gerstner_sample finish(glm::vec2 const &texcoord, wave_sums const &sums) const;
+
+		std::vector<float> _amplitudes;
+		std::vector<float> _directions_x;
+		std::vector<float> _directions_y;
+		std::vector<float> _frequencies;
+		std::vector<float> _phases;
+		std::vector<float> _steepnesses;
+		float _space_scale;
+	};
+}
@@ -1,5 +1,56 @@
 #include "interpolation_modified.hpp"
 
+#include "core/Log.h"
+#include "core/Misc.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define INTERPOLATION_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// Nodes and weights of the 5-point Gauss-Legendre quadrature on [-1, 1].
+	constexpr float gauss_nodes[] = {0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f};
+	constexpr float gauss_weights[] = {0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f};
+
+	// Pieces of a segment within which the closest point is refined, in
+	// parameter: segments are split into pieces at most this wide, and
+	// further while their hulls are large against the distance to them,
+	// down to the smallest width.
+	constexpr float max_leaf_width = 0.5f;
+	constexpr float min_interval_width = 1.0f / 1024.0f;
+	constexpr size_t max_subdivisions = 10u; // log2(1 / min_interval_width)
+
+	glm::vec3 cubic_position(glm::vec4 const *c, float x)
+	{
+		return glm::vec3(c[0] + x * (c[1] + x * (c[2] + x * c[3])));
+	}
+
+	glm::vec3 cubic_derivative(glm::vec4 const *c, float x)
+	{
+		return glm::vec3(c[1] + x * (2.0f * c[2] + 3.0f * x * c[3]));
+	}
+
+	glm::vec3 cubic_second_derivative(glm::vec4 const *c, float x)
+	{
+		return glm::vec3(2.0f * c[2] + 6.0f * x * c[3]);
+	}
+
+	float squared_distance_to_box(glm::vec3 const &p, glm::vec3 const &lower, glm::vec3 const &upper)
+	{
+		auto const outside = glm::max(glm::max(lower - p, p - upper), glm::vec3(0.0f));
+		return glm::dot(outside, outside);
+	}
+}
+
 glm::vec3
 interpolation::evalLERP(glm::vec3 const& p0, glm::vec3 const& p1, float const x)
 {
@@ -46,4 +97,498 @@ interpolation::evalCatmullRomDerivative(glm::vec3 const&p0, glm::vec3 const&p1,
 					,evalCatmullRom1DDerivative(p0.y,p1.y,p2.y,p3.y,t,x)
 					,evalCatmullRom1DDerivative(p0.z,p1.z,p2.z,p3.z,t,x)
 					);
-}
\ No newline at end of file
+}
+
+interpolation::catmull_rom_spline::catmull_rom_spline(glm::vec3 const *control_points, size_t control_points_nb, float tension)
+	: _tension(tension)
+{
+	set_control_points(control_points, control_points_nb);
+}
+
+void interpolation::catmull_rom_spline::set_control_points(glm::vec3 const *control_points, size_t control_points_nb)
+{
+	_control_points.assign(control_points, control_points + control_points_nb);
+	update_segments();
+}
+
+void interpolation::catmull_rom_spline::set_tension(float tension)
+{
+	if (tension == _tension)
+		return;
+	_tension = tension;
+	update_segments();
+}
+
+void interpolation::catmull_rom_spline::update_segments()
+{
+	auto const n = _control_points.size();
+	auto const t = _tension;
+	_segments.resize(n);
+	for (size_t i = 0u; i < n; ++i)
+	{
+		auto const &p0 = _control_points[(i + n - 1u) % n];
+		auto const &p1 = _control_points[i];
+		auto const &p2 = _control_points[(i + 1u) % n];
+		auto const &p3 = _control_points[(i + 2u) % n];
+
+		// The columns of the geometry matrix of evalCatmullRom1D().
+		auto &c = _segments[i].c;
+		c[0] = glm::vec4(p1, 0.0f);
+		c[1] = glm::vec4(t * (p2 - p0), 0.0f);
+		c[2] = glm::vec4(2.0f * t * p0 + (t - 3.0f) * p1 + (3.0f - 2.0f * t) * p2 - t * p3, 0.0f);
+		c[3] = glm::vec4(-t * p0 + (2.0f - t) * p1 + (t - 2.0f) * p2 + t * p3, 0.0f);
+	}
+}
+
+interpolation::catmull_rom_spline::segment const &interpolation::catmull_rom_spline::locate(float s, float &x) const
+{
+	auto const n = static_cast<float>(_segments.size());
+	auto const wrapped = s - n * std::floor(s / n);
+	auto const i = std::min(static_cast<size_t>(wrapped), _segments.size() - 1u);
+	x = wrapped - static_cast<float>(i);
+	return _segments[i];
+}
+
+glm::vec3 interpolation::catmull_rom_spline::position(float s) const
+{
+	glm::vec3 result(0.0f);
+	evaluate(&s, 1u, &result);
+	return result;
+}
+
+glm::vec3 interpolation::catmull_rom_spline::derivative(float s) const
+{
+	glm::vec3 result(0.0f);
+	evaluate(&s, 1u, nullptr, &result);
+	return result;
+}
+
+glm::vec3 interpolation::catmull_rom_spline::second_derivative(float s) const
+{
+	glm::vec3 result(0.0f);
+	evaluate(&s, 1u, nullptr, nullptr, &result);
+	return result;
+}
+
+void interpolation::catmull_rom_spline::evaluate(float const *parameters, size_t count, glm::vec3 *positions,
+                                                 glm::vec3 *derivatives, glm::vec3 *second_derivatives) const
+{
+	if (_segments.empty())
+		return;
+
+	for (size_t i = 0u; i < count; ++i)
+	{
+		float x;
+		auto const &c = locate(parameters[i], x).c;
+#if defined(INTERPOLATION_USE_SSE)
+		auto const c0 = _mm_loadu_ps(&c[0].x);
+		auto const c1 = _mm_loadu_ps(&c[1].x);
+		auto const c2 = _mm_loadu_ps(&c[2].x);
+		auto const c3 = _mm_loadu_ps(&c[3].x);
+		auto const xv = _mm_set1_ps(x);
+
+		// Four floats at a time, except for the last point, whose vec3
+		// may end the array.
+		auto const store = [i, count](glm::vec3 *values, __m128 v) {
+			if (i + 1u < count)
+			{
+				_mm_storeu_ps(&values[i].x, v);
+				return;
+			}
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, v);
+			values[i] = glm::vec3(lanes[0], lanes[1], lanes[2]);
+		};
+		if (positions != nullptr)
+			store(positions, _mm_add_ps(c0, _mm_mul_ps(xv, _mm_add_ps(c1, _mm_mul_ps(xv, _mm_add_ps(c2, _mm_mul_ps(xv, c3)))))));
+		if (derivatives != nullptr)
+		{
+			auto const inner = _mm_add_ps(_mm_add_ps(c2, c2), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(3.0f), xv), c3));
+			store(derivatives, _mm_add_ps(c1, _mm_mul_ps(xv, inner)));
+		}
+		if (second_derivatives != nullptr)
+			store(second_derivatives, _mm_add_ps(_mm_add_ps(c2, c2), _mm_mul_ps(_mm_set1_ps(6.0f * x), c3)));
+#else
+		if (positions != nullptr)
+			positions[i] = glm::vec3(c[0] + x * (c[1] + x * (c[2] + x * c[3])));
+		if (derivatives != nullptr)
+			derivatives[i] = glm::vec3(c[1] + x * (2.0f * c[2] + 3.0f * x * c[3]));
+		if (second_derivatives != nullptr)
+			second_derivatives[i] = glm::vec3(2.0f * c[2] + 6.0f * x * c[3]);
+#endif
+	}
+}
+
+interpolation::arc_length_table::arc_length_table(catmull_rom_spline const &spline, unsigned int samples_per_segment)
+	: _spline(&spline), _samples_per_segment(std::max(samples_per_segment, 1u))
+{
+	auto const samples_nb = spline.get_segments_nb() * _samples_per_segment;
+	auto const step = 1.0f / static_cast<float>(_samples_per_segment);
+	_lengths.resize(samples_nb + 1u);
+	_lengths[0] = 0.0;
+	for (size_t j = 0u; j < samples_nb; ++j)
+	{
+		auto const x0 = static_cast<float>(j % _samples_per_segment) * step;
+		_lengths[j + 1u] = _lengths[j] + integrate(j / _samples_per_segment, x0, x0 + step);
+	}
+}
+
+float interpolation::arc_length_table::integrate(size_t i, float x0, float x1) const
+{
+	auto const c = _spline->get_coefficients(i);
+	auto const half = 0.5f * (x1 - x0);
+	auto const middle = 0.5f * (x0 + x1);
+	auto length = 0.0f;
+	for (auto k = 0u; k < 5u; ++k)
+		length += gauss_weights[k] * glm::length(cubic_derivative(c, middle + half * gauss_nodes[k]));
+	return half * length;
+}
+
+float interpolation::arc_length_table::distance_at(float s) const
+{
+	auto const segments_nb = _spline->get_segments_nb();
+	if (segments_nb == 0u)
+		return 0.0f;
+	auto const n = static_cast<float>(segments_nb);
+	auto const wrapped = s - n * std::floor(s / n);
+	auto const j = std::min(static_cast<size_t>(wrapped * static_cast<float>(_samples_per_segment)), _lengths.size() - 2u);
+	auto const i = j / _samples_per_segment;
+	auto const x0 = static_cast<float>(j % _samples_per_segment) / static_cast<float>(_samples_per_segment);
+	return static_cast<float>(_lengths[j]) + integrate(i, x0, wrapped - static_cast<float>(i));
+}
+
+float interpolation::arc_length_table::parameter_at(float distance) const
+{
+	if (_spline->get_segments_nb() == 0u || !(get_length() > 0.0f))
+		return 0.0f;
+	auto const length = _lengths.back();
+	auto d = static_cast<double>(distance);
+	d -= length * std::floor(d / length);
+
+	// The interval of the table the distance falls in.
+	auto const after = std::upper_bound(_lengths.begin() + 1, _lengths.end() - 1, d);
+	auto const j = static_cast<size_t>(after - _lengths.begin()) - 1u;
+	auto const i = j / _samples_per_segment;
+	auto const step = 1.0f / static_cast<float>(_samples_per_segment);
+	auto const x0 = static_cast<float>(j % _samples_per_segment) * step;
+	auto const x1 = x0 + step;
+	auto const remaining = static_cast<float>(d - _lengths[j]);
+	auto const interval = static_cast<float>(_lengths[j + 1u] - _lengths[j]);
+
+	// Linear guess, then Newton's method on the length from x0, whose
+	// derivative is the speed along the curve.
+	auto x = interval > 0.0f ? x0 + step * remaining / interval : x0;
+	auto const c = _spline->get_coefficients(i);
+	for (auto iteration = 0u; iteration < 3u; ++iteration)
+	{
+		auto const speed = glm::length(cubic_derivative(c, x));
+		if (!(speed > 0.0f))
+			break;
+		x = glm::clamp(x - (integrate(i, x0, x) - remaining) / speed, x0, x1);
+	}
+	return static_cast<float>(i) + x;
+}
+
+void interpolation::arc_length_table::parameters_at(float const *distances, size_t count, float *parameters) const
+{
+	for (size_t i = 0u; i < count; ++i)
+		parameters[i] = parameter_at(distances[i]);
+}
+
+interpolation::segment_hierarchy::segment_hierarchy(catmull_rom_spline const &spline)
+	: _spline(&spline), _leaves_nb(1u)
+{
+	auto const segments_nb = spline.get_segments_nb();
+	while (_leaves_nb < segments_nb)
+		_leaves_nb *= 2u;
+
+	// Leaves past the last segment stay empty, and never get visited.
+	auto const infinity = std::numeric_limits<float>::infinity();
+	_boxes.assign(2u * _leaves_nb - 1u, box{glm::vec3(infinity), glm::vec3(-infinity)});
+	for (size_t i = 0u; i < segments_nb; ++i)
+	{
+		// Bézier control points of the segment, whose convex hull
+		// contains it.
+		auto const c = spline.get_coefficients(i);
+		glm::vec3 const points[] = {glm::vec3(c[0]), glm::vec3(c[0] + c[1] / 3.0f),
+		                            glm::vec3(c[0] + 2.0f * c[1] / 3.0f + c[2] / 3.0f),
+		                            glm::vec3(c[0] + c[1] + c[2] + c[3])};
+		auto &leaf = _boxes[_leaves_nb - 1u + i];
+		for (auto const &point : points)
+		{
+			leaf.lower = glm::min(leaf.lower, point);
+			leaf.upper = glm::max(leaf.upper, point);
+		}
+	}
+	for (auto k = _leaves_nb - 1u; k-- > 0u;)
+	{
+		_boxes[k].lower = glm::min(_boxes[2u * k + 1u].lower, _boxes[2u * k + 2u].lower);
+		_boxes[k].upper = glm::max(_boxes[2u * k + 1u].upper, _boxes[2u * k + 2u].upper);
+	}
+}
+
+void interpolation::segment_hierarchy::nearest_on_segment(size_t i, glm::vec3 const &position,
+                                                          float &best_squared_distance, float &best_s) const
+{
+	auto const c = _spline->get_coefficients(i);
+	auto const squared_distance_at = [&c, &position](float x) {
+		auto const offset = cubic_position(c, x) - position;
+		return glm::dot(offset, offset);
+	};
+
+	for (auto const x : {0.0f, 0.5f, 1.0f})
+	{
+		auto const squared_distance = squared_distance_at(x);
+		if (squared_distance < best_squared_distance)
+		{
+			best_squared_distance = squared_distance;
+			best_s = static_cast<float>(i) + x;
+		}
+	}
+
+	// Split the segment while the hulls of its pieces are closer than the
+	// best point so far, and large against the distance to it, as the
+	// curve can stray far from a few samples.
+	struct interval
+	{
+		float x0, x1;
+	};
+	interval intervals[2u * max_subdivisions + 1u];
+	size_t intervals_nb = 0u;
+	intervals[intervals_nb++] = {0.0f, 1.0f};
+	while (intervals_nb > 0u)
+	{
+		auto const current = intervals[--intervals_nb];
+		auto const width = current.x1 - current.x0;
+		auto const p0 = cubic_position(c, current.x0), p3 = cubic_position(c, current.x1);
+		auto const p1 = p0 + width / 3.0f * cubic_derivative(c, current.x0);
+		auto const p2 = p3 - width / 3.0f * cubic_derivative(c, current.x1);
+		auto const lower = glm::min(glm::min(p0, p1), glm::min(p2, p3));
+		auto const upper = glm::max(glm::max(p0, p1), glm::max(p2, p3));
+		if (squared_distance_to_box(position, lower, upper) >= best_squared_distance)
+			continue;
+
+		auto const extent = upper - lower;
+		if (width > min_interval_width
+		    && (width > max_leaf_width || glm::dot(extent, extent) > best_squared_distance))
+		{
+			auto const middle = current.x0 + 0.5f * width;
+			auto const first_closer = squared_distance_at(current.x0) < squared_distance_at(current.x1);
+			intervals[intervals_nb++] = first_closer ? interval{middle, current.x1} : interval{current.x0, middle};
+			intervals[intervals_nb++] = first_closer ? interval{current.x0, middle} : interval{middle, current.x1};
+			continue;
+		}
+
+		// Newton's method on the derivative of the squared distance,
+		// halved, from the closest of the ends and middle; steps leaving
+		// the interval, as where the distance is concave, bisect it
+		// instead.
+		auto lower_x = current.x0, upper_x = current.x1;
+		auto x = current.x0 + 0.5f * width;
+		for (auto const end : {current.x0, current.x1})
+			if (squared_distance_at(end) < squared_distance_at(x))
+				x = end;
+		for (auto iteration = 0u; iteration < 8u; ++iteration)
+		{
+			auto const offset = cubic_position(c, x) - position;
+			auto const derivative = cubic_derivative(c, x);
+			auto const slope = glm::dot(offset, derivative);
+			auto const curvature = glm::dot(derivative, derivative) + glm::dot(offset, cubic_second_derivative(c, x));
+			(slope > 0.0f ? upper_x : lower_x) = x;
+			auto const next = curvature > 0.0f ? x - slope / curvature : lower_x - 1.0f;
+			auto const previous = x;
+			x = next > lower_x && next < upper_x ? next : 0.5f * (lower_x + upper_x);
+			if (std::abs(x - previous) < 1.0e-6f)
+				break;
+		}
+		for (auto const candidate : {x, current.x0, current.x1})
+		{
+			auto const squared_distance = squared_distance_at(candidate);
+			if (squared_distance < best_squared_distance)
+			{
+				best_squared_distance = squared_distance;
+				best_s = static_cast<float>(i) + candidate;
+			}
+		}
+	}
+}
+
+float interpolation::segment_hierarchy::nearest(glm::vec3 const &position, float *distance) const
+{
+	auto const segments_nb = _spline->get_segments_nb();
+	auto best_s = 0.0f;
+	auto best_squared_distance = std::numeric_limits<float>::infinity();
+	if (segments_nb == 0u)
+	{
+		if (distance != nullptr)
+			*distance = best_squared_distance;
+		return best_s;
+	}
+
+	// Nodes to visit, with the squared distance to their box; at most one
+	// per level is left behind while descending.
+	struct pending_node
+	{
+		size_t k;
+		float squared_distance;
+	};
+	pending_node stack[2u * sizeof(size_t) * 8u];
+	size_t stack_size = 0u;
+	stack[stack_size++] = {0u, squared_distance_to_box(position, _boxes[0].lower, _boxes[0].upper)};
+	while (stack_size > 0u)
+	{
+		auto const node = stack[--stack_size];
+		if (node.squared_distance >= best_squared_distance)
+			continue;
+
+		if (node.k >= _leaves_nb - 1u)
+		{
+			nearest_on_segment(node.k - (_leaves_nb - 1u), position, best_squared_distance, best_s);
+			continue;
+		}
+
+		// The closer child is pushed last, to be visited first.
+		pending_node const left = {2u * node.k + 1u, squared_distance_to_box(position, _boxes[2u * node.k + 1u].lower, _boxes[2u * node.k + 1u].upper)};
+		pending_node const right = {2u * node.k + 2u, squared_distance_to_box(position, _boxes[2u * node.k + 2u].lower, _boxes[2u * node.k + 2u].upper)};
+		auto const &closer = left.squared_distance < right.squared_distance ? left : right;
+		auto const &farther = left.squared_distance < right.squared_distance ? right : left;
+		if (farther.squared_distance < best_squared_distance)
+			stack[stack_size++] = farther;
+		if (closer.squared_distance < best_squared_distance)
+			stack[stack_size++] = closer;
+	}
+
+	if (distance != nullptr)
+		*distance = std::sqrt(best_squared_distance);
+	return best_s;
+}
+
+void interpolation::benchmarkSpline()
+{
+	constexpr size_t control_points_nb = 4096u;
+	constexpr size_t points_nb = 1u << 20;
+
+	// A helix, with unevenly spaced control points.
+	std::vector<glm::vec3> control_points(control_points_nb);
+	for (size_t i = 0u; i < control_points_nb; ++i)
+	{
+		auto const angle = 0.1f * static_cast<float>(i) + 0.05f * std::sin(0.37f * static_cast<float>(i));
+		control_points[i] = glm::vec3(std::cos(angle), std::sin(angle), 0.01f * static_cast<float>(i));
+	}
+	auto const tension = 0.5f;
+	std::vector<float> parameters(points_nb);
+	for (size_t i = 0u; i < points_nb; ++i)
+		parameters[i] = static_cast<float>(control_points_nb) * (static_cast<float>(i) + 0.5f) / static_cast<float>(points_nb);
+
+	// As assignment2_modified.cpp does for each point.
+	std::vector<glm::vec3> positions(points_nb), derivatives(points_nb);
+	auto start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < points_nb; ++i)
+	{
+		auto const f = std::floor(parameters[i]);
+		auto const x = parameters[i] - f;
+		auto const k = static_cast<size_t>(f);
+		auto const &p0 = control_points[(k + control_points_nb - 1u) % control_points_nb];
+		auto const &p1 = control_points[k];
+		auto const &p2 = control_points[(k + 1u) % control_points_nb];
+		auto const &p3 = control_points[(k + 2u) % control_points_nb];
+		positions[i] = evalCatmullRom(p0, p1, p2, p3, tension, x);
+		derivatives[i] = evalCatmullRomDerivative(p0, p1, p2, p3, tension, x);
+	}
+	auto const per_call_duration = GetTimeMilliseconds() - start;
+
+	start = GetTimeMilliseconds();
+	catmull_rom_spline const spline(control_points.data(), control_points.size(), tension);
+	auto const setup_duration = GetTimeMilliseconds() - start;
+	std::vector<glm::vec3> spline_positions(points_nb), spline_derivatives(points_nb);
+	start = GetTimeMilliseconds();
+	spline.evaluate(parameters.data(), points_nb, spline_positions.data(), spline_derivatives.data());
+	auto const batch_duration = GetTimeMilliseconds() - start;
+
+	auto position_error = 0.0f, derivative_error = 0.0f;
+	for (size_t i = 0u; i < points_nb; ++i)
+	{
+		position_error = std::max(position_error, glm::length(spline_positions[i] - positions[i]));
+		derivative_error = std::max(derivative_error, glm::length(spline_derivatives[i] - derivatives[i]));
+	}
+
+	auto const million_points = static_cast<double>(points_nb) / 1.0e6;
+	LogInfo("Catmull-Rom positions and derivatives over %zu segments: %.1f million points per second per call, %.1f in batches (%.1fx), after %.3f ms of setup; largest differences %g and %g",
+	        control_points_nb, million_points / (1.0e-3 * per_call_duration), million_points / (1.0e-3 * batch_duration),
+	        per_call_duration / batch_duration, setup_duration, position_error, derivative_error);
+}
+
+void interpolation::benchmarkSplineQueries()
+{
+	constexpr size_t control_points_nb = 32768u;
+	constexpr size_t queries_nb = 100000u;
+	constexpr size_t brute_force_nb = 200u;
+
+	// A torus knot winding 100 times around, closing smoothly, with
+	// unevenly spaced control points.
+	std::vector<glm::vec3> control_points(control_points_nb);
+	for (size_t i = 0u; i < control_points_nb; ++i)
+	{
+		auto const n = static_cast<float>(control_points_nb);
+		auto const k = static_cast<float>(i);
+		auto const phi = glm::two_pi<float>() * (k + 0.3f * std::sin(glm::two_pi<float>() * 37.0f * k / n)) / n;
+		auto const radius = 10.0f + 2.0f * std::cos(3.0f * phi);
+		control_points[i] = glm::vec3(radius * std::cos(100.0f * phi), radius * std::sin(100.0f * phi), 2.0f * std::sin(3.0f * phi));
+	}
+	catmull_rom_spline const spline(control_points.data(), control_points.size(), 0.5f);
+
+	auto start = GetTimeMilliseconds();
+	arc_length_table const table(spline);
+	auto const table_duration = GetTimeMilliseconds() - start;
+	start = GetTimeMilliseconds();
+	segment_hierarchy const hierarchy(spline);
+	auto const hierarchy_duration = GetTimeMilliseconds() - start;
+
+	// Constant-speed steps, and how far their lengths are from the
+	// requested ones.
+	std::vector<float> distances(queries_nb), parameters(queries_nb);
+	for (size_t i = 0u; i < queries_nb; ++i)
+		distances[i] = table.get_length() * (static_cast<float>(i) + 0.5f) / static_cast<float>(queries_nb);
+	start = GetTimeMilliseconds();
+	table.parameters_at(distances.data(), queries_nb, parameters.data());
+	auto const inversion_duration = GetTimeMilliseconds() - start;
+	auto length_error = 0.0f;
+	for (size_t i = 0u; i < queries_nb; ++i)
+	{
+		auto const error = std::abs(table.distance_at(parameters[i]) - distances[i]);
+		length_error = std::max(length_error, std::min(error, table.get_length() - error));
+	}
+
+	// Points scattered around the spline, against every segment.
+	std::mt19937 generator(1u);
+	std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+	std::vector<glm::vec3> positions(queries_nb);
+	for (auto &position : positions)
+	{
+		auto const s = static_cast<float>(control_points_nb) * (offset(generator) + 0.5f);
+		position = spline.position(s) + 0.5f * glm::vec3(offset(generator), offset(generator), offset(generator));
+	}
+	std::vector<float> nearest_distances(queries_nb);
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < queries_nb; ++i)
+		hierarchy.nearest(positions[i], &nearest_distances[i]);
+	auto const nearest_duration = GetTimeMilliseconds() - start;
+
+	auto nearest_error = 0.0f;
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < brute_force_nb; ++i)
+	{
+		auto best = std::numeric_limits<float>::infinity();
+		for (size_t s = 0u; s < 16u * control_points_nb; ++s)
+			best = std::min(best, glm::length(spline.position(static_cast<float>(s) / 16.0f) - positions[i]));
+		nearest_error = std::max(nearest_error, nearest_distances[i] - best);
+	}
+	auto const brute_force_duration = (GetTimeMilliseconds() - start) / static_cast<double>(brute_force_nb);
+
+	LogInfo("Spline of %zu segments, %.0f long: arc-length table built in %.1f ms, hierarchy in %.1f ms",
+	        control_points_nb, table.get_length(), table_duration, hierarchy_duration);
+	LogInfo("Parameters at distances: %.2f us each, lengths off by at most %g",
+	        1.0e3 * inversion_duration / static_cast<double>(queries_nb), length_error);
+	LogInfo("Nearest points: %.2f us each, against %.0f us sampling every segment 16 times, and at most %g farther",
+	        1.0e3 * nearest_duration / static_cast<double>(queries_nb), 1.0e3 * brute_force_duration, nearest_error);
+}
@@ -2,6 +2,9 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <vector>
+
 namespace interpolation
 {
 	//! \brief Linearly interpolate a position between two points.
@@ -40,4 +43,154 @@ namespace interpolation
 	glm::vec3 evalCatmullRomDerivative(glm::vec3 const&p0, glm::vec3 const&p1,
 									   glm::vec3 const&p2, glm::vec3 const&p3,
 									   float const t, float const x);
+
+	//! \brief Closed Catmull-Rom spline, with the cubic coefficients of
+	//!        each segment computed once rather than on every evaluation.
+	//!
+	//! Segment i goes from control point i to control point i + 1, with
+	//! i - 1 and i + 2 as outer points, the last one joining back to the
+	//! first; parameter s lies on segment floor(s), at s - floor(s), and
+	//! wraps around every `get_segments_nb()`. Positions match
+	//! `evalCatmullRom()`, and derivatives `evalCatmullRomDerivative()`.
+	//!
+	//! Each segment keeps c0 + c1 x + c2 x² + c3 x³ as four vectors, one
+	//! cache line together, and `evaluate()` computes the three
+	//! components at once with SSE.
+	class catmull_rom_spline
+	{
+	public:
+		catmull_rom_spline() = default;
+		catmull_rom_spline(glm::vec3 const *control_points, size_t control_points_nb, float tension);
+
+		//! \brief Replace the control points, and recompute the segments.
+		void set_control_points(glm::vec3 const *control_points, size_t control_points_nb);
+
+		//! \brief Change the tension; the segments are only recomputed if
+		//!        it differs.
+		void set_tension(float tension);
+
+		float get_tension() const { return _tension; }
+		size_t get_segments_nb() const { return _segments.size(); }
+		std::vector<glm::vec3> const &get_control_points() const { return _control_points; }
+
+		//! \brief c0, c1, c2 and c3 of segment `i`, in their xyz.
+		glm::vec4 const *get_coefficients(size_t i) const { return _segments[i].c; }
+
+		glm::vec3 position(float s) const;
+		glm::vec3 derivative(float s) const;
+		glm::vec3 second_derivative(float s) const;
+
+		//! \brief Evaluate the spline at `count` parameters.
+		//!
+		//! @param [in] parameters values of s
+		//! @param [in] count number of parameters
+		//! @param [out] positions if not null, one position per parameter
+		//! @param [out] derivatives if not null, the first derivatives
+		//! @param [out] second_derivatives if not null, the second
+		//!              derivatives
+		void evaluate(float const *parameters, size_t count, glm::vec3 *positions,
+		              glm::vec3 *derivatives = nullptr, glm::vec3 *second_derivatives = nullptr) const;
+
+	private:
+		struct segment
+		{
+			glm::vec4 c[4]; // w unused
+		};
+
+		//! Segment of `s`, and where on it.
+		segment const &locate(float s, float &x) const;
+		void update_segments();
+
+		std::vector<glm::vec3> _control_points;
+		std::vector<segment> _segments;
+		float _tension = 0.5f;
+	};
+
+	//! \brief Lengths along a `catmull_rom_spline`, to move along it at
+	//!        constant speed rather than at constant parameter speed.
+	//!
+	//! The table holds the length from the start of the spline to
+	//! `samples_per_segment` evenly spaced parameters per segment,
+	//! integrated with 5-point Gauss-Legendre quadrature. `parameter_at()`
+	//! finds the interval of a length by binary search, interpolates
+	//! linearly within it, and refines the result with Newton's method.
+	//! Rebuild it when the spline changes.
+	class arc_length_table
+	{
+	public:
+		explicit arc_length_table(catmull_rom_spline const &spline, unsigned int samples_per_segment = 8u);
+
+		//! \brief Length of the whole loop.
+		float get_length() const { return static_cast<float>(_lengths.back()); }
+
+		//! \brief Length from the start of the spline to parameter `s`.
+		float distance_at(float s) const;
+
+		//! \brief Parameter at `distance` from the start of the spline,
+		//!        wrapping around the loop.
+		float parameter_at(float distance) const;
+
+		//! \brief `parameter_at()` for `count` distances, e.g. evenly
+		//!        spaced ones to pass on to `catmull_rom_spline::evaluate()`.
+		void parameters_at(float const *distances, size_t count, float *parameters) const;
+
+	private:
+		//! Length of segment `i` between `x0` and `x1`.
+		float integrate(size_t i, float x0, float x1) const;
+
+		catmull_rom_spline const *_spline;
+		unsigned int _samples_per_segment;
+		std::vector<double> _lengths; // doubles, for loops of many segments
+	};
+
+	//! \brief Bounding-box hierarchy over the segments of a
+	//!        `catmull_rom_spline`, for the point of the spline closest to
+	//!        any position.
+	//!
+	//! Each segment is bounded by the convex hull of its Bézier control
+	//! points. Consecutive segments are grouped in a balanced binary tree,
+	//! stored as an array; queries descend into the closest child first
+	//! and skip boxes farther than the best point found so far. Segments
+	//! are split the same way, with the hulls of their pieces, and the
+	//! closest point of each small piece is refined with Newton's method
+	//! on the distance. Rebuild it when the spline changes.
+	class segment_hierarchy
+	{
+	public:
+		explicit segment_hierarchy(catmull_rom_spline const &spline);
+
+		//! \brief Parameter of the point of the spline closest to
+		//!        `position`.
+		//!
+		//! @param [in] position point to project onto the spline
+		//! @param [out] distance if not null, distance from `position` to
+		//!              the closest point
+		float nearest(glm::vec3 const &position, float *distance = nullptr) const;
+
+	private:
+		struct box
+		{
+			glm::vec3 lower;
+			glm::vec3 upper;
+		};
+
+		//! Look for a point of segment `i` closer to `position` than the
+		//! best one so far.
+		void nearest_on_segment(size_t i, glm::vec3 const &position, float &best_squared_distance, float &best_s) const;
+
+		catmull_rom_spline const *_spline;
+		size_t _leaves_nb;
+		std::vector<box> _boxes; // node k has children 2k + 1 and 2k + 2
+	};
+
+	//! \brief Evaluate positions and derivatives along a long spline with
+	//!        `evalCatmullRom()` and `evalCatmullRomDerivative()`, then with
+	//!        `catmull_rom_spline::evaluate()`, and log how many points per
+	//!        second each manages and how far apart their results are.
+	void benchmarkSpline();
+
+	//! \brief Build an `arc_length_table` and a `segment_hierarchy` over
+	//!        a spline of tens of thousands of segments, and log how long
+	//!        they take to build and to query, and how accurate they are.
+	void benchmarkSplineQueries();
 }
@@ -0,0 +1,188 @@
+#include "ocean_clipmap.hpp"
+
+#include "core/helpers.hpp"
+#include "core/Log.h"
+#include "core/mesh_cpu.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	// Size of the `vertex_model_to_world` arrays of the clipmap shaders.
+	constexpr size_t max_instances_nb = 100u;
+
+	// Grid of `columns_nb` x `rows_nb` unit quads in the xz plane, from
+	// the origin towards +x and +z, facing +y.
+	bonobo::mesh_cpu build_tile(unsigned int columns_nb, unsigned int rows_nb)
+	{
+		auto const row_vertices_nb = columns_nb + 1u;
+		auto mesh = bonobo::mesh_cpu(row_vertices_nb * (rows_nb + 1u));
+		for (auto j = 0u; j <= rows_nb; ++j)
+		{
+			for (auto i = 0u; i <= columns_nb; ++i)
+			{
+				auto const vertex = j * row_vertices_nb + i;
+				mesh.vertices.set<bonobo::shader_bindings::vertices>(vertex, glm::vec3(i, 0.0f, j));
+				mesh.vertices.set<bonobo::shader_bindings::normals>(vertex, glm::vec3(0.0f, 1.0f, 0.0f));
+				mesh.vertices.set<bonobo::shader_bindings::texcoords>(vertex, glm::vec3(static_cast<float>(i) / columns_nb,
+				                                                                        static_cast<float>(j) / rows_nb, 0.0f));
+				mesh.vertices.set<bonobo::shader_bindings::tangents>(vertex, glm::vec3(1.0f, 0.0f, 0.0f));
+				mesh.vertices.set<bonobo::shader_bindings::binormals>(vertex, glm::vec3(0.0f, 0.0f, 1.0f));
+			}
+		}
+
+		// All diagonals go the same way, so that collapsing every other
+		// vertex onto its neighbour gives the triangles of the coarser grid,
+		// which is what morphing between levels does.
+		mesh.indices.reserve(6u * columns_nb * rows_nb);
+		for (auto j = 0u; j < rows_nb; ++j)
+		{
+			for (auto i = 0u; i < columns_nb; ++i)
+			{
+				auto const v00 = j * row_vertices_nb + i;
+				auto const v10 = v00 + 1u, v01 = v00 + row_vertices_nb, v11 = v01 + 1u;
+				mesh.indices.insert(mesh.indices.end(), {v00, v01, v11, v00, v11, v10});
+			}
+		}
+
+		bonobo::mesh_options options;
+		options.optimize = true;
+		bonobo::prepare_mesh(mesh, options, "clipmap tile");
+		return mesh;
+	}
+}
+
+ocean::clipmap::clipmap(clipmap_parameters const &parameters) : _parameters(parameters)
+{
+	// ocean_clipmap.vert morphs the vertices between M + 2 and 2M - 1
+	// quads from the camera, which needs M to be at least 4.
+	auto const m = parameters.block_size;
+	assert(m >= 4u && parameters.levels_nb >= 1u);
+
+	// The tiles of one level, and the 12 blocks of every other, all have
+	// to fit in the shaders' arrays of transforms.
+	if (16u + 12u * (parameters.levels_nb - 1u) > max_instances_nb)
+	{
+		LogWarning("A clipmap can have at most %u levels; using that many.",
+		           static_cast<unsigned int>((max_instances_nb - 16u) / 12u + 1u));
+		_parameters.levels_nb = static_cast<unsigned int>((max_instances_nb - 16u) / 12u + 1u);
+	}
+
+	std::array<glm::uvec2, tile_kinds_nb> const sizes = {glm::uvec2(m, m), glm::uvec2(2u, m), glm::uvec2(m, 2u),
+	                                                     glm::uvec2(2u, 2u), glm::uvec2(1u, 2u * m + 2u),
+	                                                     glm::uvec2(2u * m + 1u, 1u)};
+	for (size_t kind = 0u; kind < tile_kinds_nb; ++kind)
+	{
+		auto const tile = build_tile(sizes[kind].x, sizes[kind].y);
+		_tiles[kind].set_geometry(bonobo::upload_mesh(tile));
+		_tile_vertices_nb[kind] = tile.vertices.get_vertices_nb();
+	}
+}
+
+void ocean::clipmap::add_tile(tile_kind kind, glm::vec2 const &corner, float spacing)
+{
+	auto const transform = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(corner.x, 0.0f, corner.y)),
+	                                  glm::vec3(spacing, 1.0f, spacing));
+	_instances[kind].push_back(transform);
+}
+
+void ocean::clipmap::update(glm::vec3 const &camera_position)
+{
+	for (auto &instances : _instances)
+		instances.clear();
+
+	auto const m = static_cast<float>(_parameters.block_size);
+	float const block_offsets[4] = {0.0f, m, 2.0f * m + 2.0f, 3.0f * m + 2.0f};
+	auto const snap = [](glm::vec2 const &position, float step) {
+		return glm::vec2(std::floor(position.x / step), std::floor(position.y / step)) * step;
+	};
+
+	// Corner of each level, on the grid of the next level so that both
+	// share the vertices of their boundary; every level is 4M + 2 quads
+	// across, centred on the camera, or on the previous level, within a
+	// step.
+	auto spacing = _parameters.finest_spacing;
+	auto previous_corner = glm::vec2(0.0f);
+	for (auto level = 0u; level < _parameters.levels_nb; ++level, spacing *= 2.0f)
+	{
+		auto const camera = glm::vec2(camera_position.x, camera_position.z);
+		auto const corner = level == 0u ? snap(camera - (2.0f * m + 1.0f) * spacing, 2.0f * spacing)
+		                                : snap(previous_corner - m * spacing, 2.0f * spacing);
+
+		for (auto j = 0u; j < 4u; ++j)
+		{
+			for (auto i = 0u; i < 4u; ++i)
+			{
+				auto const inner = (i == 1u || i == 2u) && (j == 1u || j == 2u);
+				if (level == 0u || !inner)
+					add_tile(block, corner + spacing * glm::vec2(block_offsets[i], block_offsets[j]), spacing);
+			}
+		}
+		for (auto k = 0u; k < 4u; ++k)
+		{
+			if (level != 0u && (k == 1u || k == 2u))
+				continue;
+			add_tile(column_fixup, corner + spacing * glm::vec2(2.0f * m, block_offsets[k]), spacing);
+			add_tile(row_fixup, corner + spacing * glm::vec2(block_offsets[k], 2.0f * m), spacing);
+		}
+
+		if (level == 0u)
+		{
+			add_tile(centre, corner + spacing * glm::vec2(2.0f * m), spacing);
+		}
+		else
+		{
+			// The previous level covers the middle 2M + 2 quads but one, on
+			// the side it is offset away from.
+			auto const offset = glm::round((previous_corner - corner) / spacing - m);
+			auto const trim = glm::vec2(offset.x > 0.5f ? m : 3.0f * m + 1.0f,
+			                            offset.y > 0.5f ? m : 3.0f * m + 1.0f);
+			add_tile(column_trim, corner + spacing * glm::vec2(trim.x, m), spacing);
+			add_tile(row_trim, corner + spacing * glm::vec2(offset.x > 0.5f ? m + 1.0f : m, trim.y), spacing);
+		}
+		previous_corner = corner;
+	}
+}
+
+void ocean::clipmap::render(glm::mat4 const &world_to_clip, GLuint program,
+                            std::function<void(GLuint)> const &set_uniforms) const
+{
+	auto const block_size = static_cast<float>(_parameters.block_size);
+	auto const coarsest_spacing = _parameters.finest_spacing * std::exp2(static_cast<float>(_parameters.levels_nb - 1u));
+	auto const set_clipmap_uniforms = [&set_uniforms, block_size, coarsest_spacing](GLuint program) {
+		set_uniforms(program);
+		// The tiles are placed in world space, without any rotation.
+		glUniformMatrix4fv(glGetUniformLocation(program, "normal_model_to_world"), 1, GL_FALSE,
+		                   glm::value_ptr(glm::mat4(1.0f)));
+		glUniform1f(glGetUniformLocation(program, "clipmap_block_size"), block_size);
+		glUniform1f(glGetUniformLocation(program, "clipmap_coarsest_spacing"), coarsest_spacing);
+	};
+
+	for (size_t kind = 0u; kind < tile_kinds_nb; ++kind)
+		if (!_instances[kind].empty())
+			_tiles[kind].renderInstanced(world_to_clip, glm::mat4(1.0f), _instances[kind], program, set_clipmap_uniforms);
+}
+
+void ocean::clipmap::add_texture(std::string const &name, GLuint texture, GLenum type)
+{
+	for (auto &tile : _tiles)
+		tile.add_texture(name, texture, type);
+}
+
+size_t ocean::clipmap::get_vertices_nb() const
+{
+	size_t vertices_nb = 0u;
+	for (size_t kind = 0u; kind < tile_kinds_nb; ++kind)
+		vertices_nb += _tile_vertices_nb[kind] * _instances[kind].size();
+	return vertices_nb;
+}
+
+float ocean::clipmap::get_extent() const
+{
+	return (4.0f * _parameters.block_size + 2.0f) * _parameters.finest_spacing
+	     * std::exp2(static_cast<float>(_parameters.levels_nb - 1u));
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/node.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ocean
+{
+	//! \brief Parameters of a `clipmap`.
+	struct clipmap_parameters
+	{
+		unsigned int block_size = 15u;  //!< quads along each side of a block, M; at least 4
+		unsigned int levels_nb = 6u;    //!< nested levels, each twice as coarse as the previous one
+		float finest_spacing = 0.5f;    //!< distance between the vertices of the finest level, in metres
+	};
+
+	//! \brief Camera-centred geometry clipmap, to draw an ocean whose
+	//!        vertices get sparser with the distance.
+	//!
+	//! Every level is a square of 4M + 2 quads, made of the same few
+	//! tiles as in "Geometry Clipmaps" from GPU Gems 2: 16 blocks of M x M
+	//! quads, with fix-up strips 2 quads wide in between. The finest level
+	//! is complete; the others are rings whose middle is filled by the
+	//! previous level, plus an L-shaped trim one quad wide, as a level is
+	//! only moved by steps of two of its quads. That way vertices never
+	//! slide over the surface; vertex shaders morph the outer vertices of
+	//! each level onto the grid of the next one to hide the transitions.
+	//!
+	//! Each kind of tile is one mesh, drawn instanced with one transform
+	//! per tile, which scales the unit grid of the tile by the spacing of
+	//! its level; shaders find that spacing in `vertex_model_to_world[i][0][0]`.
+	class clipmap
+	{
+	public:
+		//! \brief Create the meshes of the tiles.
+		explicit clipmap(clipmap_parameters const &parameters);
+
+		//! \brief Place the levels around the camera.
+		void update(glm::vec3 const &camera_position);
+
+		//! \brief Draw all levels.
+		//!
+		//! @param [in] world_to_clip matrix from world space to clip space
+		//! @param [in] program shader program, with a `mat4[100]`
+		//!             `vertex_model_to_world` array
+		//! @param [in] set_uniforms sets the other uniforms of `program`
+		void render(glm::mat4 const &world_to_clip, GLuint program,
+		            std::function<void(GLuint)> const &set_uniforms) const;
+
+		void add_texture(std::string const &name, GLuint texture, GLenum type);
+
+		clipmap_parameters const &get_parameters() const { return _parameters; }
+
+		//! \brief Number of vertices drawn for all levels.
+		size_t get_vertices_nb() const;
+
+		//! \brief Side of the square covered by all levels, in metres.
+		float get_extent() const;
+
+	private:
+		enum tile_kind
+		{
+			block,
+			column_fixup, // 2 x M quads, between the blocks of a row
+			row_fixup,    // M x 2 quads, between the blocks of a column
+			centre,       // 2 x 2 quads, in the middle of the finest level
+			column_trim,  // 1 x (2M + 2) quads
+			row_trim,     // (2M + 1) x 1 quads
+			tile_kinds_nb
+		};
+
+		void add_tile(tile_kind kind, glm::vec2 const &corner, float spacing);
+
+		clipmap_parameters _parameters;
+		std::array<Node, tile_kinds_nb> _tiles;
+		std::array<size_t, tile_kinds_nb> _tile_vertices_nb;
+		std::array<std::vector<glm::mat4>, tile_kinds_nb> _instances;
+	};
+}
@@ -0,0 +1,297 @@
+#include "ocean_simulation.hpp"
+
+#include "core/Log.h"
+#include "core/Misc.h"
+#include "core/parallel.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	constexpr float gravity = 9.81f;
+
+	// Below this many samples, splitting a pass across threads costs more
+	// than it saves.
+	constexpr size_t min_samples_per_thread = 8192u;
+
+	// Frequency of the i-th sample along an axis of `n` samples, in the
+	// order FFTs use.
+	int signed_frequency(unsigned int i, unsigned int n)
+	{
+		return i < n / 2u ? static_cast<int>(i) : static_cast<int>(i) - static_cast<int>(n);
+	}
+
+	// Directional spreading, cos² of the angle to the wind, normalised
+	// over the half plane facing downwind; waves going upwind are left
+	// out.
+	float spreading(glm::vec2 const &k_direction, glm::vec2 const &wind_direction)
+	{
+		auto const c = glm::dot(k_direction, wind_direction);
+		return c > 0.0f ? 2.0f * glm::one_over_pi<float>() * c * c : 0.0f;
+	}
+
+	// Variance of the surface height per unit of wavevector area, for
+	// waves of wavevector `k`.
+	float spectral_density(ocean::fft_parameters const &parameters, glm::vec2 const &k)
+	{
+		auto const k_length = glm::length(k);
+		auto const wind_speed = glm::length(parameters.wind_velocity);
+		if (k_length < 1.0e-6f || wind_speed < 1.0e-3f)
+			return 0.0f;
+
+		auto const direction = spreading(k / k_length, parameters.wind_velocity / wind_speed);
+		if (direction == 0.0f)
+			return 0.0f;
+		auto const cutoff = std::exp(-k_length * k_length * parameters.small_wave_cutoff * parameters.small_wave_cutoff);
+
+		if (parameters.spectrum_kind == ocean::spectrum::phillips)
+		{
+			// α g² ω⁻⁵ over angular frequencies, moved to wavevectors with
+			// ω = sqrt(g k), and peaking at the largest waves the wind
+			// can sustain, of length V² / g.
+			auto const largest_wave = wind_speed * wind_speed / gravity;
+			auto const peak = std::exp(-1.0f / (k_length * largest_wave * k_length * largest_wave));
+			return 0.5f * parameters.phillips_constant / (k_length * k_length * k_length * k_length) * peak * direction * cutoff;
+		}
+
+		// JONSWAP over angular frequencies, with α and the peak frequency
+		// following from the wind speed and the fetch.
+		auto const fetch = std::max(parameters.fetch, 1.0f);
+		auto const alpha = 0.076f * std::pow(wind_speed * wind_speed / (fetch * gravity), 0.22f);
+		auto const omega_peak = 22.0f * std::cbrt(gravity * gravity / (wind_speed * fetch));
+		auto const omega = std::sqrt(gravity * k_length);
+		auto const sigma = omega <= omega_peak ? 0.07f : 0.09f;
+		auto const offset = (omega - omega_peak) / (sigma * omega_peak);
+		auto const ratio = omega_peak / omega;
+		auto const density_omega = alpha * gravity * gravity / std::pow(omega, 5.0f)
+		                         * std::exp(-1.25f * ratio * ratio * ratio * ratio)
+		                         * std::pow(parameters.peak_enhancement, std::exp(-0.5f * offset * offset));
+
+		// dω/dk = g / (2 ω), and dividing by k spreads the density of a
+		// wavenumber over its circle of wavevectors.
+		return density_omega * gravity / (2.0f * omega) / k_length * direction * cutoff;
+	}
+
+	// Multiply by i.
+	glm::vec2 times_i(glm::vec2 const &z)
+	{
+		return glm::vec2(-z.y, z.x);
+	}
+}
+
+ocean::fft_simulation::fft_simulation(fft_parameters const &parameters)
+	: _parameters(parameters), _fft(parameters.resolution),
+	  _displacement_texture(0u), _normal_foam_texture(0u), _textures_resolution(0u)
+{
+	generate_spectrum();
+}
+
+ocean::fft_simulation::~fft_simulation()
+{
+	release_textures();
+}
+
+void ocean::fft_simulation::set_parameters(fft_parameters const &parameters)
+{
+	auto const resolution = _parameters.resolution;
+	_parameters = parameters;
+	if (parameters.resolution != resolution)
+		_fft = bonobo::fft_2d(parameters.resolution);
+	generate_spectrum();
+}
+
+void ocean::fft_simulation::generate_spectrum()
+{
+	auto const n = _parameters.resolution;
+	assert(n >= 2u && (n & (n - 1u)) == 0u);
+	auto const samples_nb = static_cast<size_t>(n) * n;
+
+	_amplitudes.assign(samples_nb, glm::vec2(0.0f));
+	_mirrored_amplitudes.assign(samples_nb, glm::vec2(0.0f));
+	_angular_frequencies.assign(samples_nb, 0.0f);
+	for (auto i = 0u; i < 4u; ++i)
+	{
+		_real[i].assign(samples_nb, 0.0f);
+		_imaginary[i].assign(samples_nb, 0.0f);
+	}
+	_displacements.assign(samples_nb, glm::vec4(0.0f));
+	_normals_and_foam.assign(samples_nb, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+
+	// Drawn in a fixed order, so that a seed always gives the same sea.
+	std::mt19937 generator(_parameters.seed);
+	std::normal_distribution<float> gaussian(0.0f, 1.0f);
+	auto const dk = glm::two_pi<float>() / _parameters.patch_size;
+	for (auto row = 0u; row < n; ++row)
+	{
+		for (auto column = 0u; column < n; ++column)
+		{
+			auto const k = dk * glm::vec2(signed_frequency(column, n), signed_frequency(row, n));
+			auto const xi = glm::vec2(gaussian(generator), gaussian(generator));
+			auto const index = static_cast<size_t>(row) * n + column;
+			_angular_frequencies[index] = std::sqrt(gravity * glm::length(k));
+
+			// The Nyquist frequencies are their own opposites, so their
+			// derivatives could not be real: leave them out.
+			if (row == n / 2u || column == n / 2u)
+				continue;
+			_amplitudes[index] = xi * std::sqrt(0.5f * spectral_density(_parameters, k) * dk * dk);
+		}
+	}
+
+	for (auto row = 0u; row < n; ++row)
+	{
+		for (auto column = 0u; column < n; ++column)
+		{
+			auto const mirrored = static_cast<size_t>((n - row) % n) * n + (n - column) % n;
+			auto const &amplitude = _amplitudes[mirrored];
+			_mirrored_amplitudes[static_cast<size_t>(row) * n + column] = glm::vec2(amplitude.x, -amplitude.y);
+		}
+	}
+}
+
+void ocean::fft_simulation::update(float time)
+{
+	auto const n = _parameters.resolution;
+	auto const dk = glm::two_pi<float>() / _parameters.patch_size;
+	auto const min_rows_per_thread = std::max<size_t>(min_samples_per_thread / n, 1u);
+
+	// Spectra of the eight real fields, packed by pairs as a + i b, since
+	// the inverse FFT of a real field's spectrum is real:
+	// (h, Dx), (Dz, ∂h/∂x), (∂h/∂z, ∂Dx/∂x), (∂Dz/∂z, ∂Dx/∂z).
+	bonobo::parallel_for(n, [&](size_t first, size_t last) {
+		for (auto row = first; row < last; ++row)
+		{
+			for (auto column = 0u; column < n; ++column)
+			{
+				auto const index = row * n + column;
+				auto const k = dk * glm::vec2(signed_frequency(column, n), signed_frequency(static_cast<unsigned int>(row), n));
+				auto const k_length = glm::length(k);
+				auto const k_normalised = k_length > 0.0f ? k / k_length : glm::vec2(0.0f);
+
+				auto const phase = _angular_frequencies[index] * time;
+				auto const c = std::cos(phase), s = std::sin(phase);
+				auto const &a = _amplitudes[index];
+				auto const &b = _mirrored_amplitudes[index];
+				auto const h = glm::vec2(a.x * c - a.y * s + b.x * c + b.y * s,
+				                         a.x * s + a.y * c + b.y * c - b.x * s);
+
+				auto const dx = -times_i(h) * k_normalised.x;
+				auto const dz = -times_i(h) * k_normalised.y;
+				auto const slope_x = times_i(h) * k.x;
+				auto const slope_z = times_i(h) * k.y;
+				auto const dx_dx = h * (k.x * k_normalised.x);
+				auto const dz_dz = h * (k.y * k_normalised.y);
+				auto const dx_dz = h * (k.x * k_normalised.y);
+
+				glm::vec2 const packed[4] = {h + times_i(dx), dz + times_i(slope_x),
+				                             slope_z + times_i(dx_dx), dz_dz + times_i(dx_dz)};
+				for (auto i = 0u; i < 4u; ++i)
+				{
+					_real[i][index] = packed[i].x;
+					_imaginary[i][index] = packed[i].y;
+				}
+			}
+		}
+	}, min_rows_per_thread);
+
+	for (auto i = 0u; i < 4u; ++i)
+		_fft.transform(_real[i].data(), _imaginary[i].data(), bonobo::fft_direction::inverse);
+
+	auto const lambda = _parameters.choppiness;
+	auto const foam_threshold = std::max(_parameters.foam_threshold, 1.0e-3f);
+	bonobo::parallel_for(static_cast<size_t>(n) * n, [&](size_t first, size_t last) {
+		for (auto index = first; index < last; ++index)
+		{
+			auto const height = _real[0][index], dx = _imaginary[0][index];
+			auto const dz = _real[1][index], slope_x = _imaginary[1][index];
+			auto const slope_z = _real[2][index], dx_dx = _imaginary[2][index];
+			auto const dz_dz = _real[3][index], dx_dz = _imaginary[3][index];
+
+			_displacements[index] = glm::vec4(lambda * dx, height, lambda * dz, 0.0f);
+
+			auto const jacobian = (1.0f + lambda * dx_dx) * (1.0f + lambda * dz_dz) - lambda * lambda * dx_dz * dx_dz;
+			auto const foam = glm::clamp((foam_threshold - jacobian) / foam_threshold, 0.0f, 1.0f);
+			_normals_and_foam[index] = glm::vec4(glm::normalize(glm::vec3(-slope_x, 1.0f, -slope_z)), foam);
+		}
+	}, min_samples_per_thread);
+}
+
+void ocean::fft_simulation::upload()
+{
+	auto const n = static_cast<GLsizei>(_parameters.resolution);
+	if (_textures_resolution != _parameters.resolution)
+	{
+		release_textures();
+		for (auto texture : {&_displacement_texture, &_normal_foam_texture})
+		{
+			glGenTextures(1, texture);
+			glBindTexture(GL_TEXTURE_2D, *texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, n, n, 0, GL_RGBA, GL_FLOAT, nullptr);
+		}
+		_textures_resolution = _parameters.resolution;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, _displacement_texture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, n, n, GL_RGBA, GL_FLOAT, _displacements.data());
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, _normal_foam_texture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, n, n, GL_RGBA, GL_FLOAT, _normals_and_foam.data());
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0u);
+}
+
+void ocean::fft_simulation::release_textures()
+{
+	if (_textures_resolution == 0u)
+		return;
+	glDeleteTextures(1, &_displacement_texture);
+	glDeleteTextures(1, &_normal_foam_texture);
+	_displacement_texture = 0u;
+	_normal_foam_texture = 0u;
+	_textures_resolution = 0u;
+}
+
+void ocean::benchmarkFFT()
+{
+	bonobo::set_worker_threads_nb(0u);
+	auto const hardware_threads_nb = bonobo::get_worker_threads_nb();
+
+	LogInfo("Simulating FFT oceans on up to %u threads", static_cast<unsigned int>(hardware_threads_nb));
+	for (auto resolution = 128u; resolution <= 1024u; resolution *= 2u)
+	{
+		fft_parameters parameters;
+		parameters.resolution = resolution;
+		fft_simulation simulation(parameters);
+
+		// Enough updates to time about as many samples for each size.
+		auto const updates_nb = std::max(1048576u * 8u / (resolution * resolution), 4u);
+		double single_thread_duration = 0.0;
+		for (size_t threads_nb = 1u; ; threads_nb = std::min(2u * threads_nb, hardware_threads_nb))
+		{
+			bonobo::set_worker_threads_nb(threads_nb);
+			simulation.update(0.0f);
+
+			auto const start = GetTimeMilliseconds();
+			for (auto i = 0u; i < updates_nb; ++i)
+				simulation.update(0.1f * static_cast<float>(i));
+			auto const duration = (GetTimeMilliseconds() - start) / updates_nb;
+			if (threads_nb == 1u)
+				single_thread_duration = duration;
+
+			LogInfo("%4ux%-4u on %2u threads: %7.2f ms per update, %.2fx", resolution, resolution,
+			        static_cast<unsigned int>(threads_nb), duration, single_thread_duration / duration);
+			if (threads_nb == hardware_threads_nb)
+				break;
+		}
+	}
+	bonobo::set_worker_threads_nb(0u);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/fft.hpp"
+#include "external/glad/glad.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace ocean
+{
+	//! \brief Spectra describing how the energy of the waves is spread
+	//!        over wavelengths and directions.
+	enum class spectrum
+	{
+		phillips, //!< fully developed sea, as used by Tessendorf
+		jonswap   //!< sea whose growth is limited by the fetch
+	};
+
+	//! \brief Parameters of an `fft_simulation`.
+	struct fft_parameters
+	{
+		unsigned int resolution = 256u;                   //!< samples along each side of the patch, a power of two
+		float patch_size = 100.0f;                        //!< side of the patch, in metres
+		glm::vec2 wind_velocity = glm::vec2(10.0f, 0.0f); //!< wind along x and z, in m/s
+		spectrum spectrum_kind = spectrum::jonswap;
+		float phillips_constant = 0.0081f;                //!< α of the Phillips spectrum
+		float fetch = 100000.0f;                          //!< distance the wind has blown over, in metres, for JONSWAP
+		float peak_enhancement = 3.3f;                    //!< γ of JONSWAP
+		float small_wave_cutoff = 0.05f;                  //!< waves much shorter than this, in metres, are damped
+		float choppiness = 1.0f;                          //!< scale of the horizontal displacement, λ
+		float foam_threshold = 0.5f;                      //!< Jacobian below which foam starts to appear
+		unsigned int seed = 1u;
+	};
+
+	//! \brief Ocean heightfield simulated as in Tessendorf's "Simulating
+	//!        Ocean Water".
+	//!
+	//! Random amplitudes drawn from the spectrum are advanced in time with
+	//! the deep-water dispersion relation, then inverse FFTs turn them
+	//! into a patch of `resolution` x `resolution` samples which tiles
+	//! seamlessly. Each `update()` produces:
+	//! * displacements (λ·Dx, h, λ·Dz, 0), in metres;
+	//! * normals and foam (nx, ny, nz, foam), foam going from 0 to 1 as
+	//!   the Jacobian of the horizontal displacement drops from
+	//!   `foam_threshold` to 0, i.e. where the surface folds onto itself.
+	//!
+	//! The simulation runs on the CPU across `bonobo::parallel_for()`
+	//! threads and needs no OpenGL context; only `upload()` does.
+	class fft_simulation
+	{
+	public:
+		explicit fft_simulation(fft_parameters const &parameters);
+		~fft_simulation();
+		fft_simulation(fft_simulation const &) = delete;
+		fft_simulation &operator=(fft_simulation const &) = delete;
+
+		//! \brief Draw a new set of waves from `parameters`.
+		void set_parameters(fft_parameters const &parameters);
+		fft_parameters const &get_parameters() const { return _parameters; }
+
+		//! \brief Compute the displacements, normals and foam at `time`.
+		//!
+		//! @param [in] time in seconds
+		void update(float time);
+
+		//! \brief Copy the results of the last `update()` to the
+		//!        displacement and normal-foam textures, creating them on
+		//!        the first call.
+		void upload();
+
+		std::vector<glm::vec4> const &get_displacements() const { return _displacements; }
+		std::vector<glm::vec4> const &get_normals_and_foam() const { return _normals_and_foam; }
+
+		//! \brief RGBA16F texture of the displacements, wrapping with
+		//!        GL_REPEAT; 0 until `upload()` is called.
+		GLuint get_displacement_texture() const { return _displacement_texture; }
+		//! \brief RGBA16F texture of the normals and foam, wrapping with
+		//!        GL_REPEAT; 0 until `upload()` is called.
+		GLuint get_normal_foam_texture() const { return _normal_foam_texture; }
+
+	private:
+		void generate_spectrum();
+		void release_textures();
+
+		fft_parameters _parameters;
+		bonobo::fft_2d _fft;
+
+		// Initial amplitudes h0(k), and conj(h0(-k)), with k ordered as
+		// the FFT expects it: index i along an axis has frequency i for
+		// i < N / 2, and i - N otherwise.
+		std::vector<glm::vec2> _amplitudes;
+		std::vector<glm::vec2> _mirrored_amplitudes;
+		std::vector<float> _angular_frequencies;
+
+		// Four complex grids, each holding two real fields at once.
+		std::vector<float> _real[4];
+		std::vector<float> _imaginary[4];
+
+		std::vector<glm::vec4> _displacements;
+		std::vector<glm::vec4> _normals_and_foam;
+
+		GLuint _displacement_texture;
+		GLuint _normal_foam_texture;
+		unsigned int _textures_resolution;
+	};
+
+	//! \brief Time `fft_simulation::update()` for patches of 128² to 1024²
+	//!        samples, using from 1 to all hardware threads, and log the
+	//!        results.
+	void benchmarkFFT();
+}
@@ -1,14 +1,392 @@
 #include "parametric_shapes_modified.hpp"
 #include "core/Log.h"
+#include "core/Misc.h"
+#include "core/cpu_dispatch.hpp"
+#include "core/parallel.hpp"
+#include "core/simd.hpp"
+#include "core/vertex_format.hpp"
 
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <functional>
 #include <iostream>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PARAMETRIC_SHAPES_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+constexpr size_t lanes_nb = 4u;
+
+//! \brief `lanes_nb` floats, one per vertex of a `vertex_block`.
+using floatx = bonobo::simd::floatx<lanes_nb>;
+using vec3x = bonobo::simd::vec3xn<lanes_nb>;
+
+//! \brief Offset of each lane from the first column of its block.
+alignas(16) float const lane_offsets[lanes_nb] = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+//! \brief Minimum number of vertices generated by each thread; smaller
+//!        shapes are not worth spawning threads for.
+constexpr size_t min_vertices_per_thread = 16384u;
+
+//! \brief Attributes of `lanes_nb` consecutive vertices of the standard
+//!        vertex format, one array per component, so that generators
+//!        compute all lanes at once.
+struct vertex_block
+{
+	enum component : size_t
+	{
+		position_x = 0u, position_y, position_z,
+		normal_x, normal_y, normal_z,
+		texcoord_x, texcoord_y, texcoord_z,
+		tangent_x, tangent_y, tangent_z,
+		binormal_x, binormal_y, binormal_z,
+		components_nb
+	};
+
+	alignas(16) float values[components_nb][lanes_nb];
+
+	void set(component c, floatx const &value) { value.store(values[c]); }
+	void set(component c, float value) { floatx(value).store(values[c]); }
+	void set(component x, component y, component z, vec3x const &value)
+	{
+		set(x, value.x);
+		set(y, value.y);
+		set(z, value.z);
+	}
+};
+
+//! \brief Columns of the lanes of the block starting at `column`.
+floatx get_block_columns(unsigned int column)
+{
+	return floatx(static_cast<float>(column)) + floatx::load(lane_offsets);
+}
+
+static_assert(bonobo::standard_vertex_format::stride() == vertex_block::components_nb * sizeof(float),
+			  "vertex_block has to match the layout of standard_vertex_format.");
+
+//! \brief Write the first `count` vertices of `block` to `vertices`,
+//!        starting at vertex `first_vertex`.
+void store_block(bonobo::vertex_data<bonobo::standard_vertex_format> &vertices, size_t first_vertex,
+				 vertex_block const &block, size_t count)
+{
+	auto const &v = block.values;
+	if (vertices.get_storage() != bonobo::vertex_storage::interleaved)
+	{
+		for (size_t lane = 0u; lane < count; ++lane)
+		{
+			auto const vertex = first_vertex + lane;
+			vertices.set<bonobo::shader_bindings::vertices>(vertex, glm::vec3(v[0][lane], v[1][lane], v[2][lane]));
+			vertices.set<bonobo::shader_bindings::normals>(vertex, glm::vec3(v[3][lane], v[4][lane], v[5][lane]));
+			vertices.set<bonobo::shader_bindings::texcoords>(vertex, glm::vec3(v[6][lane], v[7][lane], v[8][lane]));
+			vertices.set<bonobo::shader_bindings::tangents>(vertex, glm::vec3(v[9][lane], v[10][lane], v[11][lane]));
+			vertices.set<bonobo::shader_bindings::binormals>(vertex, glm::vec3(v[12][lane], v[13][lane], v[14][lane]));
+		}
+		return;
+	}
+
+	auto *const destination = static_cast<float *>(vertices.data()) + first_vertex * vertex_block::components_nb;
+#if defined(PARAMETRIC_SHAPES_USE_SSE)
+	if (count == lanes_nb)
+	{
+		// Transpose the block four components at a time: afterwards,
+		// rows[4 * k + lane] holds components [4 * k, 4 * k + 4) of
+		// vertex `lane`, the very last component being padding.
+		__m128 rows[16];
+		for (size_t c = 0u; c < vertex_block::components_nb; ++c)
+			rows[c] = _mm_load_ps(v[c]);
+		rows[15] = _mm_setzero_ps();
+		for (size_t k = 0u; k < 16u; k += 4u)
+			_MM_TRANSPOSE4_PS(rows[k], rows[k + 1u], rows[k + 2u], rows[k + 3u]);
+		for (size_t lane = 0u; lane < lanes_nb; ++lane)
+		{
+			auto *const vertex = destination + lane * vertex_block::components_nb;
+			_mm_storeu_ps(vertex + 0u, rows[lane]);
+			_mm_storeu_ps(vertex + 4u, rows[4u + lane]);
+			_mm_storeu_ps(vertex + 8u, rows[8u + lane]);
+			_mm_storel_pi(reinterpret_cast<__m64 *>(vertex + 12u), rows[12u + lane]);
+			_mm_store_ss(vertex + 14u, _mm_movehl_ps(rows[12u + lane], rows[12u + lane]));
+		}
+		return;
+	}
+#endif
+	for (size_t lane = 0u; lane < count; ++lane)
+		for (size_t c = 0u; c < vertex_block::components_nb; ++c)
+			destination[lane * vertex_block::components_nb + c] = v[c][lane];
+}
+
+//! \brief Generate the vertices of a grid of `rows_nb` by `columns_nb`
+//!        vertices, rows being split across threads.
+//!
+//! @param [out] vertices where to write the vertices, row after row
+//! @param [in] kernel function filling a `vertex_block` given the row
+//!             and the first column of the block; it can compute lanes
+//!             past the end of the row, which are then discarded
+template <typename Kernel>
+void generate_grid(bonobo::vertex_data<bonobo::standard_vertex_format> &vertices,
+				   unsigned int rows_nb, unsigned int columns_nb, Kernel const &kernel)
+{
+	auto const min_rows_per_thread = std::max<size_t>(min_vertices_per_thread / std::max(columns_nb, 1u), 1u);
+	bonobo::parallel_for(rows_nb, [&](size_t first_row, size_t last_row) {
+		vertex_block block;
+		for (auto row = static_cast<unsigned int>(first_row); row < last_row; ++row)
+		{
+			for (unsigned int column = 0u; column < columns_nb; column += lanes_nb)
+			{
+				kernel(block, row, column);
+				store_block(vertices, static_cast<size_t>(row) * columns_nb + column, block,
+							std::min<size_t>(lanes_nb, columns_nb - column));
+			}
+		}
+	},
+						 min_rows_per_thread);
+}
+
+//! \brief Triangulate a grid of `rows_nb` by `columns_nb` vertices,
+//!        stored row after row, rows being split across threads.
+std::vector<GLuint> triangulate_grid(unsigned int rows_nb, unsigned int columns_nb)
+{
+	if (rows_nb < 2u || columns_nb < 2u)
+		return std::vector<GLuint>();
+
+	auto indices = std::vector<GLuint>(6u * (rows_nb - 1u) * (columns_nb - 1u));
+	auto const min_rows_per_thread = std::max<size_t>(min_vertices_per_thread / columns_nb, 1u);
+	// Lower triangle of each quad, then the upper one.
+	GLuint const quad[6] = { 0u, columns_nb, columns_nb + 1u, 1u, 0u, columns_nb + 1u };
+	auto const& kernels = bonobo::get_cpu_kernels();
+	bonobo::parallel_for(rows_nb - 1u, [&](size_t first_row, size_t last_row) {
+		kernels.grid_indices(indices.data() + 6u * first_row * (columns_nb - 1u), columns_nb,
+		                     static_cast<uint32_t>(first_row), static_cast<uint32_t>(last_row), quad);
+	},
+						 min_rows_per_thread);
+	return indices;
+}
+
+//! \brief Sines and cosines of `steps_nb` angles spaced by `step`,
+//!        starting at 0; padded with zeros up to a multiple of `lanes_nb`
+//!        so that kernels can read whole blocks.
+struct sincos_table
+{
+	std::vector<float> sin;
+	std::vector<float> cos;
+
+	sincos_table(unsigned int steps_nb, float step) : sin(steps_nb + lanes_nb, 0.0f), cos(steps_nb + lanes_nb, 0.0f)
+	{
+		for (unsigned int i = 0u; i < steps_nb; ++i)
+		{
+			auto const angle = step * static_cast<float>(i);
+			sin[i] = std::sin(angle);
+			cos[i] = std::cos(angle);
+		}
+	}
+};
+
+//! \brief Evenly spaced values from 0 to 1, padded like `sincos_table`;
+//!        a single step is at 0.
+std::vector<float> ramp_table(unsigned int steps_nb)
+{
+	auto ramp = std::vector<float>(steps_nb + lanes_nb, 0.0f);
+	if (steps_nb < 2u)
+		return ramp;
+	for (unsigned int i = 0u; i < steps_nb; ++i)
+		ramp[i] = static_cast<float>(i) / static_cast<float>(steps_nb - 1u);
+	return ramp;
+}
+
+//! \brief Spacing of `steps_nb` evenly spaced values spanning `range`;
+//!        0 if there are less than two of them.
+float step_size(float range, unsigned int steps_nb)
+{
+	return steps_nb > 1u ? range / static_cast<float>(steps_nb - 1u) : 0.0f;
+}
+
+//! \brief Indices of the vertices subdividing the edges of a base
+//!        polyhedron, so that the patches sharing an edge also share its
+//!        vertices; the corners of the polyhedron are expected to be
+//!        vertices [0, corners_nb).
+class edge_vertices
+{
+public:
+	edge_vertices(size_t corners_nb, unsigned int steps_nb)
+		: _corners_nb(corners_nb), _steps_nb(steps_nb),
+		  _indices(corners_nb * corners_nb * (steps_nb + 1u), invalid_index)
+	{
+	}
+
+	//! \brief Index of the vertex `step` steps away from corner `from`
+	//!        towards corner `to`, calling `create()` to generate it the
+	//!        first time it is asked for.
+	template <typename Create>
+	GLuint get(GLuint from, GLuint to, unsigned int step, Create const &create)
+	{
+		if (step == 0u)
+			return from;
+		if (step == _steps_nb)
+			return to;
+		if (from > to)
+		{
+			std::swap(from, to);
+			step = _steps_nb - step;
+		}
+		auto &index = _indices[(from * _corners_nb + to) * (_steps_nb + 1u) + step];
+		if (index == invalid_index)
+			index = create();
+		return index;
+	}
+
+private:
+	static constexpr GLuint invalid_index = ~0u;
+
+	size_t _corners_nb;
+	unsigned int _steps_nb;
+	std::vector<GLuint> _indices;
+};
+
+//! \brief Turn unit directions into the vertices of a sphere, mapped like
+//!        `createSphere()`: u follows the longitude, from +z towards +x,
+//!        and v the latitude, from -y to +y.
+//!
+//! Vertices are shared wherever the texture coordinates allow it:
+//! triangles crossing the u = 0 seam get copies of their vertices with u
+//! offset by 1, and those touching a pole get their own copy of it, with
+//! the average u of their other vertices.
+//!
+//! @param [in] directions unit directions of the shared vertices
+//! @param [in,out] indices triangle list over `directions`, updated to
+//!                 refer to the returned vertices
+bonobo::mesh_cpu build_sphere_mesh(std::vector<glm::vec3> const &directions, std::vector<GLuint> &&indices,
+								   float radius, bonobo::mesh_options const &options, char const *name)
+{
+	constexpr float pole_epsilon = 1.0e-6f;
+
+	struct sphere_vertex
+	{
+		glm::vec3 direction;
+		glm::vec2 texcoord;
+		bool is_pole;
+	};
+	auto sphere_vertices = std::vector<sphere_vertex>();
+	sphere_vertices.reserve(directions.size() + directions.size() / 16u);
+	for (auto const &d : directions)
+	{
+		auto const is_pole = d.x * d.x + d.z * d.z < pole_epsilon * pole_epsilon;
+		auto u = is_pole ? 0.0f : std::atan2(d.x, d.z) * glm::one_over_two_pi<float>();
+		if (u < 0.0f)
+			u += 1.0f;
+		auto const v = std::acos(glm::clamp(-d.y, -1.0f, 1.0f)) * glm::one_over_pi<float>();
+		sphere_vertices.push_back({ d, glm::vec2(u, v), is_pole });
+	}
+
+	auto wrapped = std::vector<GLuint>(directions.size(), ~0u);
+	for (size_t t = 0u; t + 2u < indices.size(); t += 3u)
+	{
+		GLuint *const triangle = indices.data() + t;
+
+		float u_min = 1.0f, u_max = 0.0f;
+		unsigned int poles_nb = 0u;
+		for (size_t k = 0u; k < 3u; ++k)
+		{
+			auto const &vertex = sphere_vertices[triangle[k]];
+			if (vertex.is_pole)
+			{
+				++poles_nb;
+				continue;
+			}
+			u_min = std::min(u_min, vertex.texcoord.x);
+			u_max = std::max(u_max, vertex.texcoord.x);
+		}
+
+		if (u_max - u_min > 0.5f)
+		{
+			for (size_t k = 0u; k < 3u; ++k)
+			{
+				auto &index = triangle[k];
+				if (sphere_vertices[index].is_pole || sphere_vertices[index].texcoord.x >= 0.5f)
+					continue;
+				if (wrapped[index] == ~0u)
+				{
+					wrapped[index] = static_cast<GLuint>(sphere_vertices.size());
+					auto copy = sphere_vertices[index];
+					copy.texcoord.x += 1.0f;
+					sphere_vertices.push_back(copy);
+				}
+				index = wrapped[index];
+			}
+		}
+
+		if (poles_nb == 0u || poles_nb == 3u)
+			continue;
+		float u_sum = 0.0f;
+		for (size_t k = 0u; k < 3u; ++k)
+			if (!sphere_vertices[triangle[k]].is_pole)
+				u_sum += sphere_vertices[triangle[k]].texcoord.x;
+		for (size_t k = 0u; k < 3u; ++k)
+		{
+			if (!sphere_vertices[triangle[k]].is_pole)
+				continue;
+			auto copy = sphere_vertices[triangle[k]];
+			copy.texcoord.x = u_sum / static_cast<float>(3u - poles_nb);
+			triangle[k] = static_cast<GLuint>(sphere_vertices.size());
+			sphere_vertices.push_back(copy);
+		}
+	}
+
+	auto mesh = bonobo::mesh_cpu(sphere_vertices.size(), options.storage);
+	for (size_t i = 0u; i < sphere_vertices.size(); ++i)
+	{
+		auto const &normal = sphere_vertices[i].direction;
+		auto const &texcoord = sphere_vertices[i].texcoord;
+		auto const theta = texcoord.x * glm::two_pi<float>();
+		auto const tangent = glm::vec3(std::cos(theta), 0.0f, -std::sin(theta));
+		mesh.vertices.set<bonobo::shader_bindings::vertices>(i, radius * normal);
+		mesh.vertices.set<bonobo::shader_bindings::normals>(i, normal);
+		mesh.vertices.set<bonobo::shader_bindings::texcoords>(i, glm::vec3(texcoord, 0.0f));
+		mesh.vertices.set<bonobo::shader_bindings::tangents>(i, tangent);
+		mesh.vertices.set<bonobo::shader_bindings::binormals>(i, glm::cross(normal, tangent));
+	}
+	mesh.indices = std::move(indices);
+	bonobo::prepare_mesh(mesh, options, name);
+	return mesh;
+}
+
+//! \brief Upper bound of the distance between a tessellated sphere of
+//!        radius `radius`, centred at the origin, and the sphere itself.
+//!
+//! The distance from each triangle to the sphere is bounded by that of
+//! its supporting plane; degenerate triangles, like those at the poles
+//! of `createSphere()`, are ignored, and a mesh made only of those is as
+//! far as the radius.
+float sphere_tessellation_error(bonobo::mesh_cpu const &mesh, float radius)
+{
+	auto const indices_nb = mesh.lods.empty() ? mesh.indices.size() : mesh.lods.front().indices_nb;
+	auto error = 0.0f;
+	auto has_triangles = false;
+	for (size_t t = 0u; t + 2u < indices_nb; t += 3u)
+	{
+		auto const p0 = mesh.vertices.get<bonobo::shader_bindings::vertices>(mesh.indices[t]),
+				   p1 = mesh.vertices.get<bonobo::shader_bindings::vertices>(mesh.indices[t + 1u]),
+				   p2 = mesh.vertices.get<bonobo::shader_bindings::vertices>(mesh.indices[t + 2u]);
+		auto const normal = glm::cross(p1 - p0, p2 - p0);
+		auto const length = glm::length(normal);
+		auto const longest_edge = std::max({glm::length(p1 - p0), glm::length(p2 - p1), glm::length(p0 - p2)});
+		if (length <= 1.0e-4f * longest_edge * longest_edge)
+			continue;
+		error = std::max(error, radius - std::abs(glm::dot(normal, p0)) / length);
+		has_triangles = true;
+	}
+	return has_triangles ? error : radius;
+}
+} // namespace
+
 bonobo::mesh_data
 parametric_shapes::createQuad(unsigned int width, unsigned int height)
 {
@@ -116,725 +494,565 @@ parametric_shapes::createQuad(unsigned int width, unsigned int height)
 	return data;
 }
 
-bonobo::mesh_data
-parametric_shapes::createZoneplate(unsigned int width, unsigned int height, float wave_count, float zplate_depth)
+bonobo::mesh_cpu
+parametric_shapes::buildZoneplate(unsigned int width, unsigned int height, float wave_count, float zplate_depth,
+								  bonobo::mesh_options const& options)
 {
 	//LogInfo("Creating zoneplate! res_theta:%d, res_phi:%d",width,height);
 	auto const vertices_nb = width * height;
-	size_t index = 0u;
 
 	// x = x
 	// y = y
 	// z = sin(sqrt(x^2+y^2))
-	auto vertices = std::vector<glm::vec3>(vertices_nb);
-	auto normals = std::vector<glm::vec3>(vertices_nb);
+	auto mesh = bonobo::mesh_cpu(vertices_nb, options.storage);
+	auto &vertices = mesh.vertices;
 	// texcoord.x = x
 	// texcoord.y = y
-	auto texcoords = std::vector<glm::vec3>(vertices_nb);
 	// tangent.x = 1
 	// tangent.y = 0
 	// tangent.z = cos(sqrt(x^2+y^2))*0.5f/sqrt(x^2+y^2)*2.0f*x
-	auto tangents = std::vector<glm::vec3>(vertices_nb);
 	// binormal.x = 0
 	// binormal.y = 1
 	// binormal.z = cos(sqrt(x^2+y^2))*0.5f/sqrt(x^2+y^2)*2.0f*y
-	auto binormals = std::vector<glm::vec3>(vertices_nb);
 
 	const float dwidth = 2.0f / static_cast<float>(width),
 				dheight = 2.0f / static_cast<float>(height),
 				wave_mul = wave_count * glm::two_pi<float>();
+	auto const u = ramp_table(width),
+			   v = ramp_table(height);
 
-	for (unsigned int i = 0u; i < width; ++i)
-	{
+	generate_grid(vertices, width, height, [&](vertex_block &block, unsigned int i, unsigned int j) {
 		const float x = std::fmaf(dwidth, static_cast<float>(i), -1.0f);
-
-		for (unsigned int j = 0u; j < height; ++j)
-		{
-			const float y = std::fmaf(dheight, static_cast<float>(j), -1.0f),
-						l = std::hypotf(x, y);
-			texcoords[index] = glm::vec3(static_cast<float>(i) / static_cast<float>(width - 1),
-										 static_cast<float>(j) / static_cast<float>(height - 1), 0.0f);
-			vertices[index] = glm::vec3(x, y, zplate_depth * sin(wave_mul * l));
-
-			if (l == 0.0f)
-			{
-				tangents[index] = glm::vec3(1.0f, 0.0f, 0.0f);
-				binormals[index] = glm::vec3(0.0f, 1.0f, 0.0f);
-				normals[index] = glm::vec3(0.0f, 0.0f, 1.0f);
-			}
-			else
-			{
-				tangents[index] = glm::normalize(glm::vec3(1.0f, 0.0f,
-														   zplate_depth * cos(wave_mul * l) * wave_mul * x / l));
-				binormals[index] = glm::normalize(glm::vec3(0.0f, 1.0f,
-															zplate_depth * cos(wave_mul * l) * wave_mul * y / l));
-				normals[index] = glm::normalize(glm::cross(tangents[index], binormals[index]));
-			}
-			++index;
-		}
-	}
-
-	if (index != vertices_nb)
-	{
-		LogError("Failed to generate indices for zoneplate! %d expected, %d generated", vertices_nb, index);
-	}
-
-	const size_t expected_indices = 2 * (width - 1u) * (height - 1u);
-	auto indices = std::vector<glm::uvec3>(expected_indices);
-	index = 0u;
-	for (unsigned int i = 0u; i < width - 1u; ++i)
-	{
-		for (unsigned int j = 0u; j < height - 1u; ++j)
-		{
-			//Quad lower
-			indices[index++] = glm::uvec3(height * i + j, height * (i + 1u) + j, height * (i + 1u) + j + 1u);
-			//Quad upper
-			indices[index++] = glm::uvec3(height * i + j + 1u, height * i + j, height * (i + 1u) + j + 1u);
-		}
-	}
-
-	if (index != expected_indices)
-	{
-		LogError("Failed to generate indices for zoneplate! %d expected, %d generated", expected_indices, index);
-		if (expected_indices > index)
-		{
-			indices.resize(index);
-		}
-	}
-
-	bonobo::mesh_data data;
-	glGenVertexArrays(1, &data.vao);
-	assert(data.vao != 0);
-	glBindVertexArray(data.vao);
-
-	auto const vertices_offset = 0u;
-	auto const vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-	auto const normals_offset = vertices_size;
-	auto const normals_size = static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-	auto const texcoords_offset = normals_offset + normals_size;
-	auto const texcoords_size = static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-	auto const tangents_offset = texcoords_offset + texcoords_size;
-	auto const tangents_size = static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-	auto const binormals_offset = tangents_offset + tangents_size;
-	auto const binormals_size = static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-	auto const bo_size = static_cast<GLsizeiptr>(
-		vertices_size +
-		normals_size +
-		texcoords_size +
-		tangents_size +
-		binormals_size);
-
-	glGenBuffers(1, &data.bo);
-	assert(data.bo != 0u);
-	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-	glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-	glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const *>(vertices.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-	glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const *>(normals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const *>(texcoords.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const *>(tangents.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const *>(binormals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(binormals_offset));
-
-	//Buffer filled finally! Go ahead and unbind.
-	glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-	data.indices_nb = indices.size() * 3u;
-	glGenBuffers(1, &data.ibo);
-	assert(data.ibo != 0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(glm::uvec3)),
-				 reinterpret_cast<GLvoid const *>(indices.data()), GL_STATIC_DRAW);
-
-	glBindVertexArray(0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-	return data;
+		auto const y = dheight * get_block_columns(j) - 1.0f,
+				   l = bonobo::simd::sqrt(x * x + y * y);
+		floatx sin_wave, cos_wave;
+		bonobo::simd::sincos(wave_mul * l, sin_wave, cos_wave);
+
+		// d(z)/d(l) / l, the surface being flat at its centre.
+		auto const is_centre = l == 0.0f;
+		auto const slope = bonobo::simd::select(is_centre, floatx(0.0f),
+												zplate_depth * cos_wave * wave_mul / bonobo::simd::select(is_centre, floatx(1.0f), l));
+		auto const tangent = bonobo::simd::normalize(vec3x{floatx(1.0f), floatx(0.0f), slope * x}),
+				   binormal = bonobo::simd::normalize(vec3x{floatx(0.0f), floatx(1.0f), slope * y}),
+				   normal = bonobo::simd::normalize(bonobo::simd::cross(tangent, binormal));
+
+		block.set(vertex_block::position_x, x);
+		block.set(vertex_block::position_y, y);
+		block.set(vertex_block::position_z, zplate_depth * sin_wave);
+		block.set(vertex_block::normal_x, vertex_block::normal_y, vertex_block::normal_z, normal);
+		block.set(vertex_block::texcoord_x, u[i]);
+		block.set(vertex_block::texcoord_y, floatx::load(v.data() + j));
+		block.set(vertex_block::texcoord_z, 0.0f);
+		block.set(vertex_block::tangent_x, vertex_block::tangent_y, vertex_block::tangent_z, tangent);
+		block.set(vertex_block::binormal_x, vertex_block::binormal_y, vertex_block::binormal_z, binormal);
+	});
+
+	mesh.indices = triangulate_grid(width, height);
+	bonobo::prepare_mesh(mesh, options, "zoneplate");
+	return mesh;
 }
 
 bonobo::mesh_data
-parametric_shapes::createOceanplate(unsigned int width, unsigned int height, float sideLength)
+parametric_shapes::createZoneplate(unsigned int width, unsigned int height, float wave_count, float zplate_depth,
+								   bonobo::mesh_options const& options)
+{
+	return bonobo::upload_mesh(buildZoneplate(width, height, wave_count, zplate_depth, options), options.precision);
+}
+
+bonobo::mesh_cpu
+parametric_shapes::buildOceanplate(unsigned int width, unsigned int height, float sideLength,
+									bonobo::mesh_options const& options)
 {
 	//LogInfo("Creating oceanplate! res_theta:%d, res_phi:%d",width,height);
 	auto const vertices_nb = width * height;
-	size_t index = 0u;
 
 	// x = x
 	// y = 0
 	// z = -z
-	auto vertices = std::vector<glm::vec3>(vertices_nb);
+	auto mesh = bonobo::mesh_cpu(vertices_nb, options.storage);
+	auto &vertices = mesh.vertices;
 	// normal.x = 0
 	// normal.y = 1
 	// normal.z = 0
-	auto normals = std::vector<glm::vec3>(vertices_nb);
 	// texcoord.x = x
 	// texcoord.y = z
-	auto texcoords = std::vector<glm::vec3>(vertices_nb);
 	// tangent.x = 1
 	// tangent.y = 0
 	// tangent.z = 0
-	auto tangents = std::vector<glm::vec3>(vertices_nb);
 	// binormal.x = 0
 	// binormal.y = 0
 	// binormal.z = -1
-	auto binormals = std::vector<glm::vec3>(vertices_nb);
 
-	const float dwidth = sideLength / static_cast<float>(width - 1),
-				dheight = sideLength / static_cast<float>(height - 1),
+	const float dwidth = step_size(sideLength, width),
+				dheight = step_size(sideLength, height),
 				halfside = 0.5f * sideLength;
+	auto const u = ramp_table(width),
+			   v = ramp_table(height);
 
-	for (unsigned int i = 0u; i < width; ++i)
-	{
+	generate_grid(vertices, width, height, [&](vertex_block &block, unsigned int i, unsigned int j) {
 		const float x = std::fmaf(dwidth, static_cast<float>(i), -halfside);
+		auto const z = dheight * get_block_columns(j) - halfside;
+		block.set(vertex_block::position_x, x);
+		block.set(vertex_block::position_y, 0.0f);
+		block.set(vertex_block::position_z, -z);
+		block.set(vertex_block::normal_x, 0.0f);
+		block.set(vertex_block::normal_y, 1.0f);
+		block.set(vertex_block::normal_z, 0.0f);
+		block.set(vertex_block::texcoord_x, u[i]);
+		block.set(vertex_block::texcoord_y, floatx::load(v.data() + j));
+		block.set(vertex_block::texcoord_z, 0.0f);
+		block.set(vertex_block::tangent_x, 1.0f);
+		block.set(vertex_block::tangent_y, 0.0f);
+		block.set(vertex_block::tangent_z, 0.0f);
+		block.set(vertex_block::binormal_x, 0.0f);
+		block.set(vertex_block::binormal_y, 0.0f);
+		block.set(vertex_block::binormal_z, 1.0f);
+	});
+
+	mesh.indices = triangulate_grid(width, height);
+	bonobo::prepare_mesh(mesh, options, "oceanplate");
+	return mesh;
+}
 
-		for (unsigned int j = 0u; j < height; ++j)
-		{
-			const float z = std::fmaf(dheight, static_cast<float>(j), -halfside);
-			texcoords[index] = glm::vec3(static_cast<float>(i) / static_cast<float>(width - 1),
-										 static_cast<float>(j) / static_cast<float>(height - 1),
-										 0.0f);
-			vertices[index] = glm::vec3(x, 0.0f, -z);
+bonobo::mesh_data
+parametric_shapes::createOceanplate(unsigned int width, unsigned int height, float sideLength,
+									bonobo::mesh_options const& options)
+{
+	return bonobo::upload_mesh(buildOceanplate(width, height, sideLength, options), options.precision);
+}
 
-			tangents[index] = glm::vec3(1.0f, 0.0f, 0.0f);
-			binormals[index] = glm::vec3(0.0f, 0.0f, 1.0f);
-			normals[index] = glm::vec3(0.0f, 1.0f, 0.0f);
+bonobo::mesh_cpu
+parametric_shapes::buildSphere(unsigned int const res_theta,
+								unsigned int const res_phi, float const radius,
+								bonobo::mesh_options const& options)
+{
+	//LogInfo("Creating sphere! res_theta:%d, res_phi:%d",res_theta,res_phi);
+	auto const vertices_nb = res_theta * res_phi;
 
-			++index;
-		}
-	}
+	auto mesh = bonobo::mesh_cpu(vertices_nb, options.storage);
+	auto &vertices = mesh.vertices;
+
+	const float dtheta = step_size(glm::two_pi<float>(), res_theta),
+				dphi = step_size(glm::pi<float>(), res_phi);
+	auto const theta = sincos_table(res_theta, dtheta),
+			   phi = sincos_table(res_phi, dphi);
+	auto const u = ramp_table(res_theta),
+			   v = ramp_table(res_phi);
+
+	generate_grid(vertices, res_theta, res_phi, [&](vertex_block &block, unsigned int i, unsigned int j) {
+		const float sin_theta = theta.sin[i],
+					cos_theta = theta.cos[i];
+		auto const sin_phi = floatx::load(phi.sin.data() + j),
+				   cos_phi = floatx::load(phi.cos.data() + j);
+		auto const normal = vec3x{sin_theta * sin_phi, -cos_phi, cos_theta * sin_phi};
+		block.set(vertex_block::normal_x, vertex_block::normal_y, vertex_block::normal_z, normal);
+		block.set(vertex_block::position_x, vertex_block::position_y, vertex_block::position_z, floatx(radius) * normal);
+		block.set(vertex_block::texcoord_x, u[i]);
+		block.set(vertex_block::texcoord_y, floatx::load(v.data() + j));
+		block.set(vertex_block::texcoord_z, 0.0f);
+		block.set(vertex_block::tangent_x, cos_theta);
+		block.set(vertex_block::tangent_y, 0.0f);
+		block.set(vertex_block::tangent_z, sin_theta);
+		block.set(vertex_block::binormal_x, sin_theta * cos_phi);
+		block.set(vertex_block::binormal_y, sin_phi);
+		block.set(vertex_block::binormal_z, cos_theta * cos_phi);
+	});
+
+	mesh.indices = triangulate_grid(res_theta, res_phi);
+	bonobo::prepare_mesh(mesh, options, "sphere");
+	return mesh;
+}
 
-	if (index != vertices_nb)
-	{
-		LogError("Failed to generate vertices for oceanplate! %d expected, %d generated", vertices_nb, index);
-	}
+bonobo::mesh_data
+parametric_shapes::createSphere(unsigned int const res_theta,
+								unsigned int const res_phi, float const radius,
+								bonobo::mesh_options const& options)
+{
+	return bonobo::upload_mesh(buildSphere(res_theta, res_phi, radius, options), options.precision);
+}
 
-	const size_t expected_indices = 2 * (width - 1u) * (height - 1u);
-	auto indices = std::vector<glm::uvec3>(expected_indices);
-	index = 0u;
-	for (unsigned int i = 0u; i < width - 1u; ++i)
+bonobo::mesh_cpu
+parametric_shapes::buildIcosphere(unsigned int const subdivisions, float const radius,
+								  bonobo::mesh_options const& options)
+{
+	// Corners of an icosahedron, and its faces in counter-clockwise order
+	// when seen from outside.
+	float const t = 0.5f * (1.0f + std::sqrt(5.0f));
+	std::array<glm::vec3, 12> const corners = {{
+		glm::vec3(-1.0f, t, 0.0f), glm::vec3(1.0f, t, 0.0f), glm::vec3(-1.0f, -t, 0.0f), glm::vec3(1.0f, -t, 0.0f),
+		glm::vec3(0.0f, -1.0f, t), glm::vec3(0.0f, 1.0f, t), glm::vec3(0.0f, -1.0f, -t), glm::vec3(0.0f, 1.0f, -t),
+		glm::vec3(t, 0.0f, -1.0f), glm::vec3(t, 0.0f, 1.0f), glm::vec3(-t, 0.0f, -1.0f), glm::vec3(-t, 0.0f, 1.0f)
+	}};
+	static GLuint const faces[20][3] = {
+		{0u, 11u, 5u}, {0u, 5u, 1u}, {0u, 1u, 7u}, {0u, 7u, 10u}, {0u, 10u, 11u},
+		{1u, 5u, 9u}, {5u, 11u, 4u}, {11u, 10u, 2u}, {10u, 7u, 6u}, {7u, 1u, 8u},
+		{3u, 9u, 4u}, {3u, 4u, 2u}, {3u, 2u, 6u}, {3u, 6u, 8u}, {3u, 8u, 9u},
+		{4u, 9u, 5u}, {2u, 4u, 11u}, {6u, 2u, 10u}, {8u, 6u, 7u}, {9u, 8u, 1u}
+	};
+
+	// Each face is split into n^2 triangles, with n + 1 - j vertices on
+	// its j-th row.
+	auto const n = std::max(subdivisions, 1u);
+	auto directions = std::vector<glm::vec3>();
+	directions.reserve(10u * n * n + 2u);
+	for (auto const &corner : corners)
+		directions.push_back(glm::normalize(corner));
+	auto indices = std::vector<GLuint>();
+	indices.reserve(60u * n * n);
+
+	auto edges = edge_vertices(corners.size(), n);
+	auto face_vertices = std::vector<GLuint>((n + 1u) * (n + 2u) / 2u);
+	auto const row_start = [n](unsigned int j) { return j * (n + 1u) - j * (j - 1u) / 2u; };
+	for (auto const &face : faces)
 	{
-		for (unsigned int j = 0u; j < height - 1u; ++j)
+		auto const a = face[0], b = face[1], c = face[2];
+		auto const create = [&](unsigned int i, unsigned int j) {
+			return [&, i, j]() {
+				auto const point = corners[a] + (corners[b] - corners[a]) * (static_cast<float>(i) / static_cast<float>(n))
+											  + (corners[c] - corners[a]) * (static_cast<float>(j) / static_cast<float>(n));
+				directions.push_back(glm::normalize(point));
+				return static_cast<GLuint>(directions.size() - 1u);
+			};
+		};
+		for (unsigned int j = 0u; j <= n; ++j)
 		{
-			//Quad lower
-			indices[index++] = glm::uvec3(height * i + j, height * (i + 1u) + j, height * (i + 1u) + j + 1u);
-			//Quad upper
-			indices[index++] = glm::uvec3(height * i + j + 1u, height * i + j, height * (i + 1u) + j + 1u);
+			for (unsigned int i = 0u; i + j <= n; ++i)
+			{
+				auto &index = face_vertices[row_start(j) + i];
+				if (j == 0u)
+					index = edges.get(a, b, i, create(i, j));
+				else if (i == 0u)
+					index = edges.get(a, c, j, create(i, j));
+				else if (i + j == n)
+					index = edges.get(b, c, j, create(i, j));
+				else
+					index = create(i, j)();
+			}
 		}
-	}
-
-	if (index != expected_indices)
-	{
-		LogError("Failed to generate indices for oceanplate! %d expected, %d generated", expected_indices, index);
-		if (expected_indices > index)
+		for (unsigned int j = 0u; j < n; ++j)
 		{
-			indices.resize(index);
+			for (unsigned int i = 0u; i + j < n; ++i)
+			{
+				auto const v00 = face_vertices[row_start(j) + i],
+						   v10 = face_vertices[row_start(j) + i + 1u],
+						   v01 = face_vertices[row_start(j + 1u) + i];
+				indices.insert(indices.end(), {v00, v10, v01});
+				if (i + j + 1u < n)
+				{
+					auto const v11 = face_vertices[row_start(j + 1u) + i + 1u];
+					indices.insert(indices.end(), {v10, v11, v01});
+				}
+			}
 		}
 	}
 
-	bonobo::mesh_data data;
-	glGenVertexArrays(1, &data.vao);
-	assert(data.vao != 0);
-	glBindVertexArray(data.vao);
-
-	auto const vertices_offset = 0u;
-	auto const vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-	auto const normals_offset = vertices_size;
-	auto const normals_size = static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-	auto const texcoords_offset = normals_offset + normals_size;
-	auto const texcoords_size = static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-	auto const tangents_offset = texcoords_offset + texcoords_size;
-	auto const tangents_size = static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-	auto const binormals_offset = tangents_offset + tangents_size;
-	auto const binormals_size = static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-	auto const bo_size = static_cast<GLsizeiptr>(
-		vertices_size +
-		normals_size +
-		texcoords_size +
-		tangents_size +
-		binormals_size);
-
-	glGenBuffers(1, &data.bo);
-	assert(data.bo != 0u);
-	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-	glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-	glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const *>(vertices.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-	glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const *>(normals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const *>(texcoords.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const *>(tangents.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const *>(binormals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(binormals_offset));
-
-	//Buffer filled finally! Go ahead and unbind.
-	glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-	data.indices_nb = indices.size() * 3u;
-	glGenBuffers(1, &data.ibo);
-	assert(data.ibo != 0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(glm::uvec3)),
-				 reinterpret_cast<GLvoid const *>(indices.data()), GL_STATIC_DRAW);
-
-	glBindVertexArray(0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-	return data;
+	return build_sphere_mesh(directions, std::move(indices), radius, options, "icosphere");
 }
 
 bonobo::mesh_data
-parametric_shapes::createSphere(unsigned int const res_theta,
-								unsigned int const res_phi, float const radius)
+parametric_shapes::createIcosphere(unsigned int const subdivisions, float const radius,
+								   bonobo::mesh_options const& options)
 {
-	//LogInfo("Creating sphere! res_theta:%d, res_phi:%d",res_theta,res_phi);
-	auto const vertices_nb = res_theta * res_phi;
-	size_t index = 0u;
-
-	auto vertices = std::vector<glm::vec3>(vertices_nb);
-	auto normals = std::vector<glm::vec3>(vertices_nb);
-	auto texcoords = std::vector<glm::vec3>(vertices_nb);
-	auto tangents = std::vector<glm::vec3>(vertices_nb);
-	auto binormals = std::vector<glm::vec3>(vertices_nb);
-
-	const float dtheta = glm::two_pi<float>() / (static_cast<float>(res_theta - 1)),
-				dphi = glm::pi<float>() / (static_cast<float>(res_phi - 1));
-
-	for (unsigned int i = 0u; i < res_theta; ++i)
-	{
-		const float theta = dtheta * static_cast<float>(i);
-		const float sin_theta = std::sin(theta),
-					cos_theta = std::cos(theta);
-
-		for (unsigned int j = 0u; j < res_phi; ++j)
-		{
-			const float phi = dphi * static_cast<float>(j);
-			const float sin_phi = std::sin(phi),
-						cos_phi = std::cos(phi);
-			texcoords[index] = glm::vec3(static_cast<float>(i) / static_cast<float>(res_theta - 1),
-										 static_cast<float>(j) / static_cast<float>(res_phi - 1),
-										 0.0f);
-			tangents[index] = glm::vec3(cos_theta, 0.0f, sin_theta);
-			binormals[index] = (glm::vec3(sin_theta * cos_phi, sin_phi, cos_theta * cos_phi));
-			normals[index] = glm::normalize(glm::vec3(sin_theta * sin_phi, -cos_phi, cos_theta * sin_phi));
-			vertices[index] = radius * normals[index];
-			++index;
-		}
-	}
-
-	if (index != vertices_nb)
-	{
-		LogError("Failed to generate vertices for sphere! %d expected, %d generated", vertices_nb, index);
-	}
+	return bonobo::upload_mesh(buildIcosphere(subdivisions, radius, options), options.precision);
+}
 
-	const size_t expected_indices = 2 * (res_theta - 1u) * (res_phi - 1u);
-	auto indices = std::vector<glm::uvec3>(expected_indices);
-	index = 0u;
-	for (unsigned int i = 0u; i < res_theta - 1u; ++i)
+bonobo::mesh_cpu
+parametric_shapes::buildCubeSphere(unsigned int const subdivisions, float const radius,
+								   bonobo::mesh_options const& options)
+{
+	// Corner k of the cube has coordinates -1 or 1 according to bits 0,
+	// 1 and 2 of k; faces are given as (origin, along u, along v,
+	// opposite), counter-clockwise when seen from outside.
+	std::array<glm::vec3, 8> corners;
+	for (size_t k = 0u; k < corners.size(); ++k)
+		corners[k] = glm::vec3((k & 1u) ? 1.0f : -1.0f, (k & 2u) ? 1.0f : -1.0f, (k & 4u) ? 1.0f : -1.0f);
+	static GLuint const faces[6][4] = {
+		{5u, 1u, 7u, 3u}, {0u, 4u, 2u, 6u}, {6u, 7u, 2u, 3u},
+		{0u, 1u, 4u, 5u}, {4u, 5u, 6u, 7u}, {1u, 0u, 3u, 2u}
+	};
+
+	// Grid lines are spaced by equal angles rather than equal distances
+	// on the cube, which evens out the area of the triangles once
+	// projected on the sphere.
+	auto const n = std::max(subdivisions, 1u);
+	auto warp = std::vector<float>(n + 1u);
+	for (unsigned int k = 0u; k <= n; ++k)
+		warp[k] = 0.5f + 0.5f * std::tan(glm::quarter_pi<float>() * (2.0f * static_cast<float>(k) / static_cast<float>(n) - 1.0f));
+	warp.front() = 0.0f;
+	warp.back() = 1.0f;
+
+	auto directions = std::vector<glm::vec3>();
+	directions.reserve(6u * n * n + 2u);
+	for (auto const &corner : corners)
+		directions.push_back(glm::normalize(corner));
+	auto indices = std::vector<GLuint>();
+	indices.reserve(36u * n * n);
+
+	auto edges = edge_vertices(corners.size(), n);
+	auto face_vertices = std::vector<GLuint>((n + 1u) * (n + 1u));
+	for (auto const &face : faces)
 	{
-		for (unsigned int j = 0u; j < res_phi - 1u; ++j)
+		auto const c00 = face[0], c10 = face[1], c01 = face[2], c11 = face[3];
+		auto const create = [&](unsigned int i, unsigned int j) {
+			return [&, i, j]() {
+				auto const point = corners[c00] + (corners[c10] - corners[c00]) * warp[i]
+												+ (corners[c01] - corners[c00]) * warp[j];
+				directions.push_back(glm::normalize(point));
+				return static_cast<GLuint>(directions.size() - 1u);
+			};
+		};
+		for (unsigned int j = 0u; j <= n; ++j)
 		{
-			//Quad lower
-			indices[index++] = glm::uvec3(res_phi * i + j, res_phi * (i + 1u) + j, res_phi * (i + 1u) + j + 1u);
-			//Quad upper
-			indices[index++] = glm::uvec3(res_phi * i + j + 1u, res_phi * i + j, res_phi * (i + 1u) + j + 1u);
+			for (unsigned int i = 0u; i <= n; ++i)
+			{
+				auto &index = face_vertices[j * (n + 1u) + i];
+				if (j == 0u)
+					index = edges.get(c00, c10, i, create(i, j));
+				else if (j == n)
+					index = edges.get(c01, c11, i, create(i, j));
+				else if (i == 0u)
+					index = edges.get(c00, c01, j, create(i, j));
+				else if (i == n)
+					index = edges.get(c10, c11, j, create(i, j));
+				else
+					index = create(i, j)();
+			}
 		}
-	}
-
-	if (index != expected_indices)
-	{
-		LogError("Failed to generate indices for sphere! %d expected, %d generated", expected_indices, index);
-		if (expected_indices > index)
+		for (unsigned int j = 0u; j < n; ++j)
 		{
-			indices.resize(index);
+			for (unsigned int i = 0u; i < n; ++i)
+			{
+				auto const v00 = face_vertices[j * (n + 1u) + i],
+						   v10 = face_vertices[j * (n + 1u) + i + 1u],
+						   v01 = face_vertices[(j + 1u) * (n + 1u) + i],
+						   v11 = face_vertices[(j + 1u) * (n + 1u) + i + 1u];
+				indices.insert(indices.end(), {v00, v10, v11, v00, v11, v01});
+			}
 		}
 	}
 
-	bonobo::mesh_data data;
-	glGenVertexArrays(1, &data.vao);
-	assert(data.vao != 0);
-	glBindVertexArray(data.vao);
-
-	auto const vertices_offset = 0u;
-	auto const vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-	auto const normals_offset = vertices_size;
-	auto const normals_size = static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-	auto const texcoords_offset = normals_offset + normals_size;
-	auto const texcoords_size = static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-	auto const tangents_offset = texcoords_offset + texcoords_size;
-	auto const tangents_size = static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-	auto const binormals_offset = tangents_offset + tangents_size;
-	auto const binormals_size = static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-	auto const bo_size = static_cast<GLsizeiptr>(
-		vertices_size +
-		normals_size +
-		texcoords_size +
-		tangents_size +
-		binormals_size);
-
-	glGenBuffers(1, &data.bo);
-	assert(data.bo != 0u);
-	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-	glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-	glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const *>(vertices.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-	glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const *>(normals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const *>(texcoords.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const *>(tangents.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const *>(binormals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(binormals_offset));
-
-	//Buffer filled finally! Go ahead and unbind.
-	glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-	data.indices_nb = indices.size() * 3u;
-	glGenBuffers(1, &data.ibo);
-	assert(data.ibo != 0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(glm::uvec3)),
-				 reinterpret_cast<GLvoid const *>(indices.data()), GL_STATIC_DRAW);
-
-	glBindVertexArray(0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-	return data;
+	return build_sphere_mesh(directions, std::move(indices), radius, options, "cube sphere");
 }
 
 bonobo::mesh_data
-parametric_shapes::createTorus(unsigned int const res_theta,
-							   unsigned int const res_phi, float const rA,
-							   float const rB)
+parametric_shapes::createCubeSphere(unsigned int const subdivisions, float const radius,
+									bonobo::mesh_options const& options)
+{
+	return bonobo::upload_mesh(buildCubeSphere(subdivisions, radius, options), options.precision);
+}
+
+bonobo::mesh_cpu
+parametric_shapes::buildTorus(unsigned int const res_theta,
+							  unsigned int const res_phi, float const rA,
+							  float const rB,
+							  bonobo::mesh_options const& options)
 {
 	//LogInfo("Creating torus! res_theta:%d, res_phi:%d",res_theta,res_phi);
 	auto const vertices_nb = res_theta * res_phi;
-	size_t index = 0u;
 
 	// x = (rA+rB*cos(phi))*cos(theta)
 	// y = (rA+rB*cos(phi))*sin(theta)
 	// z = rB*sin(phi)
-	auto vertices = std::vector<glm::vec3>(vertices_nb);
+	auto mesh = bonobo::mesh_cpu(vertices_nb, options.storage);
+	auto &vertices = mesh.vertices;
 	// normal = glm::cross(tangent,binormal)
-	auto normals = std::vector<glm::vec3>(vertices_nb);
 	// texcoord.x = theta/two_pi
 	// texcoord.y = phi/two_pi
-	auto texcoords = std::vector<glm::vec3>(vertices_nb);
 	// tangent.x = -sin(theta)
 	// tangent.y = cos(theta)
 	// tangent.z = 0
-	auto tangents = std::vector<glm::vec3>(vertices_nb);
 	// binormal.x = -sin(phi)*cos(theta)
 	// binormal.y = -sin(phi)*sin(theta)
 	// binormal.z = cos(phi)
-	auto binormals = std::vector<glm::vec3>(vertices_nb);
 
-	const float dtheta = glm::two_pi<float>() / (static_cast<float>(res_theta - 1)),
-				dphi = glm::two_pi<float>() / (static_cast<float>(res_phi - 1));
+	const float dtheta = step_size(glm::two_pi<float>(), res_theta),
+				dphi = step_size(glm::two_pi<float>(), res_phi);
+	auto const theta = sincos_table(res_theta, dtheta),
+			   phi = sincos_table(res_phi, dphi);
+	auto const u = ramp_table(res_theta),
+			   v = ramp_table(res_phi);
+
+	generate_grid(vertices, res_theta, res_phi, [&](vertex_block &block, unsigned int i, unsigned int j) {
+		const float sin_theta = theta.sin[i],
+					cos_theta = theta.cos[i];
+		auto const sin_phi = floatx::load(phi.sin.data() + j),
+				   cos_phi = floatx::load(phi.cos.data() + j);
+		auto const binormal_x = -sin_phi * cos_theta,
+				   binormal_y = -sin_phi * sin_theta,
+				   smallRadialEffect = rB * cos_phi + rA;
+		block.set(vertex_block::position_x, smallRadialEffect * cos_theta);
+		block.set(vertex_block::position_y, smallRadialEffect * sin_theta);
+		block.set(vertex_block::position_z, rB * sin_phi);
+		// cross(tangent, binormal), the tangent being in the xy-plane
+		block.set(vertex_block::normal_x, cos_theta * cos_phi);
+		block.set(vertex_block::normal_y, sin_theta * cos_phi);
+		block.set(vertex_block::normal_z, -sin_theta * binormal_y - cos_theta * binormal_x);
+		block.set(vertex_block::texcoord_x, u[i]);
+		block.set(vertex_block::texcoord_y, floatx::load(v.data() + j));
+		block.set(vertex_block::texcoord_z, 0.0f);
+		block.set(vertex_block::tangent_x, -sin_theta);
+		block.set(vertex_block::tangent_y, cos_theta);
+		block.set(vertex_block::tangent_z, 0.0f);
+		block.set(vertex_block::binormal_x, binormal_x);
+		block.set(vertex_block::binormal_y, binormal_y);
+		block.set(vertex_block::binormal_z, cos_phi);
+	});
+
+	mesh.indices = triangulate_grid(res_theta, res_phi);
+	bonobo::prepare_mesh(mesh, options, "torus");
+	return mesh;
+}
 
-	for (unsigned int i = 0u; i < res_theta; ++i)
-	{
-		const float theta = dtheta * static_cast<float>(i);
-		const float sin_theta = std::sin(theta),
-					cos_theta = std::cos(theta);
+bonobo::mesh_data
+parametric_shapes::createTorus(unsigned int const res_theta,
+							   unsigned int const res_phi, float const rA,
+							   float const rB,
+							   bonobo::mesh_options const& options)
+{
+	return bonobo::upload_mesh(buildTorus(res_theta, res_phi, rA, rB, options), options.precision);
+}
 
-		for (unsigned int j = 0u; j < res_phi; ++j)
-		{
-			const float phi = dphi * static_cast<float>(j);
-			const float sin_phi = std::sin(phi),
-						cos_phi = std::cos(phi);
-			texcoords[index] = glm::vec3(static_cast<float>(i) / static_cast<float>(res_theta - 1),
-										 static_cast<float>(j) / static_cast<float>(res_phi - 1),
-										 0.0f);
-			tangents[index] = glm::vec3(-sin_theta, cos_theta, 0.0f);
-			binormals[index] = glm::vec3(-sin_phi * cos_theta, -sin_phi * sin_theta, cos_phi);
-			normals[index] = glm::cross(tangents[index], binormals[index]);
-			auto const smallRadialEffect = std::fmaf(rB, cos_phi, rA);
-			vertices[index] = glm::vec3(smallRadialEffect * cos_theta, smallRadialEffect * sin_theta, rB * sin_phi);
-			++index;
-		}
-	}
+bonobo::mesh_cpu
+parametric_shapes::buildCircleRing(unsigned int const res_radius,
+									unsigned int const res_theta,
+									float const inner_radius,
+									float const outer_radius,
+									bonobo::mesh_options const& options)
+{
+	auto const vertices_nb = res_radius * res_theta;
 
-	if (index != vertices_nb)
+	auto mesh = bonobo::mesh_cpu(vertices_nb, options.storage);
+	auto &vertices = mesh.vertices;
+
+	auto const dtheta = step_size(glm::two_pi<float>(), res_theta),				 // step size, depending on the resolution
+		dradius = step_size(outer_radius - inner_radius, res_radius); // step size, depending on the resolution
+	auto const theta = sincos_table(res_theta, dtheta);
+	auto const u = ramp_table(res_radius),
+			   v = ramp_table(res_theta);
+
+	// generate vertices, one row per angle
+	generate_grid(vertices, res_theta, res_radius, [&](vertex_block &block, unsigned int i, unsigned int j) {
+		const float sin_theta = theta.sin[i],
+					cos_theta = theta.cos[i];
+		auto const radius = dradius * get_block_columns(j) + inner_radius;
+
+		// vertex
+		block.set(vertex_block::position_x, radius * cos_theta);
+		block.set(vertex_block::position_y, radius * sin_theta);
+		block.set(vertex_block::position_z, 0.0f);
+
+		// texture coordinates
+		block.set(vertex_block::texcoord_x, floatx::load(u.data() + j));
+		block.set(vertex_block::texcoord_y, v[i]);
+		block.set(vertex_block::texcoord_z, 0.0f);
+
+		// tangent
+		block.set(vertex_block::tangent_x, cos_theta);
+		block.set(vertex_block::tangent_y, sin_theta);
+		block.set(vertex_block::tangent_z, 0.0f);
+
+		// binormal
+		block.set(vertex_block::binormal_x, -sin_theta);
+		block.set(vertex_block::binormal_y, cos_theta);
+		block.set(vertex_block::binormal_z, 0.0f);
+
+		// normal = cross(tangent, binormal)
+		block.set(vertex_block::normal_x, 0.0f);
+		block.set(vertex_block::normal_y, 0.0f);
+		block.set(vertex_block::normal_z, cos_theta * cos_theta + sin_theta * sin_theta);
+	});
+
+	if (res_theta >= 2u && res_radius >= 2u)
 	{
-		LogError("Failed to generate vertices for torus! %d expected, %d generated", vertices_nb, index);
-	}
+		// create index array
+		auto indices = std::vector<GLuint>(6u * (res_theta - 1u) * (res_radius - 1u));
 
-	const size_t expected_indices = 2 * (res_theta - 1u) * (res_phi - 1u);
-	auto indices = std::vector<glm::uvec3>(expected_indices);
-	index = 0u;
-	for (unsigned int i = 0u; i < res_theta - 1u; ++i)
-	{
-		for (unsigned int j = 0u; j < res_phi - 1u; ++j)
-		{
-			//Quad lower
-			indices[index++] = glm::uvec3(res_phi * i + j, res_phi * (i + 1u) + j, res_phi * (i + 1u) + j + 1u);
-			//Quad upper
-			indices[index++] = glm::uvec3(res_phi * i + j + 1u, res_phi * i + j, res_phi * (i + 1u) + j + 1u);
-		}
-	}
+		// generate indices
+		GLuint const quad[6] = { 0u, 1u, res_radius + 1u, 0u, res_radius + 1u, res_radius };
+		bonobo::get_cpu_kernels().grid_indices(indices.data(), res_radius, 0u, res_theta - 1u, quad);
 
-	if (index != expected_indices)
-	{
-		LogError("Failed to generate indices for torus! %d expected, %d generated", expected_indices, index);
-		if (expected_indices > index)
-		{
-			indices.resize(index);
-		}
+		mesh.indices = std::move(indices);
 	}
-
-	bonobo::mesh_data data;
-	glGenVertexArrays(1, &data.vao);
-	assert(data.vao != 0);
-	glBindVertexArray(data.vao);
-
-	auto const vertices_offset = 0u;
-	auto const vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-	auto const normals_offset = vertices_size;
-	auto const normals_size = static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-	auto const texcoords_offset = normals_offset + normals_size;
-	auto const texcoords_size = static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-	auto const tangents_offset = texcoords_offset + texcoords_size;
-	auto const tangents_size = static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-	auto const binormals_offset = tangents_offset + tangents_size;
-	auto const binormals_size = static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-	auto const bo_size = static_cast<GLsizeiptr>(
-		vertices_size +
-		normals_size +
-		texcoords_size +
-		tangents_size +
-		binormals_size);
-
-	glGenBuffers(1, &data.bo);
-	assert(data.bo != 0u);
-	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-	glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-	glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const *>(vertices.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-	glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const *>(normals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const *>(texcoords.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const *>(tangents.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const *>(binormals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals),
-						  3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(binormals_offset));
-
-	//Buffer filled finally! Go ahead and unbind.
-	glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-	data.indices_nb = indices.size() * 3u;
-	glGenBuffers(1, &data.ibo);
-	assert(data.ibo != 0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(glm::uvec3)),
-				 reinterpret_cast<GLvoid const *>(indices.data()), GL_STATIC_DRAW);
-
-	glBindVertexArray(0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
-
-	return data;
+	bonobo::prepare_mesh(mesh, options, "circle ring");
+	return mesh;
 }
 
 bonobo::mesh_data
 parametric_shapes::createCircleRing(unsigned int const res_radius,
 									unsigned int const res_theta,
 									float const inner_radius,
-									float const outer_radius)
+									float const outer_radius,
+									bonobo::mesh_options const& options)
 {
-	auto const vertices_nb = res_radius * res_theta;
-
-	auto vertices = std::vector<glm::vec3>(vertices_nb);
-	auto normals = std::vector<glm::vec3>(vertices_nb);
-	auto texcoords = std::vector<glm::vec3>(vertices_nb);
-	auto tangents = std::vector<glm::vec3>(vertices_nb);
-	auto binormals = std::vector<glm::vec3>(vertices_nb);
-
-	float theta = 0.0f,															// 'stepping'-variable for theta: will go 0 - 2PI
-		dtheta = glm::two_pi<float>() / (static_cast<float>(res_theta) - 1.0f); // step size, depending on the resolution
+	return bonobo::upload_mesh(buildCircleRing(res_radius, res_theta, inner_radius, outer_radius, options), options.precision);
+}
 
-	float radius = 0.0f,																   // 'stepping'-variable for radius: will go inner_radius - outer_radius
-		dradius = (outer_radius - inner_radius) / (static_cast<float>(res_radius) - 1.0f); // step size, depending on the resolution
+void parametric_shapes::benchmarkGeneration(unsigned int resolution)
+{
+	auto const million_vertices = static_cast<double>(resolution) * static_cast<double>(resolution) / 1.0e6;
+	auto const measure = [million_vertices](char const *name, std::function<bonobo::mesh_cpu()> const &build) {
+		auto const start = GetTimeMilliseconds();
+		auto const mesh = build();
+		auto const duration = GetTimeMilliseconds() - start;
+		LogInfo("Generated %s in %.1f ms: %.1f ms per million vertices", name, duration, duration / million_vertices);
+	};
+
+	LogInfo("Generating shapes of %ux%u vertices, on %u threads",
+			resolution, resolution, static_cast<unsigned int>(bonobo::get_worker_threads_nb()));
+	measure("zoneplate", [resolution]() { return buildZoneplate(resolution, resolution); });
+	measure("oceanplate", [resolution]() { return buildOceanplate(resolution, resolution); });
+	measure("sphere", [resolution]() { return buildSphere(resolution, resolution, 1.0f); });
+	measure("torus", [resolution]() { return buildTorus(resolution, resolution, 1.0f, 0.5f); });
+	measure("circle ring", [resolution]() { return buildCircleRing(resolution, resolution, 1.0f, 2.0f); });
+}
 
-	// generate vertices iteratively
-	size_t index = 0u;
-	for (unsigned int i = 0u; i < res_theta; ++i)
+void parametric_shapes::compareSphereTessellations(float max_error)
+{
+	constexpr unsigned int max_resolution = 4096u;
+	struct tessellation
 	{
-		float cos_theta = std::cos(theta),
-			  sin_theta = std::sin(theta);
-
-		radius = inner_radius;
-
-		for (unsigned int j = 0u; j < res_radius; ++j)
+		char const *name;
+		std::function<bonobo::mesh_cpu(unsigned int)> build;
+	};
+	// The UV sphere gets twice as many columns as rows, so that its quads
+	// are square at the equator.
+	tessellation const tessellations[] = {
+		{"UV sphere", [](unsigned int n) { return buildSphere(2u * n + 1u, n + 1u, 1.0f); }},
+		{"icosphere", [](unsigned int n) { return buildIcosphere(n, 1.0f); }},
+		{"cube sphere", [](unsigned int n) { return buildCubeSphere(n, 1.0f); }}};
+
+	LogInfo("Tessellating a unit sphere with an error of at most %g", max_error);
+	for (auto const &tessellation : tessellations)
+	{
+		auto const meets_error = [&](unsigned int n) {
+			return sphere_tessellation_error(tessellation.build(n), 1.0f) <= max_error;
+		};
+
+		// The error decreases with the resolution: bracket the smallest
+		// resolution meeting it, then bisect.
+		unsigned int low = 0u, high = 1u;
+		while (high < max_resolution && !meets_error(high))
 		{
-			// vertex
-			vertices[index] = glm::vec3(radius * cos_theta,
-										radius * sin_theta,
-										0.0f);
-
-			// texture coordinates
-			texcoords[index] = glm::vec3(static_cast<float>(j) / (static_cast<float>(res_radius) - 1.0f),
-										 static_cast<float>(i) / (static_cast<float>(res_theta) - 1.0f),
-										 0.0f);
-
-			// tangent
-			auto t = glm::vec3(cos_theta, sin_theta, 0.0f);
-			t = glm::normalize(t);
-			tangents[index] = t;
-
-			// binormal
-			auto b = glm::vec3(-sin_theta, cos_theta, 0.0f);
-			b = glm::normalize(b);
-			binormals[index] = b;
-
-			// normal
-			auto const n = glm::cross(t, b);
-			normals[index] = n;
-
-			radius += dradius;
-			++index;
+			low = high;
+			high = std::min(2u * high, max_resolution);
 		}
-
-		theta += dtheta;
-	}
-
-	// create index array
-	auto indices = std::vector<glm::uvec3>(2u * (res_theta - 1u) * (res_radius - 1u));
-
-	// generate indices iteratively
-	index = 0u;
-	for (unsigned int i = 0u; i < res_theta - 1u; ++i)
-	{
-		for (unsigned int j = 0u; j < res_radius - 1u; ++j)
+		if (!meets_error(high))
 		{
-			indices[index] = glm::uvec3(res_radius * i + j,
-										res_radius * i + j + 1u,
-										res_radius * i + j + 1u + res_radius);
-			++index;
-
-			indices[index] = glm::uvec3(res_radius * i + j,
-										res_radius * i + j + res_radius + 1u,
-										res_radius * i + j + res_radius);
-			++index;
+			LogWarning("%s: resolution %u is not enough", tessellation.name, max_resolution);
+			continue;
+		}
+		while (high - low > 1u)
+		{
+			auto const middle = low + (high - low) / 2u;
+			if (meets_error(middle))
+				high = middle;
+			else
+				low = middle;
 		}
-	}
-
-	bonobo::mesh_data data;
-	glGenVertexArrays(1, &data.vao);
-	assert(data.vao != 0u);
-	glBindVertexArray(data.vao);
-
-	auto const vertices_offset = 0u;
-	auto const vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3));
-	auto const normals_offset = vertices_size;
-	auto const normals_size = static_cast<GLsizeiptr>(normals.size() * sizeof(glm::vec3));
-	auto const texcoords_offset = normals_offset + normals_size;
-	auto const texcoords_size = static_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec3));
-	auto const tangents_offset = texcoords_offset + texcoords_size;
-	auto const tangents_size = static_cast<GLsizeiptr>(tangents.size() * sizeof(glm::vec3));
-	auto const binormals_offset = tangents_offset + tangents_size;
-	auto const binormals_size = static_cast<GLsizeiptr>(binormals.size() * sizeof(glm::vec3));
-	auto const bo_size = static_cast<GLsizeiptr>(vertices_size + normals_size + texcoords_size + tangents_size + binormals_size);
-	glGenBuffers(1, &data.bo);
-	assert(data.bo != 0u);
-	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
-	glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-	glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const *>(vertices.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(0x0));
-
-	glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const *>(normals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(normals_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const *>(texcoords.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(texcoords_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const *>(tangents.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(tangents_offset));
-
-	glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const *>(binormals.data()));
-	glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-	glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const *>(binormals_offset));
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
-	data.indices_nb = indices.size() * 3u;
-	glGenBuffers(1, &data.ibo);
-	assert(data.ibo != 0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(glm::uvec3)), reinterpret_cast<GLvoid const *>(indices.data()), GL_STATIC_DRAW);
-
-	glBindVertexArray(0u);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
 
-	return data;
+		auto const mesh = tessellation.build(high);
+		LogInfo("%s: %u vertices and %u triangles at resolution %u, for an error of %g",
+				tessellation.name, static_cast<unsigned int>(mesh.vertices.get_vertices_nb()),
+				static_cast<unsigned int>(mesh.indices.size() / 3u), high, sphere_tessellation_error(mesh, 1.0f));
+	}
 }
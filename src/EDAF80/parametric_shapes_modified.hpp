@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core/helpers.hpp"
+#include "core/mesh_cpu.hpp"
+#include "core/vertex_format.hpp"
 
 namespace parametric_shapes
 {
@@ -16,9 +18,11 @@ bonobo::mesh_data createQuad(unsigned int width, unsigned int height);
 bonobo::mesh_data createZoneplate(unsigned int width,
 								  unsigned int height,
 								  float wave_count = 1.0f,
-								  float zplate_depth = 1.0f);
+								  float zplate_depth = 1.0f,
+								  bonobo::mesh_options const& options = bonobo::mesh_options());
 
-bonobo::mesh_data createOceanplate(unsigned int width, unsigned int height, float sideLength = 1.0f);
+bonobo::mesh_data createOceanplate(unsigned int width, unsigned int height, float sideLength = 1.0f,
+								   bonobo::mesh_options const& options = bonobo::mesh_options());
 
 //! \brief Create a sphere for some tesselation level and make it
 //!        available to OpenGL.
@@ -26,9 +30,46 @@ bonobo::mesh_data createOceanplate(unsigned int width, unsigned int height, floa
 //! @param res_theta tessellation resolution (nbr of vertices) in the latitude direction ( 0 < theta < PI/2 )
 //! @param res_phi tessellation resolution (nbr of vertices) in the longitude direction ( 0 < phi < 2PI )
 //! @param radius radius of the sphere
+//! @param options how to store the vertex attributes, and whether to
+//!        optimise the mesh before uploading it
 //! @return wrapper around OpenGL objects' name containing the geometry
 //!         data
-bonobo::mesh_data createSphere(unsigned int const res_theta, unsigned int const res_phi, float const radius);
+bonobo::mesh_data createSphere(unsigned int const res_theta, unsigned int const res_phi, float const radius,
+							   bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Create a sphere by subdividing the faces of an icosahedron, and
+//!        make it available to OpenGL.
+//!
+//! Unlike `createSphere()`, triangles have about the same size all over
+//! the sphere. Vertices are shared between neighbouring triangles, except
+//! along the u = 0 seam of the texture coordinates and at the poles; those
+//! are mapped like with `createSphere()`.
+//!
+//! @param subdivisions number of segments each edge of the icosahedron is
+//!        split into, giving 20 * subdivisions^2 triangles
+//! @param radius radius of the sphere
+//! @param options how to store the vertex attributes, and whether to
+//!        optimise the mesh before uploading it
+//! @return wrapper around OpenGL objects' name containing the geometry
+//!         data
+bonobo::mesh_data createIcosphere(unsigned int const subdivisions, float const radius,
+								  bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Create a sphere by projecting a subdivided cube onto it, and
+//!        make it available to OpenGL.
+//!
+//! Subdivisions are spaced by equal angles, so that triangles have
+//! similar areas; vertices are shared like with `createIcosphere()`.
+//!
+//! @param subdivisions number of segments each edge of the cube is split
+//!        into, giving 12 * subdivisions^2 triangles
+//! @param radius radius of the sphere
+//! @param options how to store the vertex attributes, and whether to
+//!        optimise the mesh before uploading it
+//! @return wrapper around OpenGL objects' name containing the geometry
+//!         data
+bonobo::mesh_data createCubeSphere(unsigned int const subdivisions, float const radius,
+								   bonobo::mesh_options const& options = bonobo::mesh_options());
 
 //! \brief Create a torus for some tesselation level and make it
 //!        available to OpenGL.
@@ -37,9 +78,12 @@ bonobo::mesh_data createSphere(unsigned int const res_theta, unsigned int const
 //! @param res_phi tessellation resolution (nbr of vertices) in the longitude direction ( 0 < phi < 2PI )
 //! @param rA radius of the innermost border of the torus
 //! @param rB radius of the outermost border of the torus
+//! @param options how to store the vertex attributes, and whether to
+//!        optimise the mesh before uploading it
 //! @return wrapper around OpenGL objects' name containing the geometry
 //!         data
-bonobo::mesh_data createTorus(unsigned int const res_theta, unsigned int const res_phi, float const rA, float const rB);
+bonobo::mesh_data createTorus(unsigned int const res_theta, unsigned int const res_phi, float const rA, float const rB,
+							  bonobo::mesh_options const& options = bonobo::mesh_options());
 
 //! \brief Create a circle ring for some tesselation level and make it
 //!        available to OpenGL.
@@ -48,7 +92,65 @@ bonobo::mesh_data createTorus(unsigned int const res_theta, unsigned int const r
 //! @param theta_res tessellation resolution (nbr of vertices) in the angular direction ( 0 < theta < 2PI )
 //! @param inner_radius radius of the innermost border of the ring
 //! @param outer_radius radius of the outermost border of the ring
+//! @param options how to store the vertex attributes, and whether to
+//!        optimise the mesh before uploading it
 //! @return wrapper around OpenGL objects' name containing the geometry
 //!         data
-bonobo::mesh_data createCircleRing(unsigned int const radius_res, unsigned int const theta_res, float const inner_radius, float const outer_radius);
+bonobo::mesh_data createCircleRing(unsigned int const radius_res, unsigned int const theta_res, float const inner_radius, float const outer_radius,
+								   bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createZoneplate()` in CPU memory,
+//!        without uploading it; this does not require an OpenGL context.
+//!
+//! The `precision` of `options` is ignored, as it only applies on upload.
+bonobo::mesh_cpu buildZoneplate(unsigned int width, unsigned int height, float wave_count = 1.0f, float zplate_depth = 1.0f,
+								bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createOceanplate()` in CPU memory;
+//!        see `buildZoneplate()`.
+bonobo::mesh_cpu buildOceanplate(unsigned int width, unsigned int height, float sideLength = 1.0f,
+								 bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createSphere()` in CPU memory; see
+//!        `buildZoneplate()`.
+bonobo::mesh_cpu buildSphere(unsigned int const res_theta, unsigned int const res_phi, float const radius,
+							 bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createIcosphere()` in CPU memory; see
+//!        `buildZoneplate()`.
+bonobo::mesh_cpu buildIcosphere(unsigned int const subdivisions, float const radius,
+								bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createCubeSphere()` in CPU memory;
+//!        see `buildZoneplate()`.
+bonobo::mesh_cpu buildCubeSphere(unsigned int const subdivisions, float const radius,
+								 bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createTorus()` in CPU memory; see
+//!        `buildZoneplate()`.
+bonobo::mesh_cpu buildTorus(unsigned int const res_theta, unsigned int const res_phi, float const rA, float const rB,
+							bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate the geometry of `createCircleRing()` in CPU memory;
+//!        see `buildZoneplate()`.
+bonobo::mesh_cpu buildCircleRing(unsigned int const radius_res, unsigned int const theta_res, float const inner_radius, float const outer_radius,
+								 bonobo::mesh_options const& options = bonobo::mesh_options());
+
+//! \brief Generate each of the above shapes with `resolution` by
+//!        `resolution` vertices, and log how long generating each one
+//!        took, per million vertices.
+//!
+//! Only the CPU-side `build*()` functions are timed, so that no OpenGL
+//! context is needed.
+//!
+//! @param resolution tessellation resolution along both directions
+void benchmarkGeneration(unsigned int resolution);
+
+//! \brief Find, for the UV sphere, the icosphere and the cube sphere, the
+//!        lowest resolution approximating a unit sphere within
+//!        `max_error`, and log how many vertices and triangles it takes.
+//!
+//! @param max_error maximum distance between the tessellation and the
+//!        sphere, relative to its radius
+void compareSphereTessellations(float max_error);
 } // namespace parametric_shapes
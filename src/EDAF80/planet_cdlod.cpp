@@ -0,0 +1,251 @@
+#include "planet_cdlod.hpp"
+
+#include "core/Log.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	// Smallest area of a part of a face on the sphere, relative to its area
+	// in angles, reached at the corners of the face.
+	constexpr float min_area_scale = 0.7698f;
+
+	struct cube_face
+	{
+		glm::vec3 normal;
+		glm::vec3 u;
+		glm::vec3 v; // cross(u, normal), so that grids in the xz plane face outwards
+	};
+
+	std::array<cube_face, 6> const cube_faces = {{
+		{glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3( 0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f)},
+		{glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3( 0.0f, 0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)},
+		{glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)},
+		{glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)},
+		{glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)},
+		{glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(-1.0f, 0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)}
+	}};
+
+	// Point of the unit sphere above `position` on a face, with the
+	// equal-angle mapping of planet_cdlod.vert.
+	glm::vec3 on_sphere(cube_face const &face, glm::vec2 const &position)
+	{
+		auto const quarter_pi = glm::quarter_pi<float>();
+		return glm::normalize(face.normal + std::tan(quarter_pi * position.x) * face.u
+		                                  + std::tan(quarter_pi * position.y) * face.v);
+	}
+
+	// Radius of the smallest sphere, centred on the axis of a cap of
+	// half-angle `angle`, around the part of the cap between the radii
+	// `inner` and `outer`; `offset` is where the centre is along the axis.
+	float cap_bounds(float angle, float inner, float outer, float &offset)
+	{
+		auto const cos_angle = std::cos(angle);
+		offset = 0.5f * (inner * cos_angle + outer);
+		auto const half_depth = 0.5f * (outer - inner * cos_angle);
+		auto const width = outer * std::sin(angle);
+		return std::sqrt(half_depth * half_depth + width * width);
+	}
+}
+
+struct planet::cdlod_selector::node_bounds
+{
+	// Around the node on the sphere, to compare with the ranges, as
+	// planet_cdlod.vert morphs vertices with their distance to the sphere.
+	glm::vec3 centre;
+	float radius;
+
+	// Around the node and everything up to `max_height` above it, to cull
+	// it.
+	glm::vec3 culling_centre;
+	float culling_radius;
+
+	node_bounds(cdlod_parameters const &parameters, unsigned int face, glm::vec2 const &corner, float size)
+	{
+		auto const &cube_face = cube_faces[face];
+		auto const direction = on_sphere(cube_face, corner + 0.5f * size);
+
+		// The node is a convex spherical quad, whose farthest points from
+		// its centre are its corners.
+		auto min_cos_angle = 1.0f;
+		for (auto k = 0u; k < 4u; ++k)
+		{
+			auto const node_corner = corner + size * glm::vec2(k & 1u, k >> 1u);
+			min_cos_angle = std::min(glm::dot(direction, on_sphere(cube_face, node_corner)), min_cos_angle);
+		}
+		auto const angle = std::acos(glm::clamp(min_cos_angle, -1.0f, 1.0f));
+
+		auto offset = 0.0f;
+		radius = cap_bounds(angle, parameters.radius, parameters.radius, offset);
+		centre = offset * direction;
+		culling_radius = cap_bounds(angle, parameters.radius, parameters.radius + parameters.max_height, offset);
+		culling_centre = offset * direction;
+	}
+
+	bool within(glm::vec3 const &position, float range) const
+	{
+		return glm::length(centre - position) - radius <= range;
+	}
+};
+
+planet::cdlod_selector::cdlod_selector(cdlod_parameters const &parameters) : _parameters(parameters), _ranges(),
+                                                                             _max_triangles_nb(0u),
+                                                                             _camera_position(0.0f),
+                                                                             _frustum(), _horizon(), _patches(),
+                                                                             _half_patches(), _statistics()
+{
+	assert(parameters.radius > 0.0f && parameters.levels_nb >= 1u);
+
+	// Quarters of patches need an even number of quads too, for their
+	// edges not to morph.
+	if (_parameters.patch_resolution < 4u || _parameters.patch_resolution % 4u != 0u)
+	{
+		_parameters.patch_resolution = std::max((_parameters.patch_resolution + 3u) / 4u * 4u, 4u);
+		LogWarning("The resolution of CDLOD patches has to be a multiple of 4; using %u.", _parameters.patch_resolution);
+	}
+	_parameters.morph_fraction = glm::clamp(_parameters.morph_fraction, 0.01f, 0.45f);
+
+	// A node can be refined up to its diameter, about twice its size,
+	// beyond the range of its children, where it must not have started to
+	// morph yet to match its neighbours; with some margin for the bounds.
+	auto const min_range_ratio = 2.1f / (1.0f - 2.0f * _parameters.morph_fraction);
+	if (_parameters.lod_range_ratio < min_range_ratio)
+	{
+		LogWarning("A CDLOD range ratio of %.2f would leave cracks; using %.2f.", _parameters.lod_range_ratio, min_range_ratio);
+		_parameters.lod_range_ratio = min_range_ratio;
+	}
+
+	auto const radius = _parameters.radius;
+	auto const quarter_pi = glm::quarter_pi<float>();
+	auto const resolution = static_cast<float>(_parameters.patch_resolution);
+	auto const patch_triangles_nb = static_cast<size_t>(2.0f * resolution * resolution);
+	_ranges.resize(_parameters.levels_nb);
+	auto size = 2.0f;
+	for (auto &range : _ranges)
+	{
+		range = _parameters.lod_range_ratio * radius * quarter_pi * size;
+		size *= 0.5f;
+	}
+
+	// Nodes refined at level l - 1 touch the sphere of range l around the
+	// camera; every point of them is within their bounds' diameter of it,
+	// which covers at most pi * distance^2 of the sphere when the camera is
+	// above the surface. Their areas do not overlap, so this many of them
+	// fit at most, and each of their 4 children is drawn with at most one
+	// patch.
+	_max_triangles_nb = cube_faces.size() * patch_triangles_nb;
+	auto nodes_nb = static_cast<double>(cube_faces.size());
+	size = 2.0f;
+	for (auto level = 1u; level < _parameters.levels_nb; ++level, nodes_nb *= 4.0, size *= 0.5f)
+	{
+		auto const max_angle = std::min(quarter_pi * size, std::acos(1.0f / std::sqrt(3.0f)));
+		auto offset = 0.0f;
+		auto const max_bounds_radius = cap_bounds(max_angle, radius, radius, offset);
+		auto const reach = _ranges[level] + 2.0f * max_bounds_radius;
+		auto const covered_area = std::min(glm::pi<double>() * reach * reach, 4.0 * glm::pi<double>() * radius * radius);
+		auto const node_area = min_area_scale * (quarter_pi * size * radius) * (quarter_pi * size * radius);
+		auto const refined_nodes_nb = std::min(nodes_nb, std::floor(covered_area / node_area));
+		_max_triangles_nb += 4u * static_cast<size_t>(refined_nodes_nb) * patch_triangles_nb;
+	}
+}
+
+float planet::cdlod_selector::get_range_per_step() const
+{
+	return _parameters.lod_range_ratio * _parameters.radius * glm::quarter_pi<float>() * _parameters.patch_resolution;
+}
+
+void planet::cdlod_selector::select(glm::vec3 const &camera_position, glm::mat4 const &world_to_clip)
+{
+	_camera_position = camera_position;
+	_patches.clear();
+	_half_patches.clear();
+	_statistics = cdlod_statistics();
+
+	_frustum = frustum(world_to_clip);
+	_horizon = horizon(camera_position, _parameters.radius);
+
+	for (auto face = 0u; face < cube_faces.size(); ++face)
+	{
+		auto const corner = glm::vec2(-1.0f);
+		select_node(face, corner, 2.0f, 0u, node_bounds(_parameters, face, corner, 2.0f), false);
+	}
+
+	auto const resolution = _parameters.patch_resolution;
+	_statistics.patches_nb = _patches.size();
+	_statistics.half_patches_nb = _half_patches.size();
+	_statistics.triangles_nb = 2u * resolution * resolution * _patches.size()
+	                         + resolution * resolution / 2u * _half_patches.size();
+	assert(_statistics.triangles_nb <= _max_triangles_nb);
+}
+
+void planet::cdlod_selector::select_node(unsigned int face, glm::vec2 const &corner, float size, unsigned int level,
+                                         node_bounds const &bounds, bool inside_frustum)
+{
+	++_statistics.visited_nodes_nb;
+	if (!is_visible(bounds, inside_frustum))
+		return;
+
+	auto const step = size / static_cast<float>(_parameters.patch_resolution);
+	if (level + 1u == _parameters.levels_nb || !bounds.within(_camera_position, _ranges[level + 1u]))
+	{
+		add_patch(_patches, face, corner, step);
+		return;
+	}
+
+	// Children out of their range are drawn as quarters of this node, at
+	// its resolution.
+	auto const child_size = 0.5f * size;
+	for (auto k = 0u; k < 4u; ++k)
+	{
+		auto const child_corner = corner + child_size * glm::vec2(k & 1u, k >> 1u);
+		auto const child_bounds = node_bounds(_parameters, face, child_corner, child_size);
+		if (child_bounds.within(_camera_position, _ranges[level + 1u]))
+		{
+			select_node(face, child_corner, child_size, level + 1u, child_bounds, inside_frustum);
+			continue;
+		}
+
+		++_statistics.visited_nodes_nb;
+		auto child_inside_frustum = inside_frustum;
+		if (is_visible(child_bounds, child_inside_frustum))
+			add_patch(_half_patches, face, child_corner, step);
+	}
+}
+
+bool planet::cdlod_selector::is_visible(node_bounds const &bounds, bool &inside_frustum)
+{
+	auto const &centre = bounds.culling_centre;
+	auto const radius = bounds.culling_radius;
+
+	// Once inside all planes, children are too.
+	if (!inside_frustum)
+	{
+		auto const intersection = _frustum.test(centre, radius);
+		if (intersection == frustum::intersection::outside)
+		{
+			++_statistics.frustum_culled_nb;
+			return false;
+		}
+		inside_frustum = intersection == frustum::intersection::inside;
+	}
+
+	if (_horizon.hides(centre, radius))
+	{
+		++_statistics.horizon_culled_nb;
+		return false;
+	}
+	return true;
+}
+
+void planet::cdlod_selector::add_patch(std::vector<glm::mat4> &patches, unsigned int face, glm::vec2 const &corner,
+                                       float step) const
+{
+	auto const &cube_face = cube_faces[face];
+	auto const origin = cube_face.normal + corner.x * cube_face.u + corner.y * cube_face.v;
+	patches.emplace_back(glm::vec4(step * cube_face.u, 0.0f), glm::vec4(cube_face.normal, 0.0f),
+	                     glm::vec4(step * cube_face.v, 0.0f), glm::vec4(origin, 1.0f));
+}
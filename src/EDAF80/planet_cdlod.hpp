@@ -0,0 +1,107 @@
+#pragma once
+
+#include "planet_culling.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+namespace planet
+{
+	//! \brief Parameters of a `cdlod_selector`.
+	struct cdlod_parameters
+	{
+		float radius = 100.0f;               //!< radius of the planet, centred on the origin
+		unsigned int patch_resolution = 32u; //!< quads along each side of a patch; multiple of 4
+		unsigned int levels_nb = 10u;        //!< levels of the quadtrees, the six cube faces included
+		float lod_range_ratio = 4.0f;        //!< distance, in node sizes, within which a node is refined
+		float morph_fraction = 0.2f;         //!< part of the range of a level over which its vertices morph
+		float max_height = 0.0f;             //!< highest the surface rises above `radius`, for culling
+	};
+
+	//! \brief What the last `cdlod_selector::select()` did.
+	struct cdlod_statistics
+	{
+		size_t visited_nodes_nb = 0u;
+		size_t frustum_culled_nb = 0u;
+		size_t horizon_culled_nb = 0u;
+		size_t patches_nb = 0u;       //!< whole nodes
+		size_t half_patches_nb = 0u;  //!< quarters of nodes, at the resolution of the node
+		size_t triangles_nb = 0u;
+	};
+
+	//! \brief Continuous distance-dependent level of detail (CDLOD, from
+	//!        Strugar's paper of the same name) over a cube sphere.
+	//!
+	//! Each face of a cube, from (-1, -1, -1) to (1, 1, 1), is the root of
+	//! a quadtree. A node of size `s`, in face units, is refined when it
+	//! comes within `lod_range_ratio` times its size on the sphere, that is
+	//! `range = lod_range_ratio * radius * pi / 4 * s`, of the camera; its
+	//! children out of their own range are drawn as quarters of it instead.
+	//! Nodes outside the frustum or below the horizon are skipped.
+	//!
+	//! Every selected node is drawn with the same grid of
+	//! `patch_resolution` quads, or half of it for quarters, whose vertices
+	//! morph onto every other one as they get close to the range of their
+	//! level, so that they match the coarser level without any popping.
+	//! Faces are mapped onto the sphere with equal angles, like
+	//! `parametric_shapes::createCubeSphere()`.
+	//!
+	//! As the ranges scale with the nodes, the area where each level is
+	//! used, relative to the size of its nodes, does not depend on the
+	//! altitude: `get_max_triangles_nb()` bounds the triangles of any
+	//! selection.
+	class cdlod_selector
+	{
+	public:
+		explicit cdlod_selector(cdlod_parameters const &parameters);
+
+		//! \brief Select the nodes to draw.
+		//!
+		//! @param [in] camera_position position of the camera, above the
+		//!             surface
+		//! @param [in] world_to_clip matrix from world space to clip space
+		void select(glm::vec3 const &camera_position, glm::mat4 const &world_to_clip);
+
+		//! \brief Transforms of the whole nodes of the last selection, from
+		//!        the grid of a patch, with (i, 0, j) for its vertex (i, j),
+		//!        to the surface of the cube.
+		std::vector<glm::mat4> const &get_patches() const { return _patches; }
+
+		//! \brief Transforms of the quarters of nodes of the last
+		//!        selection, for a grid half as large.
+		std::vector<glm::mat4> const &get_half_patches() const { return _half_patches; }
+
+		cdlod_statistics const &get_statistics() const { return _statistics; }
+
+		cdlod_parameters const &get_parameters() const { return _parameters; }
+
+		//! \brief Upper bound of the number of triangles of any selection,
+		//!        wherever the camera is above the surface.
+		size_t get_max_triangles_nb() const { return _max_triangles_nb; }
+
+		//! \brief Range of a level divided by the spacing of the vertices
+		//!        of its patches, in face units.
+		float get_range_per_step() const;
+
+	private:
+		struct node_bounds;
+
+		void select_node(unsigned int face, glm::vec2 const &corner, float size, unsigned int level,
+		                 node_bounds const &bounds, bool inside_frustum);
+		bool is_visible(node_bounds const &bounds, bool &inside_frustum);
+		void add_patch(std::vector<glm::mat4> &patches, unsigned int face, glm::vec2 const &corner, float step) const;
+
+		cdlod_parameters _parameters;
+		std::vector<float> _ranges;
+		size_t _max_triangles_nb;
+
+		glm::vec3 _camera_position;
+		frustum _frustum;
+		horizon _horizon;
+		std::vector<glm::mat4> _patches;
+		std::vector<glm::mat4> _half_patches;
+		cdlod_statistics _statistics;
+	};
+}
@@ -0,0 +1,148 @@
+#include "planet_cdlod_sphere.hpp"
+
+#include "core/helpers.hpp"
+#include "core/Log.h"
+#include "core/mesh_cpu.hpp"
+#include "core/Misc.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Size of the `vertex_model_to_world` arrays of the CDLOD shaders.
+	constexpr size_t max_instances_nb = 100u;
+
+	// Grid of `resolution` x `resolution` unit quads in the xz plane, from
+	// the origin towards +x and +z, facing +y.
+	bonobo::mesh_cpu build_patch(unsigned int resolution)
+	{
+		auto const row_vertices_nb = resolution + 1u;
+		auto mesh = bonobo::mesh_cpu(row_vertices_nb * row_vertices_nb);
+		for (auto j = 0u; j <= resolution; ++j)
+			for (auto i = 0u; i <= resolution; ++i)
+				mesh.vertices.set<bonobo::shader_bindings::vertices>(j * row_vertices_nb + i, glm::vec3(i, 0.0f, j));
+
+		// As for the tiles of `ocean::clipmap`, all diagonals go the same way
+		// so that morphed patches are made of the triangles of the coarser
+		// grid.
+		mesh.indices.reserve(6u * resolution * resolution);
+		for (auto j = 0u; j < resolution; ++j)
+		{
+			for (auto i = 0u; i < resolution; ++i)
+			{
+				auto const v00 = j * row_vertices_nb + i;
+				auto const v10 = v00 + 1u, v01 = v00 + row_vertices_nb, v11 = v01 + 1u;
+				mesh.indices.insert(mesh.indices.end(), {v00, v01, v11, v00, v11, v10});
+			}
+		}
+
+		bonobo::mesh_options options;
+		options.optimize = true;
+		bonobo::prepare_mesh(mesh, options, "CDLOD patch");
+		return mesh;
+	}
+}
+
+planet::cdlod_sphere::cdlod_sphere(cdlod_parameters const &parameters) : _selector(parameters), _patch(), _half_patch()
+{
+	auto const resolution = _selector.get_parameters().patch_resolution;
+	_patch.set_geometry(bonobo::upload_mesh(build_patch(resolution)));
+	_half_patch.set_geometry(bonobo::upload_mesh(build_patch(resolution / 2u)));
+}
+
+void planet::cdlod_sphere::select(glm::vec3 const &camera_position, glm::mat4 const &world_to_clip)
+{
+	_selector.select(camera_position, world_to_clip);
+}
+
+void planet::cdlod_sphere::render(glm::mat4 const &world_to_clip, GLuint program,
+                                  std::function<void(GLuint)> const &set_uniforms) const
+{
+	auto const &parameters = _selector.get_parameters();
+	auto const range_per_step = _selector.get_range_per_step();
+	auto const set_cdlod_uniforms = [&set_uniforms, &parameters, range_per_step](GLuint program) {
+		set_uniforms(program);
+		glUniform1f(glGetUniformLocation(program, "planet_radius"), parameters.radius);
+		glUniform1f(glGetUniformLocation(program, "cdlod_range_per_step"), range_per_step);
+		glUniform1f(glGetUniformLocation(program, "cdlod_morph_fraction"), parameters.morph_fraction);
+	};
+
+	// The shaders take at most `max_instances_nb` transforms per draw.
+	auto const render_patches = [&](Node const &patch, std::vector<glm::mat4> const &patches) {
+		std::vector<glm::mat4> instances;
+		for (size_t first = 0u; first < patches.size(); first += max_instances_nb)
+		{
+			auto const last = std::min(first + max_instances_nb, patches.size());
+			instances.assign(patches.begin() + first, patches.begin() + last);
+			patch.renderInstanced(world_to_clip, glm::mat4(1.0f), instances, program, set_cdlod_uniforms);
+		}
+	};
+	render_patches(_patch, _selector.get_patches());
+	render_patches(_half_patch, _selector.get_half_patches());
+}
+
+void planet::cdlod_sphere::add_texture(std::string const &name, GLuint texture, GLenum type)
+{
+	_patch.add_texture(name, texture, type);
+	_half_patch.add_texture(name, texture, type);
+}
+
+void planet::benchmarkCDLOD()
+{
+	cdlod_parameters const parameters;
+	cdlod_selector selector(parameters);
+	auto const radius = parameters.radius;
+
+	// Looking at the horizon, and straight down, with the whole planet in
+	// front of the far plane.
+	auto const view_at = [radius](float altitude, bool down) {
+		auto const eye = glm::vec3(0.0f, radius + altitude, 0.0f);
+		auto const horizon = std::sqrt(altitude * (2.0f * radius + altitude));
+		auto const target = down ? glm::vec3(0.0f) : eye + glm::vec3(radius, -horizon, 0.0f);
+		auto const projection = glm::perspective(0.5f * glm::half_pi<float>(), 16.0f / 9.0f, 0.01f, altitude + 2.0f * radius);
+		return projection * glm::lookAt(eye, target, down ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+	};
+
+	LogInfo("CDLOD planet of radius %.0f, %u levels of %ux%u patches, at most %zu triangles", radius,
+	        parameters.levels_nb, parameters.patch_resolution, parameters.patch_resolution, selector.get_max_triangles_nb());
+	auto const selections_nb = 200u;
+	for (auto altitude = 0.001f * radius; altitude <= 100.0f * radius; altitude *= 10.0f)
+	{
+		for (auto const down : {false, true})
+		{
+			auto const world_to_clip = view_at(altitude, down);
+			auto const camera_position = glm::vec3(0.0f, radius + altitude, 0.0f);
+			auto const start = GetTimeMilliseconds();
+			for (auto i = 0u; i < selections_nb; ++i)
+				selector.select(camera_position, world_to_clip);
+			auto const duration = (GetTimeMilliseconds() - start) / selections_nb;
+
+			auto const &statistics = selector.get_statistics();
+			LogInfo("Altitude %9.2f, looking %-7s %6.3f ms: %5zu nodes visited, %4zu frustum culled, %4zu below the horizon, %4zu + %4zu quarter patches, %7zu triangles",
+			        altitude, down ? "down:" : "ahead:", duration, statistics.visited_nodes_nb, statistics.frustum_culled_nb,
+			        statistics.horizon_culled_nb, statistics.patches_nb, statistics.half_patches_nb, statistics.triangles_nb);
+		}
+	}
+
+	// The selection should not grow with the altitude, in any direction.
+	size_t max_triangles_nb = 0u;
+	auto max_altitude = 0.0f;
+	for (auto altitude = 0.0001f * radius; altitude <= 1000.0f * radius; altitude *= 1.25f)
+	{
+		for (auto const down : {false, true})
+		{
+			selector.select(glm::vec3(0.0f, radius + altitude, 0.0f), view_at(altitude, down));
+			if (selector.get_statistics().triangles_nb > max_triangles_nb)
+			{
+				max_triangles_nb = selector.get_statistics().triangles_nb;
+				max_altitude = altitude;
+			}
+		}
+	}
+	LogInfo("Largest selection from 0.0001 to 1000 radii of altitude: %zu triangles, at %.3f", max_triangles_nb, max_altitude);
+}
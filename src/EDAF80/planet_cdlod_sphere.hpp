@@ -0,0 +1,51 @@
+#pragma once
+
+#include "planet_cdlod.hpp"
+
+#include "core/node.hpp"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <string>
+
+namespace planet
+{
+	//! \brief `cdlod_selector` with the meshes to draw its selections.
+	//!
+	//! Patches are drawn instanced, with shaders like
+	//! planet_cdlod.vert which take the transforms of the patches in a
+	//! `mat4[100]` `vertex_model_to_world` array.
+	class cdlod_sphere
+	{
+	public:
+		//! \brief Create the meshes of the patches.
+		explicit cdlod_sphere(cdlod_parameters const &parameters);
+
+		//! \brief See `cdlod_selector::select()`.
+		void select(glm::vec3 const &camera_position, glm::mat4 const &world_to_clip);
+
+		//! \brief Draw the last selection.
+		//!
+		//! @param [in] world_to_clip matrix from world space to clip space
+		//! @param [in] program shader program, with a `mat4[100]`
+		//!             `vertex_model_to_world` array
+		//! @param [in] set_uniforms sets the other uniforms of `program`
+		void render(glm::mat4 const &world_to_clip, GLuint program,
+		            std::function<void(GLuint)> const &set_uniforms) const;
+
+		void add_texture(std::string const &name, GLuint texture, GLenum type);
+
+		cdlod_selector const &get_selector() const { return _selector; }
+
+	private:
+		cdlod_selector _selector;
+		Node _patch;
+		Node _half_patch;
+	};
+
+	//! \brief Time the selection from various altitudes, and log how many
+	//!        nodes it visits and selects and how many triangles they
+	//!        make, against `cdlod_selector::get_max_triangles_nb()`.
+	void benchmarkCDLOD();
+}
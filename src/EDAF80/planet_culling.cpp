@@ -0,0 +1,59 @@
+#include "planet_culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+planet::frustum::frustum(glm::mat4 const &world_to_clip)
+{
+	// Sums and differences of the last row of the matrix with the others.
+	for (auto i = 0u; i < 3u; ++i)
+	{
+		for (auto k = 0u; k < 2u; ++k)
+		{
+			auto const sign = k == 0u ? 1.0f : -1.0f;
+			auto const plane = glm::vec4(world_to_clip[0][3] + sign * world_to_clip[0][i],
+			                             world_to_clip[1][3] + sign * world_to_clip[1][i],
+			                             world_to_clip[2][3] + sign * world_to_clip[2][i],
+			                             world_to_clip[3][3] + sign * world_to_clip[3][i]);
+			_planes[2u * i + k] = plane / glm::length(glm::vec3(plane));
+		}
+	}
+}
+
+planet::frustum::intersection planet::frustum::test(glm::vec3 const &centre, float radius) const
+{
+	auto result = intersection::inside;
+	for (auto const &plane : _planes)
+	{
+		auto const distance = glm::dot(glm::vec3(plane), centre) + plane.w;
+		if (distance < -radius)
+			return intersection::outside;
+		if (distance < radius)
+			result = intersection::intersecting;
+	}
+	return result;
+}
+
+planet::horizon::horizon(glm::vec3 const &camera_position, float radius) : _camera_position(camera_position)
+{
+	auto const camera_distance = glm::length(camera_position);
+	_enabled = camera_distance > radius;
+	if (!_enabled)
+		return;
+
+	_axis = -camera_position / camera_distance;
+	_sin_angle = radius / camera_distance;
+	_cos_angle = std::sqrt(1.0f - _sin_angle * _sin_angle);
+	_distance = camera_distance - radius * _sin_angle;
+}
+
+bool planet::horizon::hides(glm::vec3 const &centre, float radius) const
+{
+	if (!_enabled)
+		return false;
+
+	auto const to_centre = centre - _camera_position;
+	auto const along_axis = glm::dot(to_centre, _axis);
+	auto const from_axis = std::sqrt(std::max(glm::dot(to_centre, to_centre) - along_axis * along_axis, 0.0f));
+	return along_axis - radius >= _distance && from_axis * _cos_angle - along_axis * _sin_angle <= -radius;
+}
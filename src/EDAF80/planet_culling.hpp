@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+namespace planet
+{
+	//! \brief Planes of a view frustum, to cull bounding spheres.
+	class frustum
+	{
+	public:
+		enum class intersection
+		{
+			outside,
+			intersecting,
+			inside
+		};
+
+		frustum() = default;
+
+		//! @param [in] world_to_clip matrix from world space to clip space
+		explicit frustum(glm::mat4 const &world_to_clip);
+
+		intersection test(glm::vec3 const &centre, float radius) const;
+
+	private:
+		std::array<glm::vec4, 6> _planes; // pointing inwards, normalised
+	};
+
+	//! \brief Horizon of a sphere centred on the origin, to cull bounding
+	//!        spheres hidden behind it.
+	//!
+	//! Everything inside the cone from the camera tangent to the sphere,
+	//! and beyond the plane of the tangent points, is hidden by it.
+	class horizon
+	{
+	public:
+		horizon() = default;
+
+		//! @param [in] camera_position position of the camera; nothing is
+		//!             hidden when it is inside the sphere
+		//! @param [in] radius radius of the occluding sphere
+		horizon(glm::vec3 const &camera_position, float radius);
+
+		bool hides(glm::vec3 const &centre, float radius) const;
+
+	private:
+		glm::vec3 _camera_position = glm::vec3(0.0f);
+		glm::vec3 _axis = glm::vec3(0.0f);
+		float _sin_angle = 0.0f;
+		float _cos_angle = 0.0f;
+		float _distance = 0.0f;
+		bool _enabled = false;
+	};
+}
@@ -0,0 +1,315 @@
+#include "planet_rocks.hpp"
+
+#include "parametric_shapes_modified.hpp"
+
+#include "core/Log.h"
+#include "core/Misc.h"
+#include "core/parallel.hpp"
+#include "core/poisson_disk.hpp"
+#include "core/random.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+	// Size of the `vertex_model_to_world` and `rock_warps` arrays of
+	// rock_instanced.vert; two arrays of 100 take as many uniforms as the
+	// single one of 200 in rock_on_sphr.vert.
+	constexpr size_t max_instances_nb = 100u;
+
+	// Margin on the bounding spheres, as the warped box is not exactly
+	// bounded by its warped corners and midpoints.
+	constexpr float bounds_margin = 1.05f;
+
+	// `rotate_by_dir()` of rock_on_sphr.vert: rotation of the flat world
+	// onto the sphere, at `angle` from the pole in `direction`.
+	glm::mat3 rotate_by_direction(float angle, glm::vec2 const &direction)
+	{
+		auto const axis = glm::vec3(-direction.y, 0.0f, direction.x);
+		auto const c = std::cos(-angle), s = std::sin(-angle);
+		return glm::mat3(glm::vec3(axis.x * axis.x + (1.0f - axis.x * axis.x) * c, axis.z * s, axis.x * axis.z * (1.0f - c)),
+		                 glm::vec3(-axis.z * s, c, axis.x * s),
+		                 glm::vec3(axis.x * axis.z * (1.0f - c), -axis.x * s, axis.z * axis.z + (1.0f - axis.z * axis.z) * c));
+	}
+
+	// Height above the sphere given by rock_on_sphr.vert to a height in the
+	// flat world.
+	float warp_height(float height, float planet_radius)
+	{
+		return planet_radius * std::exp(height * height * height / (3.0f * planet_radius)) - planet_radius;
+	}
+
+	// Rotation of rock_instanced.vert at a vertex of a baked rock: the one
+	// at its foot, then the one at its offset from the foot; the vertex is
+	// where it puts the pole, and its `exponent` gives the cubic in the
+	// exponent of the height profile there.
+	glm::mat3 bend_baked_rock(glm::vec3 const &local, glm::mat4 const &warp, float planet_radius, float &exponent)
+	{
+		auto const offset = glm::vec2(warp[0].w * local.x + warp[1].w * local.z, warp[1].w * local.x + warp[2].w * local.z);
+		auto const arc = glm::length(offset);
+		auto const direction = arc > 0.0f ? offset / arc : glm::vec2(0.0f);
+		exponent = ((warp[3].w * local.y + warp[3].z) * local.y + warp[3].y) * local.y + warp[3].x;
+		return glm::mat3(warp) * rotate_by_direction(std::min(glm::pi<float>(), arc / planet_radius), direction);
+	}
+
+	// Corners, edge and face midpoints, and centre of a box.
+	std::array<glm::vec3, 27> box_lattice(bonobo::bounding_box const &box)
+	{
+		std::array<glm::vec3, 27> points;
+		auto const middle = 0.5f * (box.min + box.max);
+		for (auto k = 0u; k < 27u; ++k)
+		{
+			auto const pick = [](unsigned int choice, float low, float centre, float high) {
+				return choice == 0u ? low : choice == 1u ? centre : high;
+			};
+			points[k] = glm::vec3(pick(k % 3u, box.min.x, middle.x, box.max.x),
+			                      pick(k / 3u % 3u, box.min.y, middle.y, box.max.y),
+			                      pick(k / 9u, box.min.z, middle.z, box.max.z));
+		}
+		return points;
+	}
+}
+
+glm::vec3 planet::warpRockVertex(glm::vec3 const &flat_position, float planet_radius)
+{
+	auto const horizontal = glm::vec2(flat_position.x, flat_position.z);
+	auto direction = glm::vec2(0.0f);
+	auto distance = 0.0f;
+	if (horizontal != glm::vec2(0.0f))
+	{
+		direction = glm::normalize(horizontal);
+		distance = glm::length(horizontal);
+	}
+	auto const radius = planet_radius + warp_height(flat_position.y, planet_radius);
+	auto const angle = std::min(glm::pi<float>(), distance / planet_radius);
+	return radius * glm::vec3(std::sin(angle) * direction.x, std::cos(angle), std::sin(angle) * direction.y);
+}
+
+glm::vec3 planet::warpBakedRockVertex(glm::mat4 const &transform, glm::mat4 const &warp, glm::vec3 const &vertex,
+                                      float planet_radius)
+{
+	auto exponent = 0.0f;
+	auto const rotation = bend_baked_rock(glm::vec3(transform * glm::vec4(vertex, 1.0f)), warp, planet_radius, exponent);
+	return planet_radius * std::exp(exponent) * rotation[1];
+}
+
+planet::rock_placements::rock_placements(float planet_radius) : _planet_radius(planet_radius), _transforms(), _warps(),
+                                                                _bounds(), _visible_transforms(), _visible_warps(),
+                                                                _statistics()
+{
+}
+
+void planet::rock_placements::bake(std::vector<glm::mat4> const &flat_transforms, bonobo::bounding_box const &mesh_bounds)
+{
+	auto const radius = _planet_radius;
+	auto const mesh_points = box_lattice(mesh_bounds);
+	auto const mesh_centre = 0.5f * (mesh_bounds.min + mesh_bounds.max);
+
+	_transforms.clear();
+	_warps.clear();
+	_bounds.clear();
+	_transforms.reserve(flat_transforms.size());
+	_warps.reserve(flat_transforms.size());
+	_bounds.reserve(flat_transforms.size());
+	for (auto const &flat_transform : flat_transforms)
+	{
+		auto const foot = glm::vec3(flat_transform[3]);
+		auto const horizontal = glm::vec2(foot.x, foot.z);
+		auto const distance = glm::length(horizontal);
+		auto const direction = distance > 0.0f ? horizontal / distance : glm::vec2(0.0f);
+		auto const angle = std::min(glm::pi<float>(), distance / radius);
+
+		// Offsets along the direction of the foot keep their length as
+		// arcs; those across it are shrunk by sin(phi) / phi, as parallels
+		// are.
+		auto const across_scale = angle > 1e-4f ? std::sin(angle) / angle : 1.0f;
+		auto const along_scale = 1.0f;
+
+		// Heights above the foot, t, are warped to R exp((f + t)^3 / 3R).
+		auto const f = foot.y;
+		auto warp = glm::mat4(rotate_by_direction(angle, direction));
+		warp[0].w = across_scale + (along_scale - across_scale) * direction.x * direction.x;
+		warp[1].w = (along_scale - across_scale) * direction.x * direction.y;
+		warp[2].w = across_scale + (along_scale - across_scale) * direction.y * direction.y;
+		warp[3] = glm::vec4(f * f * f / (3.0f * radius), f * f / radius, f / radius, 1.0f / (3.0f * radius));
+
+		auto const transform = glm::translate(glm::mat4(1.0f), -foot) * flat_transform;
+		_transforms.push_back(transform);
+		_warps.push_back(warp);
+
+		auto const centre = warpBakedRockVertex(transform, warp, mesh_centre, radius);
+		auto bounding_radius = 0.0f;
+		for (auto const &point : mesh_points)
+			bounding_radius = std::max(glm::length(warpBakedRockVertex(transform, warp, point, radius) - centre), bounding_radius);
+		_bounds.emplace_back(centre, bounds_margin * bounding_radius);
+	}
+	_visible_transforms.clear();
+	_visible_warps.clear();
+	_statistics = rock_statistics();
+	_statistics.instances_nb = _transforms.size();
+}
+
+void planet::rock_placements::cull(glm::vec3 const &camera_position, glm::mat4 const &world_to_clip)
+{
+	auto const view_frustum = frustum(world_to_clip);
+	auto const planet_horizon = horizon(camera_position, _planet_radius);
+
+	_visible_transforms.clear();
+	_visible_warps.clear();
+	_statistics = rock_statistics();
+	_statistics.instances_nb = _transforms.size();
+	for (size_t i = 0u; i < _transforms.size(); ++i)
+	{
+		auto const centre = glm::vec3(_bounds[i]);
+		auto const bounding_radius = _bounds[i].w;
+		if (view_frustum.test(centre, bounding_radius) == frustum::intersection::outside)
+			++_statistics.frustum_culled_nb;
+		else if (planet_horizon.hides(centre, bounding_radius))
+			++_statistics.horizon_culled_nb;
+		else
+		{
+			_visible_transforms.push_back(_transforms[i]);
+			_visible_warps.push_back(_warps[i]);
+		}
+	}
+	_statistics.visible_nb = _visible_transforms.size();
+}
+
+void planet::rock_placements::render(Node const &rock, glm::mat4 const &world_to_clip, GLuint program,
+                                     std::function<void(GLuint)> const &set_uniforms) const
+{
+	// The shader takes at most `max_instances_nb` rocks per draw.
+	std::vector<glm::mat4> instances;
+	for (size_t first = 0u; first < _visible_transforms.size(); first += max_instances_nb)
+	{
+		auto const last = std::min(first + max_instances_nb, _visible_transforms.size());
+		instances.assign(_visible_transforms.begin() + first, _visible_transforms.begin() + last);
+		auto const set_rock_uniforms = [&set_uniforms, first, last, this](GLuint program) {
+			set_uniforms(program);
+			glUniform1f(glGetUniformLocation(program, "planet_radius"), _planet_radius);
+			glUniformMatrix4fv(glGetUniformLocation(program, "rock_warps"), static_cast<GLsizei>(last - first), GL_FALSE,
+			                   glm::value_ptr(_visible_warps[first]));
+		};
+		rock.renderInstanced(world_to_clip, glm::mat4(1.0f), instances, program, set_rock_uniforms);
+	}
+}
+
+void planet::benchmarkRockPlacements()
+{
+	auto const planet_radius = 50.0f;
+	auto const rock = parametric_shapes::buildIcosphere(3u, 1.0f);
+	auto const vertices_nb = rock.vertices.get_vertices_nb();
+
+	// Rocks all over the flat world, which wraps around the whole planet,
+	// as blue noise: about 200 of them, none where the camera stands.
+	auto const world_radius = 0.95f * glm::pi<float>() * planet_radius;
+	bonobo::poisson_disk_parameters scattering;
+	scattering.min_distance = 18.0f;
+	scattering.exclusion_zones.emplace_back(0.0f, 0.0f, 0.0f, 5.0f);
+	auto const positions = bonobo::poisson_disk_rectangle(glm::vec2(-world_radius), glm::vec2(world_radius), scattering);
+
+	bonobo::xoshiro256ss generator(1u);
+	std::vector<glm::mat4> flat_transforms;
+	for (auto const &position : positions)
+	{
+		if (glm::length(position) > world_radius)
+			continue;
+		auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(position.x, generator.next_float() - 0.5f, position.y));
+		transform = glm::rotate(transform, glm::two_pi<float>() * generator.next_float(), glm::vec3(0.0f, 1.0f, 0.0f));
+		flat_transforms.push_back(glm::scale(transform, glm::vec3(0.5f + 1.5f * generator.next_float(), 0.5f + generator.next_float(),
+		                                                          0.5f + 1.5f * generator.next_float())));
+	}
+	auto const rocks_nb = flat_transforms.size();
+
+	rock_placements placements(planet_radius);
+	auto start = GetTimeMilliseconds();
+	placements.bake(flat_transforms, rock.bounds);
+	auto const bake_duration = GetTimeMilliseconds() - start;
+
+	// Distance between the baked and warped vertices, against the size of
+	// the rocks.
+	auto max_error = 0.0f, total_error = 0.0f;
+	for (size_t i = 0u; i < flat_transforms.size(); ++i)
+	{
+		auto rock_error = 0.0f;
+		for (size_t v = 0u; v < vertices_nb; ++v)
+		{
+			auto const vertex = rock.vertices.get<bonobo::shader_bindings::vertices>(v);
+			auto const warped = warpRockVertex(glm::vec3(flat_transforms[i] * glm::vec4(vertex, 1.0f)), planet_radius);
+			auto const baked = warpBakedRockVertex(placements.get_transforms()[i], placements.get_warps()[i], vertex, planet_radius);
+			rock_error = std::max(glm::length(baked - warped), rock_error);
+		}
+		rock_error /= placements.get_bounds()[i].w;
+		max_error = std::max(rock_error, max_error);
+		total_error += rock_error;
+	}
+	LogInfo("Baked %zu rocks in %.3f ms; vertices are off by %.2f%% of the size of their rock on average, %.2f%% at most",
+	        rocks_nb, bake_duration, 100.0f * total_error / rocks_nb, 100.0f * max_error);
+
+	// What each vertex shader does, on the CPU.
+	auto warp_checksum = 0.0f, baked_checksum = 0.0f;
+	start = GetTimeMilliseconds();
+	for (auto const &flat_transform : flat_transforms)
+	{
+		for (size_t v = 0u; v < vertices_nb; ++v)
+		{
+			auto const normal_model_to_world = glm::transpose(glm::inverse(glm::mat3(flat_transform)));
+			auto const flat = glm::vec3(flat_transform * glm::vec4(rock.vertices.get<bonobo::shader_bindings::vertices>(v), 1.0f));
+			auto const horizontal = glm::vec2(flat.x, flat.z);
+			auto const direction = horizontal != glm::vec2(0.0f) ? glm::normalize(horizontal) : glm::vec2(0.0f);
+			auto const rotation = rotate_by_direction(std::min(glm::pi<float>(), glm::length(horizontal) / planet_radius), direction);
+			auto const normal = rotation * normal_model_to_world * rock.vertices.get<bonobo::shader_bindings::normals>(v);
+			warp_checksum += warpRockVertex(flat, planet_radius).y + normal.y;
+		}
+	}
+	auto const warp_duration = GetTimeMilliseconds() - start;
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < rocks_nb; ++i)
+	{
+		auto const &transform = placements.get_transforms()[i];
+		auto const &warp = placements.get_warps()[i];
+		for (size_t v = 0u; v < vertices_nb; ++v)
+		{
+			auto const m = glm::mat3(transform);
+			auto const cofactors = glm::mat3(glm::cross(m[1], m[2]), glm::cross(m[2], m[0]), glm::cross(m[0], m[1]));
+			auto const local = glm::vec3(transform * glm::vec4(rock.vertices.get<bonobo::shader_bindings::vertices>(v), 1.0f));
+			auto exponent = 0.0f;
+			auto const rotation = bend_baked_rock(local, warp, planet_radius, exponent);
+			auto const normal = rotation * cofactors * rock.vertices.get<bonobo::shader_bindings::normals>(v) / glm::dot(m[0], cofactors[0]);
+			baked_checksum += planet_radius * std::exp(exponent) * rotation[1].y + normal.y;
+		}
+	}
+	auto const baked_duration = GetTimeMilliseconds() - start;
+	auto const vertices_per_ms = 1e-6 * rocks_nb * vertices_nb;
+	LogInfo("Per vertex on the CPU: %.1f ns warping, %.1f ns with baked warps, %.1fx (checksums %.0f, %.0f)",
+	        warp_duration / vertices_per_ms, baked_duration / vertices_per_ms, warp_duration / baked_duration,
+	        warp_checksum, baked_checksum);
+
+	// Before, every rock was drawn.
+	auto const projection = glm::perspective(0.5f * glm::half_pi<float>(), 16.0f / 9.0f, 0.01f, 1000.0f);
+	for (auto const altitude : {2.0f, 20.0f, 200.0f})
+	{
+		auto const eye = glm::vec3(0.0f, planet_radius + altitude, 0.0f);
+		auto const horizon_distance = std::sqrt(altitude * (2.0f * planet_radius + altitude));
+		auto const view = glm::lookAt(eye, eye + glm::vec3(planet_radius, -horizon_distance, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		placements.cull(eye, projection * view);
+		auto const &statistics = placements.get_statistics();
+		LogInfo("Altitude %5.0f: %3zu of %zu rocks drawn, %zu vertices instead of %zu; %zu out of the frustum, %zu below the horizon",
+		        altitude, statistics.visible_nb, statistics.instances_nb, statistics.visible_nb * vertices_nb,
+		        statistics.instances_nb * vertices_nb, statistics.frustum_culled_nb, statistics.horizon_culled_nb);
+	}
+
+	// Scattering at the scale of an asteroid field.
+	bonobo::poisson_disk_parameters field;
+	field.min_distance = 0.1f;
+	start = GetTimeMilliseconds();
+	auto const field_points = bonobo::poisson_disk_sphere(35.0f, field);
+	LogInfo("Scattered %zu points over a sphere in %.1f ms, using %zu threads", field_points.size(),
+	        GetTimeMilliseconds() - start, bonobo::get_worker_threads_nb());
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "planet_culling.hpp"
+
+#include "core/mesh_cpu.hpp"
+#include "core/node.hpp"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace planet
+{
+	//! \brief What the last `rock_placements::cull()` did.
+	struct rock_statistics
+	{
+		size_t instances_nb = 0u;
+		size_t frustum_culled_nb = 0u;
+		size_t horizon_culled_nb = 0u;
+		size_t visible_nb = 0u;
+	};
+
+	//! \brief Rocks placed on the flat world and warped onto the planet,
+	//!        with the parameters of the warp baked per rock.
+	//!
+	//! rock_on_sphr.vert works out, for every vertex of every rock and
+	//! every frame, the rotation of the flat world onto the sphere at that
+	//! vertex, and inverts its normal matrix, although rocks never move.
+	//! `bake()` does what only depends on the rock once: its transform
+	//! relative to its foot, and a warp matrix holding the rotation at the
+	//! foot, the scales of the arcs along and across the direction of the
+	//! foot, and the coefficients of the cubic in the exponent of the
+	//! height profile. rock_instanced.vert, like `warpBakedRockVertex()`,
+	//! then only bends each vertex around the foot, with the exact profile.
+	//!
+	//! With a bounding sphere per rock, `cull()` keeps the rocks in the
+	//! frustum and above the horizon.
+	class rock_placements
+	{
+	public:
+		//! @param [in] planet_radius value of the `planet_radius` uniform
+		explicit rock_placements(float planet_radius);
+
+		//! \brief Warp rocks onto the planet; call again when they change.
+		//!
+		//! @param [in] flat_transforms transforms of the rocks in the flat
+		//!             world, as given to rock_on_sphr.vert
+		//! @param [in] mesh_bounds bounds of the rock mesh, in model space
+		void bake(std::vector<glm::mat4> const &flat_transforms, bonobo::bounding_box const &mesh_bounds);
+
+		//! \brief Keep the rocks which can be seen from the camera.
+		//!
+		//! @param [in] camera_position position of the camera
+		//! @param [in] world_to_clip matrix from world space to clip space
+		void cull(glm::vec3 const &camera_position, glm::mat4 const &world_to_clip);
+
+		//! \brief Draw the rocks kept by the last `cull()`.
+		//!
+		//! @param [in] rock node with the rock mesh and textures
+		//! @param [in] world_to_clip matrix from world space to clip space
+		//! @param [in] program shader program, with the `mat4[100]`
+		//!             `vertex_model_to_world` and `rock_warps` arrays of
+		//!             rock_instanced.vert
+		//! @param [in] set_uniforms sets the other uniforms of `program`
+		void render(Node const &rock, glm::mat4 const &world_to_clip, GLuint program,
+		            std::function<void(GLuint)> const &set_uniforms) const;
+
+		//! \brief Transforms of all rocks, from model space to the flat
+		//!        world, relative to their foot.
+		std::vector<glm::mat4> const &get_transforms() const { return _transforms; }
+
+		//! \brief Warp matrices of all rocks, see `warpBakedRockVertex()`.
+		std::vector<glm::mat4> const &get_warps() const { return _warps; }
+
+		//! \brief Bounding spheres of all rocks, as centre and radius.
+		std::vector<glm::vec4> const &get_bounds() const { return _bounds; }
+
+		//! \brief Transforms of the rocks kept by the last `cull()`.
+		std::vector<glm::mat4> const &get_visible_transforms() const { return _visible_transforms; }
+
+		//! \brief Warp matrices of the rocks kept by the last `cull()`.
+		std::vector<glm::mat4> const &get_visible_warps() const { return _visible_warps; }
+
+		rock_statistics const &get_statistics() const { return _statistics; }
+
+	private:
+		float _planet_radius;
+		std::vector<glm::mat4> _transforms;
+		std::vector<glm::mat4> _warps;
+		std::vector<glm::vec4> _bounds;
+		std::vector<glm::mat4> _visible_transforms;
+		std::vector<glm::mat4> _visible_warps;
+		rock_statistics _statistics;
+	};
+
+	//! \brief Where rock_on_sphr.vert puts a point of the flat world.
+	glm::vec3 warpRockVertex(glm::vec3 const &flat_position, float planet_radius);
+
+	//! \brief Where rock_instanced.vert puts a vertex of a baked rock.
+	//!
+	//! @param [in] transform transform of the rock, from
+	//!             `rock_placements::get_transforms()`
+	//! @param [in] warp warp matrix of the rock, from
+	//!             `rock_placements::get_warps()`
+	//! @param [in] vertex vertex of the rock, in model space
+	//! @param [in] planet_radius radius the rocks were baked with
+	glm::vec3 warpBakedRockVertex(glm::mat4 const &transform, glm::mat4 const &warp, glm::vec3 const &vertex,
+	                              float planet_radius);
+
+	//! \brief Compare baked rocks with rock_on_sphr.vert: log how far their
+	//!        vertices are from the warped ones, how long both take per
+	//!        vertex when emulated on the CPU, and how many rocks are left
+	//!        to draw from a few viewpoints; then time the scattering of
+	//!        about a million points over a sphere.
+	void benchmarkRockPlacements();
+}
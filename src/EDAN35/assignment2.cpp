@@ -6,7 +6,11 @@
 
 #include "config.hpp"
 #include "core/Bonobo.h"
+#include "core/CompactTRSTransform.h"
+#include "core/cpu_dispatch.hpp"
+#include "core/draw_commands.hpp"
 #include "core/FPSCamera.h"
+#include "core/geometry_arena.hpp"
 #include "core/GLStateInspection.h"
 #include "core/GLStateInspectionView.h"
 #include "core/helpers.hpp"
@@ -14,7 +18,13 @@
 #include "core/LogView.h"
 #include "core/Misc.h"
 #include "core/node.hpp"
+#include "core/poisson_disk.hpp"
+#include "core/quantization.hpp"
+#include "core/random.hpp"
 #include "core/ShaderProgramManager.hpp"
+#include "core/simd.hpp"
+#include "core/static_shapes.hpp"
+#include "core/transforms.hpp"
 
 #include <imgui.h>
 #include <external/imgui_impl_glfw_gl3.h>
@@ -23,6 +33,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <tinyfiledialogs.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <stdexcept>
@@ -49,8 +60,6 @@ namespace constant
 	constexpr float  light_cutoff        = 0.05f;
 }
 
-static bonobo::mesh_data loadCone();
-
 edan35::Assignment2::Assignment2() :
 	mCamera(0.5f * glm::half_pi<float>(),
 	        static_cast<float>(config::resolution_x) / static_cast<float>(config::resolution_y),
@@ -86,12 +95,25 @@ edan35::Assignment2::~Assignment2()
 void
 edan35::Assignment2::run()
 {
-	// Load the geometry of Sponza
-	auto const sponza_geometry = bonobo::loadObjects("../crysponza/sponza.obj");
+	// Load the geometry of Sponza; all its meshes share the buffers of a
+	// single arena, with quantised vertex attributes.
+	bonobo::geometry_arena static_geometry(bonobo::get_compact_vertex_layout(), 1u << 18, 1u << 20);
+	bonobo::mesh_options sponza_options;
+	sponza_options.precision = bonobo::vertex_precision::compact;
+	sponza_options.optimize = true;
+	auto const sponza_geometry = bonobo::loadObjects("../crysponza/sponza.obj", &static_geometry, sponza_options);
 	if (sponza_geometry.empty()) {
 		LogError("Failed to load the Sponza model");
 		return;
 	}
+	auto const vertices_stats = static_geometry.get_vertices_statistics();
+	auto const indices_stats = static_geometry.get_indices_statistics();
+	LogInfo("Static geometry arena: %u/%u vertices (%u KiB, %u KiB at full precision) and %u/%u indices used, in %u meshes",
+	        vertices_stats.used, vertices_stats.capacity,
+	        static_cast<unsigned int>(vertices_stats.used * bonobo::compact_vertex_format::stride() / 1024u),
+	        static_cast<unsigned int>(vertices_stats.used * bonobo::standard_vertex_format::stride() / 1024u),
+	        indices_stats.used, indices_stats.capacity,
+	        vertices_stats.allocations_nb);
 	std::vector<Node> sponza_elements;
 	sponza_elements.reserve(sponza_geometry.size());
 	for (auto const& shape : sponza_geometry) {
@@ -100,7 +122,46 @@ edan35::Assignment2::run()
 		sponza_elements.push_back(node);
 	}
 
-	auto const cone_geometry = loadCone();
+	// Group Sponza's meshes by material, i.e. by set of textures. Opaque
+	// materials come first, so that all opaque meshes can be drawn at once
+	// in passes which do not need their textures.
+	std::vector<bonobo::texture_bindings> materials;
+	std::vector<uint32_t> sponza_materials(sponza_geometry.size(), 0u);
+	size_t opaque_materials_nb = 0u;
+	for (auto const alpha_tested : { false, true }) {
+		for (size_t i = 0u; i < sponza_geometry.size(); ++i) {
+			auto const& bindings = sponza_geometry[i].bindings;
+			if ((bindings.find("opacity_texture") != bindings.end()) != alpha_tested)
+				continue;
+			auto const material = std::find(materials.begin(), materials.end(), bindings);
+			sponza_materials[i] = static_cast<uint32_t>(material - materials.begin());
+			if (material == materials.end())
+				materials.push_back(bindings);
+		}
+		if (!alpha_tested)
+			opaque_materials_nb = materials.size();
+	}
+
+	bonobo::draw_command_builder sponza_commands;
+	for (size_t i = 0u; i < sponza_geometry.size(); ++i)
+		sponza_commands.add(sponza_geometry[i], sponza_materials[i], sponza_elements[i].get_transform());
+	sponza_commands.build();
+	size_t opaque_commands_nb = 0u;
+	for (auto const& batch : sponza_commands.get_batches())
+		if (batch.material < opaque_materials_nb)
+			opaque_commands_nb += batch.commands_nb;
+	LogInfo("Sponza: %u draw commands in %u material batches",
+	        static_cast<unsigned int>(sponza_commands.get_commands().size()),
+	        static_cast<unsigned int>(sponza_commands.get_batches().size()));
+
+	bonobo::indirect_draw_buffer sponza_draws;
+	sponza_draws.attach(static_geometry.get_vao());
+	sponza_draws.upload(sponza_commands);
+
+	// The light volume is generated at compile time: only its upload runs
+	// here.
+	static constexpr auto light_cone = bonobo::static_shapes::make_cone<16u>();
+	auto const cone_geometry = bonobo::static_shapes::upload_mesh(light_cone);
 	Node cone;
 	cone.set_geometry(cone_geometry);
 
@@ -124,21 +185,21 @@ edan35::Assignment2::run()
 		return;
 	}
 
-	GLuint fill_gbuffer_shader = 0u;
-	program_manager.CreateAndRegisterProgram({ { ShaderType::vertex, "EDAN35/fill_gbuffer.vert" },
+	GLuint fill_gbuffer_indirect_shader = 0u;
+	program_manager.CreateAndRegisterProgram({ { ShaderType::vertex, "EDAN35/fill_gbuffer_indirect.vert" },
 	                                           { ShaderType::fragment, "EDAN35/fill_gbuffer.frag" } },
-	                                         fill_gbuffer_shader);
-	if (fill_gbuffer_shader == 0u) {
-		LogError("Failed to load G-buffer filling shader");
+	                                         fill_gbuffer_indirect_shader);
+	if (fill_gbuffer_indirect_shader == 0u) {
+		LogError("Failed to load indirect G-buffer filling shader");
 		return;
 	}
 
-	GLuint fill_shadowmap_shader = 0u;
-	program_manager.CreateAndRegisterProgram({ { ShaderType::vertex, "EDAN35/fill_shadowmap.vert" },
+	GLuint fill_shadowmap_indirect_shader = 0u;
+	program_manager.CreateAndRegisterProgram({ { ShaderType::vertex, "EDAN35/fill_shadowmap_indirect.vert" },
 	                                           { ShaderType::fragment, "EDAN35/fill_shadowmap.frag" } },
-	                                         fill_shadowmap_shader);
-	if (fill_shadowmap_shader == 0u) {
-		LogError("Failed to load shadowmap filling shader");
+	                                         fill_shadowmap_indirect_shader);
+	if (fill_shadowmap_indirect_shader == 0u) {
+		LogError("Failed to load indirect shadowmap filling shader");
 		return;
 	}
 
@@ -209,6 +270,46 @@ edan35::Assignment2::run()
 		GLfloat border_color[4] = { 1.0f, 0.0f, 0.0f, 0.0f};
 		glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, border_color);
 	});
+	// Textures of a material are bound to the first units, in a fixed
+	// order; the buffer texture holding per-draw transforms comes after.
+	std::array<char const*, 4> const material_textures = { "diffuse_texture", "specular_texture", "normals_texture", "opacity_texture" };
+	auto const draw_transforms_unit = static_cast<GLuint>(material_textures.size());
+	auto const bind_material = [&materials, &material_textures](GLuint program, uint32_t material){
+		auto const& bindings = materials[material];
+		for (size_t i = 0u; i < material_textures.size(); ++i) {
+			auto const texture = bindings.find(material_textures[i]);
+			auto const is_present = texture != bindings.end();
+			glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+			glBindTexture(GL_TEXTURE_2D, is_present ? texture->second : 0u);
+			glUniform1i(glGetUniformLocation(program, material_textures[i]), static_cast<GLint>(i));
+			glUniform1i(glGetUniformLocation(program, (std::string("has_") + material_textures[i]).c_str()), is_present ? 1 : 0);
+		}
+	};
+	auto const draw_sponza_batches = [&](GLuint program, glm::mat4 const& world_to_clip, size_t first_batch){
+		glUseProgram(program);
+		glUniformMatrix4fv(glGetUniformLocation(program, "vertex_world_to_clip"), 1, GL_FALSE, glm::value_ptr(world_to_clip));
+		// Normals are already brought to world-space by the vertex shader,
+		// with the per-draw normal transforms.
+		glUniformMatrix4fv(glGetUniformLocation(program, "normal_model_to_world"), 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+		glBindVertexArray(static_geometry.get_vao());
+		auto const& batches = sponza_commands.get_batches();
+		for (size_t i = first_batch; i < batches.size(); ++i) {
+			bind_material(program, batches[i].material);
+			sponza_draws.submit(program, draw_transforms_unit, batches[i].first_command, batches[i].commands_nb);
+		}
+		glBindVertexArray(0u);
+		for (size_t i = 0u; i < material_textures.size(); ++i) {
+			glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+			glBindTexture(GL_TEXTURE_2D, 0u);
+		}
+		glUseProgram(0u);
+	};
+	auto const first_alpha_tested_batch = static_cast<size_t>(
+		std::count_if(sponza_commands.get_batches().begin(), sponza_commands.get_batches().end(),
+		              [opaque_materials_nb](bonobo::draw_command_builder::batch const& batch){
+		                  return batch.material < opaque_materials_nb;
+		              }));
+
 	auto const bind_texture_with_sampler = [](GLenum target, unsigned int slot, GLuint program, std::string const& name, GLuint texture, GLuint sampler){
 		glActiveTexture(GL_TEXTURE0 + slot);
 		glBindTexture(target, texture);
@@ -220,28 +321,30 @@ edan35::Assignment2::run()
 	//
 	// Setup lights properties
 	//
-	std::array<TRSTransform<float, glm::defaultp>, constant::lights_nb> lightTransforms;
+	std::array<CompactTRSTransform<float, glm::defaultp>, constant::lights_nb> lightTransforms;
 	std::array<glm::vec3, constant::lights_nb> lightColors;
 	int lights_nb = static_cast<int>(constant::lights_nb);
 	bool are_lights_paused = false;
 
-	for (size_t i = 0; i < static_cast<size_t>(lights_nb); ++i) {
+	for (size_t i = 0; i < static_cast<size_t>(lights_nb); ++i)
 		lightTransforms[i].SetTranslate(glm::vec3(0.0f, 125.0f, 0.0f));
-		lightColors[i] = glm::vec3(0.5f + 0.5f * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX)),
-		                           0.5f + 0.5f * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX)),
-		                           0.5f + 0.5f * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX)));
-	}
+	bonobo::fill_uniform(bonobo::random_generator(), lightColors.data(), lightColors.size(), glm::vec3(0.5f), glm::vec3(1.0f));
 
-	TRSTransform<f32, glm::defaultp> coneScaleTransform = TRSTransform<f32, glm::defaultp>();
+	CompactTRSTransform<f32, glm::defaultp> coneScaleTransform;
 	coneScaleTransform.SetScale(glm::vec3(std::sqrt(constant::light_intensity / constant::light_cutoff)));
 
-	TRSTransform<f32, glm::defaultp> lightOffsetTransform = TRSTransform<f32, glm::defaultp>();
+	CompactTRSTransform<f32, glm::defaultp> lightOffsetTransform;
 	lightOffsetTransform.SetTranslate(glm::vec3(0.0f, 0.0f, -40.0f));
 
 	auto lightProjection = glm::perspective(0.5f * glm::pi<float>(),
 	                                        static_cast<float>(constant::shadowmap_res_x) / static_cast<float>(constant::shadowmap_res_y),
 	                                        1.0f, 10000.0f);
 
+	// The parts of the light and cone matrices which are the same for all
+	// lights and frames.
+	auto const lightOffsetProjection = lightProjection * lightOffsetTransform.GetMatrixInverse();
+	auto const coneOffsetScaling = lightOffsetTransform.GetMatrix() * coneScaleTransform.GetMatrix();
+
 
 	auto seconds_nb = 0.0f;
 
@@ -313,8 +416,8 @@ edan35::Assignment2::run()
 
 			GLStateInspection::CaptureSnapshot("Filling Pass");
 
-			for (auto const& element : sponza_elements)
-				element.render(mCamera.GetWorldToClipMatrix(), element.get_transform(), fill_gbuffer_shader, set_uniforms);
+			// One indirect submission per material
+			draw_sponza_batches(fill_gbuffer_indirect_shader, mCamera.GetWorldToClipMatrix(), 0u);
 
 
 
@@ -331,7 +434,7 @@ edan35::Assignment2::run()
 				auto& lightTransform = lightTransforms[i];
 				lightTransform.SetRotate(seconds_nb * 0.1f + i * 1.57f, glm::vec3(0.0f, 1.0f, 0.0f));
 
-				auto light_matrix = lightProjection * lightOffsetTransform.GetMatrixInverse() * lightTransform.GetMatrixInverse();
+				auto light_matrix = lightOffsetProjection * lightTransform.GetMatrixInverse();
 
 				//
 				// Pass 2.1: Generate shadow map for light i
@@ -342,8 +445,16 @@ edan35::Assignment2::run()
 
 				GLStateInspection::CaptureSnapshot("Shadow Map Generation");
 
-				for (auto const& element : sponza_elements)
-					element.render(light_matrix, glm::mat4(1.0f), fill_gbuffer_shader, set_uniforms);
+				// All opaque meshes in a single submission, as no texture
+				// is needed; alpha-tested ones still need their opacity
+				// texture, so they are drawn per material.
+				glUseProgram(fill_shadowmap_indirect_shader);
+				glUniformMatrix4fv(glGetUniformLocation(fill_shadowmap_indirect_shader, "vertex_world_to_clip"), 1, GL_FALSE, glm::value_ptr(light_matrix));
+				glBindVertexArray(static_geometry.get_vao());
+				sponza_draws.submit(fill_shadowmap_indirect_shader, draw_transforms_unit, 0u, opaque_commands_nb);
+				glBindVertexArray(0u);
+				glUseProgram(0u);
+				draw_sponza_batches(fill_gbuffer_indirect_shader, light_matrix, first_alpha_tested_batch);
 
 
 				glEnable(GL_BLEND);
@@ -386,7 +497,7 @@ edan35::Assignment2::run()
 				GLStateInspection::CaptureSnapshot("Accumulating");
 
 				cone.render(mCamera.GetWorldToClipMatrix(),
-				            lightTransform.GetMatrix() * lightOffsetTransform.GetMatrix() * coneScaleTransform.GetMatrix(),
+				            lightTransform.GetMatrix() * coneOffsetScaling,
 				            accumulate_lights_shader, spotlight_set_uniforms);
 
 				glBindSampler(2u, 0u);
@@ -433,7 +544,7 @@ edan35::Assignment2::run()
 //		for (size_t i = 0; i < lights_nb; ++i) {
 //			cone.render(mCamera.GetWorldToClipMatrix(),
 //			            lightTransforms[i].GetMatrix() * lightOffsetTransform.GetMatrix() * coneScaleTransform.GetMatrix(),
-//			            fill_shadowmap_shader, set_uniforms);
+//			            fallback_shader, set_uniforms);
 //		}
 //		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
@@ -467,6 +578,18 @@ edan35::Assignment2::run()
 			ImGui::Checkbox("Pause lights", &are_lights_paused);
 			ImGui::SliderInt("Number of lights", &lights_nb, 1, static_cast<int>(constant::lights_nb));
 			ImGui::Checkbox("Show textures", &show_textures);
+			if (ImGui::Button("Benchmark random numbers"))
+				bonobo::benchmark_random();
+			if (ImGui::Button("Benchmark transforms"))
+				bonobo::benchmark_transforms();
+			if (ImGui::Button("Benchmark SoA kernels"))
+				bonobo::benchmark_simd();
+			if (ImGui::Button("Benchmark CPU kernels"))
+				bonobo::benchmark_cpu_kernels();
+			if (ImGui::Button("Benchmark draw commands"))
+				bonobo::benchmark_draw_commands();
+			if (ImGui::Button("Benchmark Poisson disk sampling"))
+				bonobo::benchmark_poisson_disk();
 		}
 		ImGui::End();
 
@@ -483,10 +606,10 @@ edan35::Assignment2::run()
 	resolve_deferred_shader = 0u;
 	glDeleteProgram(accumulate_lights_shader);
 	accumulate_lights_shader = 0u;
-	glDeleteProgram(fill_shadowmap_shader);
-	fill_shadowmap_shader = 0u;
-	glDeleteProgram(fill_gbuffer_shader);
-	fill_gbuffer_shader = 0u;
+	glDeleteProgram(fill_shadowmap_indirect_shader);
+	fill_shadowmap_indirect_shader = 0u;
+	glDeleteProgram(fill_gbuffer_indirect_shader);
+	fill_gbuffer_indirect_shader = 0u;
 	glDeleteProgram(fallback_shader);
 	fallback_shader = 0u;
 }
@@ -502,97 +625,3 @@ int main()
 	}
 	Bonobo::Destroy();
 }
-
-static
-bonobo::mesh_data
-loadCone()
-{
-	bonobo::mesh_data cone;
-	cone.vertices_nb = 65;
-	cone.drawing_mode = GL_TRIANGLE_STRIP;
-	float vertexArrayData[65 * 3] = {
-		0.f, 1.f, -1.f,
-		0.f, 0.f, 0.f,
-		0.38268f, 0.92388f, -1.f,
-		0.f, 0.f, 0.f,
-		0.70711f, 0.70711f, -1.f,
-		0.f, 0.f, 0.f,
-		0.92388f, 0.38268f, -1.f,
-		0.f, 0.f, 0.f,
-		1.f, 0.f, -1.f,
-		0.f, 0.f, 0.f,
-		0.92388f, -0.38268f, -1.f,
-		0.f, 0.f, 0.f,
-		0.70711f, -0.70711f, -1.f,
-		0.f, 0.f, 0.f,
-		0.38268f, -0.92388f, -1.f,
-		0.f, 0.f, 0.f,
-		0.f, -1.f, -1.f,
-		0.f, 0.f, 0.f,
-		-0.38268f, -0.92388f, -1.f,
-		0.f, 0.f, 0.f,
-		-0.70711f, -0.70711f, -1.f,
-		0.f, 0.f, 0.f,
-		-0.92388f, -0.38268f, -1.f,
-		0.f, 0.f, 0.f,
-		-1.f, 0.f, -1.f,
-		0.f, 0.f, 0.f,
-		-0.92388f, 0.38268f, -1.f,
-		0.f, 0.f, 0.f,
-		-0.70711f, 0.70711f, -1.f,
-		0.f, 0.f, 0.f,
-		-0.38268f, 0.92388f, -1.f,
-		0.f, 1.f, -1.f,
-		0.f, 1.f, -1.f,
-		0.38268f, 0.92388f, -1.f,
-		0.f, 1.f, -1.f,
-		0.70711f, 0.70711f, -1.f,
-		0.f, 0.f, -1.f,
-		0.92388f, 0.38268f, -1.f,
-		0.f, 0.f, -1.f,
-		1.f, 0.f, -1.f,
-		0.f, 0.f, -1.f,
-		0.92388f, -0.38268f, -1.f,
-		0.f, 0.f, -1.f,
-		0.70711f, -0.70711f, -1.f,
-		0.f, 0.f, -1.f,
-		0.38268f, -0.92388f, -1.f,
-		0.f, 0.f, -1.f,
-		0.f, -1.f, -1.f,
-		0.f, 0.f, -1.f,
-		-0.38268f, -0.92388f, -1.f,
-		0.f, 0.f, -1.f,
-		-0.70711f, -0.70711f, -1.f,
-		0.f, 0.f, -1.f,
-		-0.92388f, -0.38268f, -1.f,
-		0.f, 0.f, -1.f,
-		-1.f, 0.f, -1.f,
-		0.f, 0.f, -1.f,
-		-0.92388f, 0.38268f, -1.f,
-		0.f, 0.f, -1.f,
-		-0.70711f, 0.70711f, -1.f,
-		0.f, 0.f, -1.f,
-		-0.38268f, 0.92388f, -1.f,
-		0.f, 0.f, -1.f,
-		0.f, 1.f, -1.f,
-		0.f, 0.f, -1.f
-	};
-
-	glGenVertexArrays(1, &cone.vao);
-	assert(cone.vao != 0u);
-	glBindVertexArray(cone.vao);
-	{
-		glGenBuffers(1, &cone.bo);
-		assert(cone.bo != 0u);
-		glBindBuffer(GL_ARRAY_BUFFER, cone.bo);
-		glBufferData(GL_ARRAY_BUFFER, cone.vertices_nb * 3 * sizeof(float), vertexArrayData, GL_STATIC_DRAW);
-
-		glVertexAttribPointer(static_cast<int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(0x0));
-		glEnableVertexAttribArray(static_cast<int>(bonobo::shader_bindings::vertices));
-
-		glBindBuffer(GL_ARRAY_BUFFER, 0u);
-	}
-	glBindVertexArray(0u);
-
-	return cone;
-}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/io.hpp>
+
+#include <iostream>
+
+/**
+ * A TRS-transform like TRSTransform, M = T * R * S, with the same interface,
+ * but which stores its rotation as a unit quaternion rather than a 3x3
+ * matrix: 40 bytes of state for floats instead of 60.
+ *
+ * GetMatrix() and GetMatrixInverse() are cached, and only rebuilt after the
+ * transform changes; the inverse is built directly as S^-1 * R^T * T^-1
+ * rather than through a general 4x4 inverse. Both are returned by
+ * reference, which stays valid until the next change.
+ *
+ * Rotations compose as in TRSTransform: RotateX(), RotateY() and RotateZ()
+ * rotate around the parent's axes, Rotate() around the transform's own;
+ * the quaternion is renormalised after each of them so that repeated
+ * rotations do not drift.
+ *
+ * For arrays of transforms, see the batched functions in transforms.hpp.
+ */
+template<typename T, glm::precision P>
+class CompactTRSTransform {
+
+public:
+	CompactTRSTransform();
+
+public:
+	/* Reset the transformation to the identity matrix */
+	void ResetTransform();
+
+		/* Relative transformations */
+
+	void Translate(glm::tvec3<T, P> v);
+	void Scale(glm::tvec3<T, P> v);
+	void Scale(T uniform);
+
+	/* Rotate around vector (x, y, z) */
+	void Rotate(T angle, glm::tvec3<T, P> v);
+	void RotateX(T angle);
+	void RotateY(T angle);
+	void RotateZ(T angle);
+	void PreRotate(T angle, glm::tvec3<T, P> v);
+	void PreRotateX(T angle);
+	void PreRotateY(T angle);
+	void PreRotateZ(T angle);
+
+		/* Absolute transformations */
+
+	void SetTranslate(glm::tvec3<T, P> v);
+	void SetScale(glm::tvec3<T, P> v);
+	void SetScale(T uniform);
+
+	/* Rotate around vector (x, y, z) */
+	void SetRotate(T angle, glm::tvec3<T, P> v);
+	void SetRotateX(T angle);
+	void SetRotateY(T angle);
+	void SetRotateZ(T angle);
+	void SetOrientation(glm::tquat<T, P> q);
+
+
+	void LookTowards(glm::tvec3<T, P> front_vec, glm::tvec3<T, P> up_vec);
+	void LookTowards(glm::tvec3<T, P> front_vec);
+	void LookAt(glm::tvec3<T, P> point, glm::tvec3<T, P> up_vec);
+	void LookAt(glm::tvec3<T, P> point);
+
+		/* Useful getters */
+
+	glm::tmat4x4<T, P> const& GetMatrix() const;
+	glm::tmat4x4<T, P> const& GetMatrixInverse() const;
+
+	glm::tmat3x3<T, P> GetRotation() const;
+	glm::tquat<T, P> GetOrientation() const;
+	glm::tvec3<T, P> GetTranslation() const;
+	glm::tvec3<T, P> GetScale() const;
+
+	glm::tmat4x4<T, P> GetTranslationMatrix() const;
+	glm::tmat4x4<T, P> GetRotationMatrix() const;
+	glm::tmat4x4<T, P> GetScaleMatrix() const;
+
+	glm::tmat4x4<T, P> GetTranslationMatrixInverse() const;
+	glm::tmat4x4<T, P> GetRotationMatrixInverse() const;
+	glm::tmat4x4<T, P> GetScaleMatrixInverse() const;
+
+	glm::tmat4x4<T, P> GetTranslationRotationMatrix() const;
+
+	glm::tvec3<T, P> GetUp() const;
+	glm::tvec3<T, P> GetDown() const;
+	glm::tvec3<T, P> GetLeft() const;
+	glm::tvec3<T, P> GetRight() const;
+	glm::tvec3<T, P> GetFront() const;
+	glm::tvec3<T, P> GetBack() const;
+
+protected:
+	void Invalidate();
+
+	glm::tquat<T, P>	mQ;
+	glm::tvec3<T, P>	mT;
+	glm::tvec3<T, P>	mS;
+
+	mutable glm::tmat4x4<T, P>	mMatrix;
+	mutable glm::tmat4x4<T, P>	mMatrixInverse;
+	mutable bool	mIsMatrixValid;
+	mutable bool	mIsMatrixInverseValid;
+
+public:
+	friend std::ostream &operator<<(std::ostream &os, CompactTRSTransform<T, P> &v)
+	{
+		os << v.mT << std::endl;
+		os << v.mQ.w << " " << v.mQ.x << " " << v.mQ.y << " " << v.mQ.z << std::endl;
+		os << v.mS << std::endl;
+		return os;
+	}
+	friend std::istream &operator>>(std::istream &is, CompactTRSTransform<T, P> &v)
+	{
+		is >> v.mT.x >> v.mT.y >> v.mT.z;
+		is >> v.mQ.w >> v.mQ.x >> v.mQ.y >> v.mQ.z;
+		is >> v.mS.x >> v.mS.y >> v.mS.z;
+		v.Invalidate();
+		return is;
+	}
+};
+
+#include "CompactTRSTransform.inl"
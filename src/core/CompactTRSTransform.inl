@@ -0,0 +1,451 @@
+#include <cmath>
+#include "CompactTRSTransform.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+CompactTRSTransform<T, P>::CompactTRSTransform()
+{
+	ResetTransform();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::Invalidate()
+{
+	mIsMatrixValid = false;
+	mIsMatrixInverseValid = false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::ResetTransform()
+{
+	mT = glm::tvec3<T, P>(static_cast<T>(0));
+	mS = glm::tvec3<T, P>(static_cast<T>(1));
+	mQ = glm::tquat<T, P>(static_cast<T>(1), static_cast<T>(0), static_cast<T>(0), static_cast<T>(0));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::Translate(glm::tvec3<T, P> v)
+{
+	mT += v;
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::Scale(glm::tvec3<T, P> v)
+{
+	mS *= v;
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::Scale(T uniform)
+{
+	mS *= uniform;
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::Rotate(T angle, glm::tvec3<T, P> v)
+{
+	mQ = glm::normalize(mQ * glm::angleAxis(angle, glm::normalize(v)));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::RotateX(T angle)
+{
+	mQ = glm::normalize(glm::angleAxis(angle, glm::tvec3<T, P>(1, 0, 0)) * mQ);
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::RotateY(T angle)
+{
+	mQ = glm::normalize(glm::angleAxis(angle, glm::tvec3<T, P>(0, 1, 0)) * mQ);
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::RotateZ(T angle)
+{
+	mQ = glm::normalize(glm::angleAxis(angle, glm::tvec3<T, P>(0, 0, 1)) * mQ);
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::PreRotate(T angle, glm::tvec3<T, P> v)
+{
+	mQ = glm::normalize(glm::angleAxis(angle, glm::normalize(v)) * mQ);
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::PreRotateX(T angle)
+{
+	mQ = glm::normalize(mQ * glm::angleAxis(angle, glm::tvec3<T, P>(1, 0, 0)));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::PreRotateY(T angle)
+{
+	mQ = glm::normalize(mQ * glm::angleAxis(angle, glm::tvec3<T, P>(0, 1, 0)));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::PreRotateZ(T angle)
+{
+	mQ = glm::normalize(mQ * glm::angleAxis(angle, glm::tvec3<T, P>(0, 0, 1)));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetTranslate(glm::tvec3<T, P> v)
+{
+	mT = v;
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetScale(glm::tvec3<T, P> v)
+{
+	mS = v;
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetScale(T uniform)
+{
+	mS = glm::tvec3<T, P>(uniform);
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetRotate(T angle, glm::tvec3<T, P> v)
+{
+	mQ = glm::angleAxis(angle, glm::normalize(v));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetRotateX(T angle)
+{
+	mQ = glm::angleAxis(angle, glm::tvec3<T, P>(1, 0, 0));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetRotateY(T angle)
+{
+	mQ = glm::angleAxis(angle, glm::tvec3<T, P>(0, 1, 0));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetRotateZ(T angle)
+{
+	mQ = glm::angleAxis(angle, glm::tvec3<T, P>(0, 0, 1));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::SetOrientation(glm::tquat<T, P> q)
+{
+	mQ = glm::normalize(q);
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::LookTowards(glm::tvec3<T, P> front_vec, glm::tvec3<T, P> up_vec)
+{
+	front_vec = normalize(front_vec);
+	up_vec = normalize(up_vec);
+
+	if (abs(dot(up_vec, front_vec)) > 0.99999f)
+		return;
+
+	glm::tvec3<T, P> right = normalize(cross(front_vec, up_vec));
+	glm::tvec3<T, P> up = normalize(cross(right, front_vec));
+
+	mQ = glm::normalize(glm::quat_cast(glm::tmat3x3<T, P>(right, up, -front_vec)));
+	Invalidate();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::LookTowards(glm::tvec3<T, P> front_vec)
+{
+	LookTowards(front_vec, glm::tvec3<T, P>(0, 1, 0));
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::LookAt(glm::tvec3<T, P> point, glm::tvec3<T, P> up_vec)
+{
+	LookTowards(point - mT, up_vec);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+void CompactTRSTransform<T, P>::LookAt(glm::tvec3<T, P> point)
+{
+	LookTowards(point - mT);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetTranslationMatrix() const
+{
+	return glm::tmat4x4<T, P>(
+			1, 0, 0, 0,
+			0, 1, 0, 0,
+			0, 0, 1, 0,
+			mT.x, mT.y, mT.z, 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetRotationMatrix() const
+{
+	return glm::mat4_cast(mQ);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetScaleMatrix() const
+{
+	return glm::tmat4x4<T, P>(
+			mS.x, 0  , 0  , 0,
+			0  , mS.y, 0  , 0,
+			0  , 0  , mS.z, 0,
+			0  , 0  , 0  , 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetTranslationMatrixInverse() const
+{
+	return glm::tmat4x4<T, P>(
+			1, 0, 0, 0,
+			0, 1, 0, 0,
+			0, 0, 1, 0,
+			-mT.x, -mT.y, -mT.z, 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetRotationMatrixInverse() const
+{
+	return glm::mat4_cast(glm::conjugate(mQ));
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetScaleMatrixInverse() const
+{
+	return glm::tmat4x4<T, P>(
+			T(1)/mS.x, 0, 0, 0,
+			0, T(1)/mS.y, 0, 0,
+			0, 0, T(1)/mS.z, 0,
+			0, 0, 0, 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> CompactTRSTransform<T, P>::GetTranslationRotationMatrix() const
+{
+	glm::tmat4x4<T, P> M = glm::mat4_cast(mQ);
+	M[3] = glm::tvec4<T, P>(mT, T(1));
+	return M;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> const& CompactTRSTransform<T, P>::GetMatrix() const
+{
+	if (mIsMatrixValid)
+		return mMatrix;
+
+	glm::tmat3x3<T, P> const R = glm::mat3_cast(mQ);
+	mMatrix = glm::tmat4x4<T, P>(
+			R[0][0]*mS.x, R[0][1]*mS.x, R[0][2]*mS.x, 0,
+			R[1][0]*mS.y, R[1][1]*mS.y, R[1][2]*mS.y, 0,
+			R[2][0]*mS.z, R[2][1]*mS.z, R[2][2]*mS.z, 0,
+			mT.x, mT.y, mT.z, 1);
+	mIsMatrixValid = true;
+	return mMatrix;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat4x4<T, P> const& CompactTRSTransform<T, P>::GetMatrixInverse() const
+{
+	if (mIsMatrixInverseValid)
+		return mMatrixInverse;
+
+	// S^-1 * R^T * T^-1: the rows of the rotation, divided by the scale,
+	// become the columns.
+	glm::tmat3x3<T, P> const R = glm::mat3_cast(mQ);
+	glm::tvec3<T, P> X = glm::tvec3<T, P>(T(1) / mS.x, T(1) / mS.y, T(1) / mS.z);
+
+	T a = R[0][0] * X.x;
+	T b = R[1][0] * X.y;
+	T c = R[2][0] * X.z;
+	T d = R[0][1] * X.x;
+	T e = R[1][1] * X.y;
+	T f = R[2][1] * X.z;
+	T g = R[0][2] * X.x;
+	T h = R[1][2] * X.y;
+	T i = R[2][2] * X.z;
+
+	mMatrixInverse = glm::tmat4x4<T, P>(
+			a, b, c, 0,
+			d, e, f, 0,
+			g, h, i, 0,
+			-(mT.x * a + mT.y * d + mT.z * g), -(mT.x * b + mT.y * e + mT.z * h), -(mT.x * c + mT.y * f + mT.z * i), 1);
+	mIsMatrixInverseValid = true;
+	return mMatrixInverse;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tmat3x3<T, P> CompactTRSTransform<T, P>::GetRotation() const
+{
+	return glm::mat3_cast(mQ);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tquat<T, P> CompactTRSTransform<T, P>::GetOrientation() const
+{
+	return mQ;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetTranslation() const
+{
+	return mT;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetScale() const
+{
+	return mS;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetUp() const
+{
+	return mQ * glm::tvec3<T, P>(0, mS.y, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetDown() const
+{
+	return -GetUp();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetLeft() const
+{
+	return -GetRight();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetRight() const
+{
+	return mQ * glm::tvec3<T, P>(mS.x, 0, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetFront() const
+{
+	return -GetBack();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, glm::precision P>
+glm::tvec3<T, P> CompactTRSTransform<T, P>::GetBack() const
+{
+	return mQ * glm::tvec3<T, P>(0, 0, mS.z);
+}
+
+/*----------------------------------------------------------------------------*/
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "TRSTransform.h"
+#include "CompactTRSTransform.h"
 #include "InputHandler.h"
 
 #include <glm/glm.hpp>
@@ -35,7 +35,7 @@ class FPSCamera
 	glm::tvec3<T, P> GetClipToView(glm::tvec3<T, P> xyw) const;
 
   public:
-	TRSTransform<T, P> mWorld;
+	CompactTRSTransform<T, P> mWorld;
 	T mMovementSpeed;
 	T mMouseSensitivity;
 
@@ -1,9 +1,10 @@
 #include "Misc.h"
+#include "cpu_dispatch.hpp"
+#include "random.hpp"
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 #include <cstring>
-#include <random>
 
 void *AlignedMalloc(size_t size, size_t alignment)
 {
@@ -22,20 +23,14 @@ void AlignedFree(void *ptr) {
 }
 
 
-std::mt19937 BonoboRandom(1 | (0xBABEFACE ^ rand()));
-
-#ifdef max
-#undef max
-#endif
-
 void RandomSeed(unsigned int seed)
 {
-	BonoboRandom = std::mt19937(seed);
+	bonobo::random_generator() = bonobo::xoshiro256ss(seed);
 }
 
 double RandomUniform()
 {
-	return double(BonoboRandom()) / (double(BonoboRandom.max()) + 1.0);
+	return bonobo::random_generator().next_double();
 }
 
 double RandomUniform(double from, double to)
@@ -48,25 +43,8 @@ void *InfuseData(void *arrayA, size_t strideA, size_t offsetInA,
 {
 	size_t newStride = strideA + sizeB;
 	unsigned char *newArray = (unsigned char *) malloc(n * newStride);
-	unsigned char *a_pre = ((unsigned char *) arrayA);
-	unsigned char *a_post = ((unsigned char *) arrayA) + offsetInA;
-	size_t size_post = (strideA - offsetInA);
-	unsigned char *b = ((unsigned char *) arrayB) + offsetInB;
-	unsigned char *d = newArray;
-
-	// LOWPRIO: Can be done with 2 memcpy's (+ pre and post)
-	for (size_t i = 0; i < n; i++) {
-		memcpy(d, a_pre, offsetInA);
-		a_pre += strideA;
-		d += offsetInA;
-		memcpy(d, b, sizeB);
-		b += strideB;
-		d += sizeB;
-		memcpy(d, a_post, size_post);
-		a_post += strideA;
-		d += size_post;
-	}
-
+	bonobo::get_cpu_kernels().infuse(newArray, (unsigned char *) arrayA, strideA, offsetInA,
+	                                 ((unsigned char *) arrayB) + offsetInB, strideB, sizeB, n);
 	return newArray;
 }
 
@@ -0,0 +1,416 @@
+#include "animation.hpp"
+#include "Log.h"
+#include "Misc.h"
+#include "node.hpp"
+#include "random.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ANIMATION_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// Correction of the nlerp weight `t` between keys whose dot product
+	// is `d`, from Arseny Kapoulkine's "Approximating slerp": a cubic in
+	// t which vanishes at 0, 1/2 and 1, scaled by a fit in d.
+	float
+	corrected_weight(float t, float d)
+	{
+		auto const a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+		auto const b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+		auto const k = a * (t - 0.5f) * (t - 0.5f) + b;
+		return t + t * (t - 0.5f) * (t - 1.0f) * k;
+	}
+
+#if defined(ANIMATION_USE_SSE)
+	__m128
+	corrected_weight(__m128 t, __m128 d)
+	{
+		auto const half = _mm_set1_ps(0.5f);
+		auto a = _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)));
+		a = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, a));
+		a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, a));
+		auto b = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)));
+		b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, b));
+		auto const centred = _mm_sub_ps(t, half);
+		auto const k = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, centred), centred), b);
+		auto const cubic = _mm_mul_ps(_mm_mul_ps(t, centred), _mm_sub_ps(t, _mm_set1_ps(1.0f)));
+		return _mm_add_ps(t, _mm_mul_ps(cubic, k));
+	}
+#endif
+
+	void
+	resize(std::vector<float> (&arrays)[4], size_t components_nb, size_t size)
+	{
+		for (size_t c = 0u; c < components_nb; ++c)
+			arrays[c].resize(size);
+	}
+}
+
+void
+bonobo::animation_clip::track_group::add(size_t target, std::vector<float> const& key_times,
+                                         float const* key_values)
+{
+	assert(std::is_sorted(key_times.begin(), key_times.end()));
+
+	// A single key is held as two, so that every track has an interval.
+	auto const keys_nb = std::max<size_t>(key_times.size(), 2u);
+	for (size_t k = 0u; k < keys_nb; ++k) {
+		auto const key = std::min(k, key_times.size() - 1u);
+		times.push_back(key_times[key]);
+		for (size_t c = 0u; c < components_nb; ++c)
+			values[c].push_back(key_values[key * components_nb + c]);
+	}
+	targets.push_back(static_cast<uint32_t>(target));
+	first_keys.push_back(static_cast<uint32_t>(times.size()));
+}
+
+void
+bonobo::animation_clip::add_translation_track(size_t target, std::vector<float> const& times,
+                                              std::vector<glm::vec3> const& translations)
+{
+	if (times.empty() || times.size() != translations.size()) {
+		LogError("A translation track needs as many translations as times, and at least one.");
+		return;
+	}
+	static_assert(sizeof(glm::vec3) == 3u * sizeof(float), "vec3 should be three packed floats");
+	_translations.add(target, times, reinterpret_cast<float const*>(translations.data()));
+	_duration = std::max(_duration, times.back());
+}
+
+void
+bonobo::animation_clip::add_rotation_track(size_t target, std::vector<float> const& times,
+                                           std::vector<glm::quat> const& rotations)
+{
+	if (times.empty() || times.size() != rotations.size()) {
+		LogError("A rotation track needs as many rotations as times, and at least one.");
+		return;
+	}
+	std::vector<float> values(4u * rotations.size());
+	auto previous = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	for (size_t k = 0u; k < rotations.size(); ++k) {
+		auto rotation = glm::normalize(rotations[k]);
+		if (k > 0u && glm::dot(previous, rotation) < 0.0f)
+			rotation = -rotation;
+		values[4u * k + 0u] = rotation.x;
+		values[4u * k + 1u] = rotation.y;
+		values[4u * k + 2u] = rotation.z;
+		values[4u * k + 3u] = rotation.w;
+		previous = rotation;
+	}
+	_rotations.add(target, times, values.data());
+	_duration = std::max(_duration, times.back());
+}
+
+void
+bonobo::animation_clip::add_scaling_track(size_t target, std::vector<float> const& times,
+                                          std::vector<glm::vec3> const& scalings)
+{
+	if (times.empty() || times.size() != scalings.size()) {
+		LogError("A scaling track needs as many scalings as times, and at least one.");
+		return;
+	}
+	_scalings.add(target, times, reinterpret_cast<float const*>(scalings.data()));
+	_duration = std::max(_duration, times.back());
+}
+
+size_t
+bonobo::animation_clip::get_tracks_nb() const
+{
+	return _translations.tracks_nb() + _rotations.tracks_nb() + _scalings.tracks_nb();
+}
+
+bonobo::animation_sampler::animation_sampler(animation_clip const& clip, rotation_interpolation interpolation) :
+	_clip(&clip), _interpolation(interpolation)
+{
+	for (auto group : { std::make_pair(&clip._translations, &_translations),
+	                    std::make_pair(&clip._rotations, &_rotations),
+	                    std::make_pair(&clip._scalings, &_scalings) }) {
+		auto const& tracks = *group.first;
+		auto& state = *group.second;
+		auto const tracks_nb = tracks.tracks_nb();
+		state.origins.resize(tracks_nb);
+		state.periods.resize(tracks_nb);
+		for (size_t i = 0u; i < tracks_nb; ++i) {
+			state.origins[i] = tracks.times[tracks.first_keys[i]];
+			state.periods[i] = tracks.times[tracks.first_keys[i + 1u] - 1u] - state.origins[i];
+		}
+
+		// Empty ranges, so that the first sample fills the caches.
+		state.cursors.assign(tracks_nb, 0u);
+		state.lower_bounds.assign(tracks_nb, std::numeric_limits<float>::infinity());
+		state.upper_bounds.assign(tracks_nb, -std::numeric_limits<float>::infinity());
+		state.key_times.assign(tracks_nb, 0.0f);
+		state.inverse_spans.assign(tracks_nb, 0.0f);
+		state.weights.assign(tracks_nb, 0.0f);
+		resize(state.from, tracks.components_nb, tracks_nb);
+		resize(state.to, tracks.components_nb, tracks_nb);
+		resize(state.results, tracks.components_nb, tracks_nb);
+	}
+}
+
+void
+bonobo::animation_sampler::locate(animation_clip::track_group const& group, group_state& state, float time) const
+{
+	auto const looping = _clip->_looping;
+	for (size_t i = 0u; i < group.tracks_nb(); ++i) {
+		auto local_time = time;
+		if (looping) {
+			auto const period = state.periods[i];
+			local_time = period > 0.0f ? time - period * std::floor((time - state.origins[i]) / period) : state.origins[i];
+		}
+
+		if (local_time < state.lower_bounds[i] || local_time >= state.upper_bounds[i]) {
+			// Keys [c, c + 1] hold the time if it is in between, or if it
+			// is before the first or after the last and c is the first or
+			// last interval. Try the interval after the cached one before
+			// searching.
+			auto const first = group.first_keys[i];
+			auto const times = group.times.data() + first;
+			auto const last = group.first_keys[i + 1u] - first - 1u;
+			auto const holds = [times, last, local_time](uint32_t c) {
+				return (c == 0u || times[c] <= local_time) && (c + 1u == last || local_time < times[c + 1u]);
+			};
+			auto c = state.cursors[i] + 1u;
+			if (c >= last || !holds(c))
+				c = static_cast<uint32_t>(std::upper_bound(times + 1u, times + last, local_time) - times - 1);
+
+			auto const span = times[c + 1u] - times[c];
+			state.cursors[i] = c;
+			state.lower_bounds[i] = c == 0u ? -std::numeric_limits<float>::infinity() : times[c];
+			state.upper_bounds[i] = c + 1u == last ? std::numeric_limits<float>::infinity() : times[c + 1u];
+			state.key_times[i] = times[c];
+			state.inverse_spans[i] = span > 0.0f ? 1.0f / span : 0.0f;
+			for (size_t component = 0u; component < group.components_nb; ++component) {
+				state.from[component][i] = group.values[component][first + c];
+				state.to[component][i] = group.values[component][first + c + 1u];
+			}
+		}
+
+		state.weights[i] = glm::clamp((local_time - state.key_times[i]) * state.inverse_spans[i], 0.0f, 1.0f);
+	}
+}
+
+void
+bonobo::animation_sampler::blend_vectors(group_state& state) const
+{
+	auto const tracks_nb = state.weights.size();
+	auto const weights = state.weights.data();
+	size_t i = 0u;
+#if defined(ANIMATION_USE_SSE)
+	for (; i + 4u <= tracks_nb; i += 4u) {
+		auto const weight = _mm_loadu_ps(weights + i);
+		for (size_t c = 0u; c < 3u; ++c) {
+			auto const from = _mm_loadu_ps(state.from[c].data() + i);
+			auto const to = _mm_loadu_ps(state.to[c].data() + i);
+			_mm_storeu_ps(state.results[c].data() + i, _mm_add_ps(from, _mm_mul_ps(weight, _mm_sub_ps(to, from))));
+		}
+	}
+#endif
+	for (; i < tracks_nb; ++i)
+		for (size_t c = 0u; c < 3u; ++c) {
+			auto const from = state.from[c][i];
+			auto const to = state.to[c][i];
+			state.results[c][i] = from + weights[i] * (to - from);
+		}
+}
+
+void
+bonobo::animation_sampler::blend_rotations(group_state& state) const
+{
+	auto const tracks_nb = state.weights.size();
+	auto const weights = state.weights.data();
+	auto const correct = _interpolation == rotation_interpolation::slerp;
+	size_t i = 0u;
+#if defined(ANIMATION_USE_SSE)
+	for (; i + 4u <= tracks_nb; i += 4u) {
+		__m128 from[4], to[4];
+		auto d = _mm_setzero_ps();
+		for (size_t c = 0u; c < 4u; ++c) {
+			from[c] = _mm_loadu_ps(state.from[c].data() + i);
+			to[c] = _mm_loadu_ps(state.to[c].data() + i);
+			d = _mm_add_ps(d, _mm_mul_ps(from[c], to[c]));
+		}
+		auto weight = _mm_loadu_ps(weights + i);
+		if (correct)
+			weight = corrected_weight(weight, d);
+
+		__m128 blend[4];
+		auto squared_length = _mm_setzero_ps();
+		for (size_t c = 0u; c < 4u; ++c) {
+			blend[c] = _mm_add_ps(from[c], _mm_mul_ps(weight, _mm_sub_ps(to[c], from[c])));
+			squared_length = _mm_add_ps(squared_length, _mm_mul_ps(blend[c], blend[c]));
+		}
+		auto const inverse_length = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(squared_length));
+		for (size_t c = 0u; c < 4u; ++c)
+			_mm_storeu_ps(state.results[c].data() + i, _mm_mul_ps(blend[c], inverse_length));
+	}
+#endif
+	for (; i < tracks_nb; ++i) {
+		float from[4], to[4];
+		auto d = 0.0f;
+		for (size_t c = 0u; c < 4u; ++c) {
+			from[c] = state.from[c][i];
+			to[c] = state.to[c][i];
+			d = d + from[c] * to[c];
+		}
+		auto const weight = correct ? corrected_weight(weights[i], d) : weights[i];
+
+		float blend[4];
+		auto squared_length = 0.0f;
+		for (size_t c = 0u; c < 4u; ++c) {
+			blend[c] = from[c] + weight * (to[c] - from[c]);
+			squared_length = squared_length + blend[c] * blend[c];
+		}
+		auto const inverse_length = 1.0f / std::sqrt(squared_length);
+		for (size_t c = 0u; c < 4u; ++c)
+			state.results[c][i] = blend[c] * inverse_length;
+	}
+}
+
+void
+bonobo::animation_sampler::sample(float time)
+{
+	locate(_clip->_translations, _translations, time);
+	blend_vectors(_translations);
+	locate(_clip->_rotations, _rotations, time);
+	blend_rotations(_rotations);
+	locate(_clip->_scalings, _scalings, time);
+	blend_vectors(_scalings);
+}
+
+void
+bonobo::animation_sampler::apply(Node* const* nodes) const
+{
+	auto const& clip = *_clip;
+	for (size_t i = 0u; i < clip._translations.tracks_nb(); ++i)
+		nodes[clip._translations.targets[i]]->set_translation(get_translation(i));
+	for (size_t i = 0u; i < clip._rotations.tracks_nb(); ++i)
+		nodes[clip._rotations.targets[i]]->set_orientation(get_rotation(i));
+	for (size_t i = 0u; i < clip._scalings.tracks_nb(); ++i)
+		nodes[clip._scalings.targets[i]]->set_scaling(get_scaling(i));
+}
+
+glm::vec3
+bonobo::animation_sampler::get_translation(size_t track) const
+{
+	auto const& results = _translations.results;
+	return glm::vec3(results[0][track], results[1][track], results[2][track]);
+}
+
+glm::quat
+bonobo::animation_sampler::get_rotation(size_t track) const
+{
+	auto const& results = _rotations.results;
+	return glm::quat(results[3][track], results[0][track], results[1][track], results[2][track]);
+}
+
+glm::vec3
+bonobo::animation_sampler::get_scaling(size_t track) const
+{
+	auto const& results = _scalings.results;
+	return glm::vec3(results[0][track], results[1][track], results[2][track]);
+}
+
+void
+bonobo::benchmark_animation()
+{
+	size_t const targets_nb = 4096u;
+	size_t const keys_nb = 33u;
+	float const key_interval = 0.25f;
+	unsigned int const frames_nb = 480u;
+	float const frame_interval = 1.0f / 60.0f;
+
+	// Random walks, with rotations of up to a quarter turn between keys.
+	xoshiro256ss generator(1u);
+	std::vector<float> times(keys_nb);
+	for (size_t k = 0u; k < keys_nb; ++k)
+		times[k] = key_interval * static_cast<float>(k);
+	std::vector<std::vector<glm::vec3>> translations(targets_nb), scalings(targets_nb);
+	std::vector<std::vector<glm::quat>> rotations(targets_nb);
+	animation_clip clip;
+	for (size_t target = 0u; target < targets_nb; ++target) {
+		auto translation = glm::vec3(0.0f);
+		auto scaling = glm::vec3(1.0f);
+		auto rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		for (size_t k = 0u; k < keys_nb; ++k) {
+			translation += glm::vec3(generator.uniform(-1.0f, 1.0f), generator.uniform(-1.0f, 1.0f), generator.uniform(-1.0f, 1.0f));
+			scaling *= glm::vec3(generator.uniform(0.8f, 1.25f), generator.uniform(0.8f, 1.25f), generator.uniform(0.8f, 1.25f));
+			auto const axis = glm::normalize(glm::vec3(generator.uniform(-1.0f, 1.0f), generator.uniform(-1.0f, 1.0f), 1.0f));
+			rotation = glm::normalize(rotation * glm::angleAxis(generator.uniform(0.0f, glm::half_pi<float>()), axis));
+			translations[target].push_back(translation);
+			scalings[target].push_back(scaling);
+			rotations[target].push_back(rotation);
+		}
+		clip.add_translation_track(target, times, translations[target]);
+		clip.add_rotation_track(target, times, rotations[target]);
+		clip.add_scaling_track(target, times, scalings[target]);
+	}
+
+	// What the same animation takes one track at a time with glm, for
+	// a given frame.
+	std::vector<glm::vec3> reference_translations(targets_nb), reference_scalings(targets_nb);
+	std::vector<glm::quat> reference_rotations(targets_nb);
+	auto const sample_reference = [&](float time) {
+		for (size_t target = 0u; target < targets_nb; ++target) {
+			auto const next = std::upper_bound(times.begin() + 1, times.end() - 1, time) - times.begin();
+			auto const weight = glm::clamp((time - times[next - 1]) / (times[next] - times[next - 1]), 0.0f, 1.0f);
+			reference_translations[target] = glm::mix(translations[target][next - 1], translations[target][next], weight);
+			reference_rotations[target] = glm::slerp(rotations[target][next - 1], rotations[target][next], weight);
+			reference_scalings[target] = glm::mix(scalings[target][next - 1], scalings[target][next], weight);
+		}
+	};
+
+	animation_sampler sampler(clip);
+	auto start = GetTimeMilliseconds();
+	for (unsigned int frame = 0u; frame < frames_nb; ++frame)
+		sampler.sample(frame_interval * static_cast<float>(frame));
+	auto const sampler_duration = GetTimeMilliseconds() - start;
+
+	start = GetTimeMilliseconds();
+	for (unsigned int frame = 0u; frame < frames_nb; ++frame)
+		sample_reference(frame_interval * static_cast<float>(frame));
+	auto const reference_duration = GetTimeMilliseconds() - start;
+
+	std::vector<Node> nodes(targets_nb);
+	std::vector<Node*> node_pointers(targets_nb);
+	for (size_t target = 0u; target < targets_nb; ++target)
+		node_pointers[target] = &nodes[target];
+	start = GetTimeMilliseconds();
+	for (unsigned int frame = 0u; frame < frames_nb; ++frame)
+		sampler.apply(node_pointers.data());
+	auto const apply_duration = GetTimeMilliseconds() - start;
+
+	float translation_error = 0.0f, rotation_error = 0.0f, scaling_error = 0.0f;
+	for (unsigned int frame = 0u; frame < frames_nb; frame += 7u) {
+		auto const time = frame_interval * static_cast<float>(frame);
+		sampler.sample(time);
+		sample_reference(time);
+		for (size_t target = 0u; target < targets_nb; ++target) {
+			// Unit quaternions q and r are 2 sin(a / 4) apart, for a the
+			// angle of the rotation from one to the other.
+			auto const rotation = sampler.get_rotation(target);
+			auto reference_rotation = reference_rotations[target];
+			if (glm::dot(rotation, reference_rotation) < 0.0f)
+				reference_rotation = -reference_rotation;
+			auto const difference = rotation + -reference_rotation;
+			auto const distance = std::sqrt(glm::dot(difference, difference));
+			translation_error = std::max(translation_error, glm::length(sampler.get_translation(target) - reference_translations[target]));
+			rotation_error = std::max(rotation_error, 4.0f * std::asin(std::min(0.5f * distance, 1.0f)));
+			scaling_error = std::max(scaling_error, glm::length(sampler.get_scaling(target) - reference_scalings[target]));
+		}
+	}
+
+	auto const per_frame = 1.0 / static_cast<double>(frames_nb);
+	LogInfo("Sampled %zu animation tracks in %.3f ms per frame, against %.3f ms one at a time with glm, and applied them to nodes in %.3f ms; largest differences of %g in translation, %g radian in rotation and %g in scaling",
+	        clip.get_tracks_nb(), sampler_duration * per_frame, reference_duration * per_frame, apply_duration * per_frame,
+	        translation_error, rotation_error, scaling_error);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Node;
+
+namespace bonobo
+{
+	//! \brief How `animation_sampler` blends two rotation keys.
+	enum class rotation_interpolation : uint8_t {
+		nlerp, //!< normalised linear blend: cheapest, but speeds up midway between keys far apart
+		slerp  //!< nlerp with its parameter corrected for a constant angular speed, within 1e-3 radian of a slerp
+	};
+
+	//! \brief Keyframes of translations, rotations and scalings of some
+	//!        nodes, linearly interpolated between keys.
+	//!
+	//! Each track animates one channel of a target, an index into the
+	//! nodes given to `animation_sampler::apply()`. Tracks of a channel
+	//! are stored together, with the times and the components of all
+	//! their keys in separate arrays, so that a sampler can blend four of
+	//! them at once.
+	class animation_clip {
+	public:
+		//! \brief Add a track moving `target` through `translations` at
+		//!        the increasing `times`, in seconds.
+		void add_translation_track(size_t target, std::vector<float> const& times,
+		                           std::vector<glm::vec3> const& translations);
+
+		//! \brief Add a track turning `target` through `rotations`.
+		//!
+		//! Keys are negated as needed to lie in the same hemisphere as
+		//! the previous one, so that each blend takes the short way.
+		//! Keys should thus be less than half a turn apart.
+		void add_rotation_track(size_t target, std::vector<float> const& times,
+		                        std::vector<glm::quat> const& rotations);
+
+		//! \brief Add a track scaling `target` through `scalings`.
+		void add_scaling_track(size_t target, std::vector<float> const& times,
+		                       std::vector<glm::vec3> const& scalings);
+
+		//! \brief Wrap the time around the keys of each track when
+		//!        sampling, rather than holding the first and last keys;
+		//!        the last key of a looping track should match its first.
+		void set_looping(bool looping) { _looping = looping; }
+		bool is_looping() const { return _looping; }
+
+		//! \brief Time of the last key of all tracks.
+		float get_duration() const { return _duration; }
+
+		size_t get_tracks_nb() const;
+
+	private:
+		friend class animation_sampler;
+
+		//! Tracks of one channel; the keys of track i are
+		//! [first_keys[i], first_keys[i + 1]), at least two of them.
+		struct track_group {
+			size_t components_nb;
+			std::vector<uint32_t> targets;
+			std::vector<uint32_t> first_keys = std::vector<uint32_t>(1u, 0u);
+			std::vector<float> times;
+			std::vector<float> values[4];
+
+			explicit track_group(size_t components) : components_nb(components) {}
+			size_t tracks_nb() const { return targets.size(); }
+			void add(size_t target, std::vector<float> const& key_times, float const* key_values);
+		};
+
+		track_group _translations = track_group(3u);
+		track_group _rotations = track_group(4u);
+		track_group _scalings = track_group(3u);
+		float _duration = 0.0f;
+		bool _looping = false;
+	};
+
+	//! \brief Blends the keys of an `animation_clip` at a given time, and
+	//!        writes the results into nodes.
+	//!
+	//! Each track caches the two keys it last blended between, and the
+	//! times over which they hold. While the time stays in that range,
+	//! as it mostly does when it moves forward from a frame to the next,
+	//! sampling reads those caches in order rather than the keys of the
+	//! clip; moving to the next keys takes a comparison, and only jumps
+	//! in time search the keys. The blends are done four tracks at a
+	//! time with SSE, giving the same results as without it.
+	//!
+	//! The clip should outlive the sampler, and not get new tracks once
+	//! the sampler is created.
+	class animation_sampler {
+	public:
+		explicit animation_sampler(animation_clip const& clip,
+		                           rotation_interpolation interpolation = rotation_interpolation::slerp);
+
+		//! \brief Blend the keys of every track at `time`, in seconds.
+		void sample(float time);
+
+		//! \brief Set the sampled translations, orientations and scalings
+		//!        of the targets, as `nodes[target]`.
+		void apply(Node* const* nodes) const;
+
+		//! \brief Results of the last `sample()`, by track of each channel,
+		//!        in the order they were added.
+		glm::vec3 get_translation(size_t track) const;
+		glm::quat get_rotation(size_t track) const;
+		glm::vec3 get_scaling(size_t track) const;
+
+	private:
+		//! Cached keys of the tracks of a group, and their blends.
+		struct group_state {
+			std::vector<float> origins;        //!< time of the first key of each track
+			std::vector<float> periods;        //!< time from the first key to the last
+			std::vector<uint32_t> cursors;     //!< first of the cached keys, relative to the track
+			std::vector<float> lower_bounds;   //!< times over which the cached keys hold,
+			std::vector<float> upper_bounds;   //!< infinite past the first and last keys
+			std::vector<float> key_times;      //!< time of the first cached key
+			std::vector<float> inverse_spans;  //!< inverse of the time between the cached keys
+			std::vector<float> from[4];
+			std::vector<float> to[4];
+			std::vector<float> weights;
+			std::vector<float> results[4];
+		};
+
+		void locate(animation_clip::track_group const& group, group_state& state, float time) const;
+		void blend_vectors(group_state& state) const;
+		void blend_rotations(group_state& state) const;
+
+		animation_clip const* _clip;
+		rotation_interpolation _interpolation;
+		group_state _translations;
+		group_state _rotations;
+		group_state _scalings;
+	};
+
+	//! \brief Time sampling thousands of tracks with `animation_sampler`,
+	//!        against searching and blending each track with glm, and log
+	//!        both durations and the largest difference between them.
+	void benchmark_animation();
+}
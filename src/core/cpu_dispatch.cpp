@@ -0,0 +1,424 @@
+#include "cpu_dispatch.hpp"
+#include "Log.h"
+#include "Misc.h"
+#include "random.hpp"
+
+#include "external/lodepng.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define BONOBO_CPU_X86 1
+#include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BONOBO_CPU_X86 1
+#include <cpuid.h>
+#elif defined(__linux__) && defined(__arm__)
+#include <sys/auxv.h>
+#endif
+
+namespace bonobo
+{
+	// Tables of the cpu_kernels_*.cpp files; the CMake option
+	// LUGGCGL_BUILD_MULTIVERSIONED_KERNELS defines which ones are built.
+	namespace kernels_scalar { extern cpu_kernels const kernels; }
+#if defined(BONOBO_COMPILED_KERNELS_SSE42)
+	namespace kernels_sse42 { extern cpu_kernels const kernels; }
+#endif
+#if defined(BONOBO_COMPILED_KERNELS_AVX2)
+	namespace kernels_avx2 { extern cpu_kernels const kernels; }
+#endif
+#if defined(BONOBO_COMPILED_KERNELS_AVX512)
+	namespace kernels_avx512 { extern cpu_kernels const kernels; }
+#endif
+#if defined(BONOBO_COMPILED_KERNELS_NEON)
+	namespace kernels_neon { extern cpu_kernels const kernels; }
+#endif
+}
+
+namespace
+{
+	size_t const isas_nb = static_cast<size_t>(bonobo::isa::count);
+
+	bonobo::isa const all_isas[isas_nb] = {
+		bonobo::isa::scalar, bonobo::isa::sse42, bonobo::isa::avx2, bonobo::isa::avx512, bonobo::isa::neon
+	};
+
+	bonobo::cpu_kernels const*
+	get_compiled_kernels(bonobo::isa set)
+	{
+		switch (set) {
+		case bonobo::isa::scalar: return &bonobo::kernels_scalar::kernels;
+#if defined(BONOBO_COMPILED_KERNELS_SSE42)
+		case bonobo::isa::sse42:  return &bonobo::kernels_sse42::kernels;
+#endif
+#if defined(BONOBO_COMPILED_KERNELS_AVX2)
+		case bonobo::isa::avx2:   return &bonobo::kernels_avx2::kernels;
+#endif
+#if defined(BONOBO_COMPILED_KERNELS_AVX512)
+		case bonobo::isa::avx512: return &bonobo::kernels_avx512::kernels;
+#endif
+#if defined(BONOBO_COMPILED_KERNELS_NEON)
+		case bonobo::isa::neon:   return &bonobo::kernels_neon::kernels;
+#endif
+		default:                  return nullptr;
+		}
+	}
+
+	//! \brief Next less capable instruction set, whose variant is used for
+	//!        the kernels missing from the one of `set`.
+	bonobo::isa
+	get_fallback(bonobo::isa set)
+	{
+		switch (set) {
+		case bonobo::isa::avx512: return bonobo::isa::avx2;
+		case bonobo::isa::avx2:   return bonobo::isa::sse42;
+		default:                  return bonobo::isa::scalar;
+		}
+	}
+
+#if defined(BONOBO_CPU_X86)
+	//! \brief Registers eax, ebx, ecx and edx of cpuid for `leaf`, or false
+	//!        if the CPU does not have that leaf.
+	bool
+	cpuid(unsigned int leaf, unsigned int subleaf, unsigned int registers[4])
+	{
+#if defined(_MSC_VER)
+		int values[4];
+		__cpuid(values, 0);
+		if (static_cast<unsigned int>(values[0]) < leaf)
+			return false;
+		__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (size_t i = 0u; i < 4u; ++i)
+			registers[i] = static_cast<unsigned int>(values[i]);
+#else
+		if (__get_cpuid_max(0u, nullptr) < leaf)
+			return false;
+		__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+		return true;
+	}
+
+	//! \brief Register states the OS saves on context switches, XCR0.
+	uint64_t
+	get_saved_states()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0u);
+#else
+		// With inline assembly, as the intrinsic needs -mxsave.
+		uint32_t low, high;
+		__asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0u));
+		return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+	}
+#endif
+
+	struct cpu_features {
+		bool supported[isas_nb];
+
+		cpu_features() : supported()
+		{
+			supported[static_cast<size_t>(bonobo::isa::scalar)] = true;
+#if defined(BONOBO_CPU_X86)
+			unsigned int leaf1[4] = {}, leaf7[4] = {};
+			if (!cpuid(1u, 0u, leaf1))
+				return;
+			cpuid(7u, 0u, leaf7);
+
+			bool const ssse3   = (leaf1[2] & (1u <<  9)) != 0u;
+			bool const sse41   = (leaf1[2] & (1u << 19)) != 0u;
+			bool const sse42   = (leaf1[2] & (1u << 20)) != 0u;
+			bool const osxsave = (leaf1[2] & (1u << 27)) != 0u;
+			bool const avx     = (leaf1[2] & (1u << 28)) != 0u;
+			bool const avx2    = (leaf7[1] & (1u <<  5)) != 0u;
+			bool const avx512f = (leaf7[1] & (1u << 16)) != 0u;
+
+			// The OS has to save the YMM registers for AVX, and the
+			// opmask and ZMM ones as well for AVX-512.
+			auto const states = osxsave ? get_saved_states() : 0u;
+			bool const ymm_saved = (states & 0x06u) == 0x06u;
+			bool const zmm_saved = (states & 0xe6u) == 0xe6u;
+
+			auto& supported_sse42 = supported[static_cast<size_t>(bonobo::isa::sse42)];
+			auto& supported_avx2 = supported[static_cast<size_t>(bonobo::isa::avx2)];
+			supported_sse42 = ssse3 && sse41 && sse42;
+			supported_avx2 = supported_sse42 && avx && avx2 && ymm_saved;
+			supported[static_cast<size_t>(bonobo::isa::avx512)] = supported_avx2 && avx512f && zmm_saved;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+			supported[static_cast<size_t>(bonobo::isa::neon)] = true;
+#elif defined(__linux__) && defined(__arm__)
+			unsigned long const hwcap_neon = 1ul << 12;
+			supported[static_cast<size_t>(bonobo::isa::neon)] = (getauxval(AT_HWCAP) & hwcap_neon) != 0ul;
+#elif defined(__ARM_NEON)
+			supported[static_cast<size_t>(bonobo::isa::neon)] = true;
+#endif
+		}
+	};
+
+	cpu_features const&
+	get_cpu_features()
+	{
+		static cpu_features const features;
+		return features;
+	}
+
+	//! \brief Lower-case letters and digits of `name`, so that "AVX-512",
+	//!        "avx512" or "SSE4.2" and "sse42" compare equal.
+	std::string
+	normalise_isa_name(char const* name)
+	{
+		std::string normalised;
+		for (; *name != '\0'; ++name) {
+			auto const c = static_cast<unsigned char>(*name);
+			if (std::isalnum(c))
+				normalised.push_back(static_cast<char>(std::tolower(c)));
+		}
+		return normalised;
+	}
+
+	bonobo::isa
+	select_isa()
+	{
+		auto best = bonobo::isa::scalar;
+		for (auto const set : all_isas)
+			if (bonobo::get_cpu_kernels(set) != nullptr && set != bonobo::isa::scalar)
+				best = set;
+
+		char const* const forced = std::getenv("BONOBO_ISA");
+		if (forced == nullptr || *forced == '\0')
+			return best;
+
+		auto const forced_name = normalise_isa_name(forced);
+		for (auto const set : all_isas) {
+			if (normalise_isa_name(bonobo::get_isa_name(set)) != forced_name)
+				continue;
+			if (!bonobo::is_isa_compiled(set))
+				LogWarning("BONOBO_ISA asks for the %s kernels, which were not compiled; using the %s ones.",
+				           bonobo::get_isa_name(set), bonobo::get_isa_name(best));
+			else if (!bonobo::is_isa_supported(set))
+				LogWarning("BONOBO_ISA asks for the %s kernels, which this CPU does not support; using the %s ones.",
+				           bonobo::get_isa_name(set), bonobo::get_isa_name(best));
+			else
+				return set;
+			return best;
+		}
+		LogWarning("Unknown instruction set \"%s\" in BONOBO_ISA; using the %s kernels.", forced, bonobo::get_isa_name(best));
+		return best;
+	}
+
+	template<typename F>
+	void
+	bind_kernel(F bonobo::cpu_kernels::* kernel, bonobo::isa set, bonobo::cpu_kernels& bound)
+	{
+		for (auto candidate = set; bound.*kernel == nullptr; candidate = get_fallback(candidate)) {
+			auto const variant = get_compiled_kernels(candidate);
+			if (variant != nullptr)
+				bound.*kernel = variant->*kernel;
+			if (candidate == bonobo::isa::scalar)
+				break;
+		}
+	}
+
+	bonobo::cpu_kernels
+	bind_kernels(bonobo::isa set)
+	{
+		bonobo::cpu_kernels kernels = {};
+		bind_kernel(&bonobo::cpu_kernels::infuse, set, kernels);
+		bind_kernel(&bonobo::cpu_kernels::grid_indices, set, kernels);
+		bind_kernel(&bonobo::cpu_kernels::unfilter_png_scanline, set, kernels);
+		LogInfo("CPU kernels dispatched to their %s variant", bonobo::get_isa_name(set));
+		return kernels;
+	}
+}
+
+char const*
+bonobo::get_isa_name(isa set)
+{
+	switch (set) {
+	case isa::scalar: return "scalar";
+	case isa::sse42:  return "SSE4.2";
+	case isa::avx2:   return "AVX2";
+	case isa::avx512: return "AVX-512";
+	case isa::neon:   return "NEON";
+	default:          return "unknown";
+	}
+}
+
+bool
+bonobo::is_isa_supported(isa set)
+{
+	auto const index = static_cast<size_t>(set);
+	return index < isas_nb && get_cpu_features().supported[index];
+}
+
+bool
+bonobo::is_isa_compiled(isa set)
+{
+	return get_compiled_kernels(set) != nullptr;
+}
+
+bonobo::isa
+bonobo::get_dispatched_isa()
+{
+	static isa const dispatched = select_isa();
+	return dispatched;
+}
+
+bonobo::cpu_kernels const&
+bonobo::get_cpu_kernels()
+{
+	static cpu_kernels const kernels = bind_kernels(get_dispatched_isa());
+	return kernels;
+}
+
+bonobo::cpu_kernels const*
+bonobo::get_cpu_kernels(isa set)
+{
+	return is_isa_supported(set) ? get_compiled_kernels(set) : nullptr;
+}
+
+void
+bonobo::install_png_unfilter()
+{
+	lodepng_custom_unfilter_scanline = get_cpu_kernels().unfilter_png_scanline;
+}
+
+namespace
+{
+	// Small enough for the inputs and outputs to stay in the caches, so
+	// that the kernels are not all limited by the memory bandwidth.
+	size_t const benchmark_elements_nb = 65536u;
+	uint32_t const benchmark_grid_columns = 257u;
+	uint32_t const benchmark_grid_rows = 257u;
+	size_t const benchmark_png_width = 256u;
+	size_t const benchmark_png_height = 128u;
+	size_t const benchmark_repetitions = 16u;
+
+	struct benchmark_inputs {
+		// Positions and normals, then texture coordinates to insert
+		// between them, as with InfuseData().
+		size_t stride_a, offset_in_a, size_b;
+		std::vector<uint8_t> attributes_a, attributes_b;
+
+		// Filtered scanlines of an RGB and an RGBA image, each one
+		// prefixed with its filter type.
+		std::vector<uint8_t> rgb_scanlines, rgba_scanlines;
+	};
+
+	struct benchmark_outputs {
+		std::vector<uint8_t> infused;
+		std::vector<uint32_t> grid_indices;
+		std::vector<uint8_t> rgb_pixels, rgba_pixels;
+
+		bool operator==(benchmark_outputs const& other) const
+		{
+			return infused == other.infused
+			    && grid_indices == other.grid_indices
+			    && rgb_pixels == other.rgb_pixels
+			    && rgba_pixels == other.rgba_pixels;
+		}
+	};
+
+	struct benchmark_durations {
+		double infuse, grid_indices, unfilter;
+	};
+
+	void
+	unfilter_image(bonobo::cpu_kernels const& kernels, std::vector<uint8_t> const& scanlines,
+	               size_t bytewidth, std::vector<uint8_t>& pixels)
+	{
+		auto const length = benchmark_png_width * bytewidth;
+		pixels.resize(benchmark_png_height * length);
+		uint8_t const* precon = nullptr;
+		for (size_t y = 0u; y < benchmark_png_height; ++y) {
+			auto const scanline = scanlines.data() + y * (length + 1u);
+			auto const recon = pixels.data() + y * length;
+			kernels.unfilter_png_scanline(recon, scanline + 1u, precon, bytewidth, scanline[0], length);
+			precon = recon;
+		}
+	}
+
+	benchmark_durations
+	run_kernels(bonobo::cpu_kernels const& kernels, benchmark_inputs const& in, benchmark_outputs& out)
+	{
+		benchmark_durations durations;
+
+		auto const elements_nb = in.attributes_a.size() / in.stride_a;
+		out.infused.resize(elements_nb * (in.stride_a + in.size_b));
+		auto start = GetTimeMilliseconds();
+		for (size_t r = 0u; r < benchmark_repetitions; ++r)
+			kernels.infuse(out.infused.data(), in.attributes_a.data(), in.stride_a, in.offset_in_a,
+			               in.attributes_b.data(), in.size_b, in.size_b, elements_nb);
+		durations.infuse = GetTimeMilliseconds() - start;
+
+		uint32_t const quad[6] = { 0u, 1u, benchmark_grid_columns + 1u, 0u, benchmark_grid_columns + 1u, benchmark_grid_columns };
+		out.grid_indices.resize(6u * (benchmark_grid_columns - 1u) * (benchmark_grid_rows - 1u));
+		start = GetTimeMilliseconds();
+		for (size_t r = 0u; r < benchmark_repetitions; ++r)
+			kernels.grid_indices(out.grid_indices.data(), benchmark_grid_columns, 0u, benchmark_grid_rows - 1u, quad);
+		durations.grid_indices = GetTimeMilliseconds() - start;
+
+		start = GetTimeMilliseconds();
+		for (size_t r = 0u; r < benchmark_repetitions; ++r) {
+			unfilter_image(kernels, in.rgb_scanlines, 3u, out.rgb_pixels);
+			unfilter_image(kernels, in.rgba_scanlines, 4u, out.rgba_pixels);
+		}
+		durations.unfilter = GetTimeMilliseconds() - start;
+
+		return durations;
+	}
+}
+
+void
+bonobo::benchmark_cpu_kernels()
+{
+	auto generator = xoshiro256ss(0x5eedu);
+
+	benchmark_inputs in;
+	in.stride_a = 24u;
+	in.offset_in_a = 12u;
+	in.size_b = 8u;
+	auto const attributes_nb = benchmark_elements_nb / 8u;
+	in.attributes_a.resize(attributes_nb * in.stride_a);
+	in.attributes_b.resize(attributes_nb * in.size_b);
+	for (auto& byte : in.attributes_a)
+		byte = static_cast<uint8_t>(generator());
+	for (auto& byte : in.attributes_b)
+		byte = static_cast<uint8_t>(generator());
+
+	auto const make_scanlines = [&generator](size_t bytewidth) {
+		auto const length = benchmark_png_width * bytewidth;
+		auto scanlines = std::vector<uint8_t>(benchmark_png_height * (length + 1u));
+		for (size_t y = 0u; y < benchmark_png_height; ++y) {
+			scanlines[y * (length + 1u)] = static_cast<uint8_t>(y % 5u);
+			for (size_t i = 1u; i <= length; ++i)
+				scanlines[y * (length + 1u) + i] = static_cast<uint8_t>(generator());
+		}
+		return scanlines;
+	};
+	in.rgb_scanlines = make_scanlines(3u);
+	in.rgba_scanlines = make_scanlines(4u);
+
+	benchmark_outputs reference;
+	run_kernels(kernels_scalar::kernels, in, reference);
+
+	auto const per_attribute = 1000000.0 / static_cast<double>(benchmark_repetitions * attributes_nb);
+	auto const per_quad = 1000000.0 / static_cast<double>(benchmark_repetitions * (benchmark_grid_columns - 1u) * (benchmark_grid_rows - 1u));
+	auto const per_pixel = 1000000.0 / static_cast<double>(benchmark_repetitions * 2u * benchmark_png_width * benchmark_png_height);
+
+	for (auto const set : all_isas) {
+		auto const kernels = get_cpu_kernels(set);
+		if (kernels == nullptr)
+			continue;
+
+		benchmark_outputs outputs;
+		auto const durations = run_kernels(*kernels, in, outputs);
+		LogInfo("%s kernels%s, in ns per element: %.2f InfuseData() attribute, %.2f grid quad, %.2f unfiltered PNG pixel; %s the scalar ones",
+		        get_isa_name(set), set == get_dispatched_isa() ? " (dispatched)" : "", durations.infuse * per_attribute, durations.grid_indices * per_quad,
+		        durations.unfilter * per_pixel, outputs == reference ? "same results as" : "results differ from");
+	}
+}
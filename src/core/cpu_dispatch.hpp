@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bonobo
+{
+	//! \brief Instruction sets the CPU kernels can be compiled for.
+	//!
+	//! Besides `scalar`, built with the flags of the rest of the project,
+	//! a variant is compiled for each of the others of the architecture
+	//! when the CMake option LUGGCGL_BUILD_MULTIVERSIONED_KERNELS is on:
+	//! SSE4.2, AVX2 and AVX-512 on x86, NEON on ARM.
+	enum class isa : uint8_t {
+		scalar = 0u,
+		sse42,
+		avx2,
+		avx512,
+		neon,
+		count
+	};
+
+	//! \brief Name of `set`, e.g. "AVX2"; also accepted, case aside, by
+	//!        the BONOBO_ISA environment variable.
+	char const* get_isa_name(isa set);
+
+	//! \brief Whether the CPU, and the OS for the AVX registers, support
+	//!        `set`; detected once, with cpuid on x86.
+	bool is_isa_supported(isa set);
+
+	//! \brief Whether a variant of the kernels was compiled for `set`.
+	bool is_isa_compiled(isa set);
+
+	//! \brief Instruction set the kernels are dispatched to: the most
+	//!        capable one both compiled and supported.
+	//!
+	//! Setting the environment variable BONOBO_ISA, to "scalar", "SSE4.2",
+	//! "AVX2", "AVX-512" or "NEON", forces that variant instead, e.g. to
+	//! test the others on the same machine; it is ignored, with a warning,
+	//! if that variant is not compiled or not supported.
+	isa get_dispatched_isa();
+
+	//! \brief CPU kernels behind `InfuseData()`, the PNG decoding of
+	//!        `lodepng` and the index buffers of grids.
+	//!
+	//! All variants give the same results, byte for byte.
+	struct cpu_kernels {
+		//! \brief Insert `size_b` bytes of each of the `count` elements of
+		//!        `b` at `offset_in_a` into the ones of `a`, writing the
+		//!        elements of `stride_a + size_b` bytes to `target`.
+		void (*infuse)(uint8_t* target, uint8_t const* a, size_t stride_a, size_t offset_in_a,
+		               uint8_t const* b, size_t stride_b, size_t size_b, size_t count);
+
+		//! \brief Indices of the two triangles of each quad of the rows
+		//!        [first_row, last_row) of a grid `columns` vertices wide,
+		//!        stored row after row, i.e. 6 * (columns - 1) indices per
+		//!        row; those of the quad whose first vertex is v are v plus
+		//!        each of the offsets of `quad`, e.g. {0, 1, columns + 1,
+		//!        0, columns + 1, columns}.
+		void (*grid_indices)(uint32_t* indices, uint32_t columns, uint32_t first_row, uint32_t last_row,
+		                     uint32_t const quad[6]);
+
+		//! \brief Undo the PNG filter `filter_type` of a scanline of
+		//!        `length` bytes, `precon` being the previous unfiltered
+		//!        one or null; same contract and errors as in `lodepng`.
+		unsigned (*unfilter_png_scanline)(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon,
+		                                  size_t bytewidth, uint8_t filter_type, size_t length);
+	};
+
+	//! \brief Kernels of `get_dispatched_isa()`, bound on the first call;
+	//!        those without a variant for it fall back to the variant of
+	//!        the next less capable instruction set.
+	cpu_kernels const& get_cpu_kernels();
+
+	//! \brief Kernels compiled for `set`, or null if there are none or
+	//!        the CPU does not support them.
+	cpu_kernels const* get_cpu_kernels(isa set);
+
+	//! \brief Have `lodepng` unfilter the scanlines of the PNGs it
+	//!        decodes with the dispatched kernel.
+	void install_png_unfilter();
+
+	//! \brief Time the kernels of every compiled and supported instruction
+	//!        set, check they all match the scalar ones, and log it.
+	void benchmark_cpu_kernels();
+}
@@ -0,0 +1,466 @@
+// Kernels of cpu_dispatch.hpp, compiled once per instruction set by the
+// cpu_kernels_*.cpp files, which define BONOBO_KERNELS_NAMESPACE and the
+// BONOBO_KERNELS_USE_* macro of their set before including this file.
+//
+// Those files are built with different flags, so nothing in here may be
+// an inline function or a template also instantiated by other translation
+// units: the linker would keep a single copy of it, possibly made of
+// instructions the CPU lacks. Hence no glm and no standard containers,
+// only functions and templates in unnamed namespaces, and intrinsics.
+
+#include "cpu_dispatch.hpp"
+
+#include <cstring>
+
+#if !defined(BONOBO_KERNELS_NAMESPACE)
+#error "BONOBO_KERNELS_NAMESPACE has to be defined before including cpu_kernels.inl."
+#endif
+
+#if defined(BONOBO_KERNELS_USE_AVX512)
+#define BONOBO_KERNELS_USE_AVX2 1
+#endif
+#if defined(BONOBO_KERNELS_USE_AVX2)
+#define BONOBO_KERNELS_USE_SSE42 1
+#endif
+
+#if defined(BONOBO_KERNELS_USE_AVX512) && !defined(__AVX512F__)
+#error "cpu_kernels_avx512.cpp has to be compiled with AVX-512 enabled."
+#endif
+#if defined(BONOBO_KERNELS_USE_AVX2) && !defined(__AVX2__)
+#error "cpu_kernels_avx2.cpp has to be compiled with AVX2 enabled."
+#endif
+#if defined(BONOBO_KERNELS_USE_SSE42) && !defined(__SSE4_2__) && !defined(_MSC_VER)
+#error "cpu_kernels_sse42.cpp has to be compiled with SSE4.2 enabled."
+#endif
+#if defined(BONOBO_KERNELS_USE_NEON) && !defined(__ARM_NEON) && !defined(_M_ARM64)
+#error "cpu_kernels_neon.cpp has to be compiled with NEON enabled."
+#endif
+
+#if defined(BONOBO_KERNELS_USE_AVX2)
+#include <immintrin.h>
+#elif defined(BONOBO_KERNELS_USE_SSE42)
+#include <nmmintrin.h>
+#elif defined(BONOBO_KERNELS_USE_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace bonobo
+{
+	namespace BONOBO_KERNELS_NAMESPACE
+	{
+		extern cpu_kernels const kernels;
+
+		namespace
+		{
+#if defined(BONOBO_KERNELS_USE_SSE42)
+			uint32_t
+			load_u32(void const* source, size_t size = 4u)
+			{
+				uint32_t value = 0u;
+				std::memcpy(&value, source, size);
+				return value;
+			}
+
+			void
+			store_u32(void* target, uint32_t value, size_t size = 4u)
+			{
+				std::memcpy(target, &value, size);
+			}
+
+			//! \brief The B bytes of a pixel in the lowest lanes, with B
+			//!        known at compile time so that no memcpy() is called.
+			template<size_t B>
+			__m128i
+			load_pixel(uint8_t const* source)
+			{
+				return _mm_cvtsi32_si128(static_cast<int>(load_u32(source, B)));
+			}
+
+			template<size_t B>
+			void
+			store_pixel(uint8_t* target, __m128i pixel)
+			{
+				store_u32(target, static_cast<uint32_t>(_mm_cvtsi128_si32(pixel)), B);
+			}
+#endif
+
+			//
+			// Attribute interleaving
+			//
+
+			// Each part of an element is copied as one block of B bytes,
+			// whose bytes past the part are then overwritten by the next
+			// part or element. This needs the parts to fit in a block,
+			// and the blocks of the last elements not to go past the
+			// arrays; returns the number of elements copied.
+			template<size_t B>
+			size_t
+			infuse_blocks(uint8_t* target, uint8_t const* a, size_t stride_a, size_t offset_in_a,
+			              uint8_t const* b, size_t stride_b, size_t size_b, size_t count)
+			{
+				auto const stride = stride_a + size_b;
+				auto const fits = [&](size_t i) {
+					return i * stride_a + offset_in_a + B <= count * stride_a
+					    && i * stride_b + B <= (count - 1u) * stride_b + size_b
+					    && i * stride + offset_in_a + size_b + B <= count * stride;
+				};
+				auto blocks_count = count;
+				while (blocks_count > 0u && !fits(blocks_count - 1u))
+					--blocks_count;
+
+				for (size_t i = 0u; i < blocks_count; ++i) {
+					std::memcpy(target, a, B);
+					std::memcpy(target + offset_in_a, b, B);
+					std::memcpy(target + offset_in_a + size_b, a + offset_in_a, B);
+					target += stride;
+					a += stride_a;
+					b += stride_b;
+				}
+				return blocks_count;
+			}
+
+			void
+			infuse(uint8_t* target, uint8_t const* a, size_t stride_a, size_t offset_in_a,
+			       uint8_t const* b, size_t stride_b, size_t size_b, size_t count)
+			{
+				auto const size_post = stride_a - offset_in_a;
+				auto largest_part = offset_in_a > size_b ? offset_in_a : size_b;
+				largest_part = largest_part > size_post ? largest_part : size_post;
+
+				size_t i = 0u;
+				if (count > 0u && largest_part <= 16u)
+					i = infuse_blocks<16u>(target, a, stride_a, offset_in_a, b, stride_b, size_b, count);
+#if defined(BONOBO_KERNELS_USE_AVX2)
+				else if (count > 0u && largest_part <= 32u)
+					i = infuse_blocks<32u>(target, a, stride_a, offset_in_a, b, stride_b, size_b, count);
+#endif
+
+				// The remaining elements, as in InfuseData().
+				target += i * (stride_a + size_b);
+				a += i * stride_a;
+				b += i * stride_b;
+				for (; i < count; ++i) {
+					std::memcpy(target, a, offset_in_a);
+					target += offset_in_a;
+					std::memcpy(target, b, size_b);
+					target += size_b;
+					std::memcpy(target, a + offset_in_a, size_post);
+					target += size_post;
+					a += stride_a;
+					b += stride_b;
+				}
+			}
+
+			//
+			// Grid triangulation
+			//
+
+#if defined(BONOBO_KERNELS_USE_SSE42) || defined(BONOBO_KERNELS_USE_NEON)
+			//! \brief Indices of `quads_nb` consecutive quads, the first
+			//!        one starting at vertex 0: index k is the one of
+			//!        corner k % 6 of quad k / 6.
+			void
+			fill_quads(uint32_t* indices, size_t quads_nb, uint32_t const quad[6])
+			{
+				for (size_t k = 0u; k < 6u * quads_nb; ++k)
+					indices[k] = static_cast<uint32_t>(k / 6u) + quad[k % 6u];
+			}
+#endif
+
+			// The indices of W consecutive quads are 6 vectors of W lanes,
+			// equal to those of the first W quads of the row plus the
+			// first vertex of the W quads.
+			void
+			grid_indices(uint32_t* indices, uint32_t columns, uint32_t first_row, uint32_t last_row,
+			             uint32_t const quad[6])
+			{
+				if (columns < 2u)
+					return;
+				auto const quads_per_row = columns - 1u;
+
+#if defined(BONOBO_KERNELS_USE_AVX512)
+				uint32_t pattern_16[6u * 16u];
+				fill_quads(pattern_16, 16u, quad);
+				__m512i quads_16[6];
+				for (size_t m = 0u; m < 6u; ++m)
+					quads_16[m] = _mm512_loadu_si512(pattern_16 + 16u * m);
+#endif
+#if defined(BONOBO_KERNELS_USE_AVX2)
+				uint32_t pattern_8[6u * 8u];
+				fill_quads(pattern_8, 8u, quad);
+				__m256i quads_8[6];
+				for (size_t m = 0u; m < 6u; ++m)
+					quads_8[m] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(pattern_8 + 8u * m));
+#endif
+#if defined(BONOBO_KERNELS_USE_SSE42) || defined(BONOBO_KERNELS_USE_NEON)
+				uint32_t pattern_4[6u * 4u];
+				fill_quads(pattern_4, 4u, quad);
+#endif
+#if defined(BONOBO_KERNELS_USE_SSE42)
+				__m128i quads_4[6];
+				for (size_t m = 0u; m < 6u; ++m)
+					quads_4[m] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pattern_4 + 4u * m));
+#elif defined(BONOBO_KERNELS_USE_NEON)
+				uint32x4_t quads_4[6];
+				for (size_t m = 0u; m < 6u; ++m)
+					quads_4[m] = vld1q_u32(pattern_4 + 4u * m);
+#endif
+
+				for (auto row = first_row; row < last_row; ++row) {
+					uint32_t j = 0u;
+#if defined(BONOBO_KERNELS_USE_AVX512)
+					for (; j + 16u <= quads_per_row; j += 16u, indices += 6u * 16u) {
+						auto const first = _mm512_set1_epi32(static_cast<int>(row * columns + j));
+						for (size_t m = 0u; m < 6u; ++m)
+							_mm512_storeu_si512(indices + 16u * m, _mm512_add_epi32(quads_16[m], first));
+					}
+#endif
+#if defined(BONOBO_KERNELS_USE_AVX2)
+					for (; j + 8u <= quads_per_row; j += 8u, indices += 6u * 8u) {
+						auto const first = _mm256_set1_epi32(static_cast<int>(row * columns + j));
+						for (size_t m = 0u; m < 6u; ++m)
+							_mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + 8u * m), _mm256_add_epi32(quads_8[m], first));
+					}
+#endif
+#if defined(BONOBO_KERNELS_USE_SSE42)
+					for (; j + 4u <= quads_per_row; j += 4u, indices += 6u * 4u) {
+						auto const first = _mm_set1_epi32(static_cast<int>(row * columns + j));
+						for (size_t m = 0u; m < 6u; ++m)
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + 4u * m), _mm_add_epi32(quads_4[m], first));
+					}
+#elif defined(BONOBO_KERNELS_USE_NEON)
+					for (; j + 4u <= quads_per_row; j += 4u, indices += 6u * 4u) {
+						auto const first = vdupq_n_u32(row * columns + j);
+						for (size_t m = 0u; m < 6u; ++m)
+							vst1q_u32(indices + 4u * m, vaddq_u32(quads_4[m], first));
+					}
+#endif
+					for (; j < quads_per_row; ++j, indices += 6u) {
+						auto const first = row * columns + j;
+						for (size_t k = 0u; k < 6u; ++k)
+							indices[k] = first + quad[k];
+					}
+				}
+			}
+
+			//
+			// PNG unfiltering
+			//
+			// `recon` may start before `scanline` in the same buffer, as
+			// lodepng unfilters in place: each block of `scanline` is thus
+			// read before the same block of `recon` is written.
+			//
+
+			uint8_t
+			paeth_predictor(int a, int b, int c)
+			{
+				auto const pa = b > c ? b - c : c - b;
+				auto const pb = a > c ? a - c : c - a;
+				auto const pc = a + b - c - c >= 0 ? a + b - c - c : c + c - a - b;
+				if (pc < pa && pc < pb)
+					return static_cast<uint8_t>(c);
+				if (pb < pa)
+					return static_cast<uint8_t>(b);
+				return static_cast<uint8_t>(a);
+			}
+
+			void
+			unfilter_none(uint8_t* recon, uint8_t const* scanline, size_t length)
+			{
+				if (recon != scanline)
+					std::memmove(recon, scanline, length);
+			}
+
+#if defined(BONOBO_KERNELS_USE_SSE42)
+			// One pixel of B bytes per iteration, added to the previous
+			// one byte by byte; returns the number of bytes done.
+			template<size_t B>
+			size_t
+			unfilter_sub_pixels(uint8_t* recon, uint8_t const* scanline, size_t length)
+			{
+				size_t i = 0u;
+				auto previous = _mm_setzero_si128();
+				for (; i + B <= length; i += B) {
+					previous = _mm_add_epi8(previous, load_pixel<B>(scanline + i));
+					store_pixel<B>(recon + i, previous);
+				}
+				return i;
+			}
+#endif
+
+			void
+			unfilter_sub(uint8_t* recon, uint8_t const* scanline, size_t bytewidth, size_t length)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_KERNELS_USE_SSE42)
+				if (bytewidth == 3u)
+					i = unfilter_sub_pixels<3u>(recon, scanline, length);
+				else if (bytewidth == 4u)
+					i = unfilter_sub_pixels<4u>(recon, scanline, length);
+#endif
+				for (; i < bytewidth && i < length; ++i)
+					recon[i] = scanline[i];
+				for (; i < length; ++i)
+					recon[i] = static_cast<uint8_t>(scanline[i] + recon[i - bytewidth]);
+			}
+
+			void
+			unfilter_up(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon, size_t length)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_KERNELS_USE_AVX2)
+				for (; i + 32u <= length; i += 32u) {
+					auto const current = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(scanline + i));
+					auto const above = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(precon + i));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(recon + i), _mm256_add_epi8(current, above));
+				}
+#endif
+#if defined(BONOBO_KERNELS_USE_SSE42)
+				for (; i + 16u <= length; i += 16u) {
+					auto const current = _mm_loadu_si128(reinterpret_cast<__m128i const*>(scanline + i));
+					auto const above = _mm_loadu_si128(reinterpret_cast<__m128i const*>(precon + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(recon + i), _mm_add_epi8(current, above));
+				}
+#elif defined(BONOBO_KERNELS_USE_NEON)
+				for (; i + 16u <= length; i += 16u)
+					vst1q_u8(recon + i, vaddq_u8(vld1q_u8(scanline + i), vld1q_u8(precon + i)));
+#endif
+				for (; i < length; ++i)
+					recon[i] = static_cast<uint8_t>(scanline[i] + precon[i]);
+			}
+
+#if defined(BONOBO_KERNELS_USE_SSE42)
+			// _mm_avg_epu8() rounds up, hence the subtraction of the
+			// lowest bit of a + b; the first pixel averages with 0.
+			template<size_t B>
+			size_t
+			unfilter_average_pixels(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon, size_t length)
+			{
+				size_t i = 0u;
+				auto const ones = _mm_set1_epi8(1);
+				auto previous = _mm_setzero_si128();
+				for (; i + B <= length; i += B) {
+					auto const above = load_pixel<B>(precon + i);
+					auto const average = _mm_sub_epi8(_mm_avg_epu8(previous, above),
+					                                  _mm_and_si128(_mm_xor_si128(previous, above), ones));
+					previous = _mm_add_epi8(load_pixel<B>(scanline + i), average);
+					store_pixel<B>(recon + i, previous);
+				}
+				return i;
+			}
+#endif
+
+			void
+			unfilter_average(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon, size_t bytewidth, size_t length)
+			{
+				size_t i = 0u;
+				if (precon == nullptr) {
+					for (; i < bytewidth && i < length; ++i)
+						recon[i] = scanline[i];
+					for (; i < length; ++i)
+						recon[i] = static_cast<uint8_t>(scanline[i] + recon[i - bytewidth] / 2);
+					return;
+				}
+#if defined(BONOBO_KERNELS_USE_SSE42)
+				if (bytewidth == 3u)
+					i = unfilter_average_pixels<3u>(recon, scanline, precon, length);
+				else if (bytewidth == 4u)
+					i = unfilter_average_pixels<4u>(recon, scanline, precon, length);
+#endif
+				for (; i < bytewidth && i < length; ++i)
+					recon[i] = static_cast<uint8_t>(scanline[i] + precon[i] / 2);
+				for (; i < length; ++i)
+					recon[i] = static_cast<uint8_t>(scanline[i] + (recon[i - bytewidth] + precon[i]) / 2);
+			}
+
+#if defined(BONOBO_KERNELS_USE_SSE42)
+			// One pixel per iteration, on 16-bit lanes; a is the left
+			// pixel, b the one above and c the one above on the left, all
+			// 0 for the first pixel, which predicts b as expected.
+			template<size_t B>
+			size_t
+			unfilter_paeth_pixels(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon, size_t length)
+			{
+				size_t i = 0u;
+				auto a = _mm_setzero_si128();
+				auto c = _mm_setzero_si128();
+				for (; i + B <= length; i += B) {
+					auto const b = _mm_cvtepu8_epi16(load_pixel<B>(precon + i));
+
+					auto const b_minus_c = _mm_sub_epi16(b, c);
+					auto const a_minus_c = _mm_sub_epi16(a, c);
+					auto const pa = _mm_abs_epi16(b_minus_c);
+					auto const pb = _mm_abs_epi16(a_minus_c);
+					auto const pc = _mm_abs_epi16(_mm_add_epi16(b_minus_c, a_minus_c));
+					auto const smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+					auto predictor = c;
+					predictor = _mm_blendv_epi8(predictor, b, _mm_cmpeq_epi16(smallest, pb));
+					predictor = _mm_blendv_epi8(predictor, a, _mm_cmpeq_epi16(smallest, pa));
+
+					auto const result = _mm_add_epi8(load_pixel<B>(scanline + i), _mm_packus_epi16(predictor, predictor));
+					store_pixel<B>(recon + i, result);
+					a = _mm_cvtepu8_epi16(result);
+					c = b;
+				}
+				return i;
+			}
+#endif
+
+			void
+			unfilter_paeth(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon, size_t bytewidth, size_t length)
+			{
+				if (precon == nullptr) {
+					// The predictor of the first scanline is the left pixel.
+					unfilter_sub(recon, scanline, bytewidth, length);
+					return;
+				}
+				size_t i = 0u;
+#if defined(BONOBO_KERNELS_USE_SSE42)
+				if (bytewidth == 3u)
+					i = unfilter_paeth_pixels<3u>(recon, scanline, precon, length);
+				else if (bytewidth == 4u)
+					i = unfilter_paeth_pixels<4u>(recon, scanline, precon, length);
+#endif
+				for (; i < bytewidth && i < length; ++i)
+					recon[i] = static_cast<uint8_t>(scanline[i] + precon[i]);
+				for (; i < length; ++i)
+					recon[i] = static_cast<uint8_t>(scanline[i] + paeth_predictor(recon[i - bytewidth], precon[i], precon[i - bytewidth]));
+			}
+
+			unsigned
+			unfilter_png_scanline(uint8_t* recon, uint8_t const* scanline, uint8_t const* precon,
+			                      size_t bytewidth, uint8_t filter_type, size_t length)
+			{
+				switch (filter_type) {
+				case 0u:
+					unfilter_none(recon, scanline, length);
+					return 0u;
+				case 1u:
+					unfilter_sub(recon, scanline, bytewidth, length);
+					return 0u;
+				case 2u:
+					if (precon != nullptr)
+						unfilter_up(recon, scanline, precon, length);
+					else
+						unfilter_none(recon, scanline, length);
+					return 0u;
+				case 3u:
+					unfilter_average(recon, scanline, precon, bytewidth, length);
+					return 0u;
+				case 4u:
+					unfilter_paeth(recon, scanline, precon, bytewidth, length);
+					return 0u;
+				default:
+					return 36u; // Same error as lodepng, for an unknown filter type.
+				}
+			}
+		}
+
+		cpu_kernels const kernels = {
+			&infuse,
+			&grid_indices,
+			&unfilter_png_scanline
+		};
+	}
+}
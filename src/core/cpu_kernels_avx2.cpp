@@ -0,0 +1,4 @@
+// Kernels of cpu_dispatch.hpp for AVX2, built with -mavx2 or /arch:AVX2.
+#define BONOBO_KERNELS_NAMESPACE kernels_avx2
+#define BONOBO_KERNELS_USE_AVX2 1
+#include "cpu_kernels.inl"
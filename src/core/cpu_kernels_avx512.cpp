@@ -0,0 +1,5 @@
+// Kernels of cpu_dispatch.hpp for AVX-512F, built with -mavx512f or
+// /arch:AVX512.
+#define BONOBO_KERNELS_NAMESPACE kernels_avx512
+#define BONOBO_KERNELS_USE_AVX512 1
+#include "cpu_kernels.inl"
@@ -0,0 +1,5 @@
+// Kernels of cpu_dispatch.hpp for NEON, built with -mfpu=neon on 32-bit
+// ARM; it is part of the baseline of 64-bit ARM.
+#define BONOBO_KERNELS_NAMESPACE kernels_neon
+#define BONOBO_KERNELS_USE_NEON 1
+#include "cpu_kernels.inl"
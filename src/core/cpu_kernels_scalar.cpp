@@ -0,0 +1,4 @@
+// Kernels of cpu_dispatch.hpp built with the flags of the rest of the
+// project; always compiled, they are the fallback of all the others.
+#define BONOBO_KERNELS_NAMESPACE kernels_scalar
+#include "cpu_kernels.inl"
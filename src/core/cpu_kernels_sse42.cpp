@@ -0,0 +1,4 @@
+// Kernels of cpu_dispatch.hpp for SSE4.2, built with -msse4.2.
+#define BONOBO_KERNELS_NAMESPACE kernels_sse42
+#define BONOBO_KERNELS_USE_SSE42 1
+#include "cpu_kernels.inl"
@@ -0,0 +1,120 @@
+#include "draw_command_builder.hpp"
+
+#include "core/Log.h"
+#include "core/Misc.h"
+#include "core/random.hpp"
+#include "core/transforms.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+void
+bonobo::draw_command_builder::clear()
+{
+	_draws.clear();
+	_sort_keys.clear();
+	_commands.clear();
+	_transforms.clear();
+	_normal_transforms.clear();
+	_batches.clear();
+}
+
+void
+bonobo::draw_command_builder::add(mesh_data const& mesh, uint32_t material, glm::mat4 const& model_to_world)
+{
+	if (mesh.ibo == 0u || mesh.indices_nb == 0u) {
+		LogWarning("Only indexed meshes can be drawn indirectly; ignoring mesh using VAO %u.", mesh.vao);
+		return;
+	}
+
+	draw d;
+	d.count = static_cast<GLuint>(mesh.indices_nb);
+	d.first_index = mesh.first_index;
+	d.base_vertex = mesh.base_vertex;
+	d.material = material;
+	d.model_to_world = model_to_world;
+	_draws.push_back(d);
+}
+
+void
+bonobo::draw_command_builder::build()
+{
+	assert(_draws.size() <= 0xffffffffu);
+
+	// Sort on (material, draw index): the draw index keeps the order
+	// stable, so that results do not depend on the sort implementation.
+	_sort_keys.resize(_draws.size());
+	for (size_t i = 0u; i < _draws.size(); ++i)
+		_sort_keys[i] = (static_cast<uint64_t>(_draws[i].material) << 32) | static_cast<uint64_t>(i);
+	std::sort(_sort_keys.begin(), _sort_keys.end());
+
+	_commands.resize(_draws.size());
+	_transforms.resize(_draws.size());
+	_batches.clear();
+	for (size_t i = 0u; i < _sort_keys.size(); ++i) {
+		auto const& d = _draws[static_cast<size_t>(_sort_keys[i] & 0xffffffffu)];
+
+		auto& command = _commands[i];
+		command.count = d.count;
+		command.instance_count = 1u;
+		command.first_index = d.first_index;
+		command.base_vertex = d.base_vertex;
+		command.base_instance = static_cast<GLuint>(i);
+
+		_transforms[i] = d.model_to_world;
+
+		if (_batches.empty() || _batches.back().material != d.material)
+			_batches.push_back({ d.material, i, 0u });
+		++_batches.back().commands_nb;
+	}
+
+	_normal_transforms.resize(_transforms.size());
+	normal_matrices(_transforms.data(), _transforms.size(), _normal_transforms.data());
+}
+
+void
+bonobo::benchmark_draw_commands()
+{
+	size_t const count = 65536u;
+	uint32_t const materials_nb = 32u;
+	auto const per_draw = 1.0e6 / static_cast<double>(count);
+
+	xoshiro256ss generator(1u);
+	std::vector<mesh_data> meshes(count);
+	std::vector<uint32_t> materials(count);
+	std::vector<glm::mat4> model_to_worlds(count);
+	for (size_t i = 0u; i < count; ++i) {
+		meshes[i].vao = 1u;
+		meshes[i].ibo = 1u;
+		meshes[i].indices_nb = 3u * static_cast<size_t>(generator.uniform(1.0f, 1000.0f));
+		meshes[i].first_index = static_cast<GLuint>(3u * i);
+		meshes[i].base_vertex = static_cast<GLint>(i);
+		materials[i] = std::min(static_cast<uint32_t>(generator.next_float() * materials_nb), materials_nb - 1u);
+		model_to_worlds[i] = glm::mat4(glm::vec4(generator.uniform(0.5f, 2.0f), 0.0f, 0.0f, 0.0f),
+		                               glm::vec4(0.0f, generator.uniform(0.5f, 2.0f), 0.0f, 0.0f),
+		                               glm::vec4(0.0f, 0.0f, generator.uniform(0.5f, 2.0f), 0.0f),
+		                               glm::vec4(generator.uniform(-100.0f, 100.0f), generator.uniform(-100.0f, 100.0f),
+		                                         generator.uniform(-100.0f, 100.0f), 1.0f));
+	}
+
+	// As from one frame to the next, the second round reuses the storage
+	// of the first one.
+	draw_command_builder builder;
+	double add_duration = 0.0, build_duration = 0.0;
+	for (int round = 0; round < 2; ++round) {
+		builder.clear();
+		auto start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < count; ++i)
+			builder.add(meshes[i], materials[i], model_to_worlds[i]);
+		add_duration = GetTimeMilliseconds() - start;
+
+		start = GetTimeMilliseconds();
+		builder.build();
+		build_duration = GetTimeMilliseconds() - start;
+	}
+
+	LogInfo("Indirect commands for %zu draws in %zu batches, in ns per draw: %.1f queuing them, %.1f building them (checksum %g)",
+	        builder.get_commands().size(), builder.get_batches().size(),
+	        add_duration * per_draw, build_duration * per_draw,
+	        builder.get_normal_transforms()[count / 2u][0][0]);
+}
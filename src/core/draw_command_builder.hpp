@@ -0,0 +1,92 @@
+#pragma once
+
+#include "helpers.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Indexed draw parameters, laid out as expected by
+	//!        `glDrawElementsIndirect()` and `glMultiDrawElementsIndirect()`.
+	struct draw_elements_indirect_command {
+		GLuint count;          //!< number of indices to draw
+		GLuint instance_count; //!< number of instances to draw
+		GLuint first_index;    //!< index of the first index in the index buffer
+		GLint base_vertex;     //!< value added to every fetched index
+		GLuint base_instance;  //!< value added to the instance index when
+		                       //!< fetching instanced attributes
+	};
+	static_assert(sizeof(draw_elements_indirect_command) == 5u * sizeof(GLuint),
+	              "Indirect commands must be tightly packed.");
+
+	//! \brief Turns a list of visible submeshes into indirect draw commands,
+	//!        grouped by material.
+	//!
+	//! Submeshes are queued with `add()`; `build()` then sorts them by
+	//! material, fills one indirect command per submesh and the matching
+	//! per-draw transforms and normal transforms, the latter computed all
+	//! at once with `normal_matrices()`. Each command's `base_instance` is its own index,
+	//! so that a per-draw attribute with a divisor of 1 can be used by the
+	//! shader to look up its transform.
+	//!
+	//! This class does not issue any OpenGL call: it can be exercised and
+	//! timed without a context. `indirect_draw_buffer`, from
+	//! draw_commands.hpp, uploads and submits its output.
+	class draw_command_builder
+	{
+	public:
+		//! \brief Consecutive commands sharing the same material.
+		struct batch {
+			uint32_t material;    //!< material identifier given to `add()`
+			size_t first_command; //!< index of the first command of the batch
+			size_t commands_nb;   //!< number of commands in the batch
+		};
+
+		//! \brief Forget every queued submesh and built command.
+		void clear();
+
+		//! \brief Queue a submesh for drawing.
+		//!
+		//! Only indexed meshes can be drawn indirectly; others are ignored
+		//! with a warning.
+		//!
+		//! @param [in] mesh submesh to draw, usually coming from a
+		//!             `geometry_arena`
+		//! @param [in] material identifier used to group draws together
+		//! @param [in] model_to_world matrix transforming the submesh from
+		//!             model-space to world-space
+		void add(mesh_data const& mesh, uint32_t material, glm::mat4 const& model_to_world);
+
+		//! \brief Sort the queued submeshes and generate the commands,
+		//!        transforms, normal transforms and batches.
+		void build();
+
+		std::vector<draw_elements_indirect_command> const& get_commands() const { return _commands; }
+		std::vector<glm::mat4> const& get_transforms() const { return _transforms; }
+		std::vector<glm::mat3x4> const& get_normal_transforms() const { return _normal_transforms; }
+		std::vector<batch> const& get_batches() const { return _batches; }
+
+	private:
+		struct draw {
+			GLuint count;
+			GLuint first_index;
+			GLint base_vertex;
+			uint32_t material;
+			glm::mat4 model_to_world;
+		};
+
+		std::vector<draw> _draws;
+		std::vector<uint64_t> _sort_keys;
+		std::vector<draw_elements_indirect_command> _commands;
+		std::vector<glm::mat4> _transforms;
+		std::vector<glm::mat3x4> _normal_transforms;
+		std::vector<batch> _batches;
+	};
+
+	//! \brief Time `draw_command_builder` over many submeshes spread
+	//!        across a few materials, and log the time spent per draw
+	//!        queuing them and building their commands.
+	void benchmark_draw_commands();
+}
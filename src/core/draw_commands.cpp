@@ -0,0 +1,174 @@
+#include "draw_commands.hpp"
+
+#include "core/Log.h"
+#include "core/opengl.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace
+{
+	typedef void (APIENTRYP multi_draw_elements_indirect_proc)(GLenum mode, GLenum type, void const* indirect, GLsizei drawcount, GLsizei stride);
+
+	//! Optional features used by `indirect_draw_buffer`, queried once the
+	//! first time they are needed, as they require a current context.
+	struct indirect_features {
+		multi_draw_elements_indirect_proc multi_draw_elements_indirect;
+		bool has_base_instance;
+	};
+
+	indirect_features const& get_indirect_features()
+	{
+		static indirect_features const features = []() {
+			indirect_features f;
+			f.multi_draw_elements_indirect = nullptr;
+			// Both extensions are core in OpenGL 4.3 and 4.2 respectively,
+			// but the labs only request a 4.1 context.
+			if (utils::opengl::has_extension("GL_ARB_multi_draw_indirect"))
+				f.multi_draw_elements_indirect = reinterpret_cast<multi_draw_elements_indirect_proc>(glfwGetProcAddress("glMultiDrawElementsIndirect"));
+			f.has_base_instance = utils::opengl::has_extension("GL_ARB_base_instance");
+			if (f.multi_draw_elements_indirect == nullptr)
+				LogInfo("glMultiDrawElementsIndirect is unavailable: indirect commands will be submitted one by one.");
+			return f;
+		}();
+		return features;
+	}
+
+	//! Make sure `buffer` can hold `size` bytes, reallocating it if not.
+	void reserve_buffer(GLenum target, GLuint buffer, size_t size, size_t& capacity)
+	{
+		glBindBuffer(target, buffer);
+		if (size > capacity) {
+			capacity = std::max(size, 2u * capacity);
+			glBufferData(target, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+		}
+	}
+}
+
+bonobo::indirect_draw_buffer::indirect_draw_buffer() :
+	_commands_buffer(0u), _draw_ids_buffer(0u), _transforms_buffer(0u), _transforms_texture(0u),
+	_commands_nb(0u), _commands_capacity(0u), _draw_ids_capacity(0u), _transforms_capacity(0u)
+{
+	glGenBuffers(1, &_commands_buffer);
+	assert(_commands_buffer != 0u);
+	glGenBuffers(1, &_draw_ids_buffer);
+	assert(_draw_ids_buffer != 0u);
+	glGenBuffers(1, &_transforms_buffer);
+	assert(_transforms_buffer != 0u);
+	glGenTextures(1, &_transforms_texture);
+	assert(_transforms_texture != 0u);
+}
+
+bonobo::indirect_draw_buffer::~indirect_draw_buffer()
+{
+	glDeleteTextures(1, &_transforms_texture);
+	glDeleteBuffers(1, &_transforms_buffer);
+	glDeleteBuffers(1, &_draw_ids_buffer);
+	glDeleteBuffers(1, &_commands_buffer);
+}
+
+void
+bonobo::indirect_draw_buffer::attach(GLuint vao) const
+{
+	auto const location = static_cast<unsigned int>(shader_bindings::draw_ids);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, _draw_ids_buffer);
+	glEnableVertexAttribArray(location);
+	glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, 0, reinterpret_cast<GLvoid const*>(0x0));
+	glVertexAttribDivisor(location, 1u);
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+}
+
+void
+bonobo::indirect_draw_buffer::upload(draw_command_builder const& builder)
+{
+	auto const& features = get_indirect_features();
+	auto const& commands = builder.get_commands();
+	auto const& transforms = builder.get_transforms();
+	auto const& normal_transforms = builder.get_normal_transforms();
+	_commands_nb = commands.size();
+	if (_commands_nb == 0u)
+		return;
+
+	reserve_buffer(GL_DRAW_INDIRECT_BUFFER, _commands_buffer,
+	               commands.size() * sizeof(draw_elements_indirect_command), _commands_capacity);
+	if (features.has_base_instance) {
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(commands.size() * sizeof(draw_elements_indirect_command)), commands.data());
+	} else {
+		// Without GL_ARB_base_instance, `base_instance` must be zero; the
+		// draw index is then given through `draw_id_offset` instead.
+		std::vector<draw_elements_indirect_command> zeroed(commands);
+		for (auto& command : zeroed)
+			command.base_instance = 0u;
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(zeroed.size() * sizeof(draw_elements_indirect_command)), zeroed.data());
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0u);
+
+	// The draw identifiers are simply 0, 1, 2, …; they only need to be
+	// rewritten when more commands than before are uploaded.
+	auto const draw_ids_size = commands.size() * sizeof(GLuint);
+	if (draw_ids_size > _draw_ids_capacity) {
+		std::vector<GLuint> draw_ids(commands.size());
+		std::iota(draw_ids.begin(), draw_ids.end(), 0u);
+		_draw_ids_capacity = draw_ids_size;
+		glBindBuffer(GL_ARRAY_BUFFER, _draw_ids_buffer);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(draw_ids_size), draw_ids.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0u);
+	}
+
+	auto const previous_transforms_capacity = _transforms_capacity;
+	auto const transforms_size = transforms.size() * sizeof(glm::mat4);
+	auto const normal_transforms_size = normal_transforms.size() * sizeof(glm::mat3x4);
+	reserve_buffer(GL_TEXTURE_BUFFER, _transforms_buffer, transforms_size + normal_transforms_size, _transforms_capacity);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(transforms_size), transforms.data());
+	glBufferSubData(GL_TEXTURE_BUFFER, static_cast<GLintptr>(transforms_size), static_cast<GLsizeiptr>(normal_transforms_size), normal_transforms.data());
+	if (_transforms_capacity != previous_transforms_capacity) {
+		glBindTexture(GL_TEXTURE_BUFFER, _transforms_texture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, _transforms_buffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0u);
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, 0u);
+}
+
+void
+bonobo::indirect_draw_buffer::submit(GLuint program, GLuint transforms_unit,
+                                     size_t first_command, size_t commands_nb,
+                                     GLenum drawing_mode) const
+{
+	if (commands_nb == 0u)
+		return;
+	assert(first_command + commands_nb <= _commands_nb);
+
+	auto const& features = get_indirect_features();
+
+	glActiveTexture(GL_TEXTURE0 + transforms_unit);
+	glBindTexture(GL_TEXTURE_BUFFER, _transforms_texture);
+	glUniform1i(glGetUniformLocation(program, "draw_transforms"), static_cast<GLint>(transforms_unit));
+	glUniform1ui(glGetUniformLocation(program, "normal_transforms_base"), static_cast<GLuint>(4u * _commands_nb));
+	auto const draw_id_offset_location = glGetUniformLocation(program, "draw_id_offset");
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commands_buffer);
+	auto const stride = sizeof(draw_elements_indirect_command);
+	if (features.multi_draw_elements_indirect != nullptr && features.has_base_instance) {
+		glUniform1ui(draw_id_offset_location, 0u);
+		features.multi_draw_elements_indirect(drawing_mode, GL_UNSIGNED_INT,
+		                                      reinterpret_cast<GLvoid const*>(first_command * stride),
+		                                      static_cast<GLsizei>(commands_nb), 0);
+	} else {
+		for (size_t i = first_command; i < first_command + commands_nb; ++i) {
+			glUniform1ui(draw_id_offset_location, features.has_base_instance ? 0u : static_cast<GLuint>(i));
+			glDrawElementsIndirect(drawing_mode, GL_UNSIGNED_INT, reinterpret_cast<GLvoid const*>(i * stride));
+		}
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0u);
+
+	glBindTexture(GL_TEXTURE_BUFFER, 0u);
+}
+
+void
+bonobo::indirect_draw_buffer::submit(GLuint program, GLuint transforms_unit, GLenum drawing_mode) const
+{
+	submit(program, transforms_unit, 0u, _commands_nb, drawing_mode);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "draw_command_builder.hpp"
+#include "helpers.hpp"
+
+#include <cstddef>
+
+namespace bonobo
+{
+	//! \brief GPU side of `draw_command_builder`: stores its commands in a
+	//!        GL_DRAW_INDIRECT_BUFFER and its transforms in a buffer
+	//!        texture, and submits ranges of commands.
+	//!
+	//! Submission uses a single `glMultiDrawElementsIndirect()` when the
+	//! driver exposes GL_ARB_multi_draw_indirect, and otherwise falls back
+	//! to one `glDrawElementsIndirect()` per command, which still avoids
+	//! any per-draw state change on the CPU side.
+	//!
+	//! Shaders access the per-draw data through:
+	//! * `layout (location = 5) in uint draw_id;`
+	//! * `uniform uint draw_id_offset;`
+	//! * `uniform samplerBuffer draw_transforms;`
+	//! * `uniform uint normal_transforms_base;`
+	//! where the transform of a draw is found in the 4 texels starting at
+	//! `4 * (draw_id + draw_id_offset)`, and its normal transform in the 3
+	//! texels starting at `normal_transforms_base + 3 * (draw_id +
+	//! draw_id_offset)`; all transforms come first, then all normal ones.
+	class indirect_draw_buffer
+	{
+	public:
+		indirect_draw_buffer();
+		~indirect_draw_buffer();
+
+		indirect_draw_buffer(indirect_draw_buffer const&) = delete;
+		indirect_draw_buffer& operator=(indirect_draw_buffer const&) = delete;
+
+		//! \brief Setup the `draw_id` attribute on a Vertex Array, i.e.
+		//!        the one of a `geometry_arena`.
+		void attach(GLuint vao) const;
+
+		//! \brief Copy the commands, transforms and normal transforms of
+		//!        `builder` to the GPU.
+		void upload(draw_command_builder const& builder);
+
+		//! \brief Draw a range of the uploaded commands.
+		//!
+		//! The Vertex Array the commands refer to, and which was given to
+		//! `attach()`, should be bound.
+		//!
+		//! @param [in] program shader program currently in use
+		//! @param [in] transforms_unit texture unit to bind the transforms
+		//!             buffer texture to
+		//! @param [in] first_command index of the first command to draw
+		//! @param [in] commands_nb number of commands to draw
+		//! @param [in] drawing_mode OpenGL drawing mode of all the commands
+		void submit(GLuint program, GLuint transforms_unit,
+		            size_t first_command, size_t commands_nb,
+		            GLenum drawing_mode = GL_TRIANGLES) const;
+
+		//! \brief Draw all uploaded commands.
+		void submit(GLuint program, GLuint transforms_unit, GLenum drawing_mode = GL_TRIANGLES) const;
+
+		size_t get_commands_nb() const { return _commands_nb; }
+
+	private:
+		GLuint _commands_buffer;
+		GLuint _draw_ids_buffer;
+		GLuint _transforms_buffer;
+		GLuint _transforms_texture;
+		size_t _commands_nb;
+		size_t _commands_capacity;
+		size_t _draw_ids_capacity;
+		size_t _transforms_capacity;
+	};
+}
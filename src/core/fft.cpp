@@ -0,0 +1,167 @@
+#include "fft.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FFT_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// Below this many values, splitting a pass across threads costs more
+	// than it saves.
+	constexpr size_t min_values_per_thread = 8192u;
+
+	// Butterflies a' = a + w b, b' = a - w b, for `count` consecutive
+	// values of `a` and `b`, with either one twiddle factor for all of
+	// them, or one per value.
+	template<bool SharedTwiddle>
+	void
+	butterflies(float* a_real, float* a_imaginary, float* b_real, float* b_imaginary,
+	            float const* w_real, float const* w_imaginary, float sign, size_t count)
+	{
+		size_t i = 0u;
+#if defined(FFT_USE_SSE)
+		auto const sign_v = _mm_set1_ps(sign);
+		auto wr = _mm_set1_ps(w_real[0]);
+		auto wi = _mm_mul_ps(_mm_set1_ps(w_imaginary[0]), sign_v);
+		for (; i + 4u <= count; i += 4u) {
+			if (!SharedTwiddle) {
+				wr = _mm_loadu_ps(w_real + i);
+				wi = _mm_mul_ps(_mm_loadu_ps(w_imaginary + i), sign_v);
+			}
+			auto const ar = _mm_loadu_ps(a_real + i);
+			auto const ai = _mm_loadu_ps(a_imaginary + i);
+			auto const br = _mm_loadu_ps(b_real + i);
+			auto const bi = _mm_loadu_ps(b_imaginary + i);
+			auto const tr = _mm_sub_ps(_mm_mul_ps(wr, br), _mm_mul_ps(wi, bi));
+			auto const ti = _mm_add_ps(_mm_mul_ps(wr, bi), _mm_mul_ps(wi, br));
+			_mm_storeu_ps(a_real + i, _mm_add_ps(ar, tr));
+			_mm_storeu_ps(a_imaginary + i, _mm_add_ps(ai, ti));
+			_mm_storeu_ps(b_real + i, _mm_sub_ps(ar, tr));
+			_mm_storeu_ps(b_imaginary + i, _mm_sub_ps(ai, ti));
+		}
+#endif
+		for (; i < count; ++i) {
+			auto const wr = SharedTwiddle ? w_real[0] : w_real[i];
+			auto const wi = sign * (SharedTwiddle ? w_imaginary[0] : w_imaginary[i]);
+			auto const tr = wr * b_real[i] - wi * b_imaginary[i];
+			auto const ti = wr * b_imaginary[i] + wi * b_real[i];
+			b_real[i] = a_real[i] - tr;
+			b_imaginary[i] = a_imaginary[i] - ti;
+			a_real[i] += tr;
+			a_imaginary[i] += ti;
+		}
+	}
+}
+
+bonobo::fft_2d::fft_2d(size_t size) :
+	_size(size), _bit_reversal(size), _twiddles_real(size > 1u ? size - 1u : 0u),
+	_twiddles_imaginary(size > 1u ? size - 1u : 0u)
+{
+	assert(size > 0u && (size & (size - 1u)) == 0u);
+
+	size_t bits_nb = 0u;
+	while ((size_t(1u) << bits_nb) < size)
+		++bits_nb;
+	for (size_t i = 0u; i < size; ++i) {
+		uint32_t reversed = 0u;
+		for (size_t b = 0u; b < bits_nb; ++b)
+			if (i & (size_t(1u) << b))
+				reversed |= uint32_t(1u) << (bits_nb - 1u - b);
+		_bit_reversal[i] = reversed;
+	}
+
+	double const two_pi = 6.283185307179586476925;
+	for (size_t n = 2u; n <= size; n *= 2u) {
+		auto const half = n / 2u;
+		for (size_t k = 0u; k < half; ++k) {
+			auto const angle = -two_pi * static_cast<double>(k) / static_cast<double>(n);
+			_twiddles_real[half - 1u + k] = static_cast<float>(std::cos(angle));
+			_twiddles_imaginary[half - 1u + k] = static_cast<float>(std::sin(angle));
+		}
+	}
+}
+
+void
+bonobo::fft_2d::transform(float* real, float* imaginary, fft_direction direction) const
+{
+	auto const sign = direction == fft_direction::forward ? 1.0f : -1.0f;
+	auto const min_lines_per_thread = std::max<size_t>(min_values_per_thread / _size, 1u);
+
+	parallel_for(_size, [&](size_t first, size_t last) {
+		transform_rows(real, imaginary, sign, first, last);
+	}, min_lines_per_thread);
+
+	// Columns are handed out by groups of four, to keep each thread's
+	// range aligned on whole SSE registers.
+	auto const groups_nb = (_size + 3u) / 4u;
+	parallel_for(groups_nb, [&](size_t first, size_t last) {
+		transform_columns(real, imaginary, sign, 4u * first, std::min(4u * last, _size));
+	}, std::max<size_t>(min_lines_per_thread / 4u, 1u));
+}
+
+void
+bonobo::fft_2d::transform_rows(float* real, float* imaginary, float sign,
+                               size_t first_row, size_t last_row) const
+{
+	for (size_t row = first_row; row < last_row; ++row) {
+		auto* const row_real = real + row * _size;
+		auto* const row_imaginary = imaginary + row * _size;
+
+		for (size_t i = 0u; i < _size; ++i) {
+			auto const j = _bit_reversal[i];
+			if (i < j) {
+				std::swap(row_real[i], row_real[j]);
+				std::swap(row_imaginary[i], row_imaginary[j]);
+			}
+		}
+
+		for (size_t n = 2u; n <= _size; n *= 2u) {
+			auto const half = n / 2u;
+			auto const* const w_real = _twiddles_real.data() + half - 1u;
+			auto const* const w_imaginary = _twiddles_imaginary.data() + half - 1u;
+			for (size_t start = 0u; start < _size; start += n)
+				butterflies<false>(row_real + start, row_imaginary + start,
+				                   row_real + start + half, row_imaginary + start + half,
+				                   w_real, w_imaginary, sign, half);
+		}
+	}
+}
+
+void
+bonobo::fft_2d::transform_columns(float* real, float* imaginary, float sign,
+                                  size_t first_column, size_t last_column) const
+{
+	// The butterflies of a column pass combine whole rows with the same
+	// twiddle factor, so they are run across all columns of the range at
+	// once, which keeps memory accesses contiguous.
+	auto const width = last_column - first_column;
+	for (size_t i = 0u; i < _size; ++i) {
+		auto const j = _bit_reversal[i];
+		if (i < j) {
+			std::swap_ranges(real + i * _size + first_column, real + i * _size + last_column,
+			                 real + j * _size + first_column);
+			std::swap_ranges(imaginary + i * _size + first_column, imaginary + i * _size + last_column,
+			                 imaginary + j * _size + first_column);
+		}
+	}
+
+	for (size_t n = 2u; n <= _size; n *= 2u) {
+		auto const half = n / 2u;
+		for (size_t start = 0u; start < _size; start += n) {
+			for (size_t k = 0u; k < half; ++k) {
+				auto const a = (start + k) * _size + first_column;
+				auto const b = a + half * _size;
+				butterflies<true>(real + a, imaginary + a, real + b, imaginary + b,
+				                  _twiddles_real.data() + half - 1u + k,
+				                  _twiddles_imaginary.data() + half - 1u + k, sign, width);
+			}
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Sign of the exponent used by a Fourier transform.
+	enum class fft_direction {
+		forward, //!< sums x[n] e^(-2 pi i k n / N)
+		inverse  //!< sums X[k] e^(2 pi i k n / N), without dividing by N
+	};
+
+	//! \brief Radix-2 fast Fourier transform of square grids, whose side is
+	//!        a power of two.
+	//!
+	//! Complex values are stored split, as one array of real parts and one
+	//! of imaginary parts, each laid out row after row; that way
+	//! butterflies process four values at once with SSE. Rows are
+	//! transformed first, then columns, both split across the threads of
+	//! `parallel_for()`.
+	class fft_2d
+	{
+	public:
+		//! \brief Precompute the tables used by transforms of `size` by
+		//!        `size` grids.
+		//!
+		//! @param [in] size side of the grids, a power of two
+		explicit fft_2d(size_t size);
+
+		size_t get_size() const { return _size; }
+
+		//! \brief Transform a grid in place.
+		//!
+		//! @param [in,out] real real parts of the `size * size` values
+		//! @param [in,out] imaginary imaginary parts of the values
+		//! @param [in] direction forward or inverse transform
+		void transform(float* real, float* imaginary, fft_direction direction) const;
+
+	private:
+		void transform_rows(float* real, float* imaginary, float sign,
+		                    size_t first_row, size_t last_row) const;
+		void transform_columns(float* real, float* imaginary, float sign,
+		                       size_t first_column, size_t last_column) const;
+
+		size_t _size;
+		std::vector<uint32_t> _bit_reversal;
+		// Twiddle factors e^(-2 pi i k / n) for k < n / 2, for each stage
+		// of size n = 2, 4, ..., size; those of stage n start at n / 2 - 1.
+		std::vector<float> _twiddles_real;
+		std::vector<float> _twiddles_imaginary;
+	};
+}
@@ -0,0 +1,213 @@
+#include "geometry_arena.hpp"
+
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	//! Reallocate `buffer` to `new_size` bytes, keeping its first
+	//! `old_size` bytes, and return the name of the new buffer.
+	GLuint reallocate_buffer(GLuint buffer, GLsizeiptr old_size, GLsizeiptr new_size)
+	{
+		GLuint new_buffer = 0u;
+		glGenBuffers(1, &new_buffer);
+		assert(new_buffer != 0u);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, new_size, nullptr, GL_STATIC_DRAW);
+		if (old_size > 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_size);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0u);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+		glDeleteBuffers(1, &buffer);
+
+		return new_buffer;
+	}
+
+	//! Capacity to grow `capacity` to, so as to have at least `min_extra`
+	//! more units: it is at least doubled. Return false if that does not
+	//! fit in 32 bits.
+	bool get_grown_capacity(uint32_t capacity, uint32_t min_extra, uint32_t& new_capacity)
+	{
+		auto const extra = std::max(capacity, min_extra);
+		if (extra > 0xffffffffu - capacity)
+			return false;
+		new_capacity = capacity + extra;
+		return true;
+	}
+}
+
+bonobo::geometry_arena::geometry_arena(vertex_layout const& layout, uint32_t vertices_capacity, uint32_t indices_capacity) :
+	_layout(layout), _vao(0u), _vbo(0u), _ibo(0u), _vertices(vertices_capacity), _indices(indices_capacity), _meshes()
+{
+	for (auto const& attribute : _layout.attributes)
+		assert(attribute.stride == _layout.stride);
+
+	glGenVertexArrays(1, &_vao);
+	assert(_vao != 0u);
+	glBindVertexArray(_vao);
+
+	glGenBuffers(1, &_vbo);
+	assert(_vbo != 0u);
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices_capacity) * _layout.stride, nullptr, GL_STATIC_DRAW);
+	setup_vertex_attributes(_layout);
+
+	glGenBuffers(1, &_ibo);
+	assert(_ibo != 0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices_capacity * sizeof(GLuint)), nullptr, GL_STATIC_DRAW);
+
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+}
+
+bonobo::geometry_arena::~geometry_arena()
+{
+	glDeleteBuffers(1, &_ibo);
+	glDeleteBuffers(1, &_vbo);
+	glDeleteVertexArrays(1, &_vao);
+}
+
+bonobo::mesh_data
+bonobo::geometry_arena::add(void const* vertices, uint32_t vertices_nb,
+                            GLuint const* indices, uint32_t indices_nb,
+                            GLenum drawing_mode)
+{
+	mesh_data mesh;
+	if (vertices == nullptr || vertices_nb == 0u) {
+		LogError("Can not add a mesh without vertices to a geometry arena.");
+		return mesh;
+	}
+	if ((indices == nullptr) != (indices_nb == 0u)) {
+		LogError("Inconsistent index data given to the geometry arena.");
+		return mesh;
+	}
+
+	auto vertices_range = _vertices.allocate(vertices_nb);
+	while (!vertices_range.is_valid()) {
+		if (!grow_vertices(vertices_nb)) {
+			LogError("Failed to allocate %u vertices in the geometry arena.", vertices_nb);
+			return mesh;
+		}
+		vertices_range = _vertices.allocate(vertices_nb);
+	}
+	range_allocator::allocation indices_range;
+	if (indices_nb > 0u) {
+		indices_range = _indices.allocate(indices_nb);
+		while (!indices_range.is_valid()) {
+			if (!grow_indices(indices_nb)) {
+				LogError("Failed to allocate %u indices in the geometry arena.", indices_nb);
+				_vertices.free(vertices_range);
+				return mesh;
+			}
+			indices_range = _indices.allocate(indices_nb);
+		}
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER,
+	                static_cast<GLintptr>(vertices_range.offset) * _layout.stride,
+	                static_cast<GLsizeiptr>(vertices_nb) * _layout.stride,
+	                vertices);
+	if (indices_nb > 0u) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, _ibo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER,
+		                static_cast<GLintptr>(indices_range.offset * sizeof(GLuint)),
+		                static_cast<GLsizeiptr>(indices_nb * sizeof(GLuint)),
+		                indices);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+
+	_meshes.emplace(vertices_range.offset, std::make_pair(vertices_range, indices_range));
+
+	mesh.vao = _vao;
+	mesh.bo = _vbo;
+	mesh.ibo = indices_nb > 0u ? _ibo : 0u;
+	mesh.vertices_nb = vertices_nb;
+	mesh.indices_nb = indices_nb;
+	mesh.base_vertex = static_cast<GLint>(vertices_range.offset);
+	mesh.first_index = indices_nb > 0u ? indices_range.offset : 0u;
+	mesh.drawing_mode = drawing_mode;
+
+	return mesh;
+}
+
+void
+bonobo::geometry_arena::remove(mesh_data const& mesh)
+{
+	if (mesh.vao != _vao)
+		return;
+
+	auto const it = _meshes.find(static_cast<uint32_t>(mesh.base_vertex));
+	if (it == _meshes.end()) {
+		LogWarning("Trying to remove a mesh which is not part of this geometry arena.");
+		return;
+	}
+
+	_vertices.free(it->second.first);
+	_indices.free(it->second.second);
+	_meshes.erase(it);
+}
+
+bonobo::range_allocator::statistics
+bonobo::geometry_arena::get_vertices_statistics() const
+{
+	return _vertices.get_statistics();
+}
+
+bonobo::range_allocator::statistics
+bonobo::geometry_arena::get_indices_statistics() const
+{
+	return _indices.get_statistics();
+}
+
+bool
+bonobo::geometry_arena::grow_vertices(uint32_t min_extra)
+{
+	// Growing by at least `min_extra` guarantees the free range at the end
+	// of the buffer can hold the pending allocation.
+	auto const old_capacity = _vertices.get_capacity();
+	uint32_t new_capacity;
+	if (!get_grown_capacity(old_capacity, min_extra, new_capacity))
+		return false;
+	LogInfo("Growing geometry arena vertex buffer from %u to %u vertices", old_capacity, new_capacity);
+
+	_vbo = reallocate_buffer(_vbo,
+	                         static_cast<GLsizeiptr>(old_capacity) * _layout.stride,
+	                         static_cast<GLsizeiptr>(new_capacity) * _layout.stride);
+	_vertices.grow(new_capacity);
+
+	glBindVertexArray(_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+	setup_vertex_attributes(_layout);
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+
+	return true;
+}
+
+bool
+bonobo::geometry_arena::grow_indices(uint32_t min_extra)
+{
+	auto const old_capacity = _indices.get_capacity();
+	uint32_t new_capacity;
+	if (!get_grown_capacity(old_capacity, min_extra, new_capacity))
+		return false;
+	LogInfo("Growing geometry arena index buffer from %u to %u indices", old_capacity, new_capacity);
+
+	_ibo = reallocate_buffer(_ibo,
+	                         static_cast<GLsizeiptr>(old_capacity * sizeof(GLuint)),
+	                         static_cast<GLsizeiptr>(new_capacity * sizeof(GLuint)));
+	_indices.grow(new_capacity);
+
+	glBindVertexArray(_vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+	glBindVertexArray(0u);
+
+	return true;
+}
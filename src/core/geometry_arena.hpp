@@ -0,0 +1,89 @@
+#pragma once
+
+#include "helpers.hpp"
+#include "range_allocator.hpp"
+#include "vertex_format.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+namespace bonobo
+{
+	//! \brief Large vertex and index buffers shared by many static meshes of
+	//!        the same vertex layout.
+	//!
+	//! All meshes added to an arena share a single Vertex Array, vertex
+	//! buffer and index buffer; each mesh is only a range inside them,
+	//! described by the `base_vertex` and `first_index` members of the
+	//! returned `mesh_data`. Drawing several meshes from the same arena
+	//! therefore never switches buffers.
+	//!
+	//! Ranges are handed out by `range_allocator`s; when an allocation does
+	//! not fit, the corresponding buffer is reallocated at a larger size
+	//! and its content copied over. The Vertex Array name stays the same,
+	//! but the `bo` and `ibo` names stored in previously returned
+	//! `mesh_data` may then be stale: only rely on `vao`.
+	class geometry_arena
+	{
+	public:
+		//! \brief Create the OpenGL objects backing the arena.
+		//!
+		//! @param [in] layout layout of every vertex stored in this arena;
+		//!             it has to be interleaved
+		//! @param [in] vertices_capacity initial number of vertices
+		//! @param [in] indices_capacity initial number of indices
+		geometry_arena(vertex_layout const& layout,
+		               uint32_t vertices_capacity = 1u << 16,
+		               uint32_t indices_capacity = 1u << 18);
+		~geometry_arena();
+
+		geometry_arena(geometry_arena const&) = delete;
+		geometry_arena& operator=(geometry_arena const&) = delete;
+
+		//! \brief Copy a mesh into the arena.
+		//!
+		//! @param [in] vertices interleaved vertex data following the
+		//!             arena's layout
+		//! @param [in] vertices_nb number of vertices pointed to by
+		//!             `vertices`
+		//! @param [in] indices indices relative to the first vertex of
+		//!             `vertices`; can be null for non-indexed meshes
+		//! @param [in] indices_nb number of indices
+		//! @param [in] drawing_mode OpenGL drawing mode of the mesh
+		//! @return a `mesh_data` referring to the arena's Vertex Array, or
+		//!         one with a nul `vao` if the mesh could not be added
+		mesh_data add(void const* vertices, uint32_t vertices_nb,
+		              GLuint const* indices, uint32_t indices_nb,
+		              GLenum drawing_mode = GL_TRIANGLES);
+
+		//! \brief Release the ranges used by a mesh returned by `add()`.
+		void remove(mesh_data const& mesh);
+
+		GLuint get_vao() const { return _vao; }
+		GLuint get_vertex_buffer() const { return _vbo; }
+		GLuint get_index_buffer() const { return _ibo; }
+		vertex_layout const& get_layout() const { return _layout; }
+
+		//! \brief Occupancy of the vertex buffer, in vertices.
+		range_allocator::statistics get_vertices_statistics() const;
+
+		//! \brief Occupancy of the index buffer, in indices.
+		range_allocator::statistics get_indices_statistics() const;
+
+	private:
+		//! Return false if the buffer can not grow by `min_extra` units.
+		bool grow_vertices(uint32_t min_extra);
+		bool grow_indices(uint32_t min_extra);
+
+		vertex_layout _layout;
+		GLuint _vao;
+		GLuint _vbo;
+		GLuint _ibo;
+		range_allocator _vertices;
+		range_allocator _indices;
+
+		//! Allocations of each live mesh, keyed by their base vertex.
+		std::unordered_map<uint32_t, std::pair<range_allocator::allocation, range_allocator::allocation>> _meshes;
+	};
+}
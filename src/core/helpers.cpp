@@ -1,8 +1,10 @@
 #include "config.hpp"
 #include "helpers.hpp"
+#include "mesh_cpu.hpp"
 
 #include "core/Log.h"
 #include "core/Misc.h"
+#include "core/cpu_dispatch.hpp"
 #include "core/opengl.hpp"
 #include "core/various.hpp"
 #include "external/lodepng.h"
@@ -13,6 +15,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <cassert>
+#include <utility>
 
 namespace local
 {
@@ -41,6 +44,7 @@ getTextureData(std::string const& filename, u32& width, u32& height, bool flip)
 {
 	auto const path = config::resources_path(filename);
 	std::vector<unsigned char> image;
+	bonobo::install_png_unfilter();
 	if (lodepng::decode(image, width, height, path, LCT_RGBA) != 0) {
 		LogWarning("Couldn't load or decode image file %s", path.c_str());
 		return image;
@@ -57,7 +61,7 @@ getTextureData(std::string const& filename, u32& width, u32& height, bool flip)
 }
 
 std::vector<bonobo::mesh_data>
-bonobo::loadObjects(std::string const& filename)
+bonobo::loadObjects(std::string const& filename, geometry_arena* arena, mesh_options const& options)
 {
 	std::vector<bonobo::mesh_data> objects;
 
@@ -127,69 +131,9 @@ bonobo::loadObjects(std::string const& filename)
 			continue;
 		}
 
-		bonobo::mesh_data object;
-
-		glGenVertexArrays(1, &object.vao);
-		assert(object.vao != 0u);
-		glBindVertexArray(object.vao);
-
-		auto const vertices_offset = 0u;
-		auto const vertices_size = static_cast<GLsizeiptr>(assimp_object_mesh->mNumVertices * sizeof(glm::vec3));
-
-		auto const normals_offset = vertices_size;
-		auto const normals_size = assimp_object_mesh->HasNormals() ? vertices_size : 0u;
-
-		auto const texcoords_offset = normals_offset + normals_size;
-		auto const texcoords_size = assimp_object_mesh->HasTextureCoords(0u) ? vertices_size : 0u;
-
-		auto const tangents_offset = texcoords_offset + texcoords_size;
-		auto const tangents_size = assimp_object_mesh->HasTangentsAndBitangents() ? vertices_size : 0u;
-
-		auto const binormals_offset = tangents_offset + tangents_size;
-		auto const binormals_size = assimp_object_mesh->HasTangentsAndBitangents() ? vertices_size : 0u;
-
-		auto const bo_size = static_cast<GLsizeiptr>(vertices_size
-		                                            +normals_size
-		                                            +texcoords_size
-		                                            +tangents_size
-		                                            +binormals_size
-		                                            );
-		glGenBuffers(1, &object.bo);
-		assert(object.bo != 0u);
-		glBindBuffer(GL_ARRAY_BUFFER, object.bo);
-		glBufferData(GL_ARRAY_BUFFER, bo_size, nullptr, GL_STATIC_DRAW);
-
-		glBufferSubData(GL_ARRAY_BUFFER, vertices_offset, vertices_size, static_cast<GLvoid const*>(assimp_object_mesh->mVertices));
-		glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::vertices));
-		glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::vertices), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(0x0));
-
-		if (assimp_object_mesh->HasNormals()) {
-			glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, static_cast<GLvoid const*>(assimp_object_mesh->mNormals));
-			glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::normals));
-			glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::normals), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(normals_offset));
-		}
-
-		if (assimp_object_mesh->HasTextureCoords(0u)) {
-			glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, static_cast<GLvoid const*>(assimp_object_mesh->mTextureCoords[0u]));
-			glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::texcoords));
-			glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::texcoords), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(texcoords_offset));
-		}
-
-		if (assimp_object_mesh->HasTangentsAndBitangents()) {
-			glBufferSubData(GL_ARRAY_BUFFER, tangents_offset, tangents_size, static_cast<GLvoid const*>(assimp_object_mesh->mTangents));
-			glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::tangents));
-			glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::tangents), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(tangents_offset));
-
-			glBufferSubData(GL_ARRAY_BUFFER, binormals_offset, binormals_size, static_cast<GLvoid const*>(assimp_object_mesh->mBitangents));
-			glEnableVertexAttribArray(static_cast<unsigned int>(bonobo::shader_bindings::binormals));
-			glVertexAttribPointer(static_cast<unsigned int>(bonobo::shader_bindings::binormals), 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid const*>(binormals_offset));
-		}
-
-		glBindBuffer(GL_ARRAY_BUFFER, 0u);
-
 		auto const num_vertices_per_face = assimp_object_mesh->mFaces[0u].mNumIndices;
-		object.indices_nb = assimp_object_mesh->mNumFaces * num_vertices_per_face;
-		auto object_indices = std::make_unique<GLuint[]>(static_cast<size_t>(object.indices_nb));
+		auto const indices_nb = static_cast<size_t>(assimp_object_mesh->mNumFaces * num_vertices_per_face);
+		auto object_indices = std::vector<GLuint>(indices_nb);
 		for (size_t i = 0u; i < assimp_object_mesh->mNumFaces; ++i) {
 			auto const& face = assimp_object_mesh->mFaces[i];
 			assert(face.mNumIndices <= 3);
@@ -199,15 +143,35 @@ bonobo::loadObjects(std::string const& filename)
 			if (num_vertices_per_face >= 2u)
 				object_indices[num_vertices_per_face * i + 2u] = face.mIndices[2u];
 		}
-		glGenBuffers(1, &object.ibo);
-		assert(object.ibo != 0u);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.ibo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<unsigned int>(object.indices_nb) * sizeof(GL_UNSIGNED_INT), reinterpret_cast<GLvoid const*>(object_indices.get()), GL_STATIC_DRAW);
-		object_indices.reset(nullptr);
-
-		glBindVertexArray(0u);
-		glBindBuffer(GL_ARRAY_BUFFER, 0u);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+		auto const to_vec3 = [](aiVector3D const& v){ return glm::vec3(v.x, v.y, v.z); };
+		// Arenas only hold interleaved vertices.
+		auto const storage = arena != nullptr ? vertex_storage::interleaved : options.storage;
+		auto mesh = mesh_cpu(assimp_object_mesh->mNumVertices, storage);
+		auto& vertices = mesh.vertices;
+		for (size_t i = 0u; i < vertices.get_vertices_nb(); ++i) {
+			vertices.set<shader_bindings::vertices>(i, to_vec3(assimp_object_mesh->mVertices[i]));
+			if (assimp_object_mesh->HasNormals())
+				vertices.set<shader_bindings::normals>(i, to_vec3(assimp_object_mesh->mNormals[i]));
+			if (assimp_object_mesh->HasTextureCoords(0u))
+				vertices.set<shader_bindings::texcoords>(i, to_vec3(assimp_object_mesh->mTextureCoords[0u][i]));
+			if (assimp_object_mesh->HasTangentsAndBitangents()) {
+				vertices.set<shader_bindings::tangents>(i, to_vec3(assimp_object_mesh->mTangents[i]));
+				vertices.set<shader_bindings::binormals>(i, to_vec3(assimp_object_mesh->mBitangents[i]));
+			}
+		}
+		mesh.indices = std::move(object_indices);
+		mesh.drawing_mode = num_vertices_per_face == 3u ? GL_TRIANGLES
+		                  : num_vertices_per_face == 2u ? GL_LINES
+		                  : GL_POINTS;
+		prepare_mesh(mesh, options, assimp_object_mesh->mName.C_Str());
+
+		auto object = arena == nullptr ? upload_mesh(mesh, options.precision)
+		                                : upload_mesh(mesh, options.precision, *arena);
+		if (object.vao == 0u) {
+			LogError("Failed to upload object \"%s\"", assimp_object_mesh->mName.C_Str());
+			continue;
+		}
 
 		auto const material_id = assimp_object_mesh->mMaterialIndex;
 		if (material_id >= materials_bindings.size())
@@ -21,13 +21,50 @@ namespace bonobo
 		normals,       //!< = 1, value of the binding point for normals
 		texcoords,     //!< = 2, value of the binding point for texcoords
 		tangents,      //!< = 3, value of the binding point for tangents
-		binormals      //!< = 4, value of the binding point for binormals
+		binormals,     //!< = 4, value of the binding point for binormals
+		draw_ids       //!< = 5, value of the binding point for per-draw
+		               //!<      identifiers, see `indirect_draw_buffer`
+	};
+
+	//! \brief How the attributes of the vertices of a buffer are arranged.
+	enum class vertex_storage {
+		interleaved, //!< all attributes of a vertex are contiguous (AoS)
+		planar       //!< each attribute has its own block of values (SoA)
+	};
+
+	//! \brief Precision at which vertex attributes are stored on the GPU.
+	enum class vertex_precision {
+		full,   //!< `standard_vertex_format`, 60 bytes per vertex
+		compact //!< `compact_vertex_format`, 24 bytes per vertex
+	};
+
+	//! \brief How meshes generated or loaded on the CPU are prepared
+	//!        before being uploaded.
+	struct mesh_options {
+		vertex_storage storage = vertex_storage::interleaved;
+		vertex_precision precision = vertex_precision::full;
+		bool optimize = false; //!< reorder triangles for the post-transform
+		                       //!< vertex cache and overdraw, and vertices
+		                       //!< for fetch locality; see `mesh_optimizer.hpp`
+		size_t lod_levels = 1u; //!< maximum number of levels of detail to
+		                        //!< generate for triangle meshes; see
+		                        //!< `mesh_simplifier.hpp`
 	};
 
 	//! \brief Association of a sampler name used in GLSL to a
 	//!        corresponding texture ID.
 	using texture_bindings = std::unordered_map<std::string, GLuint>;
 
+	//! \brief Range of the index buffer of a mesh holding one of its
+	//!        levels of detail.
+	struct lod_level {
+		GLuint first_index; //!< offset of the level's first index, relative
+		                    //!< to the first index of the mesh
+		size_t indices_nb;  //!< number of indices of the level
+		float error;        //!< distance, in model units, between the level
+		                    //!< and the full-detail mesh
+	};
+
 	//! \brief Contains the data for a mesh in OpenGL.
 	struct mesh_data {
 		GLuint vao;                //!< OpenGL name of the Vertex Array Object
@@ -35,10 +72,19 @@ namespace bonobo
 		GLuint ibo;                //!< OpenGL name of the Buffer Object for indices
 		size_t vertices_nb;        //!< number of vertices stored in bo
 		size_t indices_nb;         //!< number of indices stored in ibo
+		GLint base_vertex;         //!< index of the first vertex in bo, non-zero
+		                           //!< when bo is shared with other meshes
+		GLuint first_index;        //!< index of the first index in ibo, non-zero
+		                           //!< when ibo is shared with other meshes
+		GLenum indices_type;       //!< type of the indices stored in ibo, i.e.
+		                           //!< GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
 		texture_bindings bindings; //!< texture bindings for this mesh
 		GLenum drawing_mode;       //!< OpenGL drawing mode, i.e. GL_TRIANGLES, GL_LINES, etc.
+		std::vector<lod_level> lods; //!< levels of detail, from the finest,
+		                             //!< which `indices_nb` refers to, to the
+		                             //!< coarsest; empty if there is only one
 
-		mesh_data() : vao(0u), bo(0u), ibo(0u), vertices_nb(0u), indices_nb(0u), bindings(), drawing_mode(GL_TRIANGLES)
+		mesh_data() : vao(0u), bo(0u), ibo(0u), vertices_nb(0u), indices_nb(0u), base_vertex(0), first_index(0u), indices_type(GL_UNSIGNED_INT), bindings(), drawing_mode(GL_TRIANGLES), lods()
 		{
 		}
 	};
@@ -49,13 +95,23 @@ namespace bonobo
 	//! \brief Deallocate objects allocated by the `init()` function.
 	void deinit();
 
+	class geometry_arena;
+
 	//! \brief Load objects found in an object/scene file, using assimp.
 	//!
 	//! @param [in] filename of the object/scene file to load, relative to
 	//!             the `res/scenes` folder
+	//! @param [in] arena if non-null, the objects are stored in that
+	//!             arena rather than each in its own buffers; the arena
+	//!             has to use the interleaved layout matching
+	//!             `options.precision`
+	//! @param [in] options how to store and optimise the objects; the
+	//!             storage is ignored when using an arena
 	//! @return a vector of filled in `mesh_data` structures, one per
 	//!         object found in the input file
-	std::vector<mesh_data> loadObjects(std::string const& filename);
+	std::vector<mesh_data> loadObjects(std::string const& filename,
+	                                   geometry_arena* arena = nullptr,
+	                                   mesh_options const& options = mesh_options());
 
 	//! \brief Creates an OpenGL texture without any content nor parameterised.
 	//!
@@ -0,0 +1,80 @@
+#include "mesh_cpu.hpp"
+#include "geometry_arena.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_simplifier.hpp"
+#include "quantization.hpp"
+
+#include <cassert>
+#include <limits>
+
+bonobo::bounding_box
+bonobo::compute_bounds(vertex_data<standard_vertex_format> const& vertices)
+{
+	auto const vertices_nb = vertices.get_vertices_nb();
+	if (vertices_nb == 0u)
+		return { glm::vec3(0.0f), glm::vec3(0.0f) };
+
+	auto bounds = bounding_box{ glm::vec3(std::numeric_limits<float>::max()),
+	                            glm::vec3(std::numeric_limits<float>::lowest()) };
+	for (size_t i = 0u; i < vertices_nb; ++i) {
+		auto const position = vertices.get<shader_bindings::vertices>(i);
+		bounds.min = glm::min(bounds.min, position);
+		bounds.max = glm::max(bounds.max, position);
+	}
+	return bounds;
+}
+
+void
+bonobo::prepare_mesh(mesh_cpu& mesh, mesh_options const& options, char const* name)
+{
+	if (mesh.drawing_mode == GL_TRIANGLES && !mesh.indices.empty()) {
+		if (options.optimize)
+			optimize_mesh(mesh.vertices, mesh.indices.data(), mesh.indices.size(), name);
+		if (options.lod_levels > 1u)
+			mesh.lods = build_lod_chain(mesh.vertices, mesh.indices, options.lod_levels, name);
+	}
+	mesh.bounds = compute_bounds(mesh.vertices);
+}
+
+namespace
+{
+	// Only the first level of detail is drawn until another one is
+	// selected, see `Node::set_lod()`.
+	void
+	set_lods(bonobo::mesh_data& data, std::vector<bonobo::lod_level> const& lods)
+	{
+		if (data.vao == 0u || lods.empty())
+			return;
+		data.indices_nb = lods.front().indices_nb;
+		data.lods = lods;
+	}
+}
+
+bonobo::mesh_data
+bonobo::upload_mesh(mesh_cpu const& mesh, vertex_precision precision)
+{
+	auto data = create_mesh(mesh.vertices, mesh.indices.empty() ? nullptr : mesh.indices.data(),
+	                        mesh.indices.size(), precision, mesh.drawing_mode);
+	set_lods(data, mesh.lods);
+	return data;
+}
+
+bonobo::mesh_data
+bonobo::upload_mesh(mesh_cpu const& mesh, vertex_precision precision, geometry_arena& arena)
+{
+	assert(mesh.vertices.get_storage() == vertex_storage::interleaved);
+
+	auto const indices = mesh.indices.empty() ? nullptr : mesh.indices.data();
+	auto const indices_nb = static_cast<uint32_t>(mesh.indices.size());
+	mesh_data data;
+	if (precision == vertex_precision::compact) {
+		auto const compressed_vertices = compress_vertices(mesh.vertices);
+		data = arena.add(compressed_vertices.data(), static_cast<uint32_t>(compressed_vertices.get_vertices_nb()),
+		                 indices, indices_nb, mesh.drawing_mode);
+	} else {
+		data = arena.add(mesh.vertices.data(), static_cast<uint32_t>(mesh.vertices.get_vertices_nb()),
+		                 indices, indices_nb, mesh.drawing_mode);
+	}
+	set_lods(data, mesh.lods);
+	return data;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "helpers.hpp"
+#include "vertex_format.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace bonobo
+{
+	class geometry_arena;
+
+	//! \brief Axis-aligned bounding box.
+	struct bounding_box {
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	//! \brief Mesh held in CPU memory, as output by generators and loaders
+	//!        before being uploaded by `upload_mesh()`.
+	//!
+	//! Building one does not require an OpenGL context, so that it can be
+	//! done on any thread, timed or cached on its own.
+	struct mesh_cpu {
+		vertex_data<standard_vertex_format> vertices; //!< attribute streams
+		std::vector<GLuint> indices;                  //!< indices of all
+		                                              //!< levels of detail
+		std::vector<lod_level> lods;                  //!< see `mesh_data::lods`
+		bounding_box bounds;                          //!< bounds of the
+		                                              //!< vertex positions
+		GLenum drawing_mode;                          //!< OpenGL drawing mode
+
+		explicit mesh_cpu(size_t vertices_nb, vertex_storage storage = vertex_storage::interleaved) :
+			vertices(vertices_nb, storage), indices(), lods(),
+			bounds{ glm::vec3(0.0f), glm::vec3(0.0f) }, drawing_mode(GL_TRIANGLES)
+		{
+		}
+	};
+
+	//! \brief Bounds of the positions of `vertices`; empty vertex buffers
+	//!        get a box reduced to the origin.
+	bounding_box compute_bounds(vertex_data<standard_vertex_format> const& vertices);
+
+	//! \brief Apply the CPU-side processing requested by `options`, and
+	//!        compute the bounds of the mesh.
+	//!
+	//! Triangle meshes are optimised and given levels of detail if asked
+	//! to; the storage and precision options are left to the creation of
+	//! `mesh` and to `upload_mesh()` respectively.
+	//!
+	//! @param [in,out] mesh mesh to process
+	//! @param [in] options how to process the mesh
+	//! @param [in] name name of the mesh, used when logging
+	void prepare_mesh(mesh_cpu& mesh, mesh_options const& options, char const* name);
+
+	//! \brief Upload a mesh to new OpenGL buffers.
+	//!
+	//! @param [in] mesh mesh to upload
+	//! @param [in] precision whether to quantise the vertices first
+	//! @return wrapper around the created OpenGL objects' names
+	mesh_data upload_mesh(mesh_cpu const& mesh, vertex_precision precision = vertex_precision::full);
+
+	//! \brief Upload a mesh into a geometry arena, whose layout has to be
+	//!        the interleaved one matching `precision`.
+	//!
+	//! @param [in] mesh mesh to upload; its vertices have to be
+	//!             interleaved
+	//! @param [in] precision whether to quantise the vertices first
+	//! @param [in,out] arena arena to store the mesh into
+	//! @return wrapper around the ranges of the arena used by the mesh
+	mesh_data upload_mesh(mesh_cpu const& mesh, vertex_precision precision, geometry_arena& arena);
+}
@@ -0,0 +1,285 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+	GLuint const invalid_index = std::numeric_limits<GLuint>::max();
+
+	//! \brief FIFO cache emulated with timestamps: a vertex is in the cache
+	//!        if its own miss is among the last `cache_size` ones.
+	class fifo_cache
+	{
+	public:
+		fifo_cache(size_t vertices_nb, size_t cache_size) :
+			_timestamps(vertices_nb, 0u), _time(cache_size + 1u), _cache_size(cache_size)
+		{
+		}
+
+		//! \brief Reference `vertex`, and return whether it had to be
+		//!        transformed.
+		bool access(GLuint vertex)
+		{
+			if (_time - _timestamps[vertex] <= _cache_size)
+				return false;
+			_timestamps[vertex] = _time++;
+			return true;
+		}
+
+		//! \brief Evict all vertices.
+		void flush() { _time += _cache_size + 1u; }
+
+		size_t age(GLuint vertex) const { return _time - _timestamps[vertex]; }
+
+	private:
+		std::vector<size_t> _timestamps;
+		size_t _time;
+		size_t _cache_size;
+	};
+
+	//! \brief Triangles using each vertex, stored as one contiguous array
+	//!        indexed by `offsets`.
+	struct triangle_adjacency {
+		std::vector<size_t> offsets;   //!< first entry of each vertex, plus
+		                               //!< one past the last one
+		std::vector<size_t> triangles; //!< triangles of all vertices
+
+		triangle_adjacency(GLuint const* indices, size_t indices_nb, size_t vertices_nb) :
+			offsets(vertices_nb + 1u, 0u), triangles(indices_nb)
+		{
+			for (size_t i = 0u; i < indices_nb; ++i)
+				++offsets[indices[i] + 1u];
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			auto cursors = std::vector<size_t>(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0u; i < indices_nb; ++i)
+				triangles[cursors[indices[i]]++] = i / 3u;
+		}
+
+		size_t count(GLuint vertex) const { return offsets[vertex + 1u] - offsets[vertex]; }
+	};
+}
+
+bonobo::vertex_cache_statistics
+bonobo::simulate_vertex_cache(GLuint const* indices, size_t indices_nb, size_t vertices_nb, size_t cache_size)
+{
+	assert(indices_nb % 3u == 0u);
+
+	auto cache = fifo_cache(vertices_nb, cache_size);
+	auto is_referenced = std::vector<bool>(vertices_nb, false);
+	size_t transformed_nb = 0u;
+	size_t referenced_nb = 0u;
+	for (size_t i = 0u; i < indices_nb; ++i) {
+		if (cache.access(indices[i]))
+			++transformed_nb;
+		if (!is_referenced[indices[i]]) {
+			is_referenced[indices[i]] = true;
+			++referenced_nb;
+		}
+	}
+
+	vertex_cache_statistics statistics;
+	statistics.transformed_nb = transformed_nb;
+	statistics.acmr = indices_nb > 0u ? static_cast<float>(transformed_nb) / static_cast<float>(indices_nb / 3u) : 0.0f;
+	statistics.atvr = referenced_nb > 0u ? static_cast<float>(transformed_nb) / static_cast<float>(referenced_nb) : 0.0f;
+	return statistics;
+}
+
+std::vector<size_t>
+bonobo::optimize_vertex_cache(GLuint* indices, size_t indices_nb, size_t vertices_nb, size_t cache_size)
+{
+	assert(indices_nb % 3u == 0u);
+
+	auto clusters = std::vector<size_t>();
+	auto const triangles_nb = indices_nb / 3u;
+	if (triangles_nb == 0u)
+		return clusters;
+
+	auto const adjacency = triangle_adjacency(indices, indices_nb, vertices_nb);
+	auto live_triangles = std::vector<size_t>(vertices_nb);
+	for (GLuint v = 0u; v < vertices_nb; ++v)
+		live_triangles[v] = adjacency.count(v);
+
+	auto cache = fifo_cache(vertices_nb, cache_size);
+	auto is_emitted = std::vector<bool>(triangles_nb, false);
+	auto dead_ends = std::vector<GLuint>();
+	auto candidates = std::vector<GLuint>();
+	auto output = std::vector<GLuint>();
+	output.reserve(indices_nb);
+	GLuint next_scanned = 0u;
+
+	// The fanning vertex is the one whose remaining triangles are all
+	// emitted next; it starts a new cluster whenever it was not picked
+	// among the vertices of the previous fan.
+	auto fanning = indices[0];
+	clusters.push_back(0u);
+	while (fanning != invalid_index) {
+		candidates.clear();
+		for (auto i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1u]; ++i) {
+			auto const triangle = adjacency.triangles[i];
+			if (is_emitted[triangle])
+				continue;
+			is_emitted[triangle] = true;
+			for (size_t j = 0u; j < 3u; ++j) {
+				auto const v = indices[triangle * 3u + j];
+				output.push_back(v);
+				dead_ends.push_back(v);
+				candidates.push_back(v);
+				--live_triangles[v];
+				cache.access(v);
+			}
+		}
+
+		// Prefer the candidate that will still be in the cache once all its
+		// remaining triangles are emitted, and among those the oldest one.
+		auto best = invalid_index;
+		size_t best_priority = 0u;
+		for (auto const v : candidates) {
+			if (live_triangles[v] == 0u)
+				continue;
+			size_t priority = 0u;
+			if (cache.age(v) + 2u * live_triangles[v] <= cache_size)
+				priority = cache.age(v);
+			if (best == invalid_index || priority > best_priority) {
+				best = v;
+				best_priority = priority;
+			}
+		}
+		if (best != invalid_index) {
+			fanning = best;
+			continue;
+		}
+
+		// Dead end: fall back on recently used vertices, then on any vertex
+		// with triangles left.
+		while (!dead_ends.empty() && live_triangles[dead_ends.back()] == 0u)
+			dead_ends.pop_back();
+		if (!dead_ends.empty()) {
+			fanning = dead_ends.back();
+			dead_ends.pop_back();
+		} else {
+			while (next_scanned < vertices_nb && live_triangles[next_scanned] == 0u)
+				++next_scanned;
+			fanning = next_scanned < vertices_nb ? next_scanned : invalid_index;
+		}
+		if (fanning != invalid_index)
+			clusters.push_back(output.size() / 3u);
+	}
+
+	assert(output.size() == indices_nb);
+	std::copy(output.begin(), output.end(), indices);
+	return clusters;
+}
+
+void
+bonobo::optimize_overdraw(GLuint* indices, size_t indices_nb,
+                          glm::vec3 const* positions, size_t vertices_nb,
+                          std::vector<size_t> const& clusters,
+                          size_t cache_size, float threshold)
+{
+	assert(indices_nb % 3u == 0u);
+
+	auto const triangles_nb = indices_nb / 3u;
+	if (triangles_nb == 0u || clusters.empty())
+		return;
+
+	// Split the clusters further, at every triangle where the cache miss
+	// ratio of the triangles so far, starting from a cold cache, is close
+	// enough to the one of the whole cluster.
+	auto cache = fifo_cache(vertices_nb, cache_size);
+	auto const count_misses = [&](size_t first, size_t last) {
+		size_t misses = 0u;
+		cache.flush();
+		for (auto i = first * 3u; i < last * 3u; ++i)
+			misses += cache.access(indices[i]) ? 1u : 0u;
+		return misses;
+	};
+	auto boundaries = std::vector<size_t>();
+	for (size_t c = 0u; c < clusters.size(); ++c) {
+		auto const first = clusters[c];
+		auto const last = c + 1u < clusters.size() ? clusters[c + 1u] : triangles_nb;
+		auto const cluster_acmr = static_cast<float>(count_misses(first, last)) / static_cast<float>(last - first);
+
+		boundaries.push_back(first);
+		cache.flush();
+		size_t start = first;
+		size_t misses = 0u;
+		for (auto t = first; t < last; ++t) {
+			if (t > start && static_cast<float>(misses) <= threshold * cluster_acmr * static_cast<float>(t - start)) {
+				boundaries.push_back(t);
+				cache.flush();
+				start = t;
+				misses = 0u;
+			}
+			for (size_t j = 0u; j < 3u; ++j)
+				misses += cache.access(indices[t * 3u + j]) ? 1u : 0u;
+		}
+	}
+	boundaries.push_back(triangles_nb);
+
+	// Sort clusters so that those facing away from the centre of the mesh,
+	// which are likely to occlude the others, are drawn first.
+	struct cluster_info {
+		size_t first;
+		size_t last;
+		float sort_key;
+	};
+	auto infos = std::vector<cluster_info>(boundaries.size() - 1u);
+	auto centroids = std::vector<glm::vec3>(infos.size());
+	auto normals = std::vector<glm::vec3>(infos.size());
+	auto mesh_centroid = glm::vec3(0.0f);
+	auto mesh_area = 0.0f;
+	for (size_t c = 0u; c < infos.size(); ++c) {
+		infos[c] = { boundaries[c], boundaries[c + 1u], 0.0f };
+		auto centroid = glm::vec3(0.0f);
+		auto normal = glm::vec3(0.0f);
+		auto area = 0.0f;
+		for (auto t = infos[c].first; t < infos[c].last; ++t) {
+			auto const& p0 = positions[indices[t * 3u + 0u]];
+			auto const& p1 = positions[indices[t * 3u + 1u]];
+			auto const& p2 = positions[indices[t * 3u + 2u]];
+			auto const weighted_normal = glm::cross(p1 - p0, p2 - p0);
+			auto const triangle_area = 0.5f * glm::length(weighted_normal);
+			centroid += triangle_area * (p0 + p1 + p2) / 3.0f;
+			normal += weighted_normal;
+			area += triangle_area;
+		}
+		mesh_centroid += centroid;
+		mesh_area += area;
+		centroids[c] = area > 0.0f ? centroid / area : centroid;
+		normals[c] = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : normal;
+	}
+	if (mesh_area > 0.0f)
+		mesh_centroid /= mesh_area;
+	for (size_t c = 0u; c < infos.size(); ++c)
+		infos[c].sort_key = glm::dot(centroids[c] - mesh_centroid, normals[c]);
+
+	std::stable_sort(infos.begin(), infos.end(), [](cluster_info const& a, cluster_info const& b) {
+		return a.sort_key > b.sort_key;
+	});
+
+	auto output = std::vector<GLuint>();
+	output.reserve(indices_nb);
+	for (auto const& info : infos)
+		output.insert(output.end(), indices + info.first * 3u, indices + info.last * 3u);
+	std::copy(output.begin(), output.end(), indices);
+}
+
+std::vector<GLuint>
+bonobo::optimize_vertex_fetch(GLuint* indices, size_t indices_nb, size_t vertices_nb)
+{
+	auto remap = std::vector<GLuint>(vertices_nb, invalid_index);
+	GLuint next_index = 0u;
+	for (size_t i = 0u; i < indices_nb; ++i) {
+		auto& new_index = remap[indices[i]];
+		if (new_index == invalid_index)
+			new_index = next_index++;
+		indices[i] = new_index;
+	}
+	for (auto& new_index : remap)
+		if (new_index == invalid_index)
+			new_index = next_index++;
+	return remap;
+}
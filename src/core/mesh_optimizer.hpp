@@ -0,0 +1,104 @@
+#pragma once
+
+#include "vertex_format.hpp"
+
+#include "core/Log.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Efficiency of an index buffer with regard to the
+	//!        post-transform vertex cache.
+	struct vertex_cache_statistics {
+		size_t transformed_nb; //!< number of vertex shader invocations
+		float acmr;            //!< average cache miss ratio: transformed
+		                       //!< vertices per triangle, 0.5 at best for
+		                       //!< regular grids, 3 at worst
+		float atvr;            //!< average transform to vertex ratio:
+		                       //!< transformed vertices per referenced
+		                       //!< vertex, 1 at best
+	};
+
+	//! \brief Simulate a FIFO post-transform vertex cache running over a
+	//!        triangle list.
+	//!
+	//! @param [in] indices triangle list
+	//! @param [in] indices_nb number of indices, a multiple of 3
+	//! @param [in] vertices_nb number of vertices referenced by `indices`
+	//! @param [in] cache_size number of entries of the simulated cache
+	vertex_cache_statistics simulate_vertex_cache(GLuint const* indices, size_t indices_nb,
+	                                              size_t vertices_nb, size_t cache_size = 16u);
+
+	//! \brief Reorder triangles for the post-transform vertex cache, using
+	//!        Tipsify [Sander et al. 2007], in linear time.
+	//!
+	//! @param [in,out] indices triangle list to reorder
+	//! @param [in] indices_nb number of indices, a multiple of 3
+	//! @param [in] vertices_nb number of vertices referenced by `indices`
+	//! @param [in] cache_size number of entries of the targeted cache
+	//! @return index of the first triangle of each cluster, i.e. of each
+	//!         run of triangles after which the cache is expected to be
+	//!         cold; to be given to `optimize_overdraw()`
+	std::vector<size_t> optimize_vertex_cache(GLuint* indices, size_t indices_nb,
+	                                          size_t vertices_nb, size_t cache_size = 16u);
+
+	//! \brief Reorder the clusters output by `optimize_vertex_cache()` so
+	//!        that outward-facing ones are drawn first, reducing overdraw
+	//!        from most view points.
+	//!
+	//! Clusters are first split wherever doing so keeps the local cache
+	//! miss ratio under `threshold` times the cluster's one; the vertex
+	//! cache efficiency therefore degrades at most by that factor.
+	//!
+	//! @param [in,out] indices triangle list to reorder
+	//! @param [in] indices_nb number of indices, a multiple of 3
+	//! @param [in] positions positions of the vertices
+	//! @param [in] vertices_nb number of vertices
+	//! @param [in] clusters index of the first triangle of each cluster
+	//! @param [in] cache_size number of entries of the targeted cache
+	//! @param [in] threshold tolerated cache efficiency degradation
+	void optimize_overdraw(GLuint* indices, size_t indices_nb,
+	                       glm::vec3 const* positions, size_t vertices_nb,
+	                       std::vector<size_t> const& clusters,
+	                       size_t cache_size = 16u, float threshold = 1.05f);
+
+	//! \brief Renumber vertices in the order they are first referenced,
+	//!        so that vertex fetches walk memory linearly.
+	//!
+	//! @param [in,out] indices triangle list to renumber
+	//! @param [in] indices_nb number of indices
+	//! @param [in] vertices_nb number of vertices
+	//! @return new index of each vertex, to be given to
+	//!         `vertex_data::remapped()`; unreferenced vertices are moved
+	//!         to the end
+	std::vector<GLuint> optimize_vertex_fetch(GLuint* indices, size_t indices_nb, size_t vertices_nb);
+
+	//! \brief Run all the above optimisations on a triangle mesh, and log
+	//!        the vertex cache efficiency before and after.
+	//!
+	//! @param [in,out] vertices vertices of the mesh, reordered
+	//! @param [in,out] indices triangle list of the mesh, reordered
+	//! @param [in] indices_nb number of indices, a multiple of 3
+	//! @param [in] name name of the mesh, used when logging
+	template<typename Format>
+	void optimize_mesh(vertex_data<Format>& vertices, GLuint* indices, size_t indices_nb, char const* name)
+	{
+		auto const vertices_nb = vertices.get_vertices_nb();
+		auto const before = simulate_vertex_cache(indices, indices_nb, vertices_nb);
+
+		auto const clusters = optimize_vertex_cache(indices, indices_nb, vertices_nb);
+		auto positions = std::vector<glm::vec3>(vertices_nb);
+		for (size_t i = 0u; i < vertices_nb; ++i)
+			positions[i] = vertices.template get<shader_bindings::vertices>(i);
+		optimize_overdraw(indices, indices_nb, positions.data(), vertices_nb, clusters);
+		vertices = vertices.remapped(optimize_vertex_fetch(indices, indices_nb, vertices_nb));
+
+		auto const after = simulate_vertex_cache(indices, indices_nb, vertices_nb);
+		LogInfo("Optimised \"%s\": ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+		        name, before.acmr, after.acmr, before.atvr, after.atvr);
+	}
+}
@@ -0,0 +1,323 @@
+#include "mesh_simplifier.hpp"
+#include "mesh_optimizer.hpp"
+
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+	//! \brief Sum of squared distances to a set of weighted planes, as the
+	//!        upper triangle of a symmetric 4x4 matrix.
+	struct quadric {
+		double a00, a01, a02, a03;
+		double      a11, a12, a13;
+		double           a22, a23;
+		double                a33;
+		double weight;
+
+		quadric() : a00(0.0), a01(0.0), a02(0.0), a03(0.0), a11(0.0), a12(0.0), a13(0.0),
+		            a22(0.0), a23(0.0), a33(0.0), weight(0.0)
+		{
+		}
+
+		quadric(glm::dvec3 const& n, double d, double w) :
+			a00(w * n.x * n.x), a01(w * n.x * n.y), a02(w * n.x * n.z), a03(w * n.x * d),
+			a11(w * n.y * n.y), a12(w * n.y * n.z), a13(w * n.y * d),
+			a22(w * n.z * n.z), a23(w * n.z * d),
+			a33(w * d * d), weight(w)
+		{
+		}
+
+		quadric& operator+=(quadric const& q)
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+			a11 += q.a11; a12 += q.a12; a13 += q.a13;
+			a22 += q.a22; a23 += q.a23;
+			a33 += q.a33;
+			weight += q.weight;
+			return *this;
+		}
+
+		//! \brief Weighted mean of the squared distances from `p` to the
+		//!        planes.
+		double evaluate(glm::vec3 const& p) const
+		{
+			double const x = p.x, y = p.y, z = p.z;
+			auto const value = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+			                 + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+			                 + a22 * z * z + 2.0 * a23 * z
+			                 + a33;
+			return weight > 0.0 ? std::max(value / weight, 0.0) : 0.0;
+		}
+	};
+
+	struct collapse {
+		GLuint from;
+		GLuint to;
+		double cost;
+	};
+
+	//! \brief Vertices which can not be moved: those on open borders, and
+	//!        those sharing their position with other vertices.
+	std::vector<bool> find_locked_vertices(GLuint const* indices, size_t indices_nb,
+	                                       glm::vec3 const* positions, size_t vertices_nb)
+	{
+		struct position_hash {
+			size_t operator()(glm::vec3 const& p) const
+			{
+				uint32_t bits[3];
+				std::memcpy(bits, &p, sizeof(bits));
+				return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+			}
+		};
+
+		auto locked = std::vector<bool>(vertices_nb, false);
+		auto welded = std::vector<GLuint>(vertices_nb);
+		auto first_at_position = std::unordered_map<glm::vec3, GLuint, position_hash>();
+		for (GLuint v = 0u; v < vertices_nb; ++v) {
+			auto const it = first_at_position.emplace(positions[v], v);
+			welded[v] = it.first->second;
+			if (!it.second) {
+				locked[v] = true;
+				locked[it.first->second] = true;
+			}
+		}
+
+		// An edge of the welded mesh is on a border, or non-manifold, unless
+		// it is used exactly as many times in both directions.
+		auto edge_uses = std::unordered_map<uint64_t, int>();
+		for (size_t i = 0u; i < indices_nb; i += 3u) {
+			for (size_t j = 0u; j < 3u; ++j) {
+				auto const a = welded[indices[i + j]];
+				auto const b = welded[indices[i + (j + 1u) % 3u]];
+				if (a == b)
+					continue;
+				auto const key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+				edge_uses[key] += a < b ? 1 : -1;
+			}
+		}
+		auto is_on_border = std::vector<bool>(vertices_nb, false);
+		for (auto const& edge : edge_uses) {
+			if (edge.second == 0)
+				continue;
+			is_on_border[static_cast<GLuint>(edge.first >> 32)] = true;
+			is_on_border[static_cast<GLuint>(edge.first & 0xffffffffu)] = true;
+		}
+		for (GLuint v = 0u; v < vertices_nb; ++v)
+			if (is_on_border[welded[v]])
+				locked[v] = true;
+		return locked;
+	}
+
+	glm::vec3 triangle_normal(glm::vec3 const& p0, glm::vec3 const& p1, glm::vec3 const& p2)
+	{
+		return glm::cross(p1 - p0, p2 - p0);
+	}
+}
+
+std::vector<GLuint>
+bonobo::simplify_mesh(GLuint const* indices, size_t indices_nb,
+                      glm::vec3 const* positions, size_t vertices_nb,
+                      size_t target_indices_nb, float& error)
+{
+	assert(indices_nb % 3u == 0u);
+
+	auto result = std::vector<GLuint>(indices, indices + indices_nb);
+	error = 0.0f;
+	if (indices_nb <= target_indices_nb)
+		return result;
+
+	auto const locked = find_locked_vertices(indices, indices_nb, positions, vertices_nb);
+
+	auto quadrics = std::vector<quadric>(vertices_nb);
+	for (size_t i = 0u; i < indices_nb; i += 3u) {
+		auto const& p0 = positions[indices[i + 0u]];
+		auto const& p1 = positions[indices[i + 1u]];
+		auto const& p2 = positions[indices[i + 2u]];
+		auto const normal = glm::dvec3(triangle_normal(p0, p1, p2));
+		auto const length = glm::length(normal);
+		if (length <= 0.0)
+			continue;
+		auto const unit_normal = normal / length;
+		auto const plane = quadric(unit_normal, -glm::dot(unit_normal, glm::dvec3(p0)), 0.5 * length);
+		for (size_t j = 0u; j < 3u; ++j)
+			quadrics[indices[i + j]] += plane;
+	}
+
+	auto remap = std::vector<GLuint>(vertices_nb);
+	auto is_touched = std::vector<bool>(vertices_nb);
+	auto offsets = std::vector<size_t>(vertices_nb + 1u);
+	auto adjacency = std::vector<size_t>();
+	auto collapses = std::vector<collapse>();
+	double max_cost = 0.0;
+
+	// Each pass collapses, in order of increasing cost, edges whose
+	// endpoints were not touched yet by the pass, until enough triangles
+	// are expected to be removed.
+	while (result.size() > target_indices_nb) {
+		auto const triangles_nb = result.size() / 3u;
+
+		std::fill(offsets.begin(), offsets.end(), 0u);
+		for (auto const v : result)
+			++offsets[v + 1u];
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		adjacency.resize(result.size());
+		auto cursors = std::vector<size_t>(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0u; i < result.size(); ++i)
+			adjacency[cursors[result[i]]++] = i / 3u;
+
+		collapses.clear();
+		for (size_t i = 0u; i < result.size(); i += 3u) {
+			for (size_t j = 0u; j < 3u; ++j) {
+				auto const a = result[i + j];
+				auto const b = result[i + (j + 1u) % 3u];
+				auto q = quadrics[a];
+				q += quadrics[b];
+				if (!locked[a])
+					collapses.push_back({ a, b, q.evaluate(positions[b]) });
+				if (!locked[b])
+					collapses.push_back({ b, a, q.evaluate(positions[a]) });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](collapse const& lhs, collapse const& rhs) {
+			return lhs.cost < rhs.cost;
+		});
+
+		std::iota(remap.begin(), remap.end(), 0u);
+		std::fill(is_touched.begin(), is_touched.end(), false);
+		auto const triangles_to_remove = triangles_nb - target_indices_nb / 3u;
+		size_t triangles_removed = 0u;
+		for (auto const& c : collapses) {
+			if (triangles_removed >= triangles_to_remove)
+				break;
+			if (is_touched[c.from] || is_touched[c.to])
+				continue;
+
+			// Reject collapses flipping or excessively rotating a triangle.
+			bool is_valid = true;
+			size_t removed = 0u;
+			for (auto k = offsets[c.from]; k < offsets[c.from + 1u] && is_valid; ++k) {
+				auto const t = adjacency[k] * 3u;
+				GLuint v[3] = { result[t + 0u], result[t + 1u], result[t + 2u] };
+				if (v[0] == c.to || v[1] == c.to || v[2] == c.to) {
+					++removed;
+					continue;
+				}
+				auto const before = triangle_normal(positions[v[0]], positions[v[1]], positions[v[2]]);
+				for (auto& w : v)
+					if (w == c.from)
+						w = c.to;
+				auto const after = triangle_normal(positions[v[0]], positions[v[1]], positions[v[2]]);
+				is_valid = glm::dot(before, after) > 0.25f * glm::length(before) * glm::length(after);
+			}
+			if (!is_valid || removed == 0u)
+				continue;
+
+			remap[c.from] = c.to;
+			quadrics[c.to] += quadrics[c.from];
+			is_touched[c.from] = true;
+			is_touched[c.to] = true;
+			triangles_removed += removed;
+			max_cost = std::max(max_cost, c.cost);
+		}
+		if (triangles_removed == 0u)
+			break;
+
+		size_t write = 0u;
+		for (size_t i = 0u; i < result.size(); i += 3u) {
+			auto const a = remap[result[i + 0u]];
+			auto const b = remap[result[i + 1u]];
+			auto const c = remap[result[i + 2u]];
+			if (a == b || b == c || c == a)
+				continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	error = static_cast<float>(std::sqrt(max_cost));
+	return result;
+}
+
+std::vector<bonobo::lod_level>
+bonobo::build_lod_chain(std::vector<GLuint>& indices,
+                        glm::vec3 const* positions, size_t vertices_nb,
+                        size_t levels_nb, float reduction)
+{
+	auto lods = std::vector<lod_level>();
+	lods.push_back({ 0u, indices.size(), 0.0f });
+	while (lods.size() < levels_nb) {
+		auto const& previous = lods.back();
+		auto const target = static_cast<size_t>(static_cast<float>(previous.indices_nb / 3u) * reduction) * 3u;
+		float error = 0.0f;
+		auto level = simplify_mesh(indices.data() + previous.first_index, previous.indices_nb,
+		                           positions, vertices_nb, target, error);
+		if (level.empty() || level.size() * 10u > previous.indices_nb * 9u)
+			break;
+
+		optimize_vertex_cache(level.data(), level.size(), vertices_nb);
+		auto const first_index = static_cast<GLuint>(indices.size());
+		auto const total_error = previous.error + error;
+		indices.insert(indices.end(), level.begin(), level.end());
+		lods.push_back({ first_index, level.size(), total_error });
+	}
+	return lods;
+}
+
+void
+bonobo::log_lod_chain(char const* name, std::vector<lod_level> const& lods)
+{
+	for (size_t i = 0u; i < lods.size(); ++i)
+		LogInfo("LOD %u of \"%s\": %u triangles, error %g",
+		        static_cast<unsigned int>(i), name,
+		        static_cast<unsigned int>(lods[i].indices_nb / 3u), lods[i].error);
+}
+
+float
+bonobo::get_pixels_per_unit(glm::mat4 const& model_to_world, float radius,
+                            glm::vec3 const& camera_position,
+                            float vertical_fov, float viewport_height)
+{
+	auto const scaling = std::max(glm::length(glm::vec3(model_to_world[0])),
+	                              std::max(glm::length(glm::vec3(model_to_world[1])),
+	                                       glm::length(glm::vec3(model_to_world[2]))));
+	auto const centre = glm::vec3(model_to_world[3]);
+	auto const distance = std::max(glm::length(centre - camera_position) - radius * scaling, 1e-3f);
+	return scaling * viewport_height / (2.0f * distance * std::tan(0.5f * vertical_fov));
+}
+
+bonobo::lod_selector::lod_selector(float pixel_threshold, float hysteresis) :
+	_pixel_threshold(pixel_threshold), _hysteresis(hysteresis), _level(0u)
+{
+}
+
+size_t
+bonobo::lod_selector::select(std::vector<lod_level> const& lods, float pixels_per_unit)
+{
+	if (lods.empty()) {
+		_level = 0u;
+		return _level;
+	}
+	_level = std::min(_level, lods.size() - 1u);
+
+	auto const fits = [&](size_t level, float threshold) {
+		return lods[level].error * pixels_per_unit <= threshold;
+	};
+	if (!fits(_level, _pixel_threshold * (1.0f + _hysteresis))) {
+		while (_level > 0u && !fits(_level, _pixel_threshold))
+			--_level;
+	} else {
+		while (_level + 1u < lods.size() && fits(_level + 1u, _pixel_threshold * (1.0f - _hysteresis)))
+			++_level;
+	}
+	return _level;
+}
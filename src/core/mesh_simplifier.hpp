@@ -0,0 +1,120 @@
+#pragma once
+
+#include "helpers.hpp"
+#include "vertex_format.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Simplify a triangle mesh by collapsing edges in order of
+	//!        increasing quadric error [Garland and Heckbert 1997].
+	//!
+	//! Edges are only collapsed onto one of their existing vertices, so
+	//! that all levels of detail of a mesh share the same vertex buffer.
+	//! Vertices on open borders or on attribute seams, i.e. sharing their
+	//! position with another vertex, are never moved, which keeps the
+	//! silhouette of open meshes and avoids cracks along texture seams.
+	//!
+	//! @param [in] indices triangle list to simplify
+	//! @param [in] indices_nb number of indices, a multiple of 3
+	//! @param [in] positions positions of the vertices
+	//! @param [in] vertices_nb number of vertices
+	//! @param [in] target_indices_nb number of indices to aim for; the
+	//!             result may have more if no valid collapse is left
+	//! @param [out] error largest distance, in model units, between the
+	//!              simplified surface and the original one, as estimated
+	//!              by the quadrics
+	//! @return the simplified triangle list
+	std::vector<GLuint> simplify_mesh(GLuint const* indices, size_t indices_nb,
+	                                  glm::vec3 const* positions, size_t vertices_nb,
+	                                  size_t target_indices_nb, float& error);
+
+	//! \brief Generate coarser levels of detail of a triangle mesh, and
+	//!        append them to its indices.
+	//!
+	//! Each level has about `reduction` times the triangles of the
+	//! previous one, and is simplified from it; its error is the sum of
+	//! the errors of all simplifications that led to it. Generation stops
+	//! early once a level removes less than a tenth of the triangles. The
+	//! triangles of each generated level are reordered for the vertex
+	//! cache.
+	//!
+	//! @param [in,out] indices triangle list of the mesh, which becomes the
+	//!                 first level of detail
+	//! @param [in] positions positions of the vertices
+	//! @param [in] vertices_nb number of vertices
+	//! @param [in] levels_nb maximum number of levels, including the first
+	//! @param [in] reduction ratio of triangles kept from one level to the
+	//!             next
+	//! @return the levels of detail, from the finest to the coarsest
+	std::vector<lod_level> build_lod_chain(std::vector<GLuint>& indices,
+	                                       glm::vec3 const* positions, size_t vertices_nb,
+	                                       size_t levels_nb, float reduction = 0.5f);
+
+	//! \brief Log the triangle count and error of every level of detail.
+	void log_lod_chain(char const* name, std::vector<lod_level> const& lods);
+
+	//! \brief Generate the levels of detail of a mesh held in a
+	//!        `vertex_data`, and log them; see the other overload.
+	template<typename Format>
+	std::vector<lod_level> build_lod_chain(vertex_data<Format> const& vertices, std::vector<GLuint>& indices,
+	                                       size_t levels_nb, char const* name)
+	{
+		auto const vertices_nb = vertices.get_vertices_nb();
+		auto positions = std::vector<glm::vec3>(vertices_nb);
+		for (size_t i = 0u; i < vertices_nb; ++i)
+			positions[i] = vertices.template get<shader_bindings::vertices>(i);
+		auto const lods = build_lod_chain(indices, positions.data(), vertices_nb, levels_nb);
+		log_lod_chain(name, lods);
+		return lods;
+	}
+
+	//! \brief Number of pixels covered by one model unit, at the distance
+	//!        of a mesh from the camera.
+	//!
+	//! @param [in] model_to_world transform of the mesh; its largest
+	//!             scaling factor is used
+	//! @param [in] radius radius of the bounding sphere of the mesh, in
+	//!             model units; distances are measured to that sphere
+	//! @param [in] camera_position position of the camera in world space
+	//! @param [in] vertical_fov vertical field of view, in radians
+	//! @param [in] viewport_height height of the viewport, in pixels
+	float get_pixels_per_unit(glm::mat4 const& model_to_world, float radius,
+	                          glm::vec3 const& camera_position,
+	                          float vertical_fov, float viewport_height);
+
+	//! \brief Pick, for one mesh instance, the coarsest level of detail
+	//!        whose error projects to less than a given number of pixels.
+	//!
+	//! To avoid popping back and forth when the projected error hovers
+	//! around the threshold, a coarser level is only picked once its error
+	//! is `hysteresis` below the threshold, and the current level is only
+	//! left for a finer one once its error is `hysteresis` above it.
+	class lod_selector
+	{
+	public:
+		//! @param [in] pixel_threshold largest tolerated error, in pixels
+		//! @param [in] hysteresis relative margin around the threshold
+		explicit lod_selector(float pixel_threshold = 1.0f, float hysteresis = 0.25f);
+
+		//! \brief Update and return the selected level.
+		//!
+		//! @param [in] lods levels of detail of the mesh
+		//! @param [in] pixels_per_unit see `get_pixels_per_unit()`
+		size_t select(std::vector<lod_level> const& lods, float pixels_per_unit);
+
+		size_t get_level() const { return _level; }
+
+		void set_pixel_threshold(float pixel_threshold) { _pixel_threshold = pixel_threshold; }
+		float get_pixel_threshold() const { return _pixel_threshold; }
+
+	private:
+		float _pixel_threshold;
+		float _hysteresis;
+		size_t _level;
+	};
+}
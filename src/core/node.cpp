@@ -1,12 +1,20 @@
 #include "node.hpp"
 #include "helpers.hpp"
+#include "transforms.hpp"
 
 #include "core/Log.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-Node::Node() : _vao(0u), _vertices_nb(0u), _indices_nb(0u), _drawing_mode(GL_TRIANGLES), _has_indices(true), _program(nullptr), _textures(), _scaling(1.0f), _rotation(), _translation(), _children()
+#include <algorithm>
+
+static size_t index_size(GLenum indices_type)
+{
+	return indices_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+Node::Node() : _vao(0u), _vertices_nb(0u), _indices_nb(0u), _base_vertex(0), _first_index(0u), _indices_type(GL_UNSIGNED_INT), _drawing_mode(GL_TRIANGLES), _has_indices(true), _lods(), _program(nullptr), _textures(), _scaling(1.0f), _rotation(), _orientation(1.0f, 0.0f, 0.0f, 0.0f), _translation(), _children()
 {
 }
 
@@ -23,12 +31,12 @@ void Node::render(glm::mat4 const &WVP, glm::mat4 const &world, GLuint program,
 
 	glUseProgram(program);
 
-	auto const normal_model_to_world = glm::transpose(glm::inverse(world));
+	auto const normal_transform = glm::mat4(bonobo::normal_matrix(world));
 
 	set_uniforms(program);
 
 	glUniformMatrix4fv(glGetUniformLocation(program, "vertex_model_to_world"), 1, GL_FALSE, glm::value_ptr(world));
-	glUniformMatrix4fv(glGetUniformLocation(program, "normal_model_to_world"), 1, GL_FALSE, glm::value_ptr(normal_model_to_world));
+	glUniformMatrix4fv(glGetUniformLocation(program, "normal_model_to_world"), 1, GL_FALSE, glm::value_ptr(normal_transform));
 	glUniformMatrix4fv(glGetUniformLocation(program, "vertex_world_to_clip"), 1, GL_FALSE, glm::value_ptr(WVP));
 
 	for (size_t i = 0u; i < _textures.size(); ++i)
@@ -44,9 +52,10 @@ void Node::render(glm::mat4 const &WVP, glm::mat4 const &world, GLuint program,
 
 	glBindVertexArray(_vao);
 	if (_has_indices)
-		glDrawElements(_drawing_mode, _indices_nb, GL_UNSIGNED_INT, reinterpret_cast<GLvoid const *>(0x0));
+		glDrawElementsBaseVertex(_drawing_mode, _indices_nb, _indices_type,
+								 reinterpret_cast<GLvoid const *>(_first_index * index_size(_indices_type)), _base_vertex);
 	else
-		glDrawArrays(_drawing_mode, 0, _vertices_nb);
+		glDrawArrays(_drawing_mode, _base_vertex, _vertices_nb);
 	glBindVertexArray(0u);
 
 	for (auto const &texture : _textures)
@@ -66,9 +75,16 @@ void Node::set_geometry(bonobo::mesh_data const &shape)
 	_vao = shape.vao;
 	_vertices_nb = static_cast<GLsizei>(shape.vertices_nb);
 	_indices_nb = static_cast<GLsizei>(shape.indices_nb);
+	_base_vertex = shape.base_vertex;
+	_first_index = shape.first_index;
+	_indices_type = shape.indices_type;
 	_drawing_mode = shape.drawing_mode;
 	_has_indices = shape.ibo != 0u;
 
+	_lods.clear();
+	for (auto const &lod : shape.lods)
+		_lods.emplace_back(shape.first_index + lod.first_index, static_cast<GLsizei>(lod.indices_nb), lod.error);
+
 	if (!shape.bindings.empty())
 	{
 		for (auto const &binding : shape.bindings)
@@ -96,6 +112,28 @@ void Node::set_indices_nb(size_t const &indices_nb)
 	_indices_nb = static_cast<GLsizei>(indices_nb);
 }
 
+size_t
+Node::get_lods_nb() const
+{
+	return std::max<size_t>(_lods.size(), 1u);
+}
+
+float Node::get_lod_error(size_t level) const
+{
+	assert(level < get_lods_nb());
+	return _lods.empty() ? 0.0f : std::get<2>(_lods[level]);
+}
+
+void Node::set_lod(size_t level)
+{
+	assert(level < get_lods_nb());
+	if (_lods.empty())
+		return;
+
+	_first_index = std::get<0>(_lods[level]);
+	_indices_nb = std::get<1>(_lods[level]);
+}
+
 void Node::add_texture(std::string const &name, GLuint tex_id, GLenum type)
 {
 	if (tex_id != 0u)
@@ -150,7 +188,7 @@ Node::get_transform() const
 	auto const rotation_x = glm::rotate(glm::mat4(1.0f), _rotation.x, glm::vec3(1.0, 0.0, 0.0));
 	auto const rotation_y = glm::rotate(glm::mat4(1.0f), _rotation.y, glm::vec3(0.0, 1.0, 0.0));
 	auto const rotation_z = glm::rotate(glm::mat4(1.0f), _rotation.z, glm::vec3(0.0, 0.0, 1.0));
-	auto const rotating = rotation_z * rotation_y * rotation_x;
+	auto const rotating = glm::mat4_cast(_orientation) * rotation_z * rotation_y * rotation_x;
 
 	return translating * rotating * scaling;
 }
@@ -202,9 +240,10 @@ void Node::renderInstanced(glm::mat4 const &WVP, glm::mat4 const &world, const s
 
 	glBindVertexArray(_vao);
 	if (_has_indices)
-		glDrawElementsInstanced(_drawing_mode, _indices_nb, GL_UNSIGNED_INT, reinterpret_cast<GLvoid const *>(0x0), N);
+		glDrawElementsInstancedBaseVertex(_drawing_mode, _indices_nb, _indices_type,
+										  reinterpret_cast<GLvoid const *>(_first_index * index_size(_indices_type)), N, _base_vertex);
 	else
-		glDrawArraysInstanced(_drawing_mode, 0, _vertices_nb, N);
+		glDrawArraysInstanced(_drawing_mode, _base_vertex, _vertices_nb, N);
 	glBindVertexArray(0u);
 
 	for (auto const &texture : _textures)
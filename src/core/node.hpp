@@ -3,6 +3,7 @@
 #include "external/glad/glad.h"
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include <functional>
 #include <tuple>
@@ -64,6 +65,25 @@ class Node
 	//! @param [in] indices_nb how many indices to use when rendering
 	void set_indices_nb(size_t const &indices_nb);
 
+	//! \brief Get the number of levels of detail of the geometry.
+	//!
+	//! @return how many levels of detail the geometry has, 1 if it was not
+	//!         given any
+	size_t get_lods_nb() const;
+
+	//! \brief Get the error of a level of detail of the geometry.
+	//!
+	//! @param [in] level the level of detail, less than `get_lods_nb()`
+	//! @return the distance, in model units, between that level and the
+	//!         full-detail geometry
+	float get_lod_error(size_t level) const;
+
+	//! \brief Select which level of detail of the geometry to render.
+	//!
+	//! @param [in] level the level of detail, less than `get_lods_nb()`;
+	//!             0 is the full-detail one
+	void set_lod(size_t level);
+
 	//! \brief Set the program of this node.
 	//!
 	//! A node without a program will not render itself, but its children
@@ -154,6 +174,15 @@ class Node
 	//!                     radians
 	void rotate_z(float d_angle) { _rotation.z += d_angle; }
 
+	//! \brief Reset the orientation to a new value.
+	//!
+	//! The orientation is applied after the rotations around the x-, y-
+	//! and z-axes, which it leaves untouched; it is meant for rotations
+	//! coming from elsewhere, such as a `bonobo::animation_sampler`.
+	//!
+	//! @param [in] orientation new orientation, as a unit quaternion
+	void set_orientation(glm::quat const &orientation) { _orientation = orientation; }
+
 	//! \brief Reset the scaling to a new value.
 	//!
 	//! @param [in] scaling new scaling vector: `(x_scaling, y_scaling,
@@ -179,8 +208,12 @@ class Node
 	GLuint _vao;
 	GLsizei _vertices_nb;
 	GLsizei _indices_nb;
+	GLint _base_vertex;
+	GLuint _first_index;
+	GLenum _indices_type;
 	GLenum _drawing_mode;
 	bool _has_indices;
+	std::vector<std::tuple<GLuint, GLsizei, float>> _lods; // as (first index, indices count, error)
 
 	// Program data
 	GLuint const *_program;
@@ -192,6 +225,7 @@ class Node
 	// Transformation data
 	glm::vec3 _scaling;
 	glm::vec3 _rotation; // as (angle around x-axis, angle around y-axis, angle around z-axis)
+	glm::quat _orientation;
 	glm::vec3 _translation;
 
 	// Children data
@@ -3,6 +3,7 @@
 #include "various.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -14,6 +15,19 @@ namespace utils
 namespace opengl
 {
 
+bool
+has_extension(char const* name)
+{
+	GLint extensions_nb = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensions_nb);
+	for (GLint i = 0; i < extensions_nb; ++i) {
+		auto const extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+		if (extension != nullptr && std::strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
+
 namespace debug
 {
 
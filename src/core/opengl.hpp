@@ -13,6 +13,10 @@ namespace utils
 namespace opengl
 {
 
+//! \brief Whether the current context exposes the extension `name`, such
+//!        as "GL_ARB_multi_draw_indirect".
+bool has_extension(char const* name);
+
 namespace debug
 {
 
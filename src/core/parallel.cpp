@@ -0,0 +1,180 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::atomic<size_t> worker_threads_limit(0u);
+
+	//! Whether the current thread is a worker of the pool, or is running
+	//! a `parallel_for()` through it; nested calls then run inline.
+	thread_local bool is_in_parallel_for = false;
+
+	//! Threads kept alive between calls to `parallel_for()`, so that
+	//! splitting work only costs waking them up rather than creating them.
+	//!
+	//! A job is split into chunks, which the calling thread and the
+	//! workers claim one at a time; it is open from the moment it is
+	//! posted until the caller has claimed the last chunk, and the caller
+	//! returns once every worker which joined it while it was open is done.
+	class worker_pool
+	{
+	public:
+		worker_pool() : _threads(), _generation(0u), _is_open(false), _is_stopping(false),
+		                _busy_workers_nb(0u), _body(nullptr), _count(0u), _chunk_size(0u),
+		                _chunks_nb(0u), _next_chunk(0u)
+		{
+		}
+
+		~worker_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_is_stopping = true;
+			}
+			_job_posted.notify_all();
+			for (auto& thread : _threads)
+				thread.join();
+		}
+
+		worker_pool(worker_pool const&) = delete;
+		worker_pool& operator=(worker_pool const&) = delete;
+
+		//! Run the `chunks_nb` chunks of `chunk_size` items covering
+		//! [0, count) with `workers_nb` workers helping the calling
+		//! thread; return false, without running anything, if the pool
+		//! is busy with a job of another thread.
+		bool run(size_t count, size_t chunk_size, size_t chunks_nb, size_t workers_nb,
+		         std::function<void(size_t, size_t)> const& body)
+		{
+			std::unique_lock<std::mutex> dispatch_lock(_dispatch_mutex, std::try_to_lock);
+			if (!dispatch_lock.owns_lock())
+				return false;
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				while (_threads.size() < workers_nb)
+					_threads.emplace_back(&worker_pool::work, this);
+				_body = &body;
+				_count = count;
+				_chunk_size = chunk_size;
+				_chunks_nb = chunks_nb;
+				_next_chunk.store(0u, std::memory_order_relaxed);
+				_is_open = true;
+				++_generation;
+			}
+			_job_posted.notify_all();
+
+			is_in_parallel_for = true;
+			process_chunks();
+			is_in_parallel_for = false;
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_is_open = false;
+			_job_done.wait(lock, [this]() { return _busy_workers_nb == 0u; });
+			_body = nullptr;
+			return true;
+		}
+
+	private:
+		void work()
+		{
+			is_in_parallel_for = true;
+			uint64_t seen_generation = 0u;
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_job_posted.wait(lock, [&]() { return _is_stopping || _generation != seen_generation; });
+					if (_is_stopping)
+						return;
+					seen_generation = _generation;
+					if (!_is_open)
+						continue;
+					++_busy_workers_nb;
+				}
+
+				process_chunks();
+
+				bool is_last;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					is_last = --_busy_workers_nb == 0u;
+				}
+				if (is_last)
+					_job_done.notify_one();
+			}
+		}
+
+		void process_chunks()
+		{
+			for (;;) {
+				auto const chunk = _next_chunk.fetch_add(1u, std::memory_order_relaxed);
+				if (chunk >= _chunks_nb)
+					return;
+				auto const first = chunk * _chunk_size;
+				(*_body)(first, std::min(first + _chunk_size, _count));
+			}
+		}
+
+		std::mutex _dispatch_mutex;
+		std::mutex _mutex;
+		std::condition_variable _job_posted;
+		std::condition_variable _job_done;
+		std::vector<std::thread> _threads;
+
+		uint64_t _generation;
+		bool _is_open;
+		bool _is_stopping;
+		size_t _busy_workers_nb;
+
+		std::function<void(size_t, size_t)> const* _body;
+		size_t _count;
+		size_t _chunk_size;
+		size_t _chunks_nb;
+		std::atomic<size_t> _next_chunk;
+	};
+}
+
+size_t
+bonobo::get_worker_threads_nb()
+{
+	static size_t const hardware_threads_nb = std::max(std::thread::hardware_concurrency(), 1u);
+	auto const limit = worker_threads_limit.load(std::memory_order_relaxed);
+	return limit > 0u ? limit : hardware_threads_nb;
+}
+
+void
+bonobo::set_worker_threads_nb(size_t threads_nb)
+{
+	worker_threads_limit.store(threads_nb, std::memory_order_relaxed);
+}
+
+void
+bonobo::parallel_for(size_t count, std::function<void(size_t first, size_t last)> const& body,
+                     size_t min_chunk_size)
+{
+	auto const chunks_nb = std::min(get_worker_threads_nb(), count / std::max(min_chunk_size, size_t(1u)));
+	if (chunks_nb <= 1u) {
+		if (count > 0u)
+			body(0u, count);
+		return;
+	}
+
+	auto const chunk_size = (count + chunks_nb - 1u) / chunks_nb;
+	auto const used_chunks_nb = (count + chunk_size - 1u) / chunk_size;
+
+	static worker_pool pool;
+	if (!is_in_parallel_for && pool.run(count, chunk_size, used_chunks_nb, used_chunks_nb - 1u, body))
+		return;
+
+	// Called from within another `parallel_for()`, or while another
+	// thread is using the pool: run the same chunks on this thread.
+	for (size_t first = 0u; first < count; first += chunk_size)
+		body(first, std::min(first + chunk_size, count));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace bonobo
+{
+	//! \brief Number of threads `parallel_for()` splits work across, by
+	//!        default the number of hardware threads.
+	size_t get_worker_threads_nb();
+
+	//! \brief Limit how many threads `parallel_for()` splits work across,
+	//!        e.g. to measure how some work scales.
+	//!
+	//! @param [in] threads_nb number of threads to use, including the
+	//!             calling one; 0 restores one per hardware thread
+	void set_worker_threads_nb(size_t threads_nb);
+
+	//! \brief Run `body(first, last)` over contiguous chunks covering
+	//!        [0, count), one chunk per worker thread; the calling thread
+	//!        processes chunks too, and returns once all are done.
+	//!
+	//! `body` is called concurrently, so it should only write to data
+	//! derived from its own range. The worker threads are created on the
+	//! first call needing them and then wait for the next ones, so calling
+	//! this every frame does not create any thread. Calls made from within
+	//! `body`, or while another thread's call is running, process their
+	//! chunks on the calling thread.
+	//!
+	//! @param [in] count number of items to process
+	//! @param [in] body function processing the items [first, last)
+	//! @param [in] min_chunk_size minimum number of items per chunk; below
+	//!             twice that, everything runs on the calling thread
+	void parallel_for(size_t count, std::function<void(size_t first, size_t last)> const& body,
+	                  size_t min_chunk_size = 1u);
+}
@@ -0,0 +1,594 @@
+#include "poisson_disk.hpp"
+#include "Log.h"
+#include "Misc.h"
+#include "parallel.hpp"
+#include "random.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	// Tiles filled at once are one tile apart, which has to be more than
+	// the distance between two points anywhere: 9 cells on the sphere at
+	// the lowest density, 6 on a rectangle.
+	constexpr size_t tile_cells = 32u;
+	constexpr float lowest_density = 1.0f / 16.0f;
+
+	// Candidates are tried this far from a point, relative to its radius.
+	constexpr float candidate_distance = 1.0001f;
+
+	// Empty cells hold a radius of 0, and a position far from any point,
+	// so that looking for neighbours does not need to tell them apart.
+	glm::vec4 const empty_cell(1.0e18f, 1.0e18f, 1.0e18f, 0.0f);
+
+	//! Square cells of one face, each holding at most one point, as its
+	//! position and the radius around it.
+	struct grid {
+		size_t cells_x = 0u;
+		size_t cells_y = 0u;
+		std::vector<glm::vec4> cells;
+
+		glm::vec4& at(size_t x, size_t y) { return cells[y * cells_x + x]; }
+		glm::vec4 const& at(size_t x, size_t y) const { return cells[y * cells_x + x]; }
+	};
+
+	// Orthonormal vectors perpendicular to the unit vector `n`, from
+	// Duff et al.'s "Building an Orthonormal Basis, Revisited".
+	void
+	tangent_frame(glm::vec3 const& n, glm::vec3& t, glm::vec3& b)
+	{
+		auto const sign = std::copysign(1.0f, n.z);
+		auto const a = -1.0f / (sign + n.z);
+		auto const c = n.x * n.y * a;
+		t = glm::vec3(1.0f + sign * n.x * n.x * a, sign * c, -sign * n.x);
+		b = glm::vec3(c, sign + n.y * n.y * a, -n.y);
+	}
+
+	//! The rectangle, as a single face.
+	class rectangle_domain
+	{
+	public:
+		rectangle_domain(glm::vec2 const& lower, glm::vec2 const& upper, float min_distance) :
+			_lower(lower), _upper(upper), _cell_size(min_distance / glm::root_two<float>())
+		{
+			auto const extent = glm::max(upper - lower, glm::vec2(0.0f));
+			_grid.cells_x = std::max(static_cast<size_t>(std::ceil(extent.x / _cell_size)), size_t(1u));
+			_grid.cells_y = std::max(static_cast<size_t>(std::ceil(extent.y / _cell_size)), size_t(1u));
+			_grid.cells.assign(_grid.cells_x * _grid.cells_y, empty_cell);
+		}
+
+		size_t faces_nb() const { return 1u; }
+		grid& get_grid(size_t /*face*/) { return _grid; }
+		grid const& get_grid(size_t /*face*/) const { return _grid; }
+
+		//! Distance covered by the side of a cell, at least.
+		float cell_side() const { return _cell_size; }
+
+		size_t face_of(glm::vec3 const& /*p*/) const { return 0u; }
+
+		//! Position of `p` on the grid of `face`, in cells.
+		bool locate(glm::vec3 const& p, size_t /*face*/, glm::vec2& cell) const
+		{
+			cell = (glm::vec2(p) - _lower) / _cell_size;
+			return true;
+		}
+
+		bool contains(glm::vec3 const& p) const
+		{
+			return p.x >= _lower.x && p.y >= _lower.y && p.x <= _upper.x && p.y <= _upper.y;
+		}
+
+		//! Point at `cell`, in cells, on the grid of `face`.
+		glm::vec3 at(size_t /*face*/, glm::vec2 const& cell) const
+		{
+			return glm::vec3(_lower + cell * _cell_size, 0.0f);
+		}
+
+		//! Directions in which candidates are tried around `p`.
+		void frame(glm::vec3 const& /*p*/, glm::vec3& t, glm::vec3& b) const
+		{
+			t = glm::vec3(1.0f, 0.0f, 0.0f);
+			b = glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+
+		//! Distance to go along the frame of a point to end up `distance`
+		//! away from it.
+		float frame_distance(float distance) const { return distance; }
+
+		//! Point at `offset` from `p`, along its frame.
+		glm::vec3 around(glm::vec3 const& p, glm::vec3 const& offset) const
+		{
+			return p + offset;
+		}
+
+		glm::vec2 density_coordinates(glm::vec3 const& p) const
+		{
+			return (glm::vec2(p) - _lower) / (_upper - _lower);
+		}
+
+	private:
+		glm::vec2 _lower;
+		glm::vec2 _upper;
+		float _cell_size;
+		grid _grid;
+	};
+
+	//! The six faces of a cube, mapped onto the sphere with equal angles.
+	class sphere_domain
+	{
+	public:
+		sphere_domain(float radius, float min_distance) : _radius(radius)
+		{
+			// Cells get down to 1/sqrt(2) of their angle times the radius
+			// across, towards the middle of the edges of the faces; the
+			// margin keeps their diagonal below the minimal distance
+			// anywhere else.
+			auto const cell_angle = 0.95f * min_distance / (glm::root_two<float>() * radius);
+			auto const cells_nb = std::max(static_cast<size_t>(std::ceil(glm::half_pi<float>() / cell_angle)), size_t(1u));
+			_cell_angle = glm::half_pi<float>() / static_cast<float>(cells_nb);
+			for (auto& face_grid : _grids) {
+				face_grid.cells_x = cells_nb;
+				face_grid.cells_y = cells_nb;
+				face_grid.cells.assign(cells_nb * cells_nb, empty_cell);
+			}
+		}
+
+		size_t faces_nb() const { return 6u; }
+		grid& get_grid(size_t face) { return _grids[face]; }
+		grid const& get_grid(size_t face) const { return _grids[face]; }
+
+		// Towards the corners of the faces, where the grid is the most
+		// sheared, moving by a cell can cover as little as 2/3 of its
+		// angle times the radius, diagonally.
+		float cell_side() const { return (2.0f / 3.0f) * _radius * _cell_angle; }
+
+		size_t face_of(glm::vec3 const& p) const
+		{
+			auto const a = glm::abs(p);
+			auto const axis = a.x >= a.y && a.x >= a.z ? 0u : (a.y >= a.z ? 1u : 2u);
+			return 2u * axis + (p[axis] < 0.0f ? 1u : 0u);
+		}
+
+		bool locate(glm::vec3 const& p, size_t face, glm::vec2& cell) const
+		{
+			auto const axis = face / 2u;
+			auto const normal = (face & 1u) ? -p[axis] : p[axis];
+			if (normal <= 0.0f)
+				return false;
+			auto const u = p[(axis + 1u) % 3u] / normal;
+			auto const v = p[(axis + 2u) % 3u] / normal;
+			cell = (glm::vec2(std::atan(u), std::atan(v)) + glm::quarter_pi<float>()) / _cell_angle;
+			return true;
+		}
+
+		bool contains(glm::vec3 const& /*p*/) const { return true; }
+
+		glm::vec3 at(size_t face, glm::vec2 const& cell) const
+		{
+			auto const axis = face / 2u;
+			auto const angles = cell * _cell_angle - glm::quarter_pi<float>();
+			glm::vec3 p;
+			p[axis] = (face & 1u) ? -1.0f : 1.0f;
+			p[(axis + 1u) % 3u] = std::tan(angles.x);
+			p[(axis + 2u) % 3u] = std::tan(angles.y);
+			return _radius * glm::normalize(p);
+		}
+
+		void frame(glm::vec3 const& p, glm::vec3& t, glm::vec3& b) const
+		{
+			tangent_frame(p / _radius, t, b);
+		}
+
+		// Projecting back onto the sphere shortens the step, by about
+		// 3/8 (distance / radius)^2: farther than the margin between a
+		// point and its candidates as soon as the radius is less than 60
+		// times the distance.
+		float frame_distance(float distance) const
+		{
+			// At most a quarter of a great circle away.
+			auto const half_angle = std::asin(std::min(0.5f * distance / _radius, 0.7f));
+			return _radius * std::tan(2.0f * half_angle);
+		}
+
+		glm::vec3 around(glm::vec3 const& p, glm::vec3 const& offset) const
+		{
+			return _radius * glm::normalize(p + offset);
+		}
+
+		glm::vec2 density_coordinates(glm::vec3 const& p) const
+		{
+			return glm::vec2(std::atan2(p.z, p.x) * glm::one_over_two_pi<float>() + 0.5f,
+			                 std::acos(glm::clamp(p.y / _radius, -1.0f, 1.0f)) * glm::one_over_pi<float>());
+		}
+
+	private:
+		float _radius;
+		float _cell_angle;
+		grid _grids[6];
+	};
+
+	// Largest distance kept around a point, where the density is the
+	// lowest.
+	float
+	largest_radius(bonobo::poisson_disk_parameters const& parameters)
+	{
+		if (parameters.density.empty())
+			return parameters.min_distance;
+		return parameters.min_distance / std::sqrt(std::max(parameters.min_density, lowest_density));
+	}
+
+	//! Fills the tiles of a domain with Bridson's algorithm.
+	template<typename Domain>
+	class tile_sampler
+	{
+	public:
+		tile_sampler(Domain& domain, bonobo::poisson_disk_parameters const& parameters) :
+			_domain(domain), _parameters(parameters),
+			_min_density(std::max(parameters.min_density, lowest_density)),
+			_reach_cells(largest_radius(parameters) / domain.cell_side()),
+			_step(std::cos(glm::two_pi<float>() / static_cast<float>(std::max(parameters.attempts_nb, 1u))),
+			      std::sin(glm::two_pi<float>() / static_cast<float>(std::max(parameters.attempts_nb, 1u)))),
+			_offsets(), _span(0)
+		{
+			assert(_reach_cells < static_cast<float>(tile_cells));
+
+			// Cells which can hold a point within reach of a candidate
+			// somewhere in the middle one, sorted so that the middle one
+			// comes first, then the closest ones, which reject most
+			// candidates.
+			_span = static_cast<int>(std::ceil(_reach_cells)) + 1;
+			for (auto y = -_span; y <= _span; ++y)
+				for (auto x = -_span; x <= _span; ++x) {
+					auto const gap_x = static_cast<float>(std::max(std::abs(x) - 1, 0));
+					auto const gap_y = static_cast<float>(std::max(std::abs(y) - 1, 0));
+					auto const min_gap = gap_x * gap_x + gap_y * gap_y;
+					if (min_gap <= _reach_cells * _reach_cells)
+						_offsets.push_back({x, y, min_gap, static_cast<float>(x * x + y * y)});
+				}
+			std::sort(_offsets.begin(), _offsets.end(), [](cell_offset const& a, cell_offset const& b) {
+				return a.min_gap < b.min_gap || (a.min_gap == b.min_gap && a.max_gap < b.max_gap);
+			});
+			assert(_offsets.front().x == 0 && _offsets.front().y == 0);
+		}
+
+		//! Fill the faces [first_face, last_face), which must not touch
+		//! each other: their tiles go through the same passes.
+		void fill(size_t first_face, size_t last_face)
+		{
+			std::vector<tile_index> tiles;
+			for (size_t pass = 0u; pass < 4u; ++pass) {
+				tiles.clear();
+				for (auto face = first_face; face < last_face; ++face) {
+					auto const& face_grid = _domain.get_grid(face);
+					auto const tiles_x = (face_grid.cells_x + tile_cells - 1u) / tile_cells;
+					auto const tiles_y = (face_grid.cells_y + tile_cells - 1u) / tile_cells;
+					for (auto y = pass >> 1u; y < tiles_y; y += 2u)
+						for (auto x = pass & 1u; x < tiles_x; x += 2u)
+							tiles.push_back({face, x, y, tiles_x});
+				}
+				bonobo::parallel_for(tiles.size(), [&](size_t first, size_t last) {
+					for (size_t i = first; i < last; ++i)
+						fill_tile(tiles[i].face, tiles[i].x, tiles[i].y, tiles[i].tiles_x);
+				});
+			}
+		}
+
+	private:
+		struct tile {
+			size_t face;
+			size_t x0, y0, x1, y1; // cells [x0, x1) x [y0, y1)
+		};
+
+		struct tile_index {
+			size_t face;
+			size_t x, y;
+			size_t tiles_x; // on the face
+		};
+
+		//! Cell around that of a candidate, with the squared distances
+		//! from the candidate to its closest side, in cells, wherever the
+		//! candidate lies in its own cell.
+		struct cell_offset {
+			int x, y;
+			float min_gap, max_gap;
+		};
+
+		void fill_tile(size_t face, size_t tile_x, size_t tile_y, size_t tiles_x)
+		{
+			auto const& face_grid = _domain.get_grid(face);
+			tile const t{face, tile_x * tile_cells, tile_y * tile_cells,
+			             std::min((tile_x + 1u) * tile_cells, face_grid.cells_x),
+			             std::min((tile_y + 1u) * tile_cells, face_grid.cells_y)};
+			bonobo::xoshiro256ss generator((uint64_t(_parameters.seed) << 32) ^ ((face * 0x10000u + tile_y) * tiles_x + tile_x));
+
+			// Points of the tiles filled before, next to this one, so that
+			// new ones are packed against them.
+			std::vector<glm::vec4> active;
+			auto const band = static_cast<size_t>(std::ceil(_reach_cells));
+			for (auto y = t.y0 >= band ? t.y0 - band : 0u; y < std::min(t.y1 + band, face_grid.cells_y); ++y)
+				for (auto x = t.x0 >= band ? t.x0 - band : 0u; x < std::min(t.x1 + band, face_grid.cells_x); ++x)
+					if ((x < t.x0 || x >= t.x1 || y < t.y0 || y >= t.y1) && face_grid.at(x, y).w > 0.0f)
+						active.push_back(face_grid.at(x, y));
+
+			auto blocker = glm::vec3(empty_cell);
+			for (;;) {
+				while (!active.empty()) {
+					auto const index = std::min(static_cast<size_t>(generator.next_float() * active.size()), active.size() - 1u);
+					auto const p = active[index];
+					active[index] = active.back();
+					active.pop_back();
+
+					// Candidates evenly spread on the circle just beyond the
+					// radius of the point, from a random angle, as in
+					// Roberts' variant of the algorithm: each point is
+					// visited once, and they end up packed more tightly.
+					auto const angle = glm::two_pi<float>() * generator.next_float();
+					auto direction = glm::vec2(std::cos(angle), std::sin(angle));
+					glm::vec3 t_axis, b_axis;
+					_domain.frame(glm::vec3(p), t_axis, b_axis);
+					auto const distance = _domain.frame_distance(p.w * candidate_distance);
+					for (auto attempt = 0u; attempt < _parameters.attempts_nb; ++attempt) {
+						auto const offset = direction.x * t_axis + direction.y * b_axis;
+						auto candidate = _domain.around(glm::vec3(p), distance * offset);
+						float radius;
+						glm::vec2 cell;
+						if (admits(t, candidate, radius, cell) && radius > p.w) {
+							// Sparser there: step out to the radius of the
+							// candidate.
+							candidate = _domain.around(glm::vec3(p), _domain.frame_distance(radius * candidate_distance) * offset);
+							if (!admits(t, candidate, radius, cell))
+								radius = 0.0f;
+						}
+						if (radius > 0.0f)
+							insert(t, candidate, radius, cell, active, blocker);
+						direction = glm::vec2(_step.x * direction.x - _step.y * direction.y,
+						                      _step.y * direction.x + _step.x * direction.y);
+					}
+				}
+
+				// Start again from a random point of the tile, until none
+				// fits anymore.
+				bool found = false;
+				for (auto attempt = 0u; attempt < _parameters.attempts_nb && !found; ++attempt) {
+					auto const cell = glm::vec2(t.x0 + generator.next_float() * (t.x1 - t.x0), t.y0 + generator.next_float() * (t.y1 - t.y0));
+					auto const candidate = _domain.at(face, cell);
+					float radius;
+					glm::vec2 candidate_cell;
+					found = admits(t, candidate, radius, candidate_cell) && insert(t, candidate, radius, candidate_cell, active, blocker);
+				}
+				if (!found)
+					break;
+			}
+		}
+
+		// Whether `candidate` lies in the tile, in an empty cell, outside
+		// the exclusion zones and dense enough; if so, `radius` is the
+		// distance to keep around it, and `cell` its position on the grid,
+		// otherwise `radius` is 0.
+		bool admits(tile const& t, glm::vec3 const& candidate, float& radius, glm::vec2& cell) const
+		{
+			radius = 0.0f;
+			if (!_domain.contains(candidate) || _domain.face_of(candidate) != t.face)
+				return false;
+			_domain.locate(candidate, t.face, cell);
+			auto const cell_x = static_cast<size_t>(std::max(cell.x, 0.0f));
+			auto const cell_y = static_cast<size_t>(std::max(cell.y, 0.0f));
+			if (cell_x < t.x0 || cell_x >= t.x1 || cell_y < t.y0 || cell_y >= t.y1)
+				return false;
+			if (_domain.get_grid(t.face).at(cell_x, cell_y).w > 0.0f)
+				return false;
+
+			auto density = 1.0f;
+			if (!_parameters.density.empty()) {
+				density = _parameters.density.sample(_domain.density_coordinates(candidate));
+				if (!(density >= _min_density))
+					return false;
+			}
+			for (auto const& zone : _parameters.exclusion_zones) {
+				auto const offset = candidate - glm::vec3(zone);
+				if (glm::dot(offset, offset) < zone.w * zone.w)
+					return false;
+			}
+
+			radius = density < 1.0f ? _parameters.min_distance / std::sqrt(density) : _parameters.min_distance;
+			return true;
+		}
+
+		// Add an admitted candidate, unless it is too close to a point.
+		// `blocker` is the last point found too close to one: candidates
+		// around a point are tried next to each other, so it often
+		// rejects the following one too, without looking at the grid.
+		bool insert(tile const& t, glm::vec3 const& candidate, float radius, glm::vec2 const& cell,
+		            std::vector<glm::vec4>& active, glm::vec3& blocker)
+		{
+			auto const to_blocker = blocker - candidate;
+			if (glm::dot(to_blocker, to_blocker) < radius * radius
+			    || has_neighbour(candidate, radius, t.face, cell, blocker))
+				return false;
+
+			auto& slot = _domain.get_grid(t.face).at(static_cast<size_t>(cell.x), static_cast<size_t>(cell.y));
+			slot = glm::vec4(candidate, radius);
+			active.push_back(slot);
+			return true;
+		}
+
+		// Whether a point is closer than `radius` to `candidate`; if so,
+		// `neighbour` is set to it.
+		bool has_neighbour(glm::vec3 const& candidate, float radius, size_t face, glm::vec2 const& cell,
+		                   glm::vec3& neighbour) const
+		{
+			// The cell of the candidate itself was found empty when it was
+			// admitted, and comes first.
+			auto const reach = radius / _domain.cell_side();
+			if (has_neighbour_in(face, candidate, radius, cell, reach, 1u, neighbour))
+				return true;
+
+			// Other faces only matter next to the edges of this one.
+			auto const& face_grid = _domain.get_grid(face);
+			if (cell.x >= reach && cell.y >= reach
+			    && cell.x + reach < static_cast<float>(face_grid.cells_x)
+			    && cell.y + reach < static_cast<float>(face_grid.cells_y))
+				return false;
+			for (size_t other = 0u; other < _domain.faces_nb(); ++other) {
+				glm::vec2 other_cell;
+				if (other != face && _domain.locate(candidate, other, other_cell)
+				    && has_neighbour_in(other, candidate, radius, other_cell, reach, 0u, neighbour))
+					return true;
+			}
+			return false;
+		}
+
+		// Whether a point of `face` closer than `radius` to `candidate`,
+		// at `cell` on its grid, lies in the cells within `reach` of it,
+		// skipping the first `skipped_nb` of `_offsets`.
+		bool has_neighbour_in(size_t face, glm::vec3 const& candidate, float radius,
+		                      glm::vec2 const& cell, float reach, size_t skipped_nb, glm::vec3& neighbour) const
+		{
+			auto const& face_grid = _domain.get_grid(face);
+			auto const cells_x = static_cast<int>(face_grid.cells_x);
+			auto const cells_y = static_cast<int>(face_grid.cells_y);
+			if (cell.x < -reach || cell.y < -reach
+			    || cell.x > static_cast<float>(cells_x) + reach || cell.y > static_cast<float>(cells_y) + reach)
+				return false;
+
+			auto const x = static_cast<int>(std::floor(cell.x));
+			auto const y = static_cast<int>(std::floor(cell.y));
+			auto const fraction = cell - glm::vec2(static_cast<float>(x), static_cast<float>(y));
+			auto const inside = x >= _span && y >= _span && x + _span < cells_x && y + _span < cells_y;
+			auto const reach_squared = reach * reach;
+			auto const radius_squared = radius * radius;
+			for (auto offset_it = _offsets.begin() + skipped_nb; offset_it != _offsets.end(); ++offset_it) {
+				auto const& offset = *offset_it;
+				if (offset.min_gap > reach_squared)
+					break;
+
+				// Only part of the cell is within reach, and maybe not
+				// from where the candidate is.
+				if (offset.max_gap > reach_squared) {
+					auto const offset_x = static_cast<float>(offset.x);
+					auto const offset_y = static_cast<float>(offset.y);
+					auto const gap_x = std::max(std::max(offset_x - fraction.x, fraction.x - offset_x - 1.0f), 0.0f);
+					auto const gap_y = std::max(std::max(offset_y - fraction.y, fraction.y - offset_y - 1.0f), 0.0f);
+					if (gap_x * gap_x + gap_y * gap_y > reach_squared)
+						continue;
+				}
+
+				auto const neighbour_x = x + offset.x;
+				auto const neighbour_y = y + offset.y;
+				if (!inside && (neighbour_x < 0 || neighbour_y < 0 || neighbour_x >= cells_x || neighbour_y >= cells_y))
+					continue;
+				auto const point = glm::vec3(face_grid.at(static_cast<size_t>(neighbour_x), static_cast<size_t>(neighbour_y)));
+				auto const distance = point - candidate;
+				if (glm::dot(distance, distance) < radius_squared) {
+					neighbour = point;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		Domain& _domain;
+		bonobo::poisson_disk_parameters const& _parameters;
+		float _min_density;
+		float _reach_cells;
+		glm::vec2 _step; // rotation between two candidates around a point
+		std::vector<cell_offset> _offsets; // nearest first
+		int _span; // largest offset along either axis
+	};
+
+	template<typename Domain>
+	void
+	fill(Domain& domain, bonobo::poisson_disk_parameters const& parameters)
+	{
+		assert(parameters.min_distance > 0.0f);
+		tile_sampler<Domain> sampler(domain, parameters);
+
+		// Opposite faces of the cube never touch, so they are filled
+		// together.
+		for (size_t face = 0u; face < domain.faces_nb(); face += 2u)
+			sampler.fill(face, std::min(face + 2u, domain.faces_nb()));
+	}
+}
+
+float
+bonobo::density_map::sample(glm::vec2 const& uv) const
+{
+	if (values.empty())
+		return 1.0f;
+
+	auto const position = glm::clamp(uv, glm::vec2(0.0f), glm::vec2(1.0f))
+	                    * glm::vec2(width - 1u, height - 1u);
+	auto const x0 = std::min(static_cast<size_t>(position.x), width - 1u);
+	auto const y0 = std::min(static_cast<size_t>(position.y), height - 1u);
+	auto const x1 = std::min(x0 + 1u, width - 1u);
+	auto const y1 = std::min(y0 + 1u, height - 1u);
+	auto const f = position - glm::vec2(x0, y0);
+	auto const bottom = glm::mix(values[y0 * width + x0], values[y0 * width + x1], f.x);
+	auto const top = glm::mix(values[y1 * width + x0], values[y1 * width + x1], f.x);
+	return glm::mix(bottom, top, f.y);
+}
+
+std::vector<glm::vec2>
+bonobo::poisson_disk_rectangle(glm::vec2 const& lower, glm::vec2 const& upper,
+                               poisson_disk_parameters const& parameters)
+{
+	rectangle_domain domain(lower, upper, parameters.min_distance);
+	fill(domain, parameters);
+
+	std::vector<glm::vec2> points;
+	for (auto const& cell : domain.get_grid(0u).cells)
+		if (cell.w > 0.0f)
+			points.emplace_back(cell.x, cell.y);
+	return points;
+}
+
+std::vector<glm::vec3>
+bonobo::poisson_disk_sphere(float radius, poisson_disk_parameters const& parameters)
+{
+	assert(radius > 0.0f);
+	sphere_domain domain(radius, parameters.min_distance);
+	fill(domain, parameters);
+
+	std::vector<glm::vec3> points;
+	for (size_t face = 0u; face < domain.faces_nb(); ++face)
+		for (auto const& cell : domain.get_grid(face).cells)
+			if (cell.w > 0.0f)
+				points.emplace_back(cell);
+	return points;
+}
+
+void
+bonobo::benchmark_poisson_disk()
+{
+	set_worker_threads_nb(0u);
+	auto const threads_nb = get_worker_threads_nb();
+	std::vector<glm::vec2> plane_points[2];
+	std::vector<glm::vec3> sphere_points[2];
+	double plane_durations[2], sphere_durations[2];
+	for (size_t run = 0u; run < 2u; ++run) {
+		set_worker_threads_nb(run == 0u ? 1u : threads_nb);
+
+		poisson_disk_parameters parameters;
+		parameters.min_distance = 1.0f;
+		auto start = GetTimeMilliseconds();
+		plane_points[run] = poisson_disk_rectangle(glm::vec2(0.0f), glm::vec2(1100.0f), parameters);
+		plane_durations[run] = GetTimeMilliseconds() - start;
+
+		parameters.min_distance = 0.1f;
+		start = GetTimeMilliseconds();
+		sphere_points[run] = poisson_disk_sphere(31.0f, parameters);
+		sphere_durations[run] = GetTimeMilliseconds() - start;
+	}
+	set_worker_threads_nb(0u);
+
+	LogInfo("Poisson disk over a plane: %zu points in %.1f ms on 1 thread, %.1f ms across %zu (%s points)",
+	        plane_points[0].size(), plane_durations[0], plane_durations[1], threads_nb,
+	        plane_points[0] == plane_points[1] ? "same" : "different");
+	LogInfo("Poisson disk over a sphere: %zu points in %.1f ms on 1 thread, %.1f ms across %zu (%s points)",
+	        sphere_points[0].size(), sphere_durations[0], sphere_durations[1], threads_nb,
+	        sphere_points[0] == sphere_points[1] ? "same" : "different");
+}
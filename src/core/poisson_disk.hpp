@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Values over [0, 1]², such as a greyscale image, sampled
+	//!        bilinearly.
+	struct density_map {
+		size_t width = 0u;
+		size_t height = 0u;
+		std::vector<float> values; //!< row after row, from (0, 0) to (1, 1)
+
+		bool empty() const { return values.empty(); }
+
+		//! \brief Bilinear value at `uv`, clamped to the edges.
+		float sample(glm::vec2 const& uv) const;
+	};
+
+	//! \brief How `poisson_disk_rectangle()` and `poisson_disk_sphere()`
+	//!        place their points.
+	struct poisson_disk_parameters {
+		float min_distance = 1.0f;              //!< distance between points where the density is 1
+		unsigned int attempts_nb = 12u;         //!< candidates tried around each point
+		density_map density;                    //!< if not empty, points per area relative to the full density
+		float min_density = 1.0f / 16.0f;       //!< below this density, no point is placed; at least 1/16
+		std::vector<glm::vec4> exclusion_zones; //!< spheres, as centre and radius, left empty
+		uint32_t seed = 1u;
+	};
+
+	//! \brief Blue-noise points over the rectangle [lower, upper], from
+	//!        Bridson's "Fast Poisson Disk Sampling in Arbitrary
+	//!        Dimensions".
+	//!
+	//! No two points are closer than `min_distance / sqrt(density)`, with
+	//! the density of the later one, and new points are tried around
+	//! existing ones until no room is left, so that the points cover the
+	//! domain evenly without clumps nor gaps. As in Martin Roberts'
+	//! variant, the candidates around a point are evenly spaced on the
+	//! circle of its radius, which packs them more tightly than random
+	//! ones for fewer attempts. The density map covers the rectangle, and
+	//! points are (x, y, 0) for the exclusion zones.
+	//!
+	//! A uniform grid, with at most one point per cell, finds the
+	//! neighbours of each candidate, closest cells first, within the disc
+	//! its radius can reach. The grid is split into tiles, and
+	//! tiles far enough apart are filled concurrently by
+	//! `parallel_for()`, in four passes; the points only depend on the
+	//! seed, not on the number of threads.
+	std::vector<glm::vec2> poisson_disk_rectangle(glm::vec2 const& lower, glm::vec2 const& upper,
+	                                              poisson_disk_parameters const& parameters);
+
+	//! \brief Blue-noise points on the sphere of `radius` centred on the
+	//!        origin, like `poisson_disk_rectangle()`.
+	//!
+	//! Distances are measured in straight lines; the density map is
+	//! wrapped around the sphere, u going around from -x through -z and
+	//! v from +y down. Each face of a cube has its own grid, in
+	//! equal angles like `parametric_shapes::createCubeSphere()`;
+	//! opposite faces, which never touch, are filled together, and their
+	//! tiles as in the rectangle.
+	std::vector<glm::vec3> poisson_disk_sphere(float radius, poisson_disk_parameters const& parameters);
+
+	//! \brief Time `poisson_disk_rectangle()` and `poisson_disk_sphere()`
+	//!        for about a million points each, on one thread and across
+	//!        all of them, and log whether both gave the same points.
+	void benchmark_poisson_disk();
+}
@@ -0,0 +1,190 @@
+#include "quantization.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	glm::vec2 sign_not_zero(glm::vec2 const& v)
+	{
+		return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	int16_t to_snorm16(float value)
+	{
+		return static_cast<int16_t>(std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	float from_snorm16(int16_t value)
+	{
+		return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+	}
+}
+
+uint16_t
+bonobo::float_to_half(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	auto const sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+	auto const float_exponent = static_cast<int32_t>((bits >> 23) & 0xffu);
+	auto mantissa = bits & 0x7fffffu;
+
+	// Infinities and NaNs; NaNs keep a non-zero mantissa.
+	if (float_exponent == 0xff)
+		return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0u ? 0x200u : 0u));
+
+	auto const exponent = float_exponent - 127 + 15;
+	if (exponent >= 31)
+		return static_cast<uint16_t>(sign | 0x7c00u);
+
+	// Denormals: shift the mantissa, including its implicit leading one,
+	// so that its value is expressed in units of 2^-24.
+	if (exponent <= 0) {
+		if (exponent < -10)
+			return sign;
+		mantissa |= 0x800000u;
+		auto const shift = static_cast<uint32_t>(14 - exponent);
+		auto half_mantissa = mantissa >> shift;
+		auto const remainder = mantissa & ((1u << shift) - 1u);
+		auto const halfway = 1u << (shift - 1u);
+		if (remainder > halfway || (remainder == halfway && (half_mantissa & 1u) != 0u))
+			++half_mantissa;
+		return static_cast<uint16_t>(sign | half_mantissa);
+	}
+
+	// Round to nearest, ties to even; a carry out of the mantissa
+	// correctly bumps the exponent, up to infinity.
+	auto half = static_cast<uint32_t>(sign) | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	auto const remainder = mantissa & 0x1fffu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0u))
+		++half;
+	return static_cast<uint16_t>(half);
+}
+
+float
+bonobo::half_to_float(uint16_t value)
+{
+	auto const sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+	auto const exponent = static_cast<uint32_t>(value >> 10) & 0x1fu;
+	auto const mantissa = static_cast<uint32_t>(value) & 0x3ffu;
+
+	if (exponent == 0u) {
+		auto const magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+		return sign != 0u ? -magnitude : magnitude;
+	}
+
+	uint32_t bits;
+	if (exponent == 31u)
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	else
+		bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+glm::vec2
+bonobo::octahedral_encode(glm::vec3 const& v)
+{
+	auto const n = v / (std::abs(v.x) + std::abs(v.y) + std::abs(v.z));
+	auto const e = glm::vec2(n.x, n.y);
+	if (n.z >= 0.0f)
+		return e;
+	return (glm::vec2(1.0f) - glm::abs(glm::vec2(e.y, e.x))) * sign_not_zero(e);
+}
+
+glm::vec3
+bonobo::octahedral_decode(glm::vec2 const& e)
+{
+	auto v = glm::vec3(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+	if (v.z < 0.0f) {
+		auto const folded = (glm::vec2(1.0f) - glm::abs(glm::vec2(v.y, v.x))) * sign_not_zero(glm::vec2(v.x, v.y));
+		v.x = folded.x;
+		v.y = folded.y;
+	}
+	return glm::normalize(v);
+}
+
+bonobo::octahedral_snorm16
+bonobo::encode_normal(glm::vec3 const& normal)
+{
+	auto const e = octahedral_encode(normal);
+	return { to_snorm16(e.x), to_snorm16(e.y) };
+}
+
+glm::vec3
+bonobo::decode_normal(octahedral_snorm16 const& normal)
+{
+	return octahedral_decode(glm::vec2(from_snorm16(normal.x), from_snorm16(normal.y)));
+}
+
+bonobo::packed_tangent
+bonobo::encode_tangent(glm::vec3 const& normal, glm::vec3 const& tangent, glm::vec3 const& binormal)
+{
+	auto const e = octahedral_encode(tangent);
+	auto const is_left_handed = glm::dot(glm::cross(normal, tangent), binormal) < 0.0f;
+	auto const y = static_cast<int16_t>((to_snorm16(e.y) & ~1) | (is_left_handed ? 1 : 0));
+	return { to_snorm16(e.x), y };
+}
+
+glm::vec3
+bonobo::decode_tangent(packed_tangent const& tangent, float& handedness)
+{
+	handedness = (tangent.y & 1) != 0 ? -1.0f : 1.0f;
+	return octahedral_decode(glm::vec2(from_snorm16(tangent.x), from_snorm16(tangent.y)));
+}
+
+bonobo::vertex_layout const&
+bonobo::get_compact_vertex_layout()
+{
+	static vertex_layout const layout = compact_vertex_format::get_layout();
+	return layout;
+}
+
+bonobo::vertex_data<bonobo::compact_vertex_format>
+bonobo::compress_vertices(vertex_data<standard_vertex_format> const& vertices)
+{
+	auto compressed = vertex_data<compact_vertex_format>(vertices.get_vertices_nb(), vertices.get_storage());
+	for (size_t i = 0u; i < vertices.get_vertices_nb(); ++i) {
+		auto const normal = vertices.get<shader_bindings::normals>(i);
+		auto const texcoord = vertices.get<shader_bindings::texcoords>(i);
+		auto const tangent = vertices.get<shader_bindings::tangents>(i);
+		auto const binormal = vertices.get<shader_bindings::binormals>(i);
+
+		compressed.set<shader_bindings::vertices>(i, vertices.get<shader_bindings::vertices>(i));
+		// Meshes without normals or tangents have them zeroed, which can
+		// not be normalised: encode them as an arbitrary unit vector.
+		compressed.set<shader_bindings::normals>(i, encode_normal(glm::dot(normal, normal) > 0.0f ? normal : glm::vec3(0.0f, 0.0f, 1.0f)));
+		compressed.set<shader_bindings::texcoords>(i, half2{ float_to_half(texcoord.x), float_to_half(texcoord.y) });
+		compressed.set<shader_bindings::tangents>(i, encode_tangent(normal, glm::dot(tangent, tangent) > 0.0f ? tangent : glm::vec3(1.0f, 0.0f, 0.0f), binormal));
+	}
+	return compressed;
+}
+
+bonobo::mesh_data
+bonobo::create_mesh(vertex_data<standard_vertex_format> const& vertices,
+                    GLuint const* indices, size_t indices_nb,
+                    vertex_precision precision, GLenum drawing_mode)
+{
+	if (precision == vertex_precision::compact)
+		return create_mesh(compress_vertices(vertices), indices, indices_nb, drawing_mode);
+	return create_mesh(vertices, indices, indices_nb, drawing_mode);
+}
+
+std::vector<uint16_t>
+bonobo::narrow_indices(GLuint const* indices, size_t indices_nb)
+{
+	std::vector<uint16_t> narrowed(indices_nb);
+	for (size_t i = 0u; i < indices_nb; ++i) {
+		if (indices[i] > 0xffffu)
+			return std::vector<uint16_t>();
+		narrowed[i] = static_cast<uint16_t>(indices[i]);
+	}
+	return narrowed;
+}
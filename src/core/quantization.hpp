@@ -0,0 +1,126 @@
+#pragma once
+
+#include "vertex_format.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Two half-precision floats, i.e. a 2D texture coordinate.
+	struct half2 {
+		uint16_t x;
+		uint16_t y;
+	};
+
+	//! \brief Unit vector stored with an octahedral mapping, as two
+	//!        normalised 16-bit integers; read as a `vec2` in shaders.
+	struct octahedral_snorm16 {
+		int16_t x;
+		int16_t y;
+	};
+
+	//! \brief Unit tangent stored like `octahedral_snorm16`, except that
+	//!        the lowest bit of `y` holds the handedness of the tangent
+	//!        frame; read as an `ivec2` in shaders.
+	struct packed_tangent {
+		int16_t x;
+		int16_t y;
+	};
+
+	template<>
+	struct attribute_traits<half2> {
+		static constexpr GLint components = 2;
+		static constexpr GLenum type = GL_HALF_FLOAT;
+		static constexpr GLboolean normalized = GL_FALSE;
+		static constexpr bool integer = false;
+	};
+
+	template<>
+	struct attribute_traits<octahedral_snorm16> {
+		static constexpr GLint components = 2;
+		static constexpr GLenum type = GL_SHORT;
+		static constexpr GLboolean normalized = GL_TRUE;
+		static constexpr bool integer = false;
+	};
+
+	template<>
+	struct attribute_traits<packed_tangent> {
+		static constexpr GLint components = 2;
+		static constexpr GLenum type = GL_SHORT;
+		static constexpr GLboolean normalized = GL_FALSE;
+		static constexpr bool integer = true;
+	};
+
+	//! \brief Convert a float to the nearest half-precision float.
+	//!
+	//! Values too large are converted to infinity, and values too small
+	//! to denormals or zero.
+	uint16_t float_to_half(float value);
+
+	//! \brief Convert a half-precision float back to a float.
+	float half_to_float(uint16_t value);
+
+	//! \brief Map a unit vector onto the [-1, 1]² square, by projecting it
+	//!        onto the octahedron |x| + |y| + |z| = 1 and folding the
+	//!        lower half over the upper one.
+	glm::vec2 octahedral_encode(glm::vec3 const& v);
+
+	//! \brief Inverse of `octahedral_encode()`; the result is normalised.
+	glm::vec3 octahedral_decode(glm::vec2 const& e);
+
+	octahedral_snorm16 encode_normal(glm::vec3 const& normal);
+	glm::vec3 decode_normal(octahedral_snorm16 const& normal);
+
+	//! \brief Encode a tangent and the handedness of the tangent frame.
+	//!
+	//! @param [in] normal unit normal of the frame
+	//! @param [in] tangent unit tangent of the frame
+	//! @param [in] binormal binormal of the frame; only its direction
+	//!             relative to `cross(normal, tangent)` is kept
+	packed_tangent encode_tangent(glm::vec3 const& normal, glm::vec3 const& tangent, glm::vec3 const& binormal);
+
+	//! \brief Decode a tangent encoded by `encode_tangent()`.
+	//!
+	//! @param [in] tangent encoded tangent
+	//! @param [out] handedness 1 if the binormal is `cross(normal,
+	//!              tangent)`, -1 if it is its opposite
+	glm::vec3 decode_tangent(packed_tangent const& tangent, float& handedness);
+
+	//! \brief Compact counterpart of `standard_vertex_format`: 24 bytes per
+	//!        vertex instead of 60.
+	//!
+	//! Binormals are rebuilt in the shaders from the normal, the tangent
+	//! and the handedness bit; texture coordinates lose their always-zero
+	//! third component. See `shaders/EDAN35/fill_gbuffer_indirect.vert`
+	//! for the matching decoding functions.
+	using compact_vertex_format = vertex_format<
+		attribute<shader_bindings::vertices,  glm::vec3>,
+		attribute<shader_bindings::normals,   octahedral_snorm16>,
+		attribute<shader_bindings::texcoords, half2>,
+		attribute<shader_bindings::tangents,  packed_tangent>
+	>;
+
+	//! \brief Interleaved layout of `compact_vertex_format`.
+	vertex_layout const& get_compact_vertex_layout();
+
+	//! \brief Quantise vertices in the standard format to the compact one.
+	vertex_data<compact_vertex_format> compress_vertices(vertex_data<standard_vertex_format> const& vertices);
+
+	//! \brief Upload vertices in the standard format, quantising them
+	//!        first if `precision` asks for it; see the `vertex_data`
+	//!        overload of `create_mesh()`.
+	mesh_data create_mesh(vertex_data<standard_vertex_format> const& vertices,
+	                      GLuint const* indices, size_t indices_nb,
+	                      vertex_precision precision,
+	                      GLenum drawing_mode = GL_TRIANGLES);
+
+	//! \brief Narrow indices to 16 bits.
+	//!
+	//! @return the narrowed indices, or an empty vector if some index does
+	//!         not fit in 16 bits
+	std::vector<uint16_t> narrow_indices(GLuint const* indices, size_t indices_nb);
+}
@@ -0,0 +1,230 @@
+#include "random.hpp"
+#include "Log.h"
+#include "Misc.h"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RANDOM_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Seed of the first thread to call `random_generator()`.
+	constexpr uint64_t default_seed = 0xBABEFACEu;
+
+	// Values drawn from each `random_stream()` by `parallel_fill_uniform()`.
+	constexpr size_t block_size = 65536u;
+
+	std::atomic<uint64_t> threads_seeded(0u);
+
+	uint64_t
+	splitmix64(uint64_t& state)
+	{
+		auto z = (state += 0x9E3779B97F4A7C15u);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+		return z ^ (z >> 31);
+	}
+
+	// Four integers of 24 bits from the outputs of both lanes: the top
+	// bits of their low then high halves.
+	void
+	to_integers(uint64_t lane0, uint64_t lane1, float* values)
+	{
+		values[0] = static_cast<float>(static_cast<uint32_t>(lane0) >> 8);
+		values[1] = static_cast<float>(static_cast<uint32_t>(lane0 >> 32) >> 8);
+		values[2] = static_cast<float>(static_cast<uint32_t>(lane1) >> 8);
+		values[3] = static_cast<float>(static_cast<uint32_t>(lane1 >> 32) >> 8);
+	}
+
+#if defined(RANDOM_USE_SSE)
+	__m128i
+	rotl(__m128i x, int k)
+	{
+		return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+	}
+#endif
+}
+
+bonobo::xoshiro256ss::xoshiro256ss(uint64_t seed)
+{
+	for (auto& word : _s)
+		word = splitmix64(seed);
+}
+
+void
+bonobo::xoshiro256ss::jump()
+{
+	static uint64_t const polynomial[] = { 0x180EC6D33CFD0ABAu, 0xD5A61266F0C9392Cu,
+	                                       0xA9582618E03FC9AAu, 0x39ABDC4529B1661Cu };
+	uint64_t s[4] = { 0u, 0u, 0u, 0u };
+	for (auto const word : polynomial)
+		for (int bit = 0; bit < 64; ++bit) {
+			if (word & (uint64_t(1u) << bit))
+				for (int i = 0; i < 4; ++i)
+					s[i] ^= _s[i];
+			(*this)();
+		}
+	std::copy(s, s + 4, _s);
+}
+
+void
+bonobo::xoshiro256ss::long_jump()
+{
+	static uint64_t const polynomial[] = { 0x76E15D3EFEFDCBBFu, 0xC5004E441C522FB3u,
+	                                       0x77710069854EE241u, 0x39109BB02ACBE635u };
+	uint64_t s[4] = { 0u, 0u, 0u, 0u };
+	for (auto const word : polynomial)
+		for (int bit = 0; bit < 64; ++bit) {
+			if (word & (uint64_t(1u) << bit))
+				for (int i = 0; i < 4; ++i)
+					s[i] ^= _s[i];
+			(*this)();
+		}
+	std::copy(s, s + 4, _s);
+}
+
+bonobo::xoshiro256ss&
+bonobo::random_generator()
+{
+	thread_local xoshiro256ss generator(default_seed + threads_seeded.fetch_add(1u, std::memory_order_relaxed));
+	return generator;
+}
+
+bonobo::xoshiro256ss
+bonobo::random_stream(uint64_t seed, size_t index)
+{
+	xoshiro256ss generator(seed);
+	for (size_t i = 0u; i < index; ++i)
+		generator.long_jump();
+	return generator;
+}
+
+void
+bonobo::fill_uniform(xoshiro256ss& generator, float* values, size_t count, float from, float to)
+{
+	if (count == 0u)
+		return;
+
+	auto ahead = generator;
+	ahead.jump();
+	auto const steps_nb = (count + 3u) / 4u;
+	auto const scale = (to - from) / 16777216.0f;
+	size_t step = 0u;
+#if defined(RANDOM_USE_SSE)
+	auto s0 = _mm_set_epi64x(static_cast<long long>(ahead._s[0]), static_cast<long long>(generator._s[0]));
+	auto s1 = _mm_set_epi64x(static_cast<long long>(ahead._s[1]), static_cast<long long>(generator._s[1]));
+	auto s2 = _mm_set_epi64x(static_cast<long long>(ahead._s[2]), static_cast<long long>(generator._s[2]));
+	auto s3 = _mm_set_epi64x(static_cast<long long>(ahead._s[3]), static_cast<long long>(generator._s[3]));
+	auto const scale_v = _mm_set1_ps(scale);
+	auto const from_v = _mm_set1_ps(from);
+	for (; 4u * step + 4u <= count; ++step) {
+		// rotl(s1 * 5, 7) * 9, with shifts as SSE2 has no 64-bit products.
+		auto const times5 = _mm_add_epi64(_mm_slli_epi64(s1, 2), s1);
+		auto const rotated = rotl(times5, 7);
+		auto const result = _mm_add_epi64(_mm_slli_epi64(rotated, 3), rotated);
+
+		auto const t = _mm_slli_epi64(s1, 17);
+		s2 = _mm_xor_si128(s2, s0);
+		s3 = _mm_xor_si128(s3, s1);
+		s1 = _mm_xor_si128(s1, s2);
+		s0 = _mm_xor_si128(s0, s3);
+		s2 = _mm_xor_si128(s2, t);
+		s3 = rotl(s3, 45);
+
+		auto const integers = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+		_mm_storeu_ps(values + 4u * step, _mm_add_ps(from_v, _mm_mul_ps(integers, scale_v)));
+	}
+
+	alignas(16) uint64_t lanes[2];
+	auto const store = [&lanes](__m128i const& word, uint64_t& lane0, uint64_t& lane1) {
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), word);
+		lane0 = lanes[0];
+		lane1 = lanes[1];
+	};
+	store(s0, generator._s[0], ahead._s[0]);
+	store(s1, generator._s[1], ahead._s[1]);
+	store(s2, generator._s[2], ahead._s[2]);
+	store(s3, generator._s[3], ahead._s[3]);
+#endif
+	for (; step < steps_nb; ++step) {
+		float integers[4];
+		to_integers(generator(), ahead(), integers);
+		auto const first = 4u * step;
+		for (size_t i = first; i < std::min(first + 4u, count); ++i)
+			values[i] = from + integers[i - first] * scale;
+	}
+}
+
+void
+bonobo::fill_uniform(xoshiro256ss& generator, glm::vec3* values, size_t count,
+                     glm::vec3 const& lower, glm::vec3 const& upper)
+{
+	static_assert(sizeof(glm::vec3) == 3u * sizeof(float), "vec3 should be three packed floats");
+	auto floats = reinterpret_cast<float*>(values);
+	fill_uniform(generator, floats, 3u * count);
+
+	auto const extent = upper - lower;
+	for (size_t i = 0u; i < count; ++i)
+		values[i] = lower + extent * values[i];
+}
+
+void
+bonobo::parallel_fill_uniform(uint64_t seed, float* values, size_t count, float from, float to)
+{
+	auto const blocks_nb = (count + block_size - 1u) / block_size;
+	parallel_for(blocks_nb, [=](size_t first, size_t last) {
+		auto stream = random_stream(seed, first);
+		for (auto block = first; block < last; ++block) {
+			auto generator = stream;
+			auto const begin = block * block_size;
+			fill_uniform(generator, values + begin, std::min(block_size, count - begin), from, to);
+			stream.long_jump();
+		}
+	});
+}
+
+void
+bonobo::benchmark_random()
+{
+	size_t const count = size_t(1u) << 24;
+	std::vector<float> values(count);
+	auto const rate = [count](double milliseconds) {
+		return 1.0e-3 * static_cast<double>(count) / std::max(milliseconds, 1.0e-3);
+	};
+
+	// What `RandomUniform()` used to draw from.
+	std::mt19937 twister(1u);
+	auto start = GetTimeMilliseconds();
+	for (auto& value : values)
+		value = static_cast<float>(double(twister()) / (double(twister.max()) + 1.0));
+	auto const twister_duration = GetTimeMilliseconds() - start;
+	auto checksum = values[count / 2u];
+
+	xoshiro256ss generator(1u);
+	start = GetTimeMilliseconds();
+	for (auto& value : values)
+		value = generator.next_float();
+	auto const scalar_duration = GetTimeMilliseconds() - start;
+	checksum += values[count / 2u];
+
+	start = GetTimeMilliseconds();
+	fill_uniform(generator, values.data(), count);
+	auto const batch_duration = GetTimeMilliseconds() - start;
+	checksum += values[count / 2u];
+
+	start = GetTimeMilliseconds();
+	parallel_fill_uniform(1u, values.data(), count);
+	auto const parallel_duration = GetTimeMilliseconds() - start;
+	checksum += values[count / 2u];
+
+	LogInfo("Uniform floats, in millions per second: %.0f with std::mt19937, %.0f with xoshiro256**, %.0f in batches, %.0f in batches across %zu threads (checksum %g)",
+	        rate(twister_duration), rate(scalar_duration), rate(batch_duration), rate(parallel_duration),
+	        get_worker_threads_nb(), checksum);
+}
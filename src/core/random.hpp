@@ -0,0 +1,105 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bonobo
+{
+	//! \brief xoshiro256** from Blackman and Vigna's "Scrambled Linear
+	//!        Pseudorandom Number Generators": 32 bytes of state, a period
+	//!        of 2^256 - 1, and a few cycles per 64-bit number.
+	//!
+	//! It meets the requirements of a uniform random bit generator, so it
+	//! can drive the distributions of <random> in place of `std::mt19937`.
+	//! Generators are not shared between threads: each thread uses its
+	//! own, either `random_generator()` or a stream from
+	//! `random_stream()`.
+	class xoshiro256ss {
+	public:
+		using result_type = uint64_t;
+
+		//! \brief Expand `seed` into a full state with SplitMix64, so that
+		//!        close seeds still give unrelated sequences.
+		explicit xoshiro256ss(uint64_t seed = 1u);
+
+		static constexpr result_type min() { return 0u; }
+		static constexpr result_type max() { return ~result_type(0u); }
+
+		result_type operator()()
+		{
+			auto const result = rotl(_s[1] * 5u, 7) * 9u;
+			auto const t = _s[1] << 17;
+			_s[2] ^= _s[0];
+			_s[3] ^= _s[1];
+			_s[1] ^= _s[2];
+			_s[0] ^= _s[3];
+			_s[2] ^= t;
+			_s[3] = rotl(_s[3], 45);
+			return result;
+		}
+
+		//! \brief Uniform float in [0, 1), from the top 24 bits.
+		float next_float() { return static_cast<float>((*this)() >> 40) * (1.0f / 16777216.0f); }
+
+		//! \brief Uniform double in [0, 1), from the top 53 bits.
+		double next_double() { return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+
+		float uniform(float from, float to) { return from + (to - from) * next_float(); }
+
+		//! \brief Advance by 2^128 numbers, as many as 2^128 calls.
+		void jump();
+
+		//! \brief Advance by 2^192 numbers, as many as 2^64 `jump()`.
+		void long_jump();
+
+	private:
+		static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+		uint64_t _s[4];
+
+		friend void fill_uniform(xoshiro256ss& generator, float* values, size_t count, float from, float to);
+	};
+
+	//! \brief Generator of the calling thread, created on first use.
+	//!
+	//! Threads are seeded in the order they first use it, and
+	//! `RandomSeed()` reseeds the calling one; sequences are thus only
+	//! reproducible on threads which do not come and go, such as the main
+	//! one. Parallel loops should use `random_stream()` instead.
+	xoshiro256ss& random_generator();
+
+	//! \brief Generator number `index` derived from `seed`, 2^192 numbers
+	//!        after the previous one.
+	//!
+	//! Give each chunk of a parallel loop its own stream, indexed by the
+	//! chunk rather than by the thread running it, to draw the same
+	//! numbers whatever the number of threads.
+	xoshiro256ss random_stream(uint64_t seed, size_t index);
+
+	//! \brief Fill `values` with uniform floats in [from, to).
+	//!
+	//! With SSE2, two lanes, the generator and a copy `jump()` ahead of
+	//! it, produce four floats per step; without, the same numbers come
+	//! from the scalar code. The generator only advances by a step per
+	//! four values, and the lane ahead of it never meets its numbers, so
+	//! calls can be mixed freely with the scalar functions.
+	void fill_uniform(xoshiro256ss& generator, float* values, size_t count, float from = 0.0f, float to = 1.0f);
+
+	//! \brief Fill `values` with points uniformly distributed in the box
+	//!        [lower, upper), as x, y and z of consecutive floats from
+	//!        `fill_uniform()`.
+	void fill_uniform(xoshiro256ss& generator, glm::vec3* values, size_t count,
+	                  glm::vec3 const& lower, glm::vec3 const& upper);
+
+	//! \brief `fill_uniform()` across `parallel_for()`, with one
+	//!        `random_stream()` per block of values: the result only
+	//!        depends on `seed`, not on the number of threads.
+	void parallel_fill_uniform(uint64_t seed, float* values, size_t count, float from = 0.0f, float to = 1.0f);
+
+	//! \brief Time the global `std::mt19937` behind `RandomUniform()`
+	//!        against `xoshiro256ss`, one number at a time and in batches,
+	//!        and log the numbers per second of each.
+	void benchmark_random();
+}
@@ -0,0 +1,344 @@
+#include "range_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	constexpr uint32_t invalid_index = 0xffffffffu;
+
+	// Bins are indexed by a tiny floating point representation of the
+	// size: 3 mantissa bits, and the rest for the exponent. This gives 8
+	// linearly spaced bins per power of two, i.e. at most 12.5% waste.
+	constexpr uint32_t mantissa_bits = 3u;
+	constexpr uint32_t mantissa_value = 1u << mantissa_bits;
+	constexpr uint32_t mantissa_mask = mantissa_value - 1u;
+
+	uint32_t highest_set_bit(uint32_t v)
+	{
+		assert(v != 0u);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, v);
+		return static_cast<uint32_t>(index);
+#else
+		return 31u - static_cast<uint32_t>(__builtin_clz(v));
+#endif
+	}
+
+	uint32_t lowest_set_bit(uint32_t v)
+	{
+		assert(v != 0u);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, v);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctz(v));
+#endif
+	}
+
+	//! Largest bin whose size is less than or equal to `size`; used when
+	//! filing free ranges so that every range in a bin is at least as large
+	//! as the bin size.
+	uint32_t size_to_bin_round_down(uint32_t size)
+	{
+		if (size < mantissa_value)
+			return size;
+
+		auto const mantissa_start = highest_set_bit(size) - mantissa_bits;
+		auto const exponent = mantissa_start + 1u;
+		auto const mantissa = (size >> mantissa_start) & mantissa_mask;
+		return (exponent << mantissa_bits) | mantissa;
+	}
+
+	//! Smallest bin whose size is greater than or equal to `size`; used
+	//! when searching so that any range found is large enough.
+	uint32_t size_to_bin_round_up(uint32_t size)
+	{
+		if (size < mantissa_value)
+			return size;
+
+		auto const mantissa_start = highest_set_bit(size) - mantissa_bits;
+		auto const low_bits_mask = (1u << mantissa_start) - 1u;
+		auto bin = size_to_bin_round_down(size);
+		// An overflowing mantissa carries into the exponent, which is the
+		// next representable size.
+		if ((size & low_bits_mask) != 0u)
+			++bin;
+		return bin;
+	}
+}
+
+bonobo::range_allocator::range_allocator(uint32_t capacity, uint32_t max_allocations) :
+	_capacity(capacity), _allocations_nb(0u), _head(invalid_index), _tail(invalid_index),
+	_used_top_bins(0u), _used_leaf_bins(), _bin_heads(), _nodes(), _free_nodes()
+{
+	_nodes.reserve(max_allocations);
+	reset();
+}
+
+void
+bonobo::range_allocator::reset()
+{
+	_allocations_nb = 0u;
+	_used_top_bins = 0u;
+	std::fill(std::begin(_used_leaf_bins), std::end(_used_leaf_bins), static_cast<uint8_t>(0u));
+	std::fill(std::begin(_bin_heads), std::end(_bin_heads), invalid_index);
+	_nodes.clear();
+	_free_nodes.clear();
+	_head = invalid_index;
+	_tail = invalid_index;
+
+	if (_capacity == 0u)
+		return;
+
+	auto const index = new_node();
+	_nodes[index].offset = 0u;
+	_nodes[index].size = _capacity;
+	_head = index;
+	_tail = index;
+	insert_into_bin(index);
+}
+
+uint32_t
+bonobo::range_allocator::new_node()
+{
+	uint32_t index;
+	if (!_free_nodes.empty()) {
+		index = _free_nodes.back();
+		_free_nodes.pop_back();
+	} else {
+		index = static_cast<uint32_t>(_nodes.size());
+		_nodes.emplace_back();
+	}
+
+	auto& n = _nodes[index];
+	n.offset = 0u;
+	n.size = 0u;
+	n.bin_prev = invalid_index;
+	n.bin_next = invalid_index;
+	n.neighbour_prev = invalid_index;
+	n.neighbour_next = invalid_index;
+	n.used = false;
+
+	return index;
+}
+
+void
+bonobo::range_allocator::insert_into_bin(uint32_t node_index)
+{
+	auto const bin = size_to_bin_round_down(_nodes[node_index].size);
+	auto const top = bin >> mantissa_bits;
+	auto const leaf = bin & mantissa_mask;
+
+	auto const previous_head = _bin_heads[bin];
+	_nodes[node_index].bin_prev = invalid_index;
+	_nodes[node_index].bin_next = previous_head;
+	if (previous_head != invalid_index)
+		_nodes[previous_head].bin_prev = node_index;
+	_bin_heads[bin] = node_index;
+
+	_used_leaf_bins[top] |= static_cast<uint8_t>(1u << leaf);
+	_used_top_bins |= 1u << top;
+}
+
+void
+bonobo::range_allocator::remove_from_bin(uint32_t node_index)
+{
+	auto const& n = _nodes[node_index];
+	auto const bin = size_to_bin_round_down(n.size);
+
+	if (n.bin_prev != invalid_index)
+		_nodes[n.bin_prev].bin_next = n.bin_next;
+	else
+		_bin_heads[bin] = n.bin_next;
+	if (n.bin_next != invalid_index)
+		_nodes[n.bin_next].bin_prev = n.bin_prev;
+
+	if (_bin_heads[bin] != invalid_index)
+		return;
+
+	auto const top = bin >> mantissa_bits;
+	auto const leaf = bin & mantissa_mask;
+	_used_leaf_bins[top] &= static_cast<uint8_t>(~(1u << leaf));
+	if (_used_leaf_bins[top] == 0u)
+		_used_top_bins &= ~(1u << top);
+}
+
+bonobo::range_allocator::allocation
+bonobo::range_allocator::allocate(uint32_t size)
+{
+	allocation range;
+	if (size == 0u || size > _capacity)
+		return range;
+
+	auto const min_bin = size_to_bin_round_up(size);
+	auto top = min_bin >> mantissa_bits;
+	auto const leaf = min_bin & mantissa_mask;
+
+	// First look for a bin of the same top level, large enough; then for
+	// the first non-empty top level above it.
+	auto bin = invalid_index;
+	if ((_used_top_bins & (1u << top)) != 0u) {
+		auto const leaves = _used_leaf_bins[top] & (0xffu << leaf);
+		if (leaves != 0u)
+			bin = (top << mantissa_bits) | lowest_set_bit(leaves);
+	}
+	if (bin == invalid_index) {
+		auto const tops = (top + 1u < top_bins_nb) ? (_used_top_bins & (~0u << (top + 1u))) : 0u;
+		if (tops != 0u) {
+			top = lowest_set_bit(tops);
+			bin = (top << mantissa_bits) | lowest_set_bit(_used_leaf_bins[top]);
+		}
+	}
+
+	auto index = bin != invalid_index ? _bin_heads[bin] : invalid_index;
+
+	// Sizes which are not a bin size are filed one bin below the one the
+	// search starts from, so that bin can still hold large enough ranges,
+	// e.g. one of exactly `size` units: look through it as a last resort.
+	if (index == invalid_index) {
+		auto const lower_bin = size_to_bin_round_down(size);
+		if (lower_bin == min_bin)
+			return range;
+		for (index = _bin_heads[lower_bin]; index != invalid_index; index = _nodes[index].bin_next)
+			if (_nodes[index].size >= size)
+				break;
+		if (index == invalid_index)
+			return range;
+	}
+
+	assert(_nodes[index].size >= size);
+	remove_from_bin(index);
+
+	auto const remainder = _nodes[index].size - size;
+	_nodes[index].size = size;
+	_nodes[index].used = true;
+
+	if (remainder > 0u) {
+		auto const split = new_node();
+		auto& free_part = _nodes[split];
+		auto& used_part = _nodes[index];
+		free_part.offset = used_part.offset + size;
+		free_part.size = remainder;
+		free_part.neighbour_prev = index;
+		free_part.neighbour_next = used_part.neighbour_next;
+		if (used_part.neighbour_next != invalid_index)
+			_nodes[used_part.neighbour_next].neighbour_prev = split;
+		used_part.neighbour_next = split;
+		if (_tail == index)
+			_tail = split;
+		insert_into_bin(split);
+	}
+
+	++_allocations_nb;
+	range.offset = _nodes[index].offset;
+	range.size = size;
+	range.node = index;
+	return range;
+}
+
+void
+bonobo::range_allocator::free(allocation const& range)
+{
+	if (!range.is_valid())
+		return;
+
+	auto index = range.node;
+	assert(index < _nodes.size() && _nodes[index].used);
+	assert(_nodes[index].offset == range.offset);
+	_nodes[index].used = false;
+	--_allocations_nb;
+
+	// The lower-addressed node always survives a merge, so `_head` is
+	// never released.
+	auto const prev = _nodes[index].neighbour_prev;
+	if (prev != invalid_index && !_nodes[prev].used) {
+		remove_from_bin(prev);
+		auto const next = _nodes[index].neighbour_next;
+		_nodes[prev].size += _nodes[index].size;
+		_nodes[prev].neighbour_next = next;
+		if (next != invalid_index)
+			_nodes[next].neighbour_prev = prev;
+		if (_tail == index)
+			_tail = prev;
+		_free_nodes.push_back(index);
+		index = prev;
+	}
+
+	auto const next = _nodes[index].neighbour_next;
+	if (next != invalid_index && !_nodes[next].used) {
+		remove_from_bin(next);
+		auto const next_next = _nodes[next].neighbour_next;
+		_nodes[index].size += _nodes[next].size;
+		_nodes[index].neighbour_next = next_next;
+		if (next_next != invalid_index)
+			_nodes[next_next].neighbour_prev = index;
+		if (_tail == next)
+			_tail = index;
+		_free_nodes.push_back(next);
+	}
+
+	insert_into_bin(index);
+}
+
+void
+bonobo::range_allocator::grow(uint32_t new_capacity)
+{
+	if (new_capacity <= _capacity)
+		return;
+
+	auto const extra = new_capacity - _capacity;
+	if (_tail != invalid_index && !_nodes[_tail].used) {
+		remove_from_bin(_tail);
+		_nodes[_tail].size += extra;
+		insert_into_bin(_tail);
+	} else {
+		auto const index = new_node();
+		_nodes[index].offset = _capacity;
+		_nodes[index].size = extra;
+		_nodes[index].neighbour_prev = _tail;
+		if (_tail != invalid_index)
+			_nodes[_tail].neighbour_next = index;
+		else
+			_head = index;
+		_tail = index;
+		insert_into_bin(index);
+	}
+
+	_capacity = new_capacity;
+}
+
+bonobo::range_allocator::statistics
+bonobo::range_allocator::get_statistics() const
+{
+	statistics stats;
+	stats.capacity = _capacity;
+	stats.used = 0u;
+	stats.free = 0u;
+	stats.largest_free_block = 0u;
+	stats.free_blocks_nb = 0u;
+	stats.allocations_nb = _allocations_nb;
+
+	for (auto index = _head; index != invalid_index; index = _nodes[index].neighbour_next) {
+		auto const& n = _nodes[index];
+		if (n.used) {
+			stats.used += n.size;
+		} else {
+			stats.free += n.size;
+			stats.largest_free_block = std::max(stats.largest_free_block, n.size);
+			++stats.free_blocks_nb;
+		}
+	}
+
+	stats.fragmentation = stats.free > 0u
+	                    ? 1.0f - static_cast<float>(stats.largest_free_block) / static_cast<float>(stats.free)
+	                    : 0.0f;
+
+	return stats;
+}
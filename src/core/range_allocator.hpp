@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Sub-allocates ranges out of a linear address space of a
+	//!        given capacity, using a two-level segregated fit (TLSF)
+	//!        scheme: freeing is O(1), and so is allocating, bar a walk
+	//!        through a single bin for sizes which are not a bin size.
+	//!
+	//! The allocator never touches the memory it manages; offsets and sizes
+	//! are expressed in abstract units (vertices, indices, bytes, …), which
+	//! makes it usable for GPU buffers and testable without any OpenGL
+	//! context.
+	class range_allocator
+	{
+	public:
+		//! \brief Offset returned when an allocation could not be
+		//!        satisfied.
+		static constexpr uint32_t invalid_offset = 0xffffffffu;
+
+		//! \brief Handle to an allocated range.
+		struct allocation {
+			uint32_t offset; //!< first unit of the range
+			uint32_t size;   //!< number of units in the range
+			uint32_t node;   //!< internal handle, used when freeing
+
+			allocation() : offset(invalid_offset), size(0u), node(invalid_offset)
+			{
+			}
+
+			bool is_valid() const { return offset != invalid_offset; }
+		};
+
+		//! \brief Snapshot of the allocator occupancy.
+		struct statistics {
+			uint32_t capacity;           //!< total number of units managed
+			uint32_t used;               //!< number of units currently allocated
+			uint32_t free;               //!< number of units currently free
+			uint32_t largest_free_block; //!< size of the largest free range
+			uint32_t free_blocks_nb;     //!< number of disjoint free ranges
+			uint32_t allocations_nb;     //!< number of live allocations
+			float fragmentation;         //!< 1 - largest_free_block / free; 0 when
+			                             //!< all free space is contiguous
+		};
+
+		//! \brief Create an allocator managing `[0, capacity)`.
+		//!
+		//! @param [in] capacity number of units to manage
+		//! @param [in] max_allocations upper bound on the number of live
+		//!             allocations; the bookkeeping storage grows past
+		//!             it if needed, this is only a reservation hint
+		explicit range_allocator(uint32_t capacity, uint32_t max_allocations = 1024u);
+
+		//! \brief Allocate a contiguous range of `size` units.
+		//!
+		//! @return a handle whose `is_valid()` is false if no free range
+		//!         was large enough
+		allocation allocate(uint32_t size);
+
+		//! \brief Release a range previously returned by `allocate()`,
+		//!        merging it with its free neighbours.
+		void free(allocation const& range);
+
+		//! \brief Extend the managed space to `[0, new_capacity)`; existing
+		//!        allocations keep their offsets.
+		void grow(uint32_t new_capacity);
+
+		//! \brief Release every allocation at once.
+		void reset();
+
+		uint32_t get_capacity() const { return _capacity; }
+
+		//! \brief Walk all ranges to compute occupancy and fragmentation.
+		statistics get_statistics() const;
+
+	private:
+		struct node {
+			uint32_t offset;
+			uint32_t size;
+			uint32_t bin_prev;
+			uint32_t bin_next;
+			uint32_t neighbour_prev;
+			uint32_t neighbour_next;
+			bool used;
+		};
+
+		static constexpr uint32_t top_bins_nb = 32u;
+		static constexpr uint32_t leaf_bins_nb = 8u;
+		static constexpr uint32_t bins_nb = top_bins_nb * leaf_bins_nb;
+
+		uint32_t new_node();
+		void insert_into_bin(uint32_t node_index);
+		void remove_from_bin(uint32_t node_index);
+
+		uint32_t _capacity;
+		uint32_t _allocations_nb;
+		uint32_t _head;
+		uint32_t _tail;
+
+		uint32_t _used_top_bins;
+		uint8_t _used_leaf_bins[top_bins_nb];
+		uint32_t _bin_heads[bins_nb];
+
+		std::vector<node> _nodes;
+		std::vector<uint32_t> _free_nodes;
+	};
+}
@@ -0,0 +1,274 @@
+#include "simd.hpp"
+#include "Log.h"
+#include "Misc.h"
+#include "random.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+char const*
+bonobo::simd::get_instruction_sets()
+{
+#if defined(BONOBO_SIMD_USE_AVX512)
+	return "SSE2, AVX2, AVX-512";
+#elif defined(BONOBO_SIMD_USE_AVX2)
+	return "SSE2, AVX2";
+#elif defined(BONOBO_SIMD_USE_SSE2)
+	return "SSE2";
+#else
+	return "none";
+#endif
+}
+
+namespace
+{
+	size_t const elements_nb = 65536u;
+	size_t const waves_nb = 8u;
+
+	struct kernel_inputs {
+		glm::vec4 planes[6];
+		std::vector<glm::vec3> centres;
+		std::vector<float> radii;
+
+		std::vector<glm::mat4> parents;
+		std::vector<glm::mat4> locals;
+
+		glm::vec2 wave_directions[waves_nb];
+		float wave_amplitudes[waves_nb];
+		float wave_frequencies[waves_nb];
+		float wave_phases[waves_nb];
+		float time;
+		std::vector<glm::vec2> wave_positions;
+
+		// Cubic coefficients of spline segments, as a x^3 + b x^2 + c x + d.
+		std::vector<glm::vec3> spline_a, spline_b, spline_c, spline_d;
+		std::vector<float> spline_parameters;
+	};
+
+	struct kernel_outputs {
+		std::vector<uint8_t> visible;
+		std::vector<glm::mat4> worlds;
+		std::vector<float> heights;
+		std::vector<float> slopes;
+		std::vector<glm::vec3> spline_positions;
+
+		kernel_outputs() :
+			visible(elements_nb), worlds(elements_nb), heights(elements_nb), slopes(elements_nb), spline_positions(elements_nb)
+		{
+		}
+
+		bool operator==(kernel_outputs const& other) const
+		{
+			return visible == other.visible
+			    && std::memcmp(worlds.data(), other.worlds.data(), worlds.size() * sizeof(glm::mat4)) == 0
+			    && std::memcmp(heights.data(), other.heights.data(), heights.size() * sizeof(float)) == 0
+			    && std::memcmp(slopes.data(), other.slopes.data(), slopes.size() * sizeof(float)) == 0
+			    && std::memcmp(spline_positions.data(), other.spline_positions.data(), spline_positions.size() * sizeof(glm::vec3)) == 0;
+		}
+	};
+
+	//! Durations of the kernels, in milliseconds.
+	struct kernel_durations {
+		double culling, transforms, waves, splines;
+	};
+
+	void
+	run_glm(kernel_inputs const& in, kernel_outputs& out, kernel_durations& durations)
+	{
+		auto start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; ++i) {
+			bool visible = true;
+			for (auto const& plane : in.planes)
+				visible = visible && !(glm::dot(glm::vec3(plane), in.centres[i]) + plane.w < -in.radii[i]);
+			out.visible[i] = visible ? 1u : 0u;
+		}
+		durations.culling = GetTimeMilliseconds() - start;
+
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; ++i)
+			out.worlds[i] = in.parents[i] * in.locals[i];
+		durations.transforms = GetTimeMilliseconds() - start;
+
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; ++i) {
+			float height = 0.0f, slope = 0.0f;
+			for (size_t k = 0u; k < waves_nb; ++k) {
+				auto const angle = glm::dot(in.wave_directions[k], in.wave_positions[i]) * in.wave_frequencies[k] + in.wave_phases[k] * in.time;
+				height += in.wave_amplitudes[k] * std::sin(angle);
+				slope += in.wave_amplitudes[k] * in.wave_frequencies[k] * in.wave_directions[k].x * std::cos(angle);
+			}
+			out.heights[i] = height;
+			out.slopes[i] = slope;
+		}
+		durations.waves = GetTimeMilliseconds() - start;
+
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; ++i) {
+			auto const x = in.spline_parameters[i];
+			out.spline_positions[i] = ((in.spline_a[i] * x + in.spline_b[i]) * x + in.spline_c[i]) * x + in.spline_d[i];
+		}
+		durations.splines = GetTimeMilliseconds() - start;
+	}
+
+	template<size_t W>
+	void
+	run_simd(kernel_inputs const& in, kernel_outputs& out, kernel_durations& durations)
+	{
+		using namespace bonobo::simd;
+		static_assert(elements_nb % W == 0u, "The kernels do not handle partial batches.");
+
+		// Frustum culling of bounding spheres, one bit per sphere.
+		auto start = GetTimeMilliseconds();
+		vec3xn<W> plane_normals[6];
+		floatx<W> plane_distances[6];
+		for (int p = 0; p < 6; ++p) {
+			plane_normals[p] = { in.planes[p].x, in.planes[p].y, in.planes[p].z };
+			plane_distances[p] = in.planes[p].w;
+		}
+		for (size_t i = 0u; i < elements_nb; i += W) {
+			auto const centre = load_vec3<W>(in.centres.data() + i);
+			auto const radius = load_float<W>(in.radii.data() + i);
+			auto outside = dot(plane_normals[0], centre) + plane_distances[0] < -radius;
+			for (int p = 1; p < 6; ++p)
+				outside = outside | (dot(plane_normals[p], centre) + plane_distances[p] < -radius);
+			auto const visible = bits(~outside);
+			for (size_t k = 0u; k < W; ++k)
+				out.visible[i + k] = static_cast<uint8_t>((visible >> k) & 1u);
+		}
+		durations.culling = GetTimeMilliseconds() - start;
+
+		// Transform updates, world = parent * local.
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; i += W)
+			store(load_mat4<W>(in.parents.data() + i) * load_mat4<W>(in.locals.data() + i), out.worlds.data() + i);
+		durations.transforms = GetTimeMilliseconds() - start;
+
+		// Sum of sine waves, and of their derivatives along x.
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; i += W) {
+			auto const position = load_vec2<W>(in.wave_positions.data() + i);
+			floatx<W> height = 0.0f, slope = 0.0f;
+			for (size_t k = 0u; k < waves_nb; ++k) {
+				auto const angle = (in.wave_directions[k].x * position.x + in.wave_directions[k].y * position.y) * in.wave_frequencies[k]
+				                 + in.wave_phases[k] * in.time;
+				floatx<W> sine, cosine;
+				sincos(angle, sine, cosine);
+				height += in.wave_amplitudes[k] * sine;
+				slope += in.wave_amplitudes[k] * in.wave_frequencies[k] * in.wave_directions[k].x * cosine;
+			}
+			store(height, out.heights.data() + i);
+			store(slope, out.slopes.data() + i);
+		}
+		durations.waves = GetTimeMilliseconds() - start;
+
+		// Spline segments, evaluated with Horner's scheme.
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < elements_nb; i += W) {
+			auto const x = load_float<W>(in.spline_parameters.data() + i);
+			auto const a = load_vec3<W>(in.spline_a.data() + i);
+			auto const b = load_vec3<W>(in.spline_b.data() + i);
+			auto const c = load_vec3<W>(in.spline_c.data() + i);
+			auto const d = load_vec3<W>(in.spline_d.data() + i);
+			store(((a * x + b) * x + c) * x + d, out.spline_positions.data() + i);
+		}
+		durations.splines = GetTimeMilliseconds() - start;
+	}
+
+	float
+	largest_difference(float const* a, float const* b, size_t count)
+	{
+		float difference = 0.0f;
+		for (size_t i = 0u; i < count; ++i)
+			difference = std::max(difference, std::abs(a[i] - b[i]) / std::max(std::abs(b[i]), 1.0f));
+		return difference;
+	}
+}
+
+void
+bonobo::benchmark_simd()
+{
+	xoshiro256ss generator(7u);
+	auto const random_vec3 = [&generator](float from, float to) {
+		return glm::vec3(generator.uniform(from, to), generator.uniform(from, to), generator.uniform(from, to));
+	};
+
+	kernel_inputs in;
+	for (auto& plane : in.planes) {
+		auto const normal = glm::normalize(random_vec3(-1.0f, 1.0f));
+		plane = glm::vec4(normal, generator.uniform(0.0f, 50.0f));
+	}
+	in.centres.resize(elements_nb);
+	in.radii.resize(elements_nb);
+	in.parents.resize(elements_nb);
+	in.locals.resize(elements_nb);
+	in.wave_positions.resize(elements_nb);
+	in.spline_a.resize(elements_nb);
+	in.spline_b.resize(elements_nb);
+	in.spline_c.resize(elements_nb);
+	in.spline_d.resize(elements_nb);
+	in.spline_parameters.resize(elements_nb);
+	for (size_t i = 0u; i < elements_nb; ++i) {
+		in.centres[i] = random_vec3(-100.0f, 100.0f);
+		in.radii[i] = generator.uniform(0.1f, 10.0f);
+		for (int c = 0; c < 3; ++c) {
+			in.parents[i][c] = glm::vec4(random_vec3(-2.0f, 2.0f), 0.0f);
+			in.locals[i][c] = glm::vec4(random_vec3(-2.0f, 2.0f), 0.0f);
+		}
+		in.parents[i][3] = glm::vec4(random_vec3(-100.0f, 100.0f), 1.0f);
+		in.locals[i][3] = glm::vec4(random_vec3(-10.0f, 10.0f), 1.0f);
+		in.wave_positions[i] = glm::vec2(generator.uniform(-50.0f, 50.0f), generator.uniform(-50.0f, 50.0f));
+		in.spline_a[i] = random_vec3(-10.0f, 10.0f);
+		in.spline_b[i] = random_vec3(-10.0f, 10.0f);
+		in.spline_c[i] = random_vec3(-10.0f, 10.0f);
+		in.spline_d[i] = random_vec3(-10.0f, 10.0f);
+		in.spline_parameters[i] = generator.next_float();
+	}
+	for (size_t k = 0u; k < waves_nb; ++k) {
+		auto const angle = generator.uniform(0.0f, glm::two_pi<float>());
+		in.wave_directions[k] = glm::vec2(std::cos(angle), std::sin(angle));
+		in.wave_amplitudes[k] = generator.uniform(0.1f, 1.0f);
+		in.wave_frequencies[k] = generator.uniform(0.1f, 2.0f);
+		in.wave_phases[k] = generator.uniform(0.5f, 2.0f);
+	}
+	in.time = 12.5f;
+
+	kernel_outputs reference, scalar, x4, x8, x16;
+	kernel_durations glm_durations, scalar_durations, x4_durations, x8_durations, x16_durations;
+	run_glm(in, reference, glm_durations);
+	run_simd<1u>(in, scalar, scalar_durations);
+	run_simd<4u>(in, x4, x4_durations);
+	run_simd<8u>(in, x8, x8_durations);
+	run_simd<16u>(in, x16, x16_durations);
+
+	auto const per_element = 1.0e6 / static_cast<double>(elements_nb);
+	auto const log_kernel = [&](char const* name, double kernel_durations::*duration, float difference) {
+		LogInfo("%s, in ns per element: %.1f with glm, %.1f with floatx<1>, %.1f with 4 lanes, %.1f with 8, %.1f with 16; largest relative difference to glm of %g",
+		        name, glm_durations.*duration * per_element, scalar_durations.*duration * per_element, x4_durations.*duration * per_element,
+		        x8_durations.*duration * per_element, x16_durations.*duration * per_element, difference);
+	};
+
+	LogInfo("SoA kernels on %zu elements, using %s; native width of %zu lanes",
+	        elements_nb, simd::get_instruction_sets(), simd::native_width);
+	LogInfo("Sphere culling, in ns per sphere: %.1f with glm, %.1f with floatx<1>, %.1f with 4 lanes, %.1f with 8, %.1f with 16; %zu of %zu spheres visible, %s glm",
+	        glm_durations.culling * per_element, scalar_durations.culling * per_element, x4_durations.culling * per_element,
+	        x8_durations.culling * per_element, x16_durations.culling * per_element,
+	        static_cast<size_t>(std::count(x4.visible.begin(), x4.visible.end(), uint8_t(1u))), elements_nb,
+	        x4.visible == reference.visible ? "as with" : "unlike with");
+	log_kernel("Transform updates", &kernel_durations::transforms,
+	           largest_difference(&x4.worlds[0][0][0], &reference.worlds[0][0][0], 16u * elements_nb));
+	log_kernel("Wave evaluation", &kernel_durations::waves,
+	           std::max(largest_difference(x4.heights.data(), reference.heights.data(), elements_nb),
+	                    largest_difference(x4.slopes.data(), reference.slopes.data(), elements_nb)));
+	log_kernel("Spline sampling", &kernel_durations::splines,
+	           largest_difference(&x4.spline_positions[0].x, &reference.spline_positions[0].x, 3u * elements_nb));
+
+	if (x4 == scalar && x8 == scalar && x16 == scalar)
+		LogInfo("All widths gave the same results, bit for bit.");
+	else
+		LogError("Widths gave different results: 4 lanes %s, 8 lanes %s, 16 lanes %s floatx<1>.",
+		         x4 == scalar ? "match" : "differ from", x8 == scalar ? "match" : "differ from", x16 == scalar ? "match" : "differ from");
+}
@@ -0,0 +1,766 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BONOBO_SIMD_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define BONOBO_SIMD_USE_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__AVX512F__)
+#define BONOBO_SIMD_USE_AVX512 1
+#include <immintrin.h>
+#endif
+
+namespace bonobo
+{
+	//! \brief Structure-of-arrays maths on W lanes at once, W being 4, 8
+	//!        or 16, for kernels running over arrays of `glm` vectors and
+	//!        matrices.
+	//!
+	//! `floatx<W>` holds W floats, and `maskx<W>` the W results of a
+	//! comparison; `vec2xn`, `vec3xn`, `vec4xn` and `mat4xn` hold W
+	//! vectors or matrices, one component per `floatx`, and are loaded
+	//! from and stored to arrays of `glm` types with `load_vec3<W>()`,
+	//! `store()`, etc.
+	//!
+	//! Each width maps to the widest registers the compiler targets: SSE2
+	//! for 4 lanes, AVX2 for 8 and AVX-512 for 16; a width without them
+	//! is made of two halves, down to plain floats. Every operation is the
+	//! same IEEE one on each lane, without fused multiply-adds, so that all
+	//! widths, and `floatx<1>`, give bit for bit the same results; the
+	//! remainder of an array that does not fill a whole `floatx<W>` can
+	//! thus be done with `floatx<1>`. This needs the compiler not to fuse
+	//! them either, hence the -ffp-contract=off of the bonobo target.
+	namespace simd
+	{
+		template<size_t W> struct floatx;
+		template<size_t W> struct maskx;
+
+		//! \brief Width of the widest registers the compiler targets.
+#if defined(BONOBO_SIMD_USE_AVX512)
+		constexpr size_t native_width = 16u;
+#elif defined(BONOBO_SIMD_USE_AVX2)
+		constexpr size_t native_width = 8u;
+#else
+		constexpr size_t native_width = 4u;
+#endif
+
+		//! \brief Instruction sets used by the widths, e.g. "SSE2, AVX2".
+		char const* get_instruction_sets();
+
+		//
+		// Generic widths, made of two halves.
+		//
+
+		template<size_t W>
+		struct maskx {
+			maskx<W / 2u> lo, hi;
+
+			maskx() = default;
+			maskx(maskx<W / 2u> const& l, maskx<W / 2u> const& h) : lo(l), hi(h) {}
+		};
+
+		template<size_t W>
+		struct floatx {
+			static constexpr size_t width = W;
+			floatx<W / 2u> lo, hi;
+
+			floatx() = default;
+			floatx(float s) : lo(s), hi(s) {}
+			floatx(floatx<W / 2u> const& l, floatx<W / 2u> const& h) : lo(l), hi(h) {}
+
+			static floatx load(float const* p) { return floatx(floatx<W / 2u>::load(p), floatx<W / 2u>::load(p + W / 2u)); }
+			void store(float* p) const { lo.store(p); hi.store(p + W / 2u); }
+		};
+
+		template<size_t W> inline floatx<W> operator+(floatx<W> const& a, floatx<W> const& b) { return floatx<W>(a.lo + b.lo, a.hi + b.hi); }
+		template<size_t W> inline floatx<W> operator-(floatx<W> const& a, floatx<W> const& b) { return floatx<W>(a.lo - b.lo, a.hi - b.hi); }
+		template<size_t W> inline floatx<W> operator*(floatx<W> const& a, floatx<W> const& b) { return floatx<W>(a.lo * b.lo, a.hi * b.hi); }
+		template<size_t W> inline floatx<W> operator/(floatx<W> const& a, floatx<W> const& b) { return floatx<W>(a.lo / b.lo, a.hi / b.hi); }
+		template<size_t W> inline floatx<W> operator-(floatx<W> const& a) { return floatx<W>(-a.lo, -a.hi); }
+		template<size_t W> inline maskx<W> operator<(floatx<W> const& a, floatx<W> const& b) { return maskx<W>(a.lo < b.lo, a.hi < b.hi); }
+		template<size_t W> inline maskx<W> operator<=(floatx<W> const& a, floatx<W> const& b) { return maskx<W>(a.lo <= b.lo, a.hi <= b.hi); }
+		template<size_t W> inline maskx<W> operator>(floatx<W> const& a, floatx<W> const& b) { return maskx<W>(a.lo > b.lo, a.hi > b.hi); }
+		template<size_t W> inline maskx<W> operator>=(floatx<W> const& a, floatx<W> const& b) { return maskx<W>(a.lo >= b.lo, a.hi >= b.hi); }
+		template<size_t W> inline maskx<W> operator==(floatx<W> const& a, floatx<W> const& b) { return maskx<W>(a.lo == b.lo, a.hi == b.hi); }
+		template<size_t W> inline maskx<W> operator!=(floatx<W> const& a, floatx<W> const& b) { return maskx<W>(a.lo != b.lo, a.hi != b.hi); }
+		template<size_t W> inline floatx<W> min(floatx<W> const& a, floatx<W> const& b) { return floatx<W>(min(a.lo, b.lo), min(a.hi, b.hi)); }
+		template<size_t W> inline floatx<W> max(floatx<W> const& a, floatx<W> const& b) { return floatx<W>(max(a.lo, b.lo), max(a.hi, b.hi)); }
+		template<size_t W> inline floatx<W> sqrt(floatx<W> const& a) { return floatx<W>(sqrt(a.lo), sqrt(a.hi)); }
+		template<size_t W> inline floatx<W> abs(floatx<W> const& a) { return floatx<W>(abs(a.lo), abs(a.hi)); }
+		template<size_t W> inline floatx<W> trunc(floatx<W> const& a) { return floatx<W>(trunc(a.lo), trunc(a.hi)); }
+		template<size_t W> inline floatx<W> select(maskx<W> const& m, floatx<W> const& a, floatx<W> const& b) { return floatx<W>(select(m.lo, a.lo, b.lo), select(m.hi, a.hi, b.hi)); }
+
+		template<size_t W> inline maskx<W> operator&(maskx<W> const& a, maskx<W> const& b) { return maskx<W>(a.lo & b.lo, a.hi & b.hi); }
+		template<size_t W> inline maskx<W> operator|(maskx<W> const& a, maskx<W> const& b) { return maskx<W>(a.lo | b.lo, a.hi | b.hi); }
+		template<size_t W> inline maskx<W> operator^(maskx<W> const& a, maskx<W> const& b) { return maskx<W>(a.lo ^ b.lo, a.hi ^ b.hi); }
+		template<size_t W> inline maskx<W> operator~(maskx<W> const& a) { return maskx<W>(~a.lo, ~a.hi); }
+		template<size_t W> inline bool any(maskx<W> const& m) { return any(m.lo) || any(m.hi); }
+		template<size_t W> inline bool all(maskx<W> const& m) { return all(m.lo) && all(m.hi); }
+		//! \brief One bit per lane, lane i in bit i.
+		template<size_t W> inline uint32_t bits(maskx<W> const& m) { return bits(m.lo) | (bits(m.hi) << (W / 2u)); }
+
+		//
+		// Single lane, the end of the recursion.
+		//
+
+		template<>
+		struct maskx<1u> {
+			bool v;
+
+			maskx() = default;
+			maskx(bool b) : v(b) {}
+		};
+
+		template<>
+		struct floatx<1u> {
+			static constexpr size_t width = 1u;
+			float v;
+
+			floatx() = default;
+			floatx(float s) : v(s) {}
+
+			static floatx load(float const* p) { return floatx(*p); }
+			void store(float* p) const { *p = v; }
+		};
+
+		inline floatx<1u> operator+(floatx<1u> const& a, floatx<1u> const& b) { return a.v + b.v; }
+		inline floatx<1u> operator-(floatx<1u> const& a, floatx<1u> const& b) { return a.v - b.v; }
+		inline floatx<1u> operator*(floatx<1u> const& a, floatx<1u> const& b) { return a.v * b.v; }
+		inline floatx<1u> operator/(floatx<1u> const& a, floatx<1u> const& b) { return a.v / b.v; }
+		inline floatx<1u> operator-(floatx<1u> const& a) { return -a.v; }
+		inline maskx<1u> operator<(floatx<1u> const& a, floatx<1u> const& b) { return a.v < b.v; }
+		inline maskx<1u> operator<=(floatx<1u> const& a, floatx<1u> const& b) { return a.v <= b.v; }
+		inline maskx<1u> operator>(floatx<1u> const& a, floatx<1u> const& b) { return a.v > b.v; }
+		inline maskx<1u> operator>=(floatx<1u> const& a, floatx<1u> const& b) { return a.v >= b.v; }
+		inline maskx<1u> operator==(floatx<1u> const& a, floatx<1u> const& b) { return a.v == b.v; }
+		inline maskx<1u> operator!=(floatx<1u> const& a, floatx<1u> const& b) { return a.v != b.v; }
+		// As minps and maxps: the second operand when either is a NaN.
+		inline floatx<1u> min(floatx<1u> const& a, floatx<1u> const& b) { return a.v < b.v ? a.v : b.v; }
+		inline floatx<1u> max(floatx<1u> const& a, floatx<1u> const& b) { return a.v > b.v ? a.v : b.v; }
+		inline floatx<1u> sqrt(floatx<1u> const& a) { return std::sqrt(a.v); }
+		inline floatx<1u> abs(floatx<1u> const& a) { return std::abs(a.v); }
+		inline floatx<1u> trunc(floatx<1u> const& a) { return std::trunc(a.v); }
+		inline floatx<1u> select(maskx<1u> const& m, floatx<1u> const& a, floatx<1u> const& b) { return m.v ? a : b; }
+
+		inline maskx<1u> operator&(maskx<1u> const& a, maskx<1u> const& b) { return a.v && b.v; }
+		inline maskx<1u> operator|(maskx<1u> const& a, maskx<1u> const& b) { return a.v || b.v; }
+		inline maskx<1u> operator^(maskx<1u> const& a, maskx<1u> const& b) { return a.v != b.v; }
+		inline maskx<1u> operator~(maskx<1u> const& a) { return !a.v; }
+		inline bool any(maskx<1u> const& m) { return m.v; }
+		inline bool all(maskx<1u> const& m) { return m.v; }
+		inline uint32_t bits(maskx<1u> const& m) { return m.v ? 1u : 0u; }
+
+#if defined(BONOBO_SIMD_USE_SSE2)
+		//
+		// 4 lanes with SSE2.
+		//
+
+		template<>
+		struct maskx<4u> {
+			__m128 v;
+
+			maskx() = default;
+			maskx(__m128 m) : v(m) {}
+		};
+
+		template<>
+		struct floatx<4u> {
+			static constexpr size_t width = 4u;
+			__m128 v;
+
+			floatx() = default;
+			floatx(float s) : v(_mm_set1_ps(s)) {}
+			floatx(__m128 x) : v(x) {}
+
+			static floatx load(float const* p) { return _mm_loadu_ps(p); }
+			void store(float* p) const { _mm_storeu_ps(p, v); }
+		};
+
+		inline floatx<4u> operator+(floatx<4u> const& a, floatx<4u> const& b) { return _mm_add_ps(a.v, b.v); }
+		inline floatx<4u> operator-(floatx<4u> const& a, floatx<4u> const& b) { return _mm_sub_ps(a.v, b.v); }
+		inline floatx<4u> operator*(floatx<4u> const& a, floatx<4u> const& b) { return _mm_mul_ps(a.v, b.v); }
+		inline floatx<4u> operator/(floatx<4u> const& a, floatx<4u> const& b) { return _mm_div_ps(a.v, b.v); }
+		inline floatx<4u> operator-(floatx<4u> const& a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+		inline maskx<4u> operator<(floatx<4u> const& a, floatx<4u> const& b) { return _mm_cmplt_ps(a.v, b.v); }
+		inline maskx<4u> operator<=(floatx<4u> const& a, floatx<4u> const& b) { return _mm_cmple_ps(a.v, b.v); }
+		inline maskx<4u> operator>(floatx<4u> const& a, floatx<4u> const& b) { return _mm_cmpgt_ps(a.v, b.v); }
+		inline maskx<4u> operator>=(floatx<4u> const& a, floatx<4u> const& b) { return _mm_cmpge_ps(a.v, b.v); }
+		inline maskx<4u> operator==(floatx<4u> const& a, floatx<4u> const& b) { return _mm_cmpeq_ps(a.v, b.v); }
+		inline maskx<4u> operator!=(floatx<4u> const& a, floatx<4u> const& b) { return _mm_cmpneq_ps(a.v, b.v); }
+		inline floatx<4u> min(floatx<4u> const& a, floatx<4u> const& b) { return _mm_min_ps(a.v, b.v); }
+		inline floatx<4u> max(floatx<4u> const& a, floatx<4u> const& b) { return _mm_max_ps(a.v, b.v); }
+		inline floatx<4u> sqrt(floatx<4u> const& a) { return _mm_sqrt_ps(a.v); }
+		inline floatx<4u> abs(floatx<4u> const& a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+		inline floatx<4u> select(maskx<4u> const& m, floatx<4u> const& a, floatx<4u> const& b) { return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)); }
+		inline floatx<4u> trunc(floatx<4u> const& a)
+		{
+			// SSE2 has no rounding instruction: convert to integers and
+			// back, which is exact below 2^23, where floats have a
+			// fractional part, and restore the sign of zeroes.
+			auto const sign = _mm_set1_ps(-0.0f);
+			auto const truncated = _mm_or_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(a.v)), _mm_and_ps(a.v, sign));
+			auto const has_fraction = _mm_cmplt_ps(_mm_andnot_ps(sign, a.v), _mm_set1_ps(8388608.0f));
+			return select(has_fraction, truncated, a);
+		}
+
+		inline maskx<4u> operator&(maskx<4u> const& a, maskx<4u> const& b) { return _mm_and_ps(a.v, b.v); }
+		inline maskx<4u> operator|(maskx<4u> const& a, maskx<4u> const& b) { return _mm_or_ps(a.v, b.v); }
+		inline maskx<4u> operator^(maskx<4u> const& a, maskx<4u> const& b) { return _mm_xor_ps(a.v, b.v); }
+		inline maskx<4u> operator~(maskx<4u> const& a) { return _mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+		inline bool any(maskx<4u> const& m) { return _mm_movemask_ps(m.v) != 0; }
+		inline bool all(maskx<4u> const& m) { return _mm_movemask_ps(m.v) == 0xf; }
+		inline uint32_t bits(maskx<4u> const& m) { return static_cast<uint32_t>(_mm_movemask_ps(m.v)); }
+#endif
+
+#if defined(BONOBO_SIMD_USE_AVX2)
+		//
+		// 8 lanes with AVX2.
+		//
+
+		template<>
+		struct maskx<8u> {
+			__m256 v;
+
+			maskx() = default;
+			maskx(__m256 m) : v(m) {}
+		};
+
+		template<>
+		struct floatx<8u> {
+			static constexpr size_t width = 8u;
+			__m256 v;
+
+			floatx() = default;
+			floatx(float s) : v(_mm256_set1_ps(s)) {}
+			floatx(__m256 x) : v(x) {}
+
+			static floatx load(float const* p) { return _mm256_loadu_ps(p); }
+			void store(float* p) const { _mm256_storeu_ps(p, v); }
+		};
+
+		inline floatx<8u> operator+(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_add_ps(a.v, b.v); }
+		inline floatx<8u> operator-(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_sub_ps(a.v, b.v); }
+		inline floatx<8u> operator*(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_mul_ps(a.v, b.v); }
+		inline floatx<8u> operator/(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_div_ps(a.v, b.v); }
+		inline floatx<8u> operator-(floatx<8u> const& a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+		inline maskx<8u> operator<(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+		inline maskx<8u> operator<=(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+		inline maskx<8u> operator>(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+		inline maskx<8u> operator>=(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+		inline maskx<8u> operator==(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+		inline maskx<8u> operator!=(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ); }
+		inline floatx<8u> min(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_min_ps(a.v, b.v); }
+		inline floatx<8u> max(floatx<8u> const& a, floatx<8u> const& b) { return _mm256_max_ps(a.v, b.v); }
+		inline floatx<8u> sqrt(floatx<8u> const& a) { return _mm256_sqrt_ps(a.v); }
+		inline floatx<8u> abs(floatx<8u> const& a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+		inline floatx<8u> trunc(floatx<8u> const& a) { return _mm256_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+		inline floatx<8u> select(maskx<8u> const& m, floatx<8u> const& a, floatx<8u> const& b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+
+		inline maskx<8u> operator&(maskx<8u> const& a, maskx<8u> const& b) { return _mm256_and_ps(a.v, b.v); }
+		inline maskx<8u> operator|(maskx<8u> const& a, maskx<8u> const& b) { return _mm256_or_ps(a.v, b.v); }
+		inline maskx<8u> operator^(maskx<8u> const& a, maskx<8u> const& b) { return _mm256_xor_ps(a.v, b.v); }
+		inline maskx<8u> operator~(maskx<8u> const& a) { return _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+		inline bool any(maskx<8u> const& m) { return _mm256_movemask_ps(m.v) != 0; }
+		inline bool all(maskx<8u> const& m) { return _mm256_movemask_ps(m.v) == 0xff; }
+		inline uint32_t bits(maskx<8u> const& m) { return static_cast<uint32_t>(_mm256_movemask_ps(m.v)); }
+#endif
+
+#if defined(BONOBO_SIMD_USE_AVX512)
+		//
+		// 16 lanes with AVX-512.
+		//
+
+		template<>
+		struct maskx<16u> {
+			__mmask16 v;
+
+			maskx() = default;
+			maskx(__mmask16 m) : v(m) {}
+		};
+
+		template<>
+		struct floatx<16u> {
+			static constexpr size_t width = 16u;
+			__m512 v;
+
+			floatx() = default;
+			floatx(float s) : v(_mm512_set1_ps(s)) {}
+			floatx(__m512 x) : v(x) {}
+
+			static floatx load(float const* p) { return _mm512_loadu_ps(p); }
+			void store(float* p) const { _mm512_storeu_ps(p, v); }
+		};
+
+		inline floatx<16u> operator+(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_add_ps(a.v, b.v); }
+		inline floatx<16u> operator-(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_sub_ps(a.v, b.v); }
+		inline floatx<16u> operator*(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_mul_ps(a.v, b.v); }
+		inline floatx<16u> operator/(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_div_ps(a.v, b.v); }
+		inline floatx<16u> operator-(floatx<16u> const& a) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), _mm512_set1_epi32(static_cast<int>(0x80000000u)))); }
+		inline maskx<16u> operator<(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+		inline maskx<16u> operator<=(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ); }
+		inline maskx<16u> operator>(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+		inline maskx<16u> operator>=(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ); }
+		inline maskx<16u> operator==(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ); }
+		inline maskx<16u> operator!=(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ); }
+		inline floatx<16u> min(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_min_ps(a.v, b.v); }
+		inline floatx<16u> max(floatx<16u> const& a, floatx<16u> const& b) { return _mm512_max_ps(a.v, b.v); }
+		inline floatx<16u> sqrt(floatx<16u> const& a) { return _mm512_sqrt_ps(a.v); }
+		inline floatx<16u> abs(floatx<16u> const& a) { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a.v), _mm512_set1_epi32(0x7fffffff))); }
+		inline floatx<16u> trunc(floatx<16u> const& a) { return _mm512_roundscale_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+		inline floatx<16u> select(maskx<16u> const& m, floatx<16u> const& a, floatx<16u> const& b) { return _mm512_mask_blend_ps(m.v, b.v, a.v); }
+
+		inline maskx<16u> operator&(maskx<16u> const& a, maskx<16u> const& b) { return static_cast<__mmask16>(a.v & b.v); }
+		inline maskx<16u> operator|(maskx<16u> const& a, maskx<16u> const& b) { return static_cast<__mmask16>(a.v | b.v); }
+		inline maskx<16u> operator^(maskx<16u> const& a, maskx<16u> const& b) { return static_cast<__mmask16>(a.v ^ b.v); }
+		inline maskx<16u> operator~(maskx<16u> const& a) { return static_cast<__mmask16>(~a.v); }
+		inline bool any(maskx<16u> const& m) { return m.v != 0u; }
+		inline bool all(maskx<16u> const& m) { return m.v == 0xffffu; }
+		inline uint32_t bits(maskx<16u> const& m) { return static_cast<uint32_t>(m.v); }
+#endif
+
+		//
+		// Operations with broadcast floats, and derived ones, on any width.
+		//
+
+		template<size_t W> inline floatx<W> operator+(floatx<W> const& a, float b) { return a + floatx<W>(b); }
+		template<size_t W> inline floatx<W> operator-(floatx<W> const& a, float b) { return a - floatx<W>(b); }
+		template<size_t W> inline floatx<W> operator*(floatx<W> const& a, float b) { return a * floatx<W>(b); }
+		template<size_t W> inline floatx<W> operator/(floatx<W> const& a, float b) { return a / floatx<W>(b); }
+		template<size_t W> inline floatx<W> operator+(float a, floatx<W> const& b) { return floatx<W>(a) + b; }
+		template<size_t W> inline floatx<W> operator-(float a, floatx<W> const& b) { return floatx<W>(a) - b; }
+		template<size_t W> inline floatx<W> operator*(float a, floatx<W> const& b) { return floatx<W>(a) * b; }
+		template<size_t W> inline floatx<W> operator/(float a, floatx<W> const& b) { return floatx<W>(a) / b; }
+		template<size_t W> inline floatx<W>& operator+=(floatx<W>& a, floatx<W> const& b) { return a = a + b; }
+		template<size_t W> inline floatx<W>& operator-=(floatx<W>& a, floatx<W> const& b) { return a = a - b; }
+		template<size_t W> inline floatx<W>& operator*=(floatx<W>& a, floatx<W> const& b) { return a = a * b; }
+		template<size_t W> inline floatx<W>& operator/=(floatx<W>& a, floatx<W> const& b) { return a = a / b; }
+
+		//! \brief Largest integer not greater than each lane; exact for
+		//!        all floats.
+		template<size_t W>
+		inline floatx<W> floor(floatx<W> const& a)
+		{
+			auto const t = trunc(a);
+			return select(t > a, t - 1.0f, t);
+		}
+
+		//! \brief Linear blend, as `glm::mix()`.
+		template<size_t W>
+		inline floatx<W> mix(floatx<W> const& a, floatx<W> const& b, floatx<W> const& t)
+		{
+			return a + t * (b - a);
+		}
+
+		//! \brief Sine and cosine of each lane, with the range reduction
+		//!        and polynomials of the Cephes library.
+		//!
+		//! Accurate to a few ulps for |x| up to 8192, and built from the
+		//! operations above only, so that it gives the same results on
+		//! all widths.
+		template<size_t W>
+		void sincos(floatx<W> const& x, floatx<W>& sine, floatx<W>& cosine)
+		{
+			auto const a = abs(x);
+
+			// Octant of the angle, rounded up to an even one, so that the
+			// rest lies in [-pi/4, pi/4]; all are exact integers.
+			auto octant = trunc(a * 1.27323954473516f);
+			octant = octant + (octant - 2.0f * trunc(octant * 0.5f));
+			auto const octant_mod_8 = octant - 8.0f * trunc(octant * 0.125f);
+
+			// Extended precision subtraction of octant * pi/4.
+			auto r = a - octant * 0.78515625f;
+			r = r - octant * 2.4187564849853515625e-4f;
+			r = r - octant * 3.77489497744594108e-8f;
+			auto const z = r * r;
+
+			auto cos_polynomial = floatx<W>(2.443315711809948e-5f);
+			cos_polynomial = cos_polynomial * z + -1.388731625493765e-3f;
+			cos_polynomial = cos_polynomial * z + 4.166664568298827e-2f;
+			cos_polynomial = cos_polynomial * z * z;
+			cos_polynomial = cos_polynomial - z * 0.5f;
+			cos_polynomial = cos_polynomial + 1.0f;
+
+			auto sin_polynomial = floatx<W>(-1.9515295891e-4f);
+			sin_polynomial = sin_polynomial * z + 8.3321608736e-3f;
+			sin_polynomial = sin_polynomial * z + -1.6666654611e-1f;
+			sin_polynomial = sin_polynomial * z * r + r;
+
+			// Octants 0 and 4 use the sine polynomial for the sine; the sine
+			// is negated in octants 4 and 6, the cosine in 2 and 4.
+			auto const use_sine_polynomial = (octant_mod_8 == 0.0f) | (octant_mod_8 == 4.0f);
+			auto const negate_sine = (octant_mod_8 >= 4.0f) ^ (x < 0.0f);
+			auto const negate_cosine = (octant_mod_8 == 2.0f) | (octant_mod_8 == 4.0f);
+			sine = select(use_sine_polynomial, sin_polynomial, cos_polynomial);
+			cosine = select(use_sine_polynomial, cos_polynomial, sin_polynomial);
+			sine = select(negate_sine, -sine, sine);
+			cosine = select(negate_cosine, -cosine, cosine);
+		}
+
+		template<size_t W> inline maskx<W> operator<(floatx<W> const& a, float b) { return a < floatx<W>(b); }
+		template<size_t W> inline maskx<W> operator<=(floatx<W> const& a, float b) { return a <= floatx<W>(b); }
+		template<size_t W> inline maskx<W> operator>(floatx<W> const& a, float b) { return a > floatx<W>(b); }
+		template<size_t W> inline maskx<W> operator>=(floatx<W> const& a, float b) { return a >= floatx<W>(b); }
+		template<size_t W> inline maskx<W> operator==(floatx<W> const& a, float b) { return a == floatx<W>(b); }
+		template<size_t W> inline maskx<W> operator!=(floatx<W> const& a, float b) { return a != floatx<W>(b); }
+
+		//
+		// Vectors and matrices.
+		//
+
+		template<size_t W>
+		struct vec2xn {
+			floatx<W> x, y;
+		};
+
+		template<size_t W>
+		struct vec3xn {
+			floatx<W> x, y, z;
+		};
+
+		template<size_t W>
+		struct vec4xn {
+			floatx<W> x, y, z, w;
+		};
+
+		//! \brief W matrices, as 4 columns like `glm::mat4`.
+		template<size_t W>
+		struct mat4xn {
+			vec4xn<W> columns[4];
+
+			vec4xn<W>& operator[](size_t i) { return columns[i]; }
+			vec4xn<W> const& operator[](size_t i) const { return columns[i]; }
+		};
+
+		typedef floatx<4u> floatx4;
+		typedef floatx<8u> floatx8;
+		typedef floatx<16u> floatx16;
+		typedef vec2xn<4u> vec2x4;
+		typedef vec2xn<8u> vec2x8;
+		typedef vec2xn<16u> vec2x16;
+		typedef vec3xn<4u> vec3x4;
+		typedef vec3xn<8u> vec3x8;
+		typedef vec3xn<16u> vec3x16;
+		typedef vec4xn<4u> vec4x4;
+		typedef vec4xn<8u> vec4x8;
+		typedef vec4xn<16u> vec4x16;
+		// No mat4x4: it would read as a glm type; use mat4xn<4> instead.
+		typedef mat4xn<8u> mat4x8;
+		typedef mat4xn<16u> mat4x16;
+
+		template<size_t W> inline vec3xn<W> operator+(vec3xn<W> const& a, vec3xn<W> const& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+		template<size_t W> inline vec3xn<W> operator-(vec3xn<W> const& a, vec3xn<W> const& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+		template<size_t W> inline vec3xn<W> operator*(vec3xn<W> const& a, vec3xn<W> const& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+		template<size_t W> inline vec3xn<W> operator*(vec3xn<W> const& a, floatx<W> const& s) { return { a.x * s, a.y * s, a.z * s }; }
+		template<size_t W> inline vec3xn<W> operator*(floatx<W> const& s, vec3xn<W> const& a) { return { s * a.x, s * a.y, s * a.z }; }
+		template<size_t W> inline vec3xn<W> operator-(vec3xn<W> const& a) { return { -a.x, -a.y, -a.z }; }
+
+		//! \brief Sums in the same order as `glm::dot()`, (x + y) + z.
+		template<size_t W>
+		inline floatx<W> dot(vec3xn<W> const& a, vec3xn<W> const& b)
+		{
+			return (a.x * b.x + a.y * b.y) + a.z * b.z;
+		}
+
+		template<size_t W>
+		inline vec3xn<W> cross(vec3xn<W> const& a, vec3xn<W> const& b)
+		{
+			return { a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y };
+		}
+
+		template<size_t W> inline floatx<W> length(vec3xn<W> const& a) { return sqrt(dot(a, a)); }
+		template<size_t W> inline vec3xn<W> normalize(vec3xn<W> const& a) { return a * (1.0f / length(a)); }
+
+		template<size_t W>
+		inline vec3xn<W> select(maskx<W> const& m, vec3xn<W> const& a, vec3xn<W> const& b)
+		{
+			return { select(m, a.x, b.x), select(m, a.y, b.y), select(m, a.z, b.z) };
+		}
+
+		template<size_t W>
+		inline vec3xn<W> mix(vec3xn<W> const& a, vec3xn<W> const& b, floatx<W> const& t)
+		{
+			return { mix(a.x, b.x, t), mix(a.y, b.y, t), mix(a.z, b.z, t) };
+		}
+
+		//! \brief Sums in the same order as `glm::mat4 * glm::vec4`.
+		template<size_t W>
+		inline vec4xn<W> operator*(mat4xn<W> const& m, vec4xn<W> const& v)
+		{
+			return { (m[0].x * v.x + m[1].x * v.y) + (m[2].x * v.z + m[3].x * v.w),
+			         (m[0].y * v.x + m[1].y * v.y) + (m[2].y * v.z + m[3].y * v.w),
+			         (m[0].z * v.x + m[1].z * v.y) + (m[2].z * v.z + m[3].z * v.w),
+			         (m[0].w * v.x + m[1].w * v.y) + (m[2].w * v.z + m[3].w * v.w) };
+		}
+
+		//! \brief `glm::vec3(m * glm::vec4(p, 1))`, for affine matrices.
+		template<size_t W>
+		inline vec3xn<W> transform_point(mat4xn<W> const& m, vec3xn<W> const& p)
+		{
+			return { (m[0].x * p.x + m[1].x * p.y) + (m[2].x * p.z + m[3].x),
+			         (m[0].y * p.x + m[1].y * p.y) + (m[2].y * p.z + m[3].y),
+			         (m[0].z * p.x + m[1].z * p.y) + (m[2].z * p.z + m[3].z) };
+		}
+
+		//! \brief `glm::vec3(m * glm::vec4(v, 0))`.
+		template<size_t W>
+		inline vec3xn<W> transform_vector(mat4xn<W> const& m, vec3xn<W> const& v)
+		{
+			return { (m[0].x * v.x + m[1].x * v.y) + m[2].x * v.z,
+			         (m[0].y * v.x + m[1].y * v.y) + m[2].y * v.z,
+			         (m[0].z * v.x + m[1].z * v.y) + m[2].z * v.z };
+		}
+
+		//! \brief Sums in the same order as `glm::mat4 * glm::mat4`, which
+		//!        differs from the one of `glm::mat4 * glm::vec4`.
+		template<size_t W>
+		inline mat4xn<W> operator*(mat4xn<W> const& a, mat4xn<W> const& b)
+		{
+			mat4xn<W> product;
+			for (size_t c = 0u; c < 4u; ++c) {
+				auto const& v = b[c];
+				product[c] = { ((a[0].x * v.x + a[1].x * v.y) + a[2].x * v.z) + a[3].x * v.w,
+				               ((a[0].y * v.x + a[1].y * v.y) + a[2].y * v.z) + a[3].y * v.w,
+				               ((a[0].z * v.x + a[1].z * v.y) + a[2].z * v.z) + a[3].z * v.w,
+				               ((a[0].w * v.x + a[1].w * v.y) + a[2].w * v.z) + a[3].w * v.w };
+			}
+			return product;
+		}
+
+		//
+		// Conversions from and to arrays of glm types; each loads or
+		// stores W consecutive elements.
+		//
+
+		namespace detail
+		{
+			//! Split `count` vectors of 2, 3 or 4 components, the first of
+			//! each `stride` floats apart, into one array per component;
+			//! four at a time with SSE2 shuffles.
+			inline void deinterleave2(float const* p, size_t count, float* x, float* y)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_SIMD_USE_SSE2)
+				for (; i < (count & ~size_t(3u)); i += 4u) {
+					auto const a = _mm_loadu_ps(p + 2u * i), b = _mm_loadu_ps(p + 2u * i + 4u);
+					_mm_storeu_ps(x + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+					_mm_storeu_ps(y + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+				}
+#endif
+				for (; i < count; ++i) {
+					x[i] = p[2u * i + 0u];
+					y[i] = p[2u * i + 1u];
+				}
+			}
+
+			inline void deinterleave3(float const* p, size_t count, float* x, float* y, float* z)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_SIMD_USE_SSE2)
+				for (; i < (count & ~size_t(3u)); i += 4u) {
+					// (x0 y0 z0 x1), (y1 z1 x2 y2), (z2 x3 y3 z3)
+					auto const a = _mm_loadu_ps(p + 3u * i), b = _mm_loadu_ps(p + 3u * i + 4u), c = _mm_loadu_ps(p + 3u * i + 8u);
+					auto const x23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2));
+					auto const y01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), y23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+					auto const z01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), z23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+					_mm_storeu_ps(x + i, _mm_shuffle_ps(a, x23, _MM_SHUFFLE(2, 0, 3, 0)));
+					_mm_storeu_ps(y + i, _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 2, 0)));
+					_mm_storeu_ps(z + i, _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0)));
+				}
+#endif
+				for (; i < count; ++i) {
+					x[i] = p[3u * i + 0u];
+					y[i] = p[3u * i + 1u];
+					z[i] = p[3u * i + 2u];
+				}
+			}
+
+			inline void deinterleave4(float const* p, size_t stride, size_t count, float* x, float* y, float* z, float* w)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_SIMD_USE_SSE2)
+				for (; i < (count & ~size_t(3u)); i += 4u) {
+					auto a = _mm_loadu_ps(p + stride * i), b = _mm_loadu_ps(p + stride * (i + 1u));
+					auto c = _mm_loadu_ps(p + stride * (i + 2u)), d = _mm_loadu_ps(p + stride * (i + 3u));
+					_MM_TRANSPOSE4_PS(a, b, c, d);
+					_mm_storeu_ps(x + i, a);
+					_mm_storeu_ps(y + i, b);
+					_mm_storeu_ps(z + i, c);
+					_mm_storeu_ps(w + i, d);
+				}
+#endif
+				for (; i < count; ++i) {
+					x[i] = p[stride * i + 0u];
+					y[i] = p[stride * i + 1u];
+					z[i] = p[stride * i + 2u];
+					w[i] = p[stride * i + 3u];
+				}
+			}
+
+			//! Inverses of the functions above.
+			inline void interleave2(float const* x, float const* y, size_t count, float* p)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_SIMD_USE_SSE2)
+				for (; i < (count & ~size_t(3u)); i += 4u) {
+					auto const vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i);
+					_mm_storeu_ps(p + 2u * i, _mm_unpacklo_ps(vx, vy));
+					_mm_storeu_ps(p + 2u * i + 4u, _mm_unpackhi_ps(vx, vy));
+				}
+#endif
+				for (; i < count; ++i) {
+					p[2u * i + 0u] = x[i];
+					p[2u * i + 1u] = y[i];
+				}
+			}
+
+			inline void interleave3(float const* x, float const* y, float const* z, size_t count, float* p)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_SIMD_USE_SSE2)
+				for (; i < (count & ~size_t(3u)); i += 4u) {
+					auto const vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+					auto const xy0 = _mm_shuffle_ps(vx, vy, _MM_SHUFFLE(0, 0, 0, 0)), zx0 = _mm_shuffle_ps(vz, vx, _MM_SHUFFLE(1, 1, 0, 0));
+					auto const yz1 = _mm_shuffle_ps(vy, vz, _MM_SHUFFLE(1, 1, 1, 1)), xy2 = _mm_shuffle_ps(vx, vy, _MM_SHUFFLE(2, 2, 2, 2));
+					auto const zx2 = _mm_shuffle_ps(vz, vx, _MM_SHUFFLE(3, 3, 2, 2)), yz3 = _mm_shuffle_ps(vy, vz, _MM_SHUFFLE(3, 3, 3, 3));
+					_mm_storeu_ps(p + 3u * i, _mm_shuffle_ps(xy0, zx0, _MM_SHUFFLE(2, 0, 2, 0)));
+					_mm_storeu_ps(p + 3u * i + 4u, _mm_shuffle_ps(yz1, xy2, _MM_SHUFFLE(2, 0, 2, 0)));
+					_mm_storeu_ps(p + 3u * i + 8u, _mm_shuffle_ps(zx2, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+				}
+#endif
+				for (; i < count; ++i) {
+					p[3u * i + 0u] = x[i];
+					p[3u * i + 1u] = y[i];
+					p[3u * i + 2u] = z[i];
+				}
+			}
+
+			inline void interleave4(float const* x, float const* y, float const* z, float const* w, size_t count, size_t stride, float* p)
+			{
+				size_t i = 0u;
+#if defined(BONOBO_SIMD_USE_SSE2)
+				for (; i < (count & ~size_t(3u)); i += 4u) {
+					auto a = _mm_loadu_ps(x + i), b = _mm_loadu_ps(y + i), c = _mm_loadu_ps(z + i), d = _mm_loadu_ps(w + i);
+					_MM_TRANSPOSE4_PS(a, b, c, d);
+					_mm_storeu_ps(p + stride * i, a);
+					_mm_storeu_ps(p + stride * (i + 1u), b);
+					_mm_storeu_ps(p + stride * (i + 2u), c);
+					_mm_storeu_ps(p + stride * (i + 3u), d);
+				}
+#endif
+				for (; i < count; ++i) {
+					p[stride * i + 0u] = x[i];
+					p[stride * i + 1u] = y[i];
+					p[stride * i + 2u] = z[i];
+					p[stride * i + 3u] = w[i];
+				}
+			}
+		}
+
+		template<size_t W>
+		inline floatx<W> load_float(float const* p)
+		{
+			return floatx<W>::load(p);
+		}
+
+		template<size_t W>
+		inline vec2xn<W> load_vec2(glm::vec2 const* p)
+		{
+			float x[W], y[W];
+			detail::deinterleave2(&p[0].x, W, x, y);
+			return { floatx<W>::load(x), floatx<W>::load(y) };
+		}
+
+		template<size_t W>
+		inline vec3xn<W> load_vec3(glm::vec3 const* p)
+		{
+			float x[W], y[W], z[W];
+			detail::deinterleave3(&p[0].x, W, x, y, z);
+			return { floatx<W>::load(x), floatx<W>::load(y), floatx<W>::load(z) };
+		}
+
+		template<size_t W>
+		inline vec4xn<W> load_vec4(glm::vec4 const* p)
+		{
+			float x[W], y[W], z[W], w[W];
+			detail::deinterleave4(&p[0].x, 4u, W, x, y, z, w);
+			return { floatx<W>::load(x), floatx<W>::load(y), floatx<W>::load(z), floatx<W>::load(w) };
+		}
+
+		template<size_t W>
+		inline mat4xn<W> load_mat4(glm::mat4 const* p)
+		{
+			float v[4][W];
+			mat4xn<W> m;
+			for (int c = 0; c < 4; ++c) {
+				detail::deinterleave4(&p[0][c].x, 16u, W, v[0], v[1], v[2], v[3]);
+				m[c] = { floatx<W>::load(v[0]), floatx<W>::load(v[1]), floatx<W>::load(v[2]), floatx<W>::load(v[3]) };
+			}
+			return m;
+		}
+
+		template<size_t W>
+		inline void store(floatx<W> const& a, float* p)
+		{
+			a.store(p);
+		}
+
+		template<size_t W>
+		inline void store(vec2xn<W> const& a, glm::vec2* p)
+		{
+			float x[W], y[W];
+			a.x.store(x);
+			a.y.store(y);
+			detail::interleave2(x, y, W, &p[0].x);
+		}
+
+		template<size_t W>
+		inline void store(vec3xn<W> const& a, glm::vec3* p)
+		{
+			float x[W], y[W], z[W];
+			a.x.store(x);
+			a.y.store(y);
+			a.z.store(z);
+			detail::interleave3(x, y, z, W, &p[0].x);
+		}
+
+		template<size_t W>
+		inline void store(vec4xn<W> const& a, glm::vec4* p)
+		{
+			float x[W], y[W], z[W], w[W];
+			a.x.store(x);
+			a.y.store(y);
+			a.z.store(z);
+			a.w.store(w);
+			detail::interleave4(x, y, z, w, W, 4u, &p[0].x);
+		}
+
+		template<size_t W>
+		inline void store(mat4xn<W> const& a, glm::mat4* p)
+		{
+			float v[4][W];
+			for (int c = 0; c < 4; ++c) {
+				a[c].x.store(v[0]);
+				a[c].y.store(v[1]);
+				a[c].z.store(v[2]);
+				a[c].w.store(v[3]);
+				detail::interleave4(v[0], v[1], v[2], v[3], W, 16u, &p[0][c].x);
+			}
+		}
+	}
+
+	//! \brief Time frustum culling, transform updates, wave evaluation and
+	//!        spline sampling with `glm` and with `simd` on 4, 8 and 16
+	//!        lanes, log their durations, and check that all widths give
+	//!        the same results.
+	void benchmark_simd();
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "vertex_format.hpp"
+
+#include <cstddef>
+
+namespace bonobo
+{
+	//! \brief Small fixed shapes generated at compile time.
+	//!
+	//! Every generator is `constexpr`, so that
+	//! `constexpr auto cone = static_shapes::make_cone<16u>();` stores
+	//! the finished vertices and indices in the executable, and only
+	//! `upload_mesh()` runs at startup. The tessellation is given as
+	//! template arguments, as it determines the size of the arrays.
+	namespace static_shapes
+	{
+		//! \brief Fixed-size array whose elements can be written to in
+		//!        constant expressions, which `std::array` only allows from
+		//!        C++17 on.
+		template<typename T, size_t N>
+		struct array {
+			T values[N];
+
+			constexpr T& operator[](size_t i) { return values[i]; }
+			constexpr T const& operator[](size_t i) const { return values[i]; }
+			constexpr T const* data() const { return values; }
+			static constexpr size_t size() { return N; }
+		};
+
+		//! \brief Vertex of the static shapes, following `vertex_format`.
+		struct vertex {
+			float position[3];
+			float normal[3];
+			float texcoord[2];
+		};
+
+		using vertex_format = bonobo::vertex_format<
+			attribute<shader_bindings::vertices,  glm::vec3>,
+			attribute<shader_bindings::normals,   glm::vec3>,
+			attribute<shader_bindings::texcoords, glm::vec2>
+		>;
+		static_assert(sizeof(vertex) == vertex_format::stride(), "vertex has to match vertex_format.");
+
+		//! \brief Indexed triangle list of `VerticesNb` vertices.
+		template<size_t VerticesNb, size_t IndicesNb>
+		struct mesh {
+			array<vertex, VerticesNb> vertices;
+			array<GLuint, IndicesNb> indices;
+		};
+
+		namespace detail
+		{
+			constexpr double pi = 3.14159265358979323846;
+
+			//! \brief `angle` brought back to [-pi, pi].
+			constexpr double wrap_angle(double angle)
+			{
+				auto const turns = static_cast<long long>(angle / (2.0 * pi) + (angle >= 0.0 ? 0.5 : -0.5));
+				return angle - 2.0 * pi * static_cast<double>(turns);
+			}
+
+			//! \brief Sine computed by its Taylor series, more than
+			//!        accurate enough for single-precision results.
+			constexpr double sin(double angle)
+			{
+				auto const x = wrap_angle(angle);
+				auto term = x;
+				auto sum = x;
+				for (int n = 1; n < 12; ++n) {
+					term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+					sum += term;
+				}
+				return sum;
+			}
+
+			constexpr double cos(double angle)
+			{
+				return sin(angle + 0.5 * pi);
+			}
+
+			constexpr vertex make_vertex(double px, double py, double pz,
+			                             double nx, double ny, double nz,
+			                             double u, double v)
+			{
+				return vertex{
+					{ static_cast<float>(px), static_cast<float>(py), static_cast<float>(pz) },
+					{ static_cast<float>(nx), static_cast<float>(ny), static_cast<float>(nz) },
+					{ static_cast<float>(u), static_cast<float>(v) }
+				};
+			}
+		}
+
+		//! \brief Square from (-1, -1, 0) to (1, 1, 0), facing +z, with
+		//!        texture coordinates from (0, 0) to (1, 1).
+		constexpr mesh<4u, 6u> make_quad()
+		{
+			return mesh<4u, 6u>{
+				{{ detail::make_vertex(-1.0, -1.0, 0.0,  0.0, 0.0, 1.0,  0.0, 0.0),
+				   detail::make_vertex( 1.0, -1.0, 0.0,  0.0, 0.0, 1.0,  1.0, 0.0),
+				   detail::make_vertex(-1.0,  1.0, 0.0,  0.0, 0.0, 1.0,  0.0, 1.0),
+				   detail::make_vertex( 1.0,  1.0, 0.0,  0.0, 0.0, 1.0,  1.0, 1.0) }},
+				{{ 0u, 1u, 3u, 0u, 3u, 2u }}
+			};
+		}
+
+		//! \brief Cube from (-1, -1, -1) to (1, 1, 1), with separate
+		//!        vertices for each face so that normals are flat, and each
+		//!        face textured from (0, 0) to (1, 1).
+		constexpr mesh<24u, 36u> make_cube()
+		{
+			// Normal, then axes along u and v, of each face.
+			double const faces[6][3][3] = {
+				{ {  1.0, 0.0,  0.0 }, { 0.0, 0.0, -1.0 }, { 0.0, 1.0,  0.0 } },
+				{ { -1.0, 0.0,  0.0 }, { 0.0, 0.0,  1.0 }, { 0.0, 1.0,  0.0 } },
+				{ {  0.0, 1.0,  0.0 }, { 1.0, 0.0,  0.0 }, { 0.0, 0.0, -1.0 } },
+				{ {  0.0, -1.0, 0.0 }, { 1.0, 0.0,  0.0 }, { 0.0, 0.0,  1.0 } },
+				{ {  0.0, 0.0,  1.0 }, { 1.0, 0.0,  0.0 }, { 0.0, 1.0,  0.0 } },
+				{ {  0.0, 0.0, -1.0 }, { -1.0, 0.0, 0.0 }, { 0.0, 1.0,  0.0 } }
+			};
+
+			mesh<24u, 36u> cube{};
+			for (size_t f = 0u; f < 6u; ++f) {
+				auto const& n = faces[f][0];
+				auto const& u = faces[f][1];
+				auto const& v = faces[f][2];
+				for (size_t corner = 0u; corner < 4u; ++corner) {
+					auto const s = (corner & 1u) ? 1.0 : 0.0;
+					auto const t = (corner & 2u) ? 1.0 : 0.0;
+					cube.vertices[4u * f + corner] = detail::make_vertex(
+						n[0] + (2.0 * s - 1.0) * u[0] + (2.0 * t - 1.0) * v[0],
+						n[1] + (2.0 * s - 1.0) * u[1] + (2.0 * t - 1.0) * v[1],
+						n[2] + (2.0 * s - 1.0) * u[2] + (2.0 * t - 1.0) * v[2],
+						n[0], n[1], n[2], s, t);
+				}
+				auto const first = static_cast<GLuint>(4u * f);
+				GLuint const face_indices[6] = { first, first + 1u, first + 3u, first, first + 3u, first + 2u };
+				for (size_t i = 0u; i < 6u; ++i)
+					cube.indices[6u * f + i] = face_indices[i];
+			}
+			return cube;
+		}
+
+		//! \brief Closed cone with its apex at the origin and a base of
+		//!        radius 1 at z = -1, i.e. opening along -z like a spot
+		//!        light's volume.
+		//!
+		//! The side is textured with u going around the cone and v from
+		//! the base to the apex; the base maps its disc onto [0, 1]^2.
+		//!
+		//! @tparam Segments number of segments around the cone
+		template<size_t Segments>
+		constexpr mesh<3u * Segments + 3u, 6u * Segments> make_cone()
+		{
+			static_assert(Segments >= 3u, "A cone needs at least 3 segments.");
+
+			constexpr double side_normal_z = 0.70710678118654752440;
+			mesh<3u * Segments + 3u, 6u * Segments> cone{};
+
+			// Side: one apex per segment, pointing along the middle of the
+			// segment, followed by the ring of the base.
+			auto const ring = static_cast<GLuint>(Segments);
+			for (size_t k = 0u; k < Segments; ++k) {
+				auto const angle = 2.0 * detail::pi * (static_cast<double>(k) + 0.5) / static_cast<double>(Segments);
+				cone.vertices[k] = detail::make_vertex(0.0, 0.0, 0.0,
+				                                       side_normal_z * detail::cos(angle), side_normal_z * detail::sin(angle), side_normal_z,
+				                                       (static_cast<double>(k) + 0.5) / static_cast<double>(Segments), 1.0);
+			}
+			for (size_t k = 0u; k <= Segments; ++k) {
+				auto const angle = 2.0 * detail::pi * static_cast<double>(k) / static_cast<double>(Segments);
+				auto const c = detail::cos(angle), s = detail::sin(angle);
+				cone.vertices[ring + k] = detail::make_vertex(c, s, -1.0,
+				                                              side_normal_z * c, side_normal_z * s, side_normal_z,
+				                                              static_cast<double>(k) / static_cast<double>(Segments), 0.0);
+			}
+
+			// Base: its centre, followed by another ring facing -z.
+			auto const centre = static_cast<GLuint>(2u * Segments + 1u);
+			cone.vertices[centre] = detail::make_vertex(0.0, 0.0, -1.0, 0.0, 0.0, -1.0, 0.5, 0.5);
+			for (size_t k = 0u; k <= Segments; ++k) {
+				auto const angle = 2.0 * detail::pi * static_cast<double>(k) / static_cast<double>(Segments);
+				auto const c = detail::cos(angle), s = detail::sin(angle);
+				cone.vertices[centre + 1u + k] = detail::make_vertex(c, s, -1.0, 0.0, 0.0, -1.0,
+				                                                     0.5 + 0.5 * c, 0.5 + 0.5 * s);
+			}
+
+			for (size_t k = 0u; k < Segments; ++k) {
+				auto const i = static_cast<GLuint>(k);
+				cone.indices[3u * k + 0u] = i;
+				cone.indices[3u * k + 1u] = ring + i;
+				cone.indices[3u * k + 2u] = ring + i + 1u;
+
+				cone.indices[3u * (Segments + k) + 0u] = centre;
+				cone.indices[3u * (Segments + k) + 1u] = centre + 2u + i;
+				cone.indices[3u * (Segments + k) + 2u] = centre + 1u + i;
+			}
+			return cone;
+		}
+
+		//! \brief Sphere of radius 1, mapped like the parametric sphere of
+		//!        the labs: u goes around the y axis starting from +z, and
+		//!        v from the south pole to the north one.
+		//!
+		//! @tparam Columns number of segments around the y axis
+		//! @tparam Rows number of segments from pole to pole
+		template<size_t Columns, size_t Rows>
+		constexpr mesh<(Columns + 1u) * (Rows + 1u), 6u * Columns * (Rows - 1u)> make_sphere()
+		{
+			static_assert(Columns >= 3u && Rows >= 2u, "A sphere needs at least 3 columns and 2 rows.");
+
+			mesh<(Columns + 1u) * (Rows + 1u), 6u * Columns * (Rows - 1u)> sphere{};
+			for (size_t j = 0u; j <= Rows; ++j) {
+				auto const v = static_cast<double>(j) / static_cast<double>(Rows);
+				auto const sin_phi = detail::sin(detail::pi * v), cos_phi = detail::cos(detail::pi * v);
+				for (size_t i = 0u; i <= Columns; ++i) {
+					auto const u = static_cast<double>(i) / static_cast<double>(Columns);
+					auto const sin_theta = detail::sin(2.0 * detail::pi * u), cos_theta = detail::cos(2.0 * detail::pi * u);
+					auto const x = sin_theta * sin_phi, y = -cos_phi, z = cos_theta * sin_phi;
+					sphere.vertices[j * (Columns + 1u) + i] = detail::make_vertex(x, y, z, x, y, z, u, v);
+				}
+			}
+
+			// The first and last rows of quads are triangles, as one of their
+			// sides is collapsed on a pole.
+			size_t index = 0u;
+			for (size_t j = 0u; j < Rows; ++j) {
+				for (size_t i = 0u; i < Columns; ++i) {
+					auto const v00 = static_cast<GLuint>(j * (Columns + 1u) + i);
+					auto const v10 = v00 + 1u;
+					auto const v01 = v00 + static_cast<GLuint>(Columns + 1u);
+					auto const v11 = v01 + 1u;
+					if (j != 0u) {
+						sphere.indices[index++] = v00;
+						sphere.indices[index++] = v10;
+						sphere.indices[index++] = v11;
+					}
+					if (j != Rows - 1u) {
+						sphere.indices[index++] = v00;
+						sphere.indices[index++] = v11;
+						sphere.indices[index++] = v01;
+					}
+				}
+			}
+			return sphere;
+		}
+
+		//! \brief Upload a static shape to new OpenGL buffers.
+		template<size_t VerticesNb, size_t IndicesNb>
+		mesh_data upload_mesh(mesh<VerticesNb, IndicesNb> const& shape)
+		{
+			return create_mesh(vertex_format::get_layout(), shape.vertices.data(), sizeof(shape.vertices),
+			                   VerticesNb, shape.indices.data(), IndicesNb);
+		}
+	}
+}
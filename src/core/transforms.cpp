@@ -0,0 +1,453 @@
+#include "transforms.hpp"
+#include "CompactTRSTransform.h"
+#include "Log.h"
+#include "Misc.h"
+#include "random.hpp"
+#include "TRSTransform.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TRANSFORMS_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// Columns of the rotation of a unit quaternion, as in glm::mat3_cast().
+	void
+	rotation_columns(glm::quat const& q, float r[3][3])
+	{
+		auto const xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		auto const xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		auto const wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		r[0][0] = 1.0f - 2.0f * (yy + zz);
+		r[0][1] = 2.0f * (xy + wz);
+		r[0][2] = 2.0f * (xz - wy);
+		r[1][0] = 2.0f * (xy - wz);
+		r[1][1] = 1.0f - 2.0f * (xx + zz);
+		r[1][2] = 2.0f * (yz + wx);
+		r[2][0] = 2.0f * (xz + wy);
+		r[2][1] = 2.0f * (yz - wx);
+		r[2][2] = 1.0f - 2.0f * (xx + yy);
+	}
+
+	void
+	trs_to_matrix(glm::vec3 const& t, glm::quat const& q, glm::vec3 const& s, glm::mat4& m)
+	{
+		float r[3][3];
+		rotation_columns(q, r);
+		for (int c = 0; c < 3; ++c)
+			m[c] = glm::vec4(r[c][0] * s[c], r[c][1] * s[c], r[c][2] * s[c], 0.0f);
+		m[3] = glm::vec4(t, 1.0f);
+	}
+
+	void
+	trs_to_inverse_matrix(glm::vec3 const& t, glm::quat const& q, glm::vec3 const& s, glm::mat4& m)
+	{
+		float r[3][3];
+		rotation_columns(q, r);
+		auto const x = glm::vec3(1.0f / s.x, 1.0f / s.y, 1.0f / s.z);
+		for (int c = 0; c < 3; ++c)
+			m[c] = glm::vec4(r[0][c] * x.x, r[1][c] * x.y, r[2][c] * x.z, 0.0f);
+		m[3] = glm::vec4(-((t.x * glm::vec3(m[0]) + t.y * glm::vec3(m[1])) + t.z * glm::vec3(m[2])), 1.0f);
+	}
+
+	// Relative tolerance on the lengths and dot products of the columns of
+	// a 3x3, under which it is taken as a rotation and a uniform scaling.
+	float const uniform_scale_tolerance = 1.0e-5f;
+
+	float
+	dot3(float const* a, float const* b)
+	{
+		return (a[0] * b[0] + a[1] * b[1]) + a[2] * b[2];
+	}
+
+#if defined(TRANSFORMS_USE_SSE)
+	__m128
+	dot3(__m128 const* a, __m128 const* b)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+	}
+
+	//! Components of four transforms, one per lane.
+	struct trs_lanes {
+		__m128 t[3];
+		__m128 s[3];
+		__m128 r[3][3]; // columns of the rotations
+	};
+
+	void
+	load_lanes(glm::vec3 const* translations, glm::quat const* rotations, glm::vec3 const* scalings,
+	           trs_lanes& lanes)
+	{
+		for (int c = 0; c < 3; ++c) {
+			lanes.t[c] = _mm_setr_ps(translations[0][c], translations[1][c], translations[2][c], translations[3][c]);
+			lanes.s[c] = _mm_setr_ps(scalings[0][c], scalings[1][c], scalings[2][c], scalings[3][c]);
+		}
+		auto const x = _mm_setr_ps(rotations[0].x, rotations[1].x, rotations[2].x, rotations[3].x);
+		auto const y = _mm_setr_ps(rotations[0].y, rotations[1].y, rotations[2].y, rotations[3].y);
+		auto const z = _mm_setr_ps(rotations[0].z, rotations[1].z, rotations[2].z, rotations[3].z);
+		auto const w = _mm_setr_ps(rotations[0].w, rotations[1].w, rotations[2].w, rotations[3].w);
+
+		auto const xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		auto const xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		auto const wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+		auto const one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+		lanes.r[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+		lanes.r[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+		lanes.r[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+		lanes.r[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+		lanes.r[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+		lanes.r[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+		lanes.r[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+		lanes.r[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+		lanes.r[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+	}
+
+	// Write column `c` of four matrices, given one component per lane.
+	template<typename M>
+	void
+	store_column(M* matrices, int c, __m128 x, __m128 y, __m128 z, __m128 w)
+	{
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(glm::value_ptr(matrices[0][c]), x);
+		_mm_storeu_ps(glm::value_ptr(matrices[1][c]), y);
+		_mm_storeu_ps(glm::value_ptr(matrices[2][c]), z);
+		_mm_storeu_ps(glm::value_ptr(matrices[3][c]), w);
+	}
+#endif
+}
+
+void
+bonobo::trs_to_matrices(glm::vec3 const* translations, glm::quat const* rotations, glm::vec3 const* scalings,
+                        size_t count, glm::mat4* matrices)
+{
+	size_t i = 0u;
+#if defined(TRANSFORMS_USE_SSE)
+	for (; i + 4u <= count; i += 4u) {
+		trs_lanes lanes;
+		load_lanes(translations + i, rotations + i, scalings + i, lanes);
+		for (int c = 0; c < 3; ++c)
+			store_column(matrices + i, c, _mm_mul_ps(lanes.r[c][0], lanes.s[c]), _mm_mul_ps(lanes.r[c][1], lanes.s[c]),
+			             _mm_mul_ps(lanes.r[c][2], lanes.s[c]), _mm_setzero_ps());
+		store_column(matrices + i, 3, lanes.t[0], lanes.t[1], lanes.t[2], _mm_set1_ps(1.0f));
+	}
+#endif
+	for (; i < count; ++i)
+		trs_to_matrix(translations[i], rotations[i], scalings[i], matrices[i]);
+}
+
+void
+bonobo::trs_to_inverse_matrices(glm::vec3 const* translations, glm::quat const* rotations, glm::vec3 const* scalings,
+                                size_t count, glm::mat4* inverses)
+{
+	size_t i = 0u;
+#if defined(TRANSFORMS_USE_SSE)
+	auto const sign = _mm_set1_ps(-0.0f);
+	for (; i + 4u <= count; i += 4u) {
+		trs_lanes lanes;
+		load_lanes(translations + i, rotations + i, scalings + i, lanes);
+		__m128 const x[3] = { _mm_div_ps(_mm_set1_ps(1.0f), lanes.s[0]),
+		                      _mm_div_ps(_mm_set1_ps(1.0f), lanes.s[1]),
+		                      _mm_div_ps(_mm_set1_ps(1.0f), lanes.s[2]) };
+		__m128 columns[3][3];
+		for (int c = 0; c < 3; ++c) {
+			for (int r = 0; r < 3; ++r)
+				columns[c][r] = _mm_mul_ps(lanes.r[r][c], x[r]);
+			store_column(inverses + i, c, columns[c][0], columns[c][1], columns[c][2], _mm_setzero_ps());
+		}
+		__m128 translation[3];
+		for (int r = 0; r < 3; ++r) {
+			auto const sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lanes.t[0], columns[0][r]), _mm_mul_ps(lanes.t[1], columns[1][r])),
+			                            _mm_mul_ps(lanes.t[2], columns[2][r]));
+			translation[r] = _mm_xor_ps(sum, sign);
+		}
+		store_column(inverses + i, 3, translation[0], translation[1], translation[2], _mm_set1_ps(1.0f));
+	}
+#endif
+	for (; i < count; ++i)
+		trs_to_inverse_matrix(translations[i], rotations[i], scalings[i], inverses[i]);
+}
+
+void
+bonobo::multiply_affine_matrices(glm::mat4 const* lhs, glm::mat4 const* rhs, size_t count, glm::mat4* products)
+{
+	for (size_t i = 0u; i < count; ++i) {
+#if defined(TRANSFORMS_USE_SSE)
+		auto const a = glm::value_ptr(lhs[i]);
+		auto const b = glm::value_ptr(rhs[i]);
+		__m128 const columns[4] = { _mm_loadu_ps(a), _mm_loadu_ps(a + 4), _mm_loadu_ps(a + 8), _mm_loadu_ps(a + 12) };
+		__m128 product[4];
+		for (int c = 0; c < 4; ++c) {
+			product[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(b[4 * c + 0])),
+			                                   _mm_mul_ps(columns[1], _mm_set1_ps(b[4 * c + 1]))),
+			                        _mm_mul_ps(columns[2], _mm_set1_ps(b[4 * c + 2])));
+		}
+		product[3] = _mm_add_ps(product[3], columns[3]);
+		auto const p = glm::value_ptr(products[i]);
+		for (int c = 0; c < 4; ++c)
+			_mm_storeu_ps(p + 4 * c, product[c]);
+#else
+		auto const a = lhs[i];
+		auto const& b = rhs[i];
+		glm::mat4 product;
+		for (int c = 0; c < 4; ++c)
+			product[c] = (a[0] * b[c][0] + a[1] * b[c][1]) + a[2] * b[c][2];
+		product[3] += a[3];
+		products[i] = product;
+#endif
+	}
+}
+
+glm::mat3
+bonobo::normal_matrix(glm::mat4 const& model_to_world)
+{
+	float c[3][3];
+	for (int col = 0; col < 3; ++col)
+		for (int row = 0; row < 3; ++row)
+			c[col][row] = model_to_world[col][row];
+
+	auto const s = dot3(c[0], c[0]);
+	auto const tolerance = uniform_scale_tolerance * s;
+	float n[3][3];
+	float inverse;
+	if (std::abs(dot3(c[1], c[1]) - s) <= tolerance && std::abs(dot3(c[2], c[2]) - s) <= tolerance &&
+	    std::abs(dot3(c[0], c[1])) <= tolerance && std::abs(dot3(c[0], c[2])) <= tolerance &&
+	    std::abs(dot3(c[1], c[2])) <= tolerance) {
+		std::copy(&c[0][0], &c[0][0] + 9, &n[0][0]);
+		inverse = 1.0f / s;
+	} else {
+		for (int col = 0; col < 3; ++col) {
+			auto const a = c[(col + 1) % 3], b = c[(col + 2) % 3];
+			n[col][0] = a[1] * b[2] - a[2] * b[1];
+			n[col][1] = a[2] * b[0] - a[0] * b[2];
+			n[col][2] = a[0] * b[1] - a[1] * b[0];
+		}
+		inverse = 1.0f / dot3(c[0], n[0]);
+	}
+
+	glm::mat3 normal;
+	for (int col = 0; col < 3; ++col)
+		for (int row = 0; row < 3; ++row)
+			normal[col][row] = n[col][row] * inverse;
+	return normal;
+}
+
+void
+bonobo::normal_matrices(glm::mat4 const* model_to_worlds, size_t count, glm::mat3x4* normals)
+{
+	size_t i = 0u;
+#if defined(TRANSFORMS_USE_SSE)
+	auto const sign = _mm_set1_ps(-0.0f);
+	auto const one = _mm_set1_ps(1.0f);
+	for (; i + 4u <= count; i += 4u) {
+		__m128 c[3][3]; // [column][row], one matrix per lane
+		for (int col = 0; col < 3; ++col) {
+			auto x = _mm_loadu_ps(glm::value_ptr(model_to_worlds[i + 0u]) + 4 * col);
+			auto y = _mm_loadu_ps(glm::value_ptr(model_to_worlds[i + 1u]) + 4 * col);
+			auto z = _mm_loadu_ps(glm::value_ptr(model_to_worlds[i + 2u]) + 4 * col);
+			auto w = _mm_loadu_ps(glm::value_ptr(model_to_worlds[i + 3u]) + 4 * col);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			c[col][0] = x;
+			c[col][1] = y;
+			c[col][2] = z;
+		}
+
+		auto const s = dot3(c[0], c[0]);
+		auto const tolerance = _mm_mul_ps(_mm_set1_ps(uniform_scale_tolerance), s);
+		auto const is_within = [sign, tolerance](__m128 v) {
+			return _mm_cmple_ps(_mm_andnot_ps(sign, v), tolerance);
+		};
+		auto const uniform = _mm_and_ps(_mm_and_ps(_mm_and_ps(is_within(_mm_sub_ps(dot3(c[1], c[1]), s)),
+		                                                      is_within(_mm_sub_ps(dot3(c[2], c[2]), s))),
+		                                           _mm_and_ps(is_within(dot3(c[0], c[1])),
+		                                                      is_within(dot3(c[0], c[2])))),
+		                                is_within(dot3(c[1], c[2])));
+		auto const uniform_lanes = _mm_movemask_ps(uniform);
+
+		__m128 n[3][3];
+		auto inverse = _mm_div_ps(one, s);
+		if (uniform_lanes == 0xf) {
+			std::copy(&c[0][0], &c[0][0] + 9, &n[0][0]);
+		} else {
+			for (int col = 0; col < 3; ++col) {
+				auto const a = c[(col + 1) % 3], b = c[(col + 2) % 3];
+				n[col][0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+				n[col][1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+				n[col][2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+			}
+			auto const cofactor_inverse = _mm_div_ps(one, dot3(c[0], n[0]));
+			if (uniform_lanes == 0x0) {
+				inverse = cofactor_inverse;
+			} else {
+				for (int col = 0; col < 3; ++col)
+					for (int row = 0; row < 3; ++row)
+						n[col][row] = _mm_or_ps(_mm_and_ps(uniform, c[col][row]), _mm_andnot_ps(uniform, n[col][row]));
+				inverse = _mm_or_ps(_mm_and_ps(uniform, inverse), _mm_andnot_ps(uniform, cofactor_inverse));
+			}
+		}
+
+		for (int col = 0; col < 3; ++col)
+			store_column(normals + i, col, _mm_mul_ps(n[col][0], inverse), _mm_mul_ps(n[col][1], inverse),
+			             _mm_mul_ps(n[col][2], inverse), _mm_setzero_ps());
+	}
+#endif
+	for (; i < count; ++i) {
+		auto const normal = normal_matrix(model_to_worlds[i]);
+		for (int col = 0; col < 3; ++col)
+			normals[i][col] = glm::vec4(normal[col], 0.0f);
+	}
+}
+
+void
+bonobo::benchmark_transforms()
+{
+	size_t const count = 65536u;
+	auto const per_transform = 1.0e6 / static_cast<double>(count);
+
+	xoshiro256ss generator(1u);
+	std::vector<glm::vec3> translations(count), scalings(count);
+	std::vector<glm::quat> rotations(count);
+	std::vector<TRSTransform<float, glm::defaultp>> matrix_transforms(count);
+	std::vector<CompactTRSTransform<float, glm::defaultp>> compact_transforms(count);
+	for (size_t i = 0u; i < count; ++i) {
+		translations[i] = glm::vec3(generator.uniform(-100.0f, 100.0f), generator.uniform(-100.0f, 100.0f), generator.uniform(-100.0f, 100.0f));
+		scalings[i] = glm::vec3(generator.uniform(0.5f, 2.0f), generator.uniform(0.5f, 2.0f), generator.uniform(0.5f, 2.0f));
+		auto const axis = glm::normalize(glm::vec3(generator.uniform(-1.0f, 1.0f), generator.uniform(-1.0f, 1.0f), 1.0f));
+		auto const angle = generator.uniform(-glm::pi<float>(), glm::pi<float>());
+		rotations[i] = glm::angleAxis(angle, axis);
+		matrix_transforms[i].SetTranslate(translations[i]);
+		matrix_transforms[i].SetRotate(angle, axis);
+		matrix_transforms[i].SetScale(scalings[i]);
+		compact_transforms[i].SetTranslate(translations[i]);
+		compact_transforms[i].SetOrientation(rotations[i]);
+		compact_transforms[i].SetScale(scalings[i]);
+	}
+
+	std::vector<glm::mat4> matrices(count), inverses(count), reference(count), products(count);
+	auto const largest_difference = [&reference](std::vector<glm::mat4> const& values) {
+		float difference = 0.0f;
+		for (size_t i = 0u; i < values.size(); ++i)
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					difference = std::max(difference, std::abs(values[i][c][r] - reference[i][c][r]) / std::max(std::abs(reference[i][c][r]), 1.0f));
+		return difference;
+	};
+
+	auto start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		reference[i] = glm::translate(glm::mat4(1.0f), translations[i]) * glm::mat4_cast(rotations[i]) * glm::scale(glm::mat4(1.0f), scalings[i]);
+	auto const glm_duration = GetTimeMilliseconds() - start;
+
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		matrices[i] = matrix_transforms[i].GetMatrix();
+	auto const matrix_transform_duration = GetTimeMilliseconds() - start;
+
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		matrices[i] = compact_transforms[i].GetMatrix();
+	auto const compact_duration = GetTimeMilliseconds() - start;
+	auto const compact_difference = largest_difference(matrices);
+
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		matrices[i] = compact_transforms[i].GetMatrix();
+	auto const cached_duration = GetTimeMilliseconds() - start;
+
+	start = GetTimeMilliseconds();
+	trs_to_matrices(translations.data(), rotations.data(), scalings.data(), count, matrices.data());
+	auto const batch_duration = GetTimeMilliseconds() - start;
+	auto const batch_difference = largest_difference(matrices);
+
+	LogInfo("TRS to matrix, in ns per transform: %.1f with glm, %.1f with TRSTransform, %.1f with CompactTRSTransform (%.1f once cached), %.1f in batches; largest relative differences to glm of %g and %g",
+	        glm_duration * per_transform, matrix_transform_duration * per_transform, compact_duration * per_transform,
+	        cached_duration * per_transform, batch_duration * per_transform, compact_difference, batch_difference);
+
+	auto const forward = reference;
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		reference[i] = glm::inverse(forward[i]);
+	auto const glm_inverse_duration = GetTimeMilliseconds() - start;
+
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		inverses[i] = compact_transforms[i].GetMatrixInverse();
+	auto const compact_inverse_duration = GetTimeMilliseconds() - start;
+	auto const compact_inverse_difference = largest_difference(inverses);
+
+	start = GetTimeMilliseconds();
+	trs_to_inverse_matrices(translations.data(), rotations.data(), scalings.data(), count, inverses.data());
+	auto const batch_inverse_duration = GetTimeMilliseconds() - start;
+	auto const batch_inverse_difference = largest_difference(inverses);
+
+	LogInfo("TRS to inverse matrix, in ns per transform: %.1f with glm::inverse(), %.1f with CompactTRSTransform, %.1f in batches; largest relative differences to glm of %g and %g",
+	        glm_inverse_duration * per_transform, compact_inverse_duration * per_transform, batch_inverse_duration * per_transform,
+	        compact_inverse_difference, batch_inverse_difference);
+
+	// Each matrix under the next one, as parents and children.
+	std::rotate(reference.begin(), reference.begin() + 1, reference.end());
+	start = GetTimeMilliseconds();
+	for (size_t i = 0u; i < count; ++i)
+		products[i] = forward[i] * reference[i];
+	auto const glm_product_duration = GetTimeMilliseconds() - start;
+	reference.swap(products);
+
+	std::rotate(inverses.begin(), inverses.begin() + 1, inverses.end());
+	start = GetTimeMilliseconds();
+	multiply_affine_matrices(forward.data(), inverses.data(), count, products.data());
+	auto const batch_product_duration = GetTimeMilliseconds() - start;
+
+	LogInfo("Affine matrix products, in ns per product: %.1f with glm, %.1f in batches; largest relative difference of %g",
+	        glm_product_duration * per_transform, batch_product_duration * per_transform, largest_difference(products));
+
+	// Normal matrices, first of the scaled transforms, then of the same
+	// ones without scaling, as most nodes have.
+	std::vector<glm::mat3x4> normals(count);
+	std::vector<glm::vec3> const unit_scalings(count, glm::vec3(1.0f));
+	auto const largest_normal_difference = [&reference](std::vector<glm::mat4> const& values) {
+		float difference = 0.0f;
+		for (size_t i = 0u; i < values.size(); ++i)
+			for (int c = 0; c < 3; ++c)
+				for (int r = 0; r < 3; ++r)
+					difference = std::max(difference, std::abs(values[i][c][r] - reference[i][c][r]) / std::max(std::abs(reference[i][c][r]), 1.0f));
+		return difference;
+	};
+	for (auto const uniform : { false, true }) {
+		if (uniform)
+			trs_to_matrices(translations.data(), rotations.data(), unit_scalings.data(), count, products.data());
+		else
+			products = forward;
+
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < count; ++i)
+			reference[i] = glm::transpose(glm::inverse(products[i]));
+		auto const glm_normal_duration = GetTimeMilliseconds() - start;
+
+		start = GetTimeMilliseconds();
+		for (size_t i = 0u; i < count; ++i)
+			matrices[i] = glm::mat4(normal_matrix(products[i]));
+		auto const single_normal_duration = GetTimeMilliseconds() - start;
+		auto const single_normal_difference = largest_normal_difference(matrices);
+
+		start = GetTimeMilliseconds();
+		normal_matrices(products.data(), count, normals.data());
+		auto const batch_normal_duration = GetTimeMilliseconds() - start;
+		float batch_normal_difference = 0.0f;
+		for (size_t i = 0u; i < count; ++i)
+			for (int c = 0; c < 3; ++c)
+				for (int r = 0; r < 3; ++r)
+					batch_normal_difference = std::max(batch_normal_difference, std::abs(normals[i][c][r] - matrices[i][c][r]));
+
+		LogInfo("Normal matrices%s, in ns per matrix: %.1f with glm::transpose(glm::inverse()), %.1f one by one, %.1f in batches; largest relative difference to glm of %g, largest difference between batches and single of %g",
+		        uniform ? " without scaling" : "", glm_normal_duration * per_transform, single_normal_duration * per_transform,
+		        batch_normal_duration * per_transform, single_normal_difference, batch_normal_difference);
+	}
+}
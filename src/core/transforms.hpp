@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+
+namespace bonobo
+{
+	//! \brief Matrices T * R * S of `count` transforms, given as arrays of
+	//!        translations, unit quaternions and scalings.
+	//!
+	//! Four transforms are converted at once with SSE, the same as
+	//! without it; this is `CompactTRSTransform::GetMatrix()` over arrays,
+	//! such as the output of an `animation_sampler`.
+	void trs_to_matrices(glm::vec3 const* translations, glm::quat const* rotations, glm::vec3 const* scalings,
+	                     size_t count, glm::mat4* matrices);
+
+	//! \brief Inverses of the matrices of `trs_to_matrices()`, built as
+	//!        S^-1 * R^T * T^-1 rather than through a general inverse.
+	void trs_to_inverse_matrices(glm::vec3 const* translations, glm::quat const* rotations, glm::vec3 const* scalings,
+	                             size_t count, glm::mat4* inverses);
+
+	//! \brief Compose `count` pairs of affine matrices, whose last row is
+	//!        (0, 0, 0, 1), as products[i] = lhs[i] * rhs[i]; e.g. the
+	//!        world matrices of parents with the local ones of children.
+	//!
+	//! `products` may be `lhs` or `rhs`.
+	void multiply_affine_matrices(glm::mat4 const* lhs, glm::mat4 const* rhs, size_t count, glm::mat4* products);
+
+	//! \brief Matrix transforming normals from model-space to world-space,
+	//!        i.e. the inverse transpose of the upper 3x3 of `model_to_world`.
+	//!
+	//! It is built from the cofactors of that 3x3, the cross products of
+	//! its columns, divided by its determinant. When the columns are
+	//! orthogonal and of the same length s, i.e. a rotation and a uniform
+	//! scaling, it is the 3x3 itself divided by s^2, and the cofactors are
+	//! skipped.
+	glm::mat3 normal_matrix(glm::mat4 const& model_to_world);
+
+	//! \brief `normal_matrix()` of `count` matrices, four at a time with
+	//!        SSE, the same as without it.
+	//!
+	//! The results are stored as 3 columns of 4 floats, the last one being
+	//! 0, so that they can be copied as is into a buffer texture or a
+	//! std140 block.
+	void normal_matrices(glm::mat4 const* model_to_worlds, size_t count, glm::mat3x4* normals);
+
+	//! \brief Time `TRSTransform`, `CompactTRSTransform`, the functions
+	//!        above and their glm equivalents over many transforms, and
+	//!        log their durations and largest differences.
+	void benchmark_transforms();
+}
@@ -0,0 +1,71 @@
+#include "vertex_format.hpp"
+#include "quantization.hpp"
+
+#include <cassert>
+
+void
+bonobo::setup_vertex_attributes(vertex_layout const& layout, GLintptr base_offset)
+{
+	for (auto const& attribute : layout.attributes) {
+		auto const location = static_cast<unsigned int>(attribute.binding);
+		auto const pointer = reinterpret_cast<GLvoid const*>(base_offset + attribute.offset);
+		glEnableVertexAttribArray(location);
+		if (attribute.integer)
+			glVertexAttribIPointer(location, attribute.components, attribute.type, attribute.stride, pointer);
+		else
+			glVertexAttribPointer(location, attribute.components, attribute.type, attribute.normalized,
+			                      attribute.stride, pointer);
+	}
+}
+
+bonobo::mesh_data
+bonobo::create_mesh(vertex_layout const& layout,
+                    void const* vertices, size_t vertices_size, size_t vertices_nb,
+                    GLuint const* indices, size_t indices_nb,
+                    GLenum drawing_mode)
+{
+	mesh_data data;
+	data.vertices_nb = vertices_nb;
+	data.drawing_mode = drawing_mode;
+
+	glGenVertexArrays(1, &data.vao);
+	assert(data.vao != 0u);
+	glBindVertexArray(data.vao);
+
+	glGenBuffers(1, &data.bo);
+	assert(data.bo != 0u);
+	glBindBuffer(GL_ARRAY_BUFFER, data.bo);
+	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices_size), vertices, GL_STATIC_DRAW);
+	setup_vertex_attributes(layout);
+
+	if (indices != nullptr && indices_nb > 0u) {
+		data.indices_nb = indices_nb;
+		glGenBuffers(1, &data.ibo);
+		assert(data.ibo != 0u);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ibo);
+
+		// Halve the size of the index buffer whenever all vertices can be
+		// addressed with 16 bits.
+		auto const narrowed_indices = vertices_nb <= 0x10000u ? narrow_indices(indices, indices_nb) : std::vector<uint16_t>();
+		if (!narrowed_indices.empty()) {
+			data.indices_type = GL_UNSIGNED_SHORT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices_nb * sizeof(uint16_t)), narrowed_indices.data(), GL_STATIC_DRAW);
+		} else {
+			data.indices_type = GL_UNSIGNED_INT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices_nb * sizeof(GLuint)), indices, GL_STATIC_DRAW);
+		}
+	}
+
+	glBindVertexArray(0u);
+	glBindBuffer(GL_ARRAY_BUFFER, 0u);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0u);
+
+	return data;
+}
+
+bonobo::vertex_layout const&
+bonobo::get_standard_vertex_layout()
+{
+	static vertex_layout const layout = standard_vertex_format::get_layout();
+	return layout;
+}
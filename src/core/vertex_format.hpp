@@ -0,0 +1,294 @@
+#pragma once
+
+#include "helpers.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace bonobo
+{
+	//! \brief Description of one vertex attribute inside a vertex buffer.
+	struct vertex_attribute {
+		shader_bindings binding; //!< attribute location it feeds
+		GLint components;        //!< number of components, 1 to 4
+		GLenum type;             //!< component type, i.e. GL_FLOAT
+		GLboolean normalized;    //!< whether integer types are normalised
+		bool integer;            //!< whether values are read as integers by
+		                         //!< shaders, i.e. `ivec2` rather than `vec2`
+		GLuint offset;           //!< offset in bytes of the attribute of the
+		                         //!< first vertex
+		GLsizei stride;          //!< distance in bytes between two
+		                         //!< consecutive values of this attribute
+	};
+
+	//! \brief Description of how the attributes of a vertex are laid out in
+	//!        a buffer.
+	struct vertex_layout {
+		GLsizei stride;                           //!< size in bytes of one vertex
+		std::vector<vertex_attribute> attributes; //!< enabled attributes
+	};
+
+	//! \brief Enable and point the attributes of `layout` at the buffer
+	//!        currently bound to GL_ARRAY_BUFFER, on the currently bound
+	//!        Vertex Array.
+	//!
+	//! @param [in] layout vertex layout to set up
+	//! @param [in] base_offset offset in bytes of the first vertex in the
+	//!             buffer
+	void setup_vertex_attributes(vertex_layout const& layout, GLintptr base_offset = 0);
+
+	//! \brief Upload vertices and indices to new OpenGL buffers, and create
+	//!        a Vertex Array using them.
+	//!
+	//! @param [in] layout layout of the vertex data
+	//! @param [in] vertices vertex data to upload
+	//! @param [in] vertices_size size in bytes of the vertex data
+	//! @param [in] vertices_nb number of vertices
+	//! @param [in] indices indices to upload; can be null for non-indexed
+	//!             meshes
+	//! @param [in] indices_nb number of indices
+	//! @param [in] drawing_mode OpenGL drawing mode of the mesh
+	//! @return wrapper around the created OpenGL objects' names
+	mesh_data create_mesh(vertex_layout const& layout,
+	                      void const* vertices, size_t vertices_size, size_t vertices_nb,
+	                      GLuint const* indices, size_t indices_nb,
+	                      GLenum drawing_mode = GL_TRIANGLES);
+
+	//! \brief OpenGL description of a C++ type used as vertex attribute.
+	template<typename T>
+	struct attribute_traits;
+
+	template<>
+	struct attribute_traits<float> {
+		static constexpr GLint components = 1;
+		static constexpr GLenum type = GL_FLOAT;
+		static constexpr GLboolean normalized = GL_FALSE;
+		static constexpr bool integer = false;
+	};
+
+	template<>
+	struct attribute_traits<glm::vec2> {
+		static constexpr GLint components = 2;
+		static constexpr GLenum type = GL_FLOAT;
+		static constexpr GLboolean normalized = GL_FALSE;
+		static constexpr bool integer = false;
+	};
+
+	template<>
+	struct attribute_traits<glm::vec3> {
+		static constexpr GLint components = 3;
+		static constexpr GLenum type = GL_FLOAT;
+		static constexpr GLboolean normalized = GL_FALSE;
+		static constexpr bool integer = false;
+	};
+
+	template<>
+	struct attribute_traits<glm::vec4> {
+		static constexpr GLint components = 4;
+		static constexpr GLenum type = GL_FLOAT;
+		static constexpr GLboolean normalized = GL_FALSE;
+		static constexpr bool integer = false;
+	};
+
+	//! \brief Element of a `vertex_format`: a value of type `T` fed to the
+	//!        attribute location `Binding`.
+	template<shader_bindings Binding, typename T>
+	struct attribute {
+		using type = T;
+		static constexpr shader_bindings binding = Binding;
+	};
+
+	namespace detail
+	{
+		template<size_t I, typename Head, typename... Tail>
+		struct type_at {
+			using type = typename type_at<I - 1u, Tail...>::type;
+		};
+
+		template<typename Head, typename... Tail>
+		struct type_at<0u, Head, Tail...> {
+			using type = Head;
+		};
+	}
+
+	//! \brief Compile-time description of a vertex, as a list of
+	//!        `attribute`s.
+	//!
+	//! The stride, offsets and OpenGL types of every attribute are derived
+	//! from the list, for both interleaved and planar storage; see
+	//! `vertex_data` to fill buffers following a format.
+	template<typename... Attributes>
+	struct vertex_format {
+		static_assert(sizeof...(Attributes) > 0u, "A vertex format needs at least one attribute.");
+
+		static constexpr size_t attributes_nb = sizeof...(Attributes);
+
+		//! \brief Position in the list of the attribute fed to `binding`.
+		static constexpr size_t index_of(shader_bindings binding)
+		{
+			shader_bindings const bindings[] = { Attributes::binding... };
+			for (size_t i = 0u; i < attributes_nb; ++i)
+				if (bindings[i] == binding)
+					return i;
+			return attributes_nb;
+		}
+
+		//! \brief Type of the attribute fed to `Binding`.
+		template<shader_bindings Binding>
+		using value_type = typename detail::type_at<
+			vertex_format::index_of(Binding), typename Attributes::type...>::type;
+
+		//! \brief Offset in bytes of the `index`-th attribute inside an
+		//!        interleaved vertex.
+		static constexpr size_t offset_of(size_t index)
+		{
+			size_t const sizes[] = { sizeof(typename Attributes::type)... };
+			size_t offset = 0u;
+			for (size_t i = 0u; i < index && i < attributes_nb; ++i)
+				offset += sizes[i];
+			return offset;
+		}
+
+		//! \brief Size in bytes of the `index`-th attribute.
+		static constexpr size_t size_of(size_t index)
+		{
+			size_t const sizes[] = { sizeof(typename Attributes::type)... };
+			return sizes[index];
+		}
+
+		//! \brief Size in bytes of one vertex.
+		static constexpr size_t stride() { return offset_of(attributes_nb); }
+
+		//! \brief Layout of a buffer holding `vertices_nb` vertices
+		//!        following this format.
+		//!
+		//! @param [in] storage how the vertices are arranged
+		//! @param [in] vertices_nb number of vertices in the buffer; only
+		//!             used by planar storage
+		static vertex_layout get_layout(vertex_storage storage = vertex_storage::interleaved,
+		                                size_t vertices_nb = 0u)
+		{
+			return make_layout(storage, vertices_nb, std::index_sequence_for<Attributes...>{});
+		}
+
+	private:
+		template<size_t... Is>
+		static vertex_layout make_layout(vertex_storage storage, size_t vertices_nb, std::index_sequence<Is...>)
+		{
+			auto const is_planar = storage == vertex_storage::planar;
+			vertex_layout layout;
+			layout.stride = static_cast<GLsizei>(stride());
+			layout.attributes = {
+				vertex_attribute{
+					Attributes::binding,
+					attribute_traits<typename Attributes::type>::components,
+					attribute_traits<typename Attributes::type>::type,
+					attribute_traits<typename Attributes::type>::normalized,
+					attribute_traits<typename Attributes::type>::integer,
+					static_cast<GLuint>(is_planar ? offset_of(Is) * vertices_nb : offset_of(Is)),
+					static_cast<GLsizei>(is_planar ? size_of(Is) : stride())
+				}...
+			};
+			return layout;
+		}
+	};
+
+	//! \brief CPU-side vertex buffer following the vertex format `Format`.
+	//!
+	//! Attributes are written and read by binding point, i.e.
+	//! `data.set<shader_bindings::normals>(i, n)`, whatever the storage
+	//! chosen.
+	template<typename Format>
+	class vertex_data
+	{
+	public:
+		vertex_data(size_t vertices_nb, vertex_storage storage = vertex_storage::interleaved) :
+			_bytes(vertices_nb * Format::stride(), 0u), _vertices_nb(vertices_nb), _storage(storage)
+		{
+		}
+
+		template<shader_bindings Binding>
+		void set(size_t vertex, typename Format::template value_type<Binding> const& value)
+		{
+			std::memcpy(_bytes.data() + address<Binding>(vertex), &value, sizeof(value));
+		}
+
+		template<shader_bindings Binding>
+		typename Format::template value_type<Binding> get(size_t vertex) const
+		{
+			typename Format::template value_type<Binding> value;
+			std::memcpy(&value, _bytes.data() + address<Binding>(vertex), sizeof(value));
+			return value;
+		}
+
+		//! \brief Copy of this buffer where vertex `i` is moved to
+		//!        `new_indices[i]`.
+		//!
+		//! @param [in] new_indices permutation of [0, vertices_nb)
+		vertex_data remapped(std::vector<GLuint> const& new_indices) const
+		{
+			vertex_data result(_vertices_nb, _storage);
+			for (size_t i = 0u; i < _vertices_nb; ++i)
+				for (size_t a = 0u; a < Format::attributes_nb; ++a)
+					std::memcpy(result._bytes.data() + result.address(a, new_indices[i]),
+					            _bytes.data() + address(a, i), Format::size_of(a));
+			return result;
+		}
+
+		size_t get_vertices_nb() const { return _vertices_nb; }
+		vertex_storage get_storage() const { return _storage; }
+		vertex_layout get_layout() const { return Format::get_layout(_storage, _vertices_nb); }
+
+		void const* data() const { return _bytes.data(); }
+		void* data() { return _bytes.data(); }
+		size_t size() const { return _bytes.size(); }
+
+	private:
+		template<shader_bindings Binding>
+		size_t address(size_t vertex) const
+		{
+			constexpr auto index = Format::index_of(Binding);
+			static_assert(index < Format::attributes_nb, "This binding is not part of the vertex format.");
+			return address(index, vertex);
+		}
+
+		size_t address(size_t attribute_index, size_t vertex) const
+		{
+			return _storage == vertex_storage::interleaved
+			     ? vertex * Format::stride() + Format::offset_of(attribute_index)
+			     : Format::offset_of(attribute_index) * _vertices_nb + vertex * Format::size_of(attribute_index);
+		}
+
+		std::vector<unsigned char> _bytes;
+		size_t _vertices_nb;
+		vertex_storage _storage;
+	};
+
+	//! \brief Upload the content of a `vertex_data`; see the non-template
+	//!        overload.
+	template<typename Format>
+	mesh_data create_mesh(vertex_data<Format> const& vertices,
+	                      GLuint const* indices, size_t indices_nb,
+	                      GLenum drawing_mode = GL_TRIANGLES)
+	{
+		return create_mesh(vertices.get_layout(), vertices.data(), vertices.size(), vertices.get_vertices_nb(),
+		                   indices, indices_nb, drawing_mode);
+	}
+
+	//! \brief Vertex holding all the attributes used by the labs, as the
+	//!        parametric shapes and `loadObjects()` generate them.
+	using standard_vertex_format = vertex_format<
+		attribute<shader_bindings::vertices,  glm::vec3>,
+		attribute<shader_bindings::normals,   glm::vec3>,
+		attribute<shader_bindings::texcoords, glm::vec3>,
+		attribute<shader_bindings::tangents,  glm::vec3>,
+		attribute<shader_bindings::binormals, glm::vec3>
+	>;
+
+	//! \brief Interleaved layout of `standard_vertex_format`.
+	vertex_layout const& get_standard_vertex_layout();
+}
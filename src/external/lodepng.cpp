@@ -4010,6 +4010,10 @@ unsigned lodepng_inspect(unsigned* w, unsigned* h, LodePNGState* state,
   return state->error;
 }
 
+unsigned (*lodepng_custom_unfilter_scanline)(unsigned char* recon, const unsigned char* scanline,
+                                             const unsigned char* precon, size_t bytewidth,
+                                             unsigned char filterType, size_t length) = 0;
+
 static unsigned unfilterScanline(unsigned char* recon, const unsigned char* scanline, const unsigned char* precon,
                                  size_t bytewidth, unsigned char filterType, size_t length)
 {
@@ -4023,6 +4027,10 @@ static unsigned unfilterScanline(unsigned char* recon, const unsigned char* scan
   */
 
   size_t i;
+  if(lodepng_custom_unfilter_scanline)
+  {
+    return lodepng_custom_unfilter_scanline(recon, scanline, precon, bytewidth, filterType, length);
+  }
   switch(filterType)
   {
     case 0:
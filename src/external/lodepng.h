@@ -267,6 +267,13 @@ struct LodePNGDecompressSettings
 
 extern const LodePNGDecompressSettings lodepng_default_decompress_settings;
 void lodepng_decompress_settings_init(LodePNGDecompressSettings* settings);
+
+/*use custom unfiltering of a scanline instead of the built in one (default: null),
+e.g. one using SIMD instructions; it gets the same arguments, must give the same
+result, and returns 0 or the error of the built in one*/
+extern unsigned (*lodepng_custom_unfilter_scanline)(unsigned char* recon, const unsigned char* scanline,
+                                                    const unsigned char* precon, size_t bytewidth,
+                                                    unsigned char filterType, size_t length);
 #endif /*LODEPNG_COMPILE_DECODER*/
 
 #ifdef LODEPNG_COMPILE_ENCODER
@@ -0,0 +1,199 @@
+#include "core/draw_command_builder.hpp"
+#include "core/transforms.hpp"
+
+#include "core/Log.h"
+#include "core/Misc.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// The builder warns about the meshes it ignores, and the benchmarks next
+// to it log and time themselves; the checks are built without the rest of
+// core, so both are provided here.
+void Log::Report(unsigned int /*flags*/, char const* /*file*/, char const* /*function*/, int /*line*/,
+                 Log::Type /*type*/, char const* str, ...)
+{
+	va_list arguments;
+	va_start(arguments, str);
+	std::vfprintf(stderr, str, arguments);
+	va_end(arguments);
+	std::fprintf(stderr, "\n");
+}
+
+double GetTimeMilliseconds()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+namespace
+{
+	unsigned int failures_nb = 0u;
+
+	void check(bool condition, char const* expression, char const* file, int line)
+	{
+		if (condition)
+			return;
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		++failures_nb;
+	}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+	// Submesh number `i`, which can be told apart from the others by its
+	// indices and vertices.
+	bonobo::mesh_data submesh(size_t i)
+	{
+		bonobo::mesh_data mesh;
+		mesh.vao = 1u;
+		mesh.bo = 1u;
+		mesh.ibo = 2u;
+		mesh.indices_nb = 3u * (i + 1u);
+		mesh.first_index = static_cast<GLuint>(100u * i);
+		mesh.base_vertex = static_cast<GLint>(10u * i);
+		return mesh;
+	}
+
+	glm::mat4 transform(size_t i)
+	{
+		auto const angle = 0.37f * static_cast<float>(i);
+		auto const scaling = glm::vec3(1.0f + 0.1f * static_cast<float>(i), 2.0f, 0.5f + 0.25f * static_cast<float>(i % 3u));
+		return glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i), -2.0f, 3.0f)),
+		                              angle, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))),
+		                  scaling);
+	}
+
+	void test_commands()
+	{
+		// Materials 0 to 2 are drawn with one program, and 3 and up, alpha
+		// tested, with another one, as in EDAN35.
+		uint32_t const materials[] = { 4u, 1u, 4u, 0u, 1u, 3u, 1u, 0u, 4u, 1u };
+		size_t const draws_nb = sizeof(materials) / sizeof(materials[0]);
+		uint32_t const opaque_materials_nb = 3u;
+
+		bonobo::draw_command_builder builder;
+		for (size_t i = 0u; i < draws_nb; ++i)
+			builder.add(submesh(i), materials[i], transform(i));
+
+		// Not indexed, so ignored.
+		auto not_indexed = submesh(draws_nb);
+		not_indexed.ibo = 0u;
+		builder.add(not_indexed, 0u, transform(draws_nb));
+		not_indexed = submesh(draws_nb);
+		not_indexed.indices_nb = 0u;
+		builder.add(not_indexed, 0u, transform(draws_nb));
+		builder.build();
+
+		auto const& commands = builder.get_commands();
+		auto const& transforms = builder.get_transforms();
+		auto const& normal_transforms = builder.get_normal_transforms();
+		auto const& batches = builder.get_batches();
+		CHECK(commands.size() == draws_nb);
+		CHECK(transforms.size() == draws_nb);
+		CHECK(normal_transforms.size() == draws_nb);
+
+		// Sorted by material, then in the order they were added.
+		std::vector<size_t> order(draws_nb);
+		for (size_t i = 0u; i < draws_nb; ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&materials](size_t a, size_t b) { return materials[a] < materials[b]; });
+		for (size_t i = 0u; i < commands.size(); ++i) {
+			auto const expected = submesh(order[i]);
+			CHECK(commands[i].count == static_cast<GLuint>(expected.indices_nb));
+			CHECK(commands[i].instance_count == 1u);
+			CHECK(commands[i].first_index == expected.first_index);
+			CHECK(commands[i].base_vertex == expected.base_vertex);
+			CHECK(commands[i].base_instance == static_cast<GLuint>(i));
+			CHECK(transforms[i] == transform(order[i]));
+
+			auto const normal_transform = glm::transpose(glm::inverse(glm::mat3(transforms[i])));
+			for (int c = 0; c < 3; ++c) {
+				for (int r = 0; r < 3; ++r)
+					CHECK(std::abs(normal_transforms[i][c][r] - normal_transform[c][r]) < 1.0e-5f * std::max(std::abs(normal_transform[c][r]), 1.0f));
+				CHECK(normal_transforms[i][c][3] == 0.0f);
+			}
+		}
+
+		// One batch per material, covering all commands one after the
+		// other; those of each program come together.
+		uint32_t const expected_materials[] = { 0u, 1u, 3u, 4u };
+		size_t const expected_counts[] = { 2u, 4u, 1u, 3u };
+		CHECK(batches.size() == 4u);
+		size_t next_command = 0u;
+		for (size_t i = 0u; i < std::min(batches.size(), size_t(4u)); ++i) {
+			CHECK(batches[i].material == expected_materials[i]);
+			CHECK(batches[i].first_command == next_command);
+			CHECK(batches[i].commands_nb == expected_counts[i]);
+			for (size_t j = 0u; j < batches[i].commands_nb; ++j)
+				CHECK(materials[order[batches[i].first_command + j]] == batches[i].material);
+			next_command += batches[i].commands_nb;
+		}
+		CHECK(next_command == commands.size());
+		auto const first_alpha_tested_batch = std::count_if(batches.begin(), batches.end(),
+		                                                    [opaque_materials_nb](bonobo::draw_command_builder::batch const& batch) {
+		                                                        return batch.material < opaque_materials_nb;
+		                                                    });
+		CHECK(first_alpha_tested_batch == 2);
+		for (size_t i = 0u; i < batches.size(); ++i)
+			CHECK((batches[i].material < opaque_materials_nb) == (i < static_cast<size_t>(first_alpha_tested_batch)));
+
+		// Built again from scratch after clearing.
+		builder.clear();
+		builder.add(submesh(7u), 2u, transform(7u));
+		builder.build();
+		CHECK(builder.get_commands().size() == 1u);
+		CHECK(builder.get_commands().front().base_instance == 0u);
+		CHECK(builder.get_commands().front().first_index == submesh(7u).first_index);
+		CHECK(builder.get_batches().size() == 1u);
+		CHECK(builder.get_batches().front().material == 2u && builder.get_batches().front().commands_nb == 1u);
+	}
+
+	void test_bulk_transforms()
+	{
+		// More draws than the SSE path handles at once, with a remainder,
+		// and uniformly scaled rotations, whose cofactors are skipped.
+		size_t const draws_nb = 1027u;
+		bonobo::draw_command_builder builder;
+		for (size_t i = 0u; i < draws_nb; ++i) {
+			auto model_to_world = transform(i);
+			if (i % 4u == 1u)
+				model_to_world = glm::scale(glm::rotate(glm::mat4(1.0f), 0.1f * static_cast<float>(i), glm::vec3(0.0f, 1.0f, 0.0f)),
+				                            glm::vec3(1.0f + 0.01f * static_cast<float>(i)));
+			builder.add(submesh(i), static_cast<uint32_t>((i * 7u) % 5u), model_to_world);
+		}
+		builder.build();
+
+		auto const& transforms = builder.get_transforms();
+		auto const& normal_transforms = builder.get_normal_transforms();
+		CHECK(transforms.size() == draws_nb && normal_transforms.size() == draws_nb);
+		float largest_difference = 0.0f;
+		for (size_t i = 0u; i < std::min(transforms.size(), normal_transforms.size()); ++i) {
+			auto const normal_transform = bonobo::normal_matrix(transforms[i]);
+			for (int c = 0; c < 3; ++c)
+				for (int r = 0; r < 3; ++r)
+					largest_difference = std::max(std::abs(normal_transforms[i][c][r] - normal_transform[c][r]) / std::max(std::abs(normal_transform[c][r]), 1.0f),
+					                              largest_difference);
+		}
+		std::printf("%zu normal transforms, at most %g away from normal_matrix()\n", normal_transforms.size(), largest_difference);
+		CHECK(largest_difference < 1.0e-5f);
+	}
+}
+
+int main()
+{
+	test_commands();
+	test_bulk_transforms();
+
+	if (failures_nb > 0u) {
+		std::fprintf(stderr, "%u draw command builder checks failed\n", failures_nb);
+		return EXIT_FAILURE;
+	}
+	std::printf("All draw command builder checks passed\n");
+	return EXIT_SUCCESS;
+}
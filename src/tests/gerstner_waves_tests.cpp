@@ -0,0 +1,133 @@
+#include "EDAF80/gerstner_waves.hpp"
+#include "core/parallel.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// my_ocean3.vert, translated line by line, to check the evaluator
+	// against.
+	glm::mat3 reference_wave_height(glm::vec2 uv, float A, glm::vec2 D, float f, float p, float k, float t)
+	{
+		float s = A * std::sin(glm::dot(uv, D) * f + t * p),
+		      c = A * std::cos(glm::dot(uv, D) * f + t * p),
+		      Q = k / 10.0f,
+		      QDxyWAs = Q * D.x * D.y * f * s;
+		return glm::mat3(glm::vec3(Q * D.x * c, Q * D.y * c, s),
+		                 glm::vec3(1.0f - Q * D.x * D.x * f * s, -QDxyWAs, D.x * f * c),
+		                 glm::vec3(-QDxyWAs, 1.0f - Q * D.y * D.y * f * s, D.y * f * c));
+	}
+
+	ocean::gerstner_sample reference_vertex(glm::vec2 const &texcoord, std::vector<ocean::gerstner_wave> const &waves,
+	                                        float space_scale, float t)
+	{
+		glm::vec2 uv = (-1.0f + 2.0f * texcoord) * space_scale;
+		glm::mat3 wave_height = glm::mat3(0.0f);
+		for (auto const &wave : waves)
+			wave_height += reference_wave_height(uv, wave.amplitude, wave.direction, wave.frequency, wave.phase, wave.spikiness, t);
+
+		glm::vec2 texedgeDistances = glm::min(texcoord, 1.0f - texcoord);
+		float texedgeFactor = glm::smoothstep(0.0f, 0.05f, glm::min(texedgeDistances.x, texedgeDistances.y));
+		wave_height[0] *= texedgeFactor;
+
+		glm::vec3 tang = glm::normalize(glm::mix(glm::vec3(1.0f, 0.0f, 0.0f), wave_height[1], texedgeFactor));
+		glm::vec3 bino = glm::normalize(glm::mix(glm::vec3(0.0f, 1.0f, 0.0f), wave_height[2], texedgeFactor));
+		return {wave_height[0], tang, bino, glm::cross(tang, bino)};
+	}
+
+	//! Compare `gerstner_evaluator` with the shader for `points_nb` random
+	//! points, and check that the heights it finds lie on the displaced
+	//! surface; print the largest errors, and return whether they are all
+	//! within single-precision tolerances.
+	bool check_evaluator(unsigned int seed, size_t points_nb)
+	{
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		// Waves like the default ones of assignment 4, whose surface does
+		// not fold onto itself.
+		std::vector<ocean::gerstner_wave> waves;
+		for (auto i = 0u; i < 4u; ++i)
+			waves.push_back({unit(generator),
+			                 glm::vec2(2.0f * unit(generator) - 1.0f, 2.0f * unit(generator) - 1.0f),
+			                 0.5f * unit(generator),
+			                 2.0f * unit(generator) - 1.0f,
+			                 1.0f + 2.0f * unit(generator)});
+		auto const space_scale = 50.0f;
+		auto const surface_size = glm::vec2(40.0f, -40.0f);
+		ocean::gerstner_evaluator const evaluator(waves, space_scale);
+
+		std::vector<glm::vec2> texcoords(points_nb);
+		for (auto &texcoord : texcoords)
+			texcoord = glm::vec2(unit(generator), unit(generator));
+
+		auto const time = 100.0f * unit(generator);
+		std::vector<ocean::gerstner_sample> samples(points_nb);
+		evaluator.evaluate(texcoords.data(), points_nb, time, samples.data());
+
+		float displacement_error = 0.0f, normal_error = 0.0f;
+		for (size_t i = 0u; i < points_nb; ++i)
+		{
+			auto const expected = reference_vertex(texcoords[i], waves, space_scale, time);
+			displacement_error = std::max(displacement_error, glm::length(samples[i].displacement - expected.displacement));
+			normal_error = std::max(normal_error, glm::length(samples[i].normal - expected.normal));
+		}
+		if (points_nb > 0u)
+		{
+			auto const single = evaluator.evaluate(texcoords.back(), time);
+			displacement_error = std::max(displacement_error, glm::length(single.displacement - samples.back().displacement));
+		}
+
+		// The heights found for points away from the edges should be those
+		// of vertices which the shader moves onto these points.
+		std::vector<glm::vec2> points(points_nb);
+		for (auto &point : points)
+			point = glm::vec2(0.1f + 0.8f * unit(generator), 0.1f + 0.8f * unit(generator));
+		std::vector<float> heights(points_nb);
+		std::vector<glm::vec2> rest(points_nb);
+		evaluator.heights_at(points.data(), points_nb, time, surface_size, heights.data(), rest.data());
+
+		float position_error = 0.0f, height_error = 0.0f;
+		for (size_t i = 0u; i < points_nb; ++i)
+		{
+			auto const expected = reference_vertex(rest[i], waves, space_scale, time).displacement;
+			auto const position = rest[i] * surface_size + glm::vec2(expected);
+			position_error = std::max(position_error, glm::length(position - points[i] * surface_size));
+			height_error = std::max(height_error, std::abs(heights[i] - expected.z));
+		}
+
+		std::printf("Gerstner evaluator against my_ocean3.vert, over %u points: displacement error %g, normal error %g, "
+		            "position error of the heights %g, height error %g\n",
+		            static_cast<unsigned int>(points_nb), displacement_error, normal_error, position_error, height_error);
+		return displacement_error < 1.0e-3f && normal_error < 1.0e-3f
+		    && position_error < 1.0e-3f && height_error < 1.0e-3f;
+	}
+}
+
+int main()
+{
+	// Batches not filling whole SSE registers, and large ones split
+	// across threads, both with several threads and with one.
+	bool passed = true;
+	for (auto const threads_nb : {0u, 1u})
+	{
+		bonobo::set_worker_threads_nb(threads_nb);
+		passed = check_evaluator(36u, 10000u) && passed;
+		passed = check_evaluator(37u, 7u) && passed;
+		passed = check_evaluator(38u, 1u) && passed;
+	}
+
+	if (!passed)
+	{
+		std::fprintf(stderr, "The Gerstner evaluator does not match my_ocean3.vert.\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
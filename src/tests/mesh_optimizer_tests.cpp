@@ -0,0 +1,99 @@
+#include "core/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	unsigned int failures_nb = 0u;
+
+	void check(bool condition, char const* expression, char const* file, int line)
+	{
+		if (condition)
+			return;
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		++failures_nb;
+	}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+	void test_fifo_misses()
+	{
+		// 0 1 2 | 2 1 0 | 0 1 3 | 3 1 2, misses marked with a *:
+		// * 1 entry:   *0 *1 *2 |  2 *1 *0 |  0 *1 *3 |  3 *1 *2 -> 9
+		// * 2 entries: *0 *1 *2 |  2  1 *0 |  0 *1 *3 |  3  1 *2 -> 7
+		// * 3 entries: *0 *1 *2 |  2  1  0 |  0  1 *3 |  3  1  2 -> 4
+		GLuint const indices[] = { 0u, 1u, 2u, 2u, 1u, 0u, 0u, 1u, 3u, 3u, 1u, 2u };
+		std::array<size_t, 3> const expected_misses = { { 9u, 7u, 4u } };
+		for (size_t cache_size = 1u; cache_size <= 3u; ++cache_size) {
+			auto const stats = bonobo::simulate_vertex_cache(indices, 12u, 4u, cache_size);
+			CHECK(stats.transformed_nb == expected_misses[cache_size - 1u]);
+			CHECK(stats.acmr == static_cast<float>(expected_misses[cache_size - 1u]) / 4.0f);
+			CHECK(stats.atvr == static_cast<float>(expected_misses[cache_size - 1u]) / 4.0f);
+		}
+
+		// With as many entries as vertices, each one is only transformed
+		// once.
+		auto const stats = bonobo::simulate_vertex_cache(indices, 12u, 4u, 4u);
+		CHECK(stats.transformed_nb == 4u && stats.atvr == 1.0f);
+	}
+
+	void test_tipsify_grid()
+	{
+		// A grid much wider than the cache, triangulated row after row, so
+		// that no vertex is still cached when the next row reuses it.
+		size_t const quads_x = 64u, quads_y = 32u;
+		size_t const vertices_nb = (quads_x + 1u) * (quads_y + 1u);
+		auto indices = std::vector<GLuint>();
+		for (size_t y = 0u; y < quads_y; ++y)
+			for (size_t x = 0u; x < quads_x; ++x) {
+				auto const v = static_cast<GLuint>(y * (quads_x + 1u) + x);
+				auto const w = static_cast<GLuint>(quads_x + 1u);
+				GLuint const quad[] = { v, v + 1u, v + w + 1u, v, v + w + 1u, v + w };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		auto const original = indices;
+
+		auto const before = bonobo::simulate_vertex_cache(indices.data(), indices.size(), vertices_nb);
+		auto const clusters = bonobo::optimize_vertex_cache(indices.data(), indices.size(), vertices_nb);
+		auto const after = bonobo::simulate_vertex_cache(indices.data(), indices.size(), vertices_nb);
+		std::printf("Grid of %zux%zu quads: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %zu clusters\n",
+		            quads_x, quads_y, before.acmr, after.acmr, before.atvr, after.atvr, clusters.size());
+
+		// Each row transforms the vertices of its lower edge again.
+		CHECK(before.acmr > 0.98f && before.acmr < 1.05f);
+		CHECK(after.acmr < 0.75f);
+		CHECK(after.atvr < 1.5f);
+		CHECK(!clusters.empty() && clusters.front() == 0u);
+		CHECK(std::is_sorted(clusters.begin(), clusters.end()));
+
+		// Same triangles, with the same winding, in another order.
+		auto const triangles = [](std::vector<GLuint> const& list) {
+			auto sorted = std::vector<std::array<GLuint, 3>>();
+			for (size_t i = 0u; i < list.size(); i += 3u) {
+				std::array<GLuint, 3> triangle = { { list[i], list[i + 1u], list[i + 2u] } };
+				std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+				sorted.push_back(triangle);
+			}
+			std::sort(sorted.begin(), sorted.end());
+			return sorted;
+		};
+		CHECK(triangles(indices) == triangles(original));
+	}
+}
+
+int main()
+{
+	test_fifo_misses();
+	test_tipsify_grid();
+
+	if (failures_nb > 0u) {
+		std::fprintf(stderr, "%u mesh optimizer checks failed\n", failures_nb);
+		return EXIT_FAILURE;
+	}
+	std::printf("All mesh optimizer checks passed\n");
+	return EXIT_SUCCESS;
+}
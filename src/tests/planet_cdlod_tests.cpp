@@ -0,0 +1,113 @@
+#include "EDAF80/planet_cdlod.hpp"
+
+#include "core/Log.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+// cdlod_selector logs the parameters it has to fix; the checks are built
+// without the rest of core, so its messages are printed here.
+void Log::Report(unsigned int /*flags*/, char const* /*file*/, char const* /*function*/, int /*line*/,
+                 Log::Type /*type*/, char const* str, ...)
+{
+	va_list arguments;
+	va_start(arguments, str);
+	std::vfprintf(stderr, str, arguments);
+	va_end(arguments);
+	std::fprintf(stderr, "\n");
+}
+
+namespace
+{
+	unsigned int failures_nb = 0u;
+
+	void check(bool condition, char const* expression, char const* file, int line)
+	{
+		if (condition)
+			return;
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		++failures_nb;
+	}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+	// Camera at `altitude` above the surface in `direction`, looking
+	// either at the horizon or straight down; the near plane follows the
+	// altitude to keep the far plane precise.
+	glm::mat4 view_at(glm::vec3 const& direction, float radius, float altitude, bool down)
+	{
+		auto const eye = (radius + altitude) * direction;
+		auto const tangent = glm::normalize(glm::cross(direction, std::abs(direction.y) < 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f)
+		                                                                                     : glm::vec3(1.0f, 0.0f, 0.0f)));
+		auto const horizon = std::sqrt(altitude * (2.0f * radius + altitude));
+		auto const target = down ? glm::vec3(0.0f) : eye + radius * tangent - horizon * direction;
+		auto const projection = glm::perspective(0.5f * glm::half_pi<float>(), 16.0f / 9.0f, 0.5f * altitude,
+		                                                altitude + 2.0f * radius);
+		return projection * glm::lookAt(eye, target, down ? tangent : direction);
+	}
+
+	void test_triangle_bound(planet::cdlod_parameters const& parameters)
+	{
+		planet::cdlod_selector selector(parameters);
+		auto const radius = selector.get_parameters().radius;
+
+		// Above the centre of a face, an edge and a corner of the cube,
+		// where the nodes are the largest and smallest on the sphere.
+		glm::vec3 const directions[] = {
+			glm::vec3(0.0f, 1.0f, 0.0f),
+			glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)),
+			glm::normalize(glm::vec3(1.0f, 1.0f, 1.0f)),
+			glm::normalize(glm::vec3(0.3f, 0.8f, -0.5f))
+		};
+		size_t selections_nb = 0u, max_triangles_nb = 0u;
+		for (auto altitude = 0.0001f * radius; altitude <= 1000.0f * radius; altitude *= 1.25f) {
+			for (auto const& direction : directions) {
+				for (auto const down : { false, true }) {
+					selector.select((radius + altitude) * direction, view_at(direction, radius, altitude, down));
+					auto const& statistics = selector.get_statistics();
+					CHECK(statistics.triangles_nb <= selector.get_max_triangles_nb());
+					CHECK(statistics.patches_nb + statistics.half_patches_nb > 0u);
+					CHECK(selector.get_patches().size() == statistics.patches_nb);
+					CHECK(selector.get_half_patches().size() == statistics.half_patches_nb);
+					max_triangles_nb = std::max(statistics.triangles_nb, max_triangles_nb);
+					++selections_nb;
+				}
+			}
+		}
+		std::printf("%u levels of %ux%u patches: at most %zu of %zu triangles over %zu selections\n",
+		            selector.get_parameters().levels_nb, selector.get_parameters().patch_resolution,
+		            selector.get_parameters().patch_resolution, max_triangles_nb, selector.get_max_triangles_nb(),
+		            selections_nb);
+	}
+}
+
+int main()
+{
+	test_triangle_bound(planet::cdlod_parameters());
+
+	planet::cdlod_parameters mountains;
+	mountains.radius = 6000.0f;
+	mountains.levels_nb = 14u;
+	mountains.patch_resolution = 16u;
+	mountains.max_height = 50.0f;
+	test_triangle_bound(mountains);
+
+	planet::cdlod_parameters coarse;
+	coarse.levels_nb = 4u;
+	coarse.patch_resolution = 8u;
+	coarse.lod_range_ratio = 8.0f;
+	test_triangle_bound(coarse);
+
+	if (failures_nb > 0u) {
+		std::fprintf(stderr, "%u CDLOD checks failed\n", failures_nb);
+		return EXIT_FAILURE;
+	}
+	std::printf("All CDLOD checks passed\n");
+	return EXIT_SUCCESS;
+}
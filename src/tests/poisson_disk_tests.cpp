@@ -0,0 +1,160 @@
+#include "core/poisson_disk.hpp"
+#include "core/parallel.hpp"
+
+#include "core/Log.h"
+#include "core/Misc.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// The benchmarks next to the samplers log and time themselves; the checks
+// are built without the rest of core, so both are provided here.
+void Log::Report(unsigned int /*flags*/, char const* /*file*/, char const* /*function*/, int /*line*/,
+                 Log::Type /*type*/, char const* str, ...)
+{
+	va_list arguments;
+	va_start(arguments, str);
+	std::vfprintf(stderr, str, arguments);
+	va_end(arguments);
+	std::fprintf(stderr, "\n");
+}
+
+double GetTimeMilliseconds()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+namespace
+{
+	unsigned int failures_nb = 0u;
+
+	void check(bool condition, char const* expression, char const* file, int line)
+	{
+		if (condition)
+			return;
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		++failures_nb;
+	}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+	// Closest two points came, relative to the distance kept around the
+	// denser of the two, sweeping along x.
+	template<typename Point, typename Radius>
+	float closest_ratio(std::vector<Point> points, float max_radius, Radius const& radius_at)
+	{
+		std::sort(points.begin(), points.end(), [](Point const& a, Point const& b) { return a.x < b.x; });
+		auto ratio = 2.0f;
+		for (size_t i = 0u; i < points.size(); ++i)
+			for (size_t j = i + 1u; j < points.size() && points[j].x - points[i].x < max_radius; ++j) {
+				auto const radius = std::min(radius_at(points[i]), radius_at(points[j]));
+				ratio = std::min(glm::length(points[j] - points[i]) / radius, ratio);
+			}
+		return ratio;
+	}
+
+	void test_rectangle()
+	{
+		glm::vec2 const lower(-20.0f, 10.0f), upper(180.0f, 110.0f);
+		bonobo::poisson_disk_parameters parameters;
+		parameters.min_distance = 0.5f;
+		auto const points = bonobo::poisson_disk_rectangle(lower, upper, parameters);
+		auto const ratio = closest_ratio(points, parameters.min_distance, [&](glm::vec2 const&) { return parameters.min_distance; });
+		std::printf("%zu points over a rectangle, at least %.5f times the minimal distance apart\n", points.size(), ratio);
+
+		// Closer to a hexagonal packing than to a random one.
+		auto const area = (upper.x - lower.x) * (upper.y - lower.y);
+		CHECK(points.size() > static_cast<size_t>(0.6f * area / (parameters.min_distance * parameters.min_distance)));
+		CHECK(ratio >= 0.9999f);
+		for (auto const& point : points)
+			CHECK(point.x >= lower.x && point.y >= lower.y && point.x <= upper.x && point.y <= upper.y);
+	}
+
+	void test_density()
+	{
+		// Sparser towards +x, empty below 1/8 and around the zone.
+		bonobo::poisson_disk_parameters parameters;
+		parameters.min_distance = 0.5f;
+		parameters.min_density = 1.0f / 8.0f;
+		parameters.density.width = 3u;
+		parameters.density.height = 2u;
+		parameters.density.values = { 1.0f, 0.25f, 0.0f, 1.0f, 0.25f, 0.0f };
+		parameters.exclusion_zones.emplace_back(10.0f, 20.0f, 0.0f, 5.0f);
+		glm::vec2 const lower(0.0f), upper(60.0f, 40.0f);
+		auto const points = bonobo::poisson_disk_rectangle(lower, upper, parameters);
+
+		auto const density_at = [&](glm::vec2 const& point) {
+			return parameters.density.sample((point - lower) / (upper - lower));
+		};
+		auto const radius_at = [&](glm::vec2 const& point) {
+			return parameters.min_distance / std::sqrt(std::min(density_at(point), 1.0f));
+		};
+		auto const ratio = closest_ratio(points, parameters.min_distance / std::sqrt(parameters.min_density), radius_at);
+		std::printf("%zu points over a density map, at least %.5f times their distance apart\n", points.size(), ratio);
+
+		CHECK(!points.empty());
+		CHECK(ratio >= 0.9999f);
+		for (auto const& point : points) {
+			CHECK(density_at(point) >= parameters.min_density);
+			CHECK(glm::length(point - glm::vec2(10.0f, 20.0f)) >= 5.0f);
+		}
+	}
+
+	void test_sphere()
+	{
+		// Coarse enough for points to gather along the edges and at the
+		// corners of the cube.
+		auto const radius = 10.0f;
+		bonobo::poisson_disk_parameters parameters;
+		parameters.min_distance = 0.4f;
+		auto const points = bonobo::poisson_disk_sphere(radius, parameters);
+		auto const ratio = closest_ratio(points, parameters.min_distance, [&](glm::vec3 const&) { return parameters.min_distance; });
+		std::printf("%zu points over a sphere, at least %.5f times the minimal distance apart\n", points.size(), ratio);
+
+		auto const area = 4.0f * glm::pi<float>() * radius * radius;
+		CHECK(points.size() > static_cast<size_t>(0.6f * area / (parameters.min_distance * parameters.min_distance)));
+		CHECK(ratio >= 0.9999f);
+		for (auto const& point : points)
+			CHECK(std::abs(glm::length(point) - radius) < 1.0e-4f * radius);
+	}
+
+	void test_threads()
+	{
+		// Tiles, and opposite faces of the sphere, are filled concurrently,
+		// from seeds which do not depend on the threads.
+		bonobo::poisson_disk_parameters parameters;
+		parameters.min_distance = 0.25f;
+		std::vector<glm::vec2> plane_points[2];
+		std::vector<glm::vec3> sphere_points[2];
+		for (size_t run = 0u; run < 2u; ++run) {
+			bonobo::set_worker_threads_nb(run == 0u ? 1u : 4u);
+			plane_points[run] = bonobo::poisson_disk_rectangle(glm::vec2(0.0f), glm::vec2(50.0f), parameters);
+			sphere_points[run] = bonobo::poisson_disk_sphere(6.0f, parameters);
+		}
+		bonobo::set_worker_threads_nb(0u);
+		CHECK(plane_points[0] == plane_points[1]);
+		CHECK(sphere_points[0] == sphere_points[1]);
+	}
+}
+
+int main()
+{
+	test_rectangle();
+	test_density();
+	test_sphere();
+	test_threads();
+
+	if (failures_nb > 0u) {
+		std::fprintf(stderr, "%u Poisson disk checks failed\n", failures_nb);
+		return EXIT_FAILURE;
+	}
+	std::printf("All Poisson disk checks passed\n");
+	return EXIT_SUCCESS;
+}
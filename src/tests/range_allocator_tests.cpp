@@ -0,0 +1,275 @@
+#include "core/range_allocator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	unsigned int failures_nb = 0u;
+
+	void check(bool condition, char const* expression, char const* file, int line)
+	{
+		if (condition)
+			return;
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		++failures_nb;
+	}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+	using allocation = bonobo::range_allocator::allocation;
+
+	void test_allocate_and_free()
+	{
+		bonobo::range_allocator allocator(1024u);
+
+		auto const a = allocator.allocate(100u);
+		auto const b = allocator.allocate(200u);
+		auto const c = allocator.allocate(300u);
+		CHECK(a.is_valid() && b.is_valid() && c.is_valid());
+		CHECK(a.offset == 0u && a.size == 100u);
+		CHECK(b.offset == 100u && b.size == 200u);
+		CHECK(c.offset == 300u && c.size == 300u);
+
+		CHECK(!allocator.allocate(0u).is_valid());
+		CHECK(!allocator.allocate(1025u).is_valid());
+		CHECK(!allocator.allocate(500u).is_valid());
+		auto const d = allocator.allocate(424u);
+		CHECK(d.is_valid() && d.offset == 600u);
+		CHECK(!allocator.allocate(1u).is_valid());
+
+		// A freed range is handed out again.
+		allocator.free(b);
+		auto const e = allocator.allocate(150u);
+		CHECK(e.is_valid() && e.offset == 100u);
+
+		// Freeing an invalid handle is a no-op.
+		allocator.free(allocation());
+		CHECK(allocator.get_statistics().allocations_nb == 4u);
+
+		allocator.reset();
+		auto const stats = allocator.get_statistics();
+		CHECK(stats.allocations_nb == 0u && stats.used == 0u && stats.free == 1024u);
+		CHECK(allocator.allocate(1024u).offset == 0u);
+	}
+
+	void test_exact_fit()
+	{
+		// Every size, whether a bin size or in between two of them, fits in
+		// a free range of exactly that size.
+		for (uint32_t size = 1u; size <= 5000u; ++size) {
+			bonobo::range_allocator allocator(size);
+			auto const range = allocator.allocate(size);
+			CHECK(range.is_valid() && range.offset == 0u && range.size == size);
+		}
+		for (uint32_t shift = 10u; shift < 32u; ++shift) {
+			auto const size = (1u << shift) + 1u;
+			bonobo::range_allocator allocator(size);
+			CHECK(allocator.allocate(size).is_valid());
+		}
+		{
+			bonobo::range_allocator allocator(0xffffffffu);
+			CHECK(allocator.allocate(0xffffffffu).is_valid());
+		}
+
+		// Same in a hole between two used ranges.
+		bonobo::range_allocator allocator(3000u);
+		auto const a = allocator.allocate(1000u);
+		auto const b = allocator.allocate(1000u);
+		auto const c = allocator.allocate(1000u);
+		CHECK(c.is_valid());
+		allocator.free(b);
+		auto const d = allocator.allocate(1000u);
+		CHECK(d.is_valid() && d.offset == 1000u);
+		CHECK(!allocator.allocate(1u).is_valid());
+		allocator.free(a);
+		CHECK(!allocator.allocate(1001u).is_valid());
+		CHECK(allocator.allocate(999u).offset == 0u);
+	}
+
+	void test_coalescing()
+	{
+		// Free the middle one last, then the outer ones first: all orders
+		// end with a single free range spanning the whole capacity.
+		uint32_t const orders[][3] = {
+			{ 0u, 1u, 2u }, { 0u, 2u, 1u }, { 1u, 0u, 2u },
+			{ 1u, 2u, 0u }, { 2u, 0u, 1u }, { 2u, 1u, 0u }
+		};
+		for (auto const& order : orders) {
+			bonobo::range_allocator allocator(1000u);
+			allocation ranges[3] = {
+				allocator.allocate(100u),
+				allocator.allocate(200u),
+				allocator.allocate(300u)
+			};
+			for (auto const i : order)
+				allocator.free(ranges[i]);
+
+			auto const stats = allocator.get_statistics();
+			CHECK(stats.free_blocks_nb == 1u);
+			CHECK(stats.largest_free_block == 1000u);
+			CHECK(stats.fragmentation == 0.0f);
+			CHECK(allocator.allocate(1000u).is_valid());
+		}
+	}
+
+	void test_grow()
+	{
+		// Growing with a used range at the end appends a new free range.
+		{
+			bonobo::range_allocator allocator(100u);
+			auto const a = allocator.allocate(100u);
+			CHECK(a.is_valid());
+			allocator.grow(300u);
+			CHECK(allocator.get_capacity() == 300u);
+			auto const b = allocator.allocate(200u);
+			CHECK(b.is_valid() && b.offset == 100u);
+			allocator.free(a);
+			allocator.free(b);
+			CHECK(allocator.get_statistics().free_blocks_nb == 1u);
+			CHECK(allocator.allocate(300u).is_valid());
+		}
+
+		// Growing with a free range at the end extends it; this is what
+		// the geometry arena does when a mesh does not fit, growing by the
+		// size of the mesh at least.
+		{
+			bonobo::range_allocator allocator(1u << 16);
+			CHECK(allocator.allocate(50u).is_valid());
+			CHECK(!allocator.allocate(100000u).is_valid());
+			allocator.grow((1u << 16) + 100000u);
+			auto const range = allocator.allocate(100000u);
+			CHECK(range.is_valid() && range.offset == 50u);
+			CHECK(allocator.get_statistics().free_blocks_nb == 1u);
+		}
+
+		// Shrinking is ignored.
+		{
+			bonobo::range_allocator allocator(100u);
+			allocator.grow(50u);
+			CHECK(allocator.get_capacity() == 100u);
+		}
+
+		// Growing an empty allocator.
+		{
+			bonobo::range_allocator allocator(0u);
+			CHECK(!allocator.allocate(1u).is_valid());
+			allocator.grow(10u);
+			CHECK(allocator.allocate(10u).is_valid());
+		}
+	}
+
+	void test_statistics()
+	{
+		bonobo::range_allocator allocator(1000u);
+		auto stats = allocator.get_statistics();
+		CHECK(stats.capacity == 1000u && stats.used == 0u && stats.free == 1000u);
+		CHECK(stats.largest_free_block == 1000u && stats.free_blocks_nb == 1u);
+		CHECK(stats.allocations_nb == 0u && stats.fragmentation == 0.0f);
+
+		allocation ranges[10];
+		for (auto& range : ranges)
+			range = allocator.allocate(100u);
+		stats = allocator.get_statistics();
+		CHECK(stats.used == 1000u && stats.free == 0u && stats.allocations_nb == 10u);
+		CHECK(stats.free_blocks_nb == 0u && stats.fragmentation == 0.0f);
+
+		// Free every other range: 5 holes of 100 units.
+		for (std::size_t i = 0u; i < 10u; i += 2u)
+			allocator.free(ranges[i]);
+		stats = allocator.get_statistics();
+		CHECK(stats.used == 500u && stats.free == 500u && stats.allocations_nb == 5u);
+		CHECK(stats.free_blocks_nb == 5u && stats.largest_free_block == 100u);
+		CHECK(std::abs(stats.fragmentation - 0.8f) < 1e-6f);
+		CHECK(!allocator.allocate(101u).is_valid());
+
+		// Closing the gap between the two last holes merges three ranges.
+		allocator.free(ranges[7]);
+		stats = allocator.get_statistics();
+		CHECK(stats.free_blocks_nb == 4u && stats.largest_free_block == 300u);
+		CHECK(allocator.allocate(300u).offset == 600u);
+	}
+
+	void test_random_operations()
+	{
+		// Compare against a plain list of the live ranges: they must never
+		// overlap, and the statistics must match it.
+		std::mt19937 generator(1234u);
+		uint32_t const capacity = 1u << 20;
+		bonobo::range_allocator allocator(capacity, 16u);
+		std::vector<allocation> live;
+		uint32_t used = 0u;
+
+		for (int step = 0; step < 20000; ++step) {
+			auto const roll = generator() % 100u;
+			if (roll < 55u || live.empty()) {
+				auto const size = 1u + generator() % ((roll < 5u) ? 65536u : 2048u);
+				auto const range = allocator.allocate(size);
+				if (!range.is_valid())
+					continue;
+				CHECK(range.size == size);
+				CHECK(range.offset + range.size <= allocator.get_capacity());
+				live.push_back(range);
+				used += size;
+			} else if (roll < 99u) {
+				auto const index = generator() % live.size();
+				allocator.free(live[index]);
+				used -= live[index].size;
+				live[index] = live.back();
+				live.pop_back();
+			} else {
+				allocator.grow(allocator.get_capacity() + generator() % 4096u);
+			}
+
+			if (step % 97 != 0)
+				continue;
+
+			auto sorted = live;
+			std::sort(sorted.begin(), sorted.end(),
+			          [](allocation const& a, allocation const& b){ return a.offset < b.offset; });
+			for (std::size_t i = 1u; i < sorted.size(); ++i)
+				CHECK(sorted[i - 1u].offset + sorted[i - 1u].size <= sorted[i].offset);
+
+			auto const stats = allocator.get_statistics();
+			CHECK(stats.used == used);
+			CHECK(stats.free == stats.capacity - used);
+			CHECK(stats.allocations_nb == live.size());
+			CHECK(stats.largest_free_block <= stats.free);
+			CHECK(stats.fragmentation >= 0.0f && stats.fragmentation <= 1.0f);
+			// The largest free range can always be allocated whole.
+			if (stats.largest_free_block > 0u) {
+				auto const range = allocator.allocate(stats.largest_free_block);
+				CHECK(range.is_valid());
+				allocator.free(range);
+			}
+		}
+
+		for (auto const& range : live)
+			allocator.free(range);
+		auto const stats = allocator.get_statistics();
+		CHECK(stats.used == 0u && stats.free_blocks_nb == 1u && stats.allocations_nb == 0u);
+		CHECK(allocator.allocate(allocator.get_capacity()).is_valid());
+	}
+}
+
+int main()
+{
+	test_allocate_and_free();
+	test_exact_fit();
+	test_coalescing();
+	test_grow();
+	test_statistics();
+	test_random_operations();
+
+	if (failures_nb > 0u) {
+		std::fprintf(stderr, "%u range allocator checks failed\n", failures_nb);
+		return EXIT_FAILURE;
+	}
+	std::printf("All range allocator checks passed\n");
+	return EXIT_SUCCESS;
+}